@@ -0,0 +1,12 @@
+if(EIGEN3_INCLUDE_DIR)
+    # Already in cache, be silent
+    set(Eigen3_FIND_QUIETLY TRUE)
+endif()
+
+find_path(EIGEN3_INCLUDE_DIR NAMES Eigen/Core PATH_SUFFIXES eigen3)
+
+include(FindPackageHandleStandardArgs)
+
+find_package_handle_standard_args(Eigen3 DEFAULT_MSG EIGEN3_INCLUDE_DIR)
+
+mark_as_advanced(EIGEN3_INCLUDE_DIR)
@@ -0,0 +1,604 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#ifndef ARBPP_AFFINE_ARB_HPP
+#define ARBPP_AFFINE_ARB_HPP
+
+#include <algorithm>
+#include <arb.h>
+#include <arf.h>
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <mag.h>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "arbpp.hpp"
+
+namespace arbpp
+{
+
+/// Affine ball.
+/**
+ * An affine ball represents a real quantity in the affine form
+ * \f[
+ * \hat{x} = x_0 + \sum_i x_i \varepsilon_i,
+ * \f]
+ * where the centre \f$ x_0 \f$ and the partial deviations \f$ x_i \f$ are arbpp::arb balls with exact midpoints, and the
+ * \f$ \varepsilon_i \in [-1,1] \f$ are noise symbols. Each noise symbol stands for one source of uncertainty (the radius
+ * of an input, or the rounding and linearisation errors of an operation), and it is shared by all the quantities which
+ * depend on it. The deviations are stored as a sparse vector sorted by noise symbol.
+ *
+ * Since the first-order correlations are kept symbolically, the contributions of the common noise symbols cancel
+ * in the linear operations: <tt>x - x</tt> is exactly zero, and in a long chain of additions and subtractions of correlated
+ * quantities (e.g., the taps of a filter) the uncertainty does not grow with the length of the chain. With plain balls
+ * instead each occurrence of a quantity is treated as independent, and the radii of the operands add up at each step.
+ *
+ * An affine ball is created from an arbpp::arb (or from a type interoperable with it), introducing a fresh noise symbol
+ * for its radius, and it is converted back to an enclosing arbpp::arb via an explicit conversion. The arithmetic operators,
+ * the comparisons and the functions (cos(), sqrt(), abs()) mirror the ones of arbpp::arb, including the mixed operations
+ * with arbpp::arb and with the interoperable types. The operations are carried out with the maximum precision of the
+ * operands. The nonlinear operations use the min-range (for division and square root) or the mean-value (for the cosine)
+ * linearisation, and the errors of each operation are collected into a single fresh noise symbol. Hence the number of
+ * noise symbols grows with the number of nonlinear operations.
+ *
+ * The noise symbols are drawn from a global atomic counter, so that the affine balls created in different threads
+ * can be freely combined.
+ */
+class affine_arb: public detail::arb_scalar_ops<affine_arb>
+{
+        friend class detail::arb_scalar_ops<affine_arb>;
+        typedef unsigned long long symbol_type;
+        typedef std::vector<std::pair<symbol_type,arb>> terms_type;
+        static symbol_type new_symbol()
+        {
+            static std::atomic<symbol_type> counter(0u);
+            return counter.fetch_add(1u);
+        }
+        static arb zero(long prec)
+        {
+            arb retval;
+            retval.set_precision(prec);
+            return retval;
+        }
+        // Exact zero with precision prec.
+        struct zero_tag {};
+        affine_arb(long prec, zero_tag):m_prec(prec),m_center(zero(prec)) {}
+        // Move the radii of the centre and of the deviations, together with the magnitude of err, into a fresh noise
+        // symbol, so that all the balls stored in this are exact.
+        void normalise(const arb &err)
+        {
+            arb e{zero(m_prec)};
+            ::arb_add_error(e.get_arb_t(),err.get_arb_t());
+            ::arb_add_error_mag(e.get_arb_t(),arb_radref(m_center.get_arb_t()));
+            ::mag_zero(arb_radref(m_center.get_arb_t()));
+            std::size_t n = 0u;
+            for (auto &t: m_terms) {
+                ::arb_add_error_mag(e.get_arb_t(),arb_radref(t.second.get_arb_t()));
+                ::mag_zero(arb_radref(t.second.get_arb_t()));
+                if (!::arf_is_zero(arb_midref(t.second.get_arb_t()))) {
+                    if (&m_terms[n] != &t) {
+                        m_terms[n] = std::move(t);
+                    }
+                    ++n;
+                }
+            }
+            m_terms.erase(m_terms.begin() + static_cast<terms_type::difference_type>(n),m_terms.end());
+            if (::mag_is_zero(arb_radref(e.get_arb_t()))) {
+                return;
+            }
+            arb c{zero(m_prec)};
+            ::arf_set_mag(arb_midref(c.get_arb_t()),arb_radref(e.get_arb_t()));
+            const auto s = new_symbol();
+            const auto it = std::upper_bound(m_terms.begin(),m_terms.end(),s,
+                [](symbol_type x, const std::pair<symbol_type,arb> &t) {return x < t.first;});
+            m_terms.emplace(it,s,std::move(c));
+        }
+        // Sum of the magnitudes of the deviations.
+        arb abs_sum() const
+        {
+            arb retval{zero(m_prec)}, a{zero(m_prec)};
+            for (const auto &t: m_terms) {
+                ::arb_abs(a.get_arb_t(),t.second.get_arb_t());
+                ::arb_add(retval.get_arb_t(),retval.get_arb_t(),a.get_arb_t(),m_prec);
+            }
+            return retval;
+        }
+        // Enclosure of the values of this.
+        arb enclosure() const
+        {
+            arb retval{m_center};
+            for (const auto &t: m_terms) {
+                ::arb_add_error(retval.get_arb_t(),t.second.get_arb_t());
+            }
+            return retval;
+        }
+        static affine_arb indeterminate(long prec)
+        {
+            affine_arb retval(prec,zero_tag{});
+            ::arb_indeterminate(retval.m_center.get_arb_t());
+            return retval;
+        }
+        // Implementation of the arithmetic operations.
+        static affine_arb binary_add(const affine_arb &a, const affine_arb &b, bool negate_b)
+        {
+            affine_arb retval(std::max(a.m_prec,b.m_prec),zero_tag{});
+            const long prec = retval.m_prec;
+            auto op = negate_b ? ::arb_sub : ::arb_add;
+            op(retval.m_center.get_arb_t(),a.m_center.get_arb_t(),b.m_center.get_arb_t(),prec);
+            retval.m_terms.reserve(a.m_terms.size() + b.m_terms.size());
+            auto ia = a.m_terms.begin(), ib = b.m_terms.begin();
+            while (ia != a.m_terms.end() || ib != b.m_terms.end()) {
+                arb c{zero(prec)};
+                if (ib == b.m_terms.end() || (ia != a.m_terms.end() && ia->first < ib->first)) {
+                    ::arb_set(c.get_arb_t(),ia->second.get_arb_t());
+                    retval.m_terms.emplace_back(ia->first,std::move(c));
+                    ++ia;
+                } else if (ia == a.m_terms.end() || ib->first < ia->first) {
+                    ::arb_set(c.get_arb_t(),ib->second.get_arb_t());
+                    if (negate_b) {
+                        ::arb_neg(c.get_arb_t(),c.get_arb_t());
+                    }
+                    retval.m_terms.emplace_back(ib->first,std::move(c));
+                    ++ib;
+                } else {
+                    // Common noise symbol.
+                    op(c.get_arb_t(),ia->second.get_arb_t(),ib->second.get_arb_t(),prec);
+                    retval.m_terms.emplace_back(ia->first,std::move(c));
+                    ++ia;
+                    ++ib;
+                }
+            }
+            retval.normalise(zero(prec));
+            return retval;
+        }
+        static affine_arb binary_mul(const affine_arb &a, const affine_arb &b)
+        {
+            // (a0 + A) * (b0 + B) = a0 * b0 + a0 * B + b0 * A + A * B. In the quadratic part A * B, the squares
+            // a_i * b_i * eps_i**2 range over [0,a_i * b_i]: their midpoints are moved into the centre, and the rest
+            // of A * B is bounded by sum |a_i| * sum |b_i| - sum |a_i * b_i| / 2.
+            affine_arb retval(std::max(a.m_prec,b.m_prec),zero_tag{});
+            const long prec = retval.m_prec;
+            arb diag{zero(prec)}, diag_abs{zero(prec)}, t{zero(prec)};
+            retval.m_terms.reserve(a.m_terms.size() + b.m_terms.size());
+            auto ia = a.m_terms.begin(), ib = b.m_terms.begin();
+            while (ia != a.m_terms.end() || ib != b.m_terms.end()) {
+                arb c{zero(prec)};
+                if (ib == b.m_terms.end() || (ia != a.m_terms.end() && ia->first < ib->first)) {
+                    ::arb_mul(c.get_arb_t(),ia->second.get_arb_t(),b.m_center.get_arb_t(),prec);
+                    retval.m_terms.emplace_back(ia->first,std::move(c));
+                    ++ia;
+                } else if (ia == a.m_terms.end() || ib->first < ia->first) {
+                    ::arb_mul(c.get_arb_t(),ib->second.get_arb_t(),a.m_center.get_arb_t(),prec);
+                    retval.m_terms.emplace_back(ib->first,std::move(c));
+                    ++ib;
+                } else {
+                    ::arb_mul(c.get_arb_t(),ia->second.get_arb_t(),b.m_center.get_arb_t(),prec);
+                    ::arb_addmul(c.get_arb_t(),ib->second.get_arb_t(),a.m_center.get_arb_t(),prec);
+                    retval.m_terms.emplace_back(ia->first,std::move(c));
+                    ::arb_mul(t.get_arb_t(),ia->second.get_arb_t(),ib->second.get_arb_t(),prec);
+                    ::arb_add(diag.get_arb_t(),diag.get_arb_t(),t.get_arb_t(),prec);
+                    ::arb_abs(t.get_arb_t(),t.get_arb_t());
+                    ::arb_add(diag_abs.get_arb_t(),diag_abs.get_arb_t(),t.get_arb_t(),prec);
+                    ++ia;
+                    ++ib;
+                }
+            }
+            ::arb_mul(retval.m_center.get_arb_t(),a.m_center.get_arb_t(),b.m_center.get_arb_t(),prec);
+            ::arb_mul_2exp_si(diag.get_arb_t(),diag.get_arb_t(),-1);
+            ::arb_add(retval.m_center.get_arb_t(),retval.m_center.get_arb_t(),diag.get_arb_t(),prec);
+            const arb sa = a.abs_sum(), sb = b.abs_sum();
+            ::arb_mul(t.get_arb_t(),sa.get_arb_t(),sb.get_arb_t(),prec);
+            ::arb_mul_2exp_si(diag_abs.get_arb_t(),diag_abs.get_arb_t(),-1);
+            ::arb_sub(t.get_arb_t(),t.get_arb_t(),diag_abs.get_arb_t(),prec);
+            retval.normalise(t);
+            return retval;
+        }
+        // NOTE: shift() and scale() leave the rounding errors in the radii, normalise() must be called afterwards.
+        void shift(const arb &x)
+        {
+            ::arb_add(m_center.get_arb_t(),m_center.get_arb_t(),x.get_arb_t(),m_prec);
+        }
+        void scale(const arb &x)
+        {
+            ::arb_mul(m_center.get_arb_t(),m_center.get_arb_t(),x.get_arb_t(),m_prec);
+            for (auto &t: m_terms) {
+                ::arb_mul(t.second.get_arb_t(),t.second.get_arb_t(),x.get_arb_t(),m_prec);
+            }
+        }
+        void add_scalar(const arb &x, long prec)
+        {
+            m_prec = prec;
+            shift(x);
+            normalise(zero(m_prec));
+        }
+        void mul_scalar(const arb &x, long prec)
+        {
+            m_prec = prec;
+            scale(x);
+            normalise(zero(m_prec));
+        }
+        void div_scalar(const arb &x, long prec)
+        {
+            m_prec = prec;
+            ::arb_div(m_center.get_arb_t(),m_center.get_arb_t(),x.get_arb_t(),m_prec);
+            for (auto &t: m_terms) {
+                ::arb_div(t.second.get_arb_t(),t.second.get_arb_t(),x.get_arb_t(),m_prec);
+            }
+            normalise(zero(m_prec));
+        }
+        affine_arb rdiv_scalar(const arb &x, long prec) const
+        {
+            affine_arb retval = reciprocal();
+            retval.mul_scalar(x,prec);
+            return retval;
+        }
+        // Min-range linearisation of phi(this), for a function phi whose derivative is monotone over the range [l,u]
+        // of this. With alpha = phi'(u), g(x) = phi(x) - alpha * x is monotone over [l,u], and its range is enclosed by
+        // the union of g(l) and g(u). The slope actually used is the midpoint m of alpha, and the
+        // difference (alpha - m) * x is added to the range of g.
+        template <typename F, typename DF>
+        affine_arb min_range(const F &phi, const DF &dphi) const
+        {
+            const long prec = m_prec;
+            const arb r = enclosure();
+            if (m_terms.empty()) {
+                return affine_arb{phi(r)};
+            }
+            arb l{zero(prec)}, u{zero(prec)};
+            ::arb_get_lbound_arf(arb_midref(l.get_arb_t()),r.get_arb_t(),prec);
+            ::arb_get_ubound_arf(arb_midref(u.get_arb_t()),r.get_arb_t(),prec);
+            const arb alpha = dphi(u);
+            arb m{zero(prec)}, gl = phi(l), gu = phi(u), g{zero(prec)};
+            ::arb_get_mid_arb(m.get_arb_t(),alpha.get_arb_t());
+            ::arb_submul(gl.get_arb_t(),alpha.get_arb_t(),l.get_arb_t(),prec);
+            ::arb_submul(gu.get_arb_t(),alpha.get_arb_t(),u.get_arb_t(),prec);
+            ::arb_union(g.get_arb_t(),gl.get_arb_t(),gu.get_arb_t(),prec);
+            ::arb_sub(gl.get_arb_t(),alpha.get_arb_t(),m.get_arb_t(),prec);
+            ::arb_addmul(g.get_arb_t(),gl.get_arb_t(),r.get_arb_t(),prec);
+            affine_arb retval{*this};
+            retval.scale(m);
+            retval.shift(g);
+            retval.normalise(zero(prec));
+            return retval;
+        }
+        affine_arb reciprocal() const
+        {
+            if (::arb_contains_zero(enclosure().get_arb_t())) {
+                return indeterminate(m_prec);
+            }
+            const long prec = m_prec;
+            return min_range([prec](const arb &x) -> arb {
+                arb retval{zero(prec)};
+                ::arb_inv(retval.get_arb_t(),x.get_arb_t(),prec);
+                return retval;
+            },[prec](const arb &x) -> arb {
+                // -1 / x**2.
+                arb retval{zero(prec)};
+                ::arb_sqr(retval.get_arb_t(),x.get_arb_t(),prec);
+                ::arb_inv(retval.get_arb_t(),retval.get_arb_t(),prec);
+                ::arb_neg(retval.get_arb_t(),retval.get_arb_t());
+                return retval;
+            });
+        }
+    public:
+        /// Default constructor.
+        /**
+         * Will initialise an exact zero with the default precision.
+         */
+        affine_arb():affine_arb(arb::get_default_precision(),zero_tag{}) {}
+        /// Constructor from arbpp::arb.
+        /**
+         * The centre of the affine ball is the midpoint of \p x, and the radius of \p x (if nonzero) is assigned to a fresh
+         * noise symbol. The precision of \p this is the precision of \p x.
+         *
+         * @param[in] x construction argument.
+         */
+        explicit affine_arb(const arb &x):affine_arb(x.get_precision(),zero_tag{})
+        {
+            arb r{zero(m_prec)};
+            ::arb_get_mid_arb(m_center.get_arb_t(),x.get_arb_t());
+            ::arb_get_rad_arb(r.get_arb_t(),x.get_arb_t());
+            normalise(r);
+        }
+        /// Generic constructor.
+        /**
+         * \note
+         * This constructor is enabled only if \p T is a type interoperable with arbpp::arb.
+         *
+         * Equivalent to constructing from <tt>arb{x,prec}</tt>.
+         *
+         * @param[in] x construction argument.
+         * @param[in] prec desired precision.
+         *
+         * @throws unspecified any exception thrown by the constructor of arbpp::arb from \p x.
+         */
+        template <typename T, typename std::enable_if<detail::is_arb_scalar<T>::value &&
+            !std::is_same<T,arb>::value,int>::type = 0>
+        explicit affine_arb(const T &x, long prec = arb::get_default_precision()):affine_arb(arb{x,prec}) {}
+        /// Conversion to arbpp::arb.
+        /**
+         * @return an arbpp::arb enclosing all the values of \p this, with the precision of \p this.
+         */
+        explicit operator arb() const
+        {
+            return enclosure();
+        }
+        /// Precision getter.
+        /**
+         * @return the precision of \p this.
+         */
+        long get_precision() const
+        {
+            return m_prec;
+        }
+        /// Centre getter.
+        /**
+         * @return a const reference to the centre of \p this.
+         */
+        const arb &get_center() const
+        {
+            return m_center;
+        }
+        /// Number of noise symbols.
+        /**
+         * @return the number of noise symbols on which \p this depends.
+         */
+        std::size_t get_n_symbols() const
+        {
+            return m_terms.size();
+        }
+        /// Identity operator.
+        /**
+         * @return a copy of \p this.
+         */
+        affine_arb operator+() const
+        {
+            return *this;
+        }
+        /// Negated copy.
+        /**
+         * @return a negated copy of \p this.
+         */
+        affine_arb operator-() const
+        {
+            affine_arb retval{*this};
+            ::arb_neg(retval.m_center.get_arb_t(),retval.m_center.get_arb_t());
+            for (auto &t: retval.m_terms) {
+                ::arb_neg(t.second.get_arb_t(),t.second.get_arb_t());
+            }
+            return retval;
+        }
+        /// Addition.
+        /**
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         *
+         * @return <tt>a + b</tt>.
+         */
+        friend affine_arb operator+(const affine_arb &a, const affine_arb &b)
+        {
+            return binary_add(a,b,false);
+        }
+        /// Subtraction.
+        /**
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         *
+         * @return <tt>a - b</tt>.
+         */
+        friend affine_arb operator-(const affine_arb &a, const affine_arb &b)
+        {
+            return binary_add(a,b,true);
+        }
+        /// Multiplication.
+        /**
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         *
+         * @return <tt>a * b</tt>.
+         */
+        friend affine_arb operator*(const affine_arb &a, const affine_arb &b)
+        {
+            return binary_mul(a,b);
+        }
+        /// Division.
+        /**
+         * The division is computed as the product of \p a by the (linearised) reciprocal of \p b.
+         *
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         *
+         * @return <tt>a / b</tt>.
+         */
+        friend affine_arb operator/(const affine_arb &a, const affine_arb &b)
+        {
+            return a * b.reciprocal();
+        }
+        /// Equality.
+        /**
+         * The comparisons are performed on the enclosure of <tt>a - b</tt>, so that the contributions of the noise
+         * symbols shared by \p a and \p b cancel out.
+         *
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         *
+         * @return <tt>arb(a - b) == 0</tt>.
+         */
+        friend tribool operator==(const affine_arb &a, const affine_arb &b)
+        {
+            return (a - b).enclosure() == zero(a.m_prec);
+        }
+        /// Inequality.
+        /**
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         *
+         * @return <tt>arb(a - b) != 0</tt>.
+         */
+        friend tribool operator!=(const affine_arb &a, const affine_arb &b)
+        {
+            return (a - b).enclosure() != zero(a.m_prec);
+        }
+        /// Less-than.
+        /**
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         *
+         * @return <tt>arb(a - b) < 0</tt>.
+         */
+        friend tribool operator<(const affine_arb &a, const affine_arb &b)
+        {
+            return (a - b).enclosure() < zero(a.m_prec);
+        }
+        /// Less-than or equal.
+        /**
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         *
+         * @return <tt>arb(a - b) <= 0</tt>.
+         */
+        friend tribool operator<=(const affine_arb &a, const affine_arb &b)
+        {
+            return (a - b).enclosure() <= zero(a.m_prec);
+        }
+        /// Greater-than.
+        /**
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         *
+         * @return <tt>arb(a - b) > 0</tt>.
+         */
+        friend tribool operator>(const affine_arb &a, const affine_arb &b)
+        {
+            return (a - b).enclosure() > zero(a.m_prec);
+        }
+        /// Greater-than or equal.
+        /**
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         *
+         * @return <tt>arb(a - b) >= 0</tt>.
+         */
+        friend tribool operator>=(const affine_arb &a, const affine_arb &b)
+        {
+            return (a - b).enclosure() >= zero(a.m_prec);
+        }
+        /// Cosine.
+        /**
+         * @param[in] x argument.
+         *
+         * @return the cosine of \p x.
+         */
+        friend affine_arb cos(const affine_arb &x)
+        {
+            // Mean-value form: cos(x) = cos(c) - sin(xi) * (x - c) for some xi in the range of x. With m the midpoint
+            // of -sin over the range, the error of m * (x - c) + cos(c) is bounded by |-sin(range) - m| * |x - c|.
+            const long prec = x.m_prec;
+            const arb r = x.enclosure();
+            if (x.m_terms.empty()) {
+                return affine_arb{cos(r)};
+            }
+            arb d{zero(prec)}, m{zero(prec)}, c{zero(prec)};
+            ::arb_sin(d.get_arb_t(),r.get_arb_t(),prec);
+            ::arb_neg(d.get_arb_t(),d.get_arb_t());
+            ::arb_get_mid_arb(m.get_arb_t(),d.get_arb_t());
+            ::arb_sub(d.get_arb_t(),d.get_arb_t(),m.get_arb_t(),prec);
+            const arb dev = x.abs_sum();
+            ::arb_mul(d.get_arb_t(),d.get_arb_t(),dev.get_arb_t(),prec);
+            ::arb_cos(c.get_arb_t(),x.m_center.get_arb_t(),prec);
+            affine_arb retval{x};
+            ::arb_zero(retval.m_center.get_arb_t());
+            retval.scale(m);
+            retval.shift(c);
+            retval.normalise(d);
+            return retval;
+        }
+        /// Square root.
+        /**
+         * @param[in] x argument.
+         *
+         * @return the square root of \p x (indeterminate if the range of \p x contains negative numbers).
+         */
+        friend affine_arb sqrt(const affine_arb &x)
+        {
+            if (!::arb_is_nonnegative(x.enclosure().get_arb_t())) {
+                return indeterminate(x.m_prec);
+            }
+            const long prec = x.m_prec;
+            return x.min_range([prec](const arb &y) -> arb {
+                arb retval{zero(prec)};
+                ::arb_sqrt(retval.get_arb_t(),y.get_arb_t(),prec);
+                return retval;
+            },[prec](const arb &y) -> arb {
+                // 1 / (2 * sqrt(y)).
+                arb retval{zero(prec)};
+                ::arb_sqrt(retval.get_arb_t(),y.get_arb_t(),prec);
+                ::arb_mul_2exp_si(retval.get_arb_t(),retval.get_arb_t(),1);
+                ::arb_inv(retval.get_arb_t(),retval.get_arb_t(),prec);
+                return retval;
+            });
+        }
+        /// Absolute value.
+        /**
+         * If the range of \p x contains both positive and negative numbers, the result does not retain the dependency
+         * on the noise symbols of \p x.
+         *
+         * @param[in] x argument.
+         *
+         * @return the absolute value of \p x.
+         */
+        friend affine_arb abs(const affine_arb &x)
+        {
+            const arb r = x.enclosure();
+            if (::arb_is_nonnegative(r.get_arb_t())) {
+                return x;
+            }
+            if (::arb_is_nonpositive(r.get_arb_t())) {
+                return -x;
+            }
+            return affine_arb{abs(r)};
+        }
+        /// Stream operator.
+        /**
+         * Prints the enclosure of \p x as an arbpp::arb.
+         *
+         * @param[in,out] os target stream.
+         * @param[in] x arbpp::affine_arb to be streamed.
+         *
+         * @return reference to \p os.
+         */
+        friend std::ostream &operator<<(std::ostream &os, const affine_arb &x)
+        {
+            return os << x.enclosure();
+        }
+    private:
+        long        m_prec;
+        arb         m_center;
+        terms_type  m_terms;
+};
+
+}
+
+#endif
@@ -24,22 +24,325 @@
 #include <algorithm>
 #include <arb.h>
 #include <arf.h>
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <cmath>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <flint.h>
+#include <fmpq.h>
 #include <fmpr.h>
+#include <fmpz.h>
+#include <functional>
+#include <gmp.h>
 #include <iostream>
 #include <limits>
 #include <mag.h>
 #include <memory>
 #include <mpfr.h>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 /// Root Arbpp namespace.
 namespace arbpp
 {
 
+#if defined(ARBPP_ENABLE_TRACING)
+
+/// Tracing.
+/**
+ * This namespace is available only if the \p ARBPP_ENABLE_TRACING macro is defined before including arbpp.hpp.
+ * In that case, the parallel algorithms of arbpp (sorting, summation, bulk conversions), the kernels of the matrix
+ * products of the Eigen integration and the evaluations of the elementary functions at high precision record spans
+ * (name, start and end times, thread) into per-thread ring buffers. Recording a span does not take any lock: each
+ * thread writes only to its own buffer, and the buffer is registered globally once, the first time the thread
+ * records a span. When a thread exits, its spans are moved to a global buffer. When a buffer is full, the oldest
+ * spans are overwritten.
+ *
+ * The recorded spans can be exported in the JSON format of the Chrome trace viewer
+ * (<tt>chrome://tracing</tt>, Perfetto). When the macro is not defined, the tracing hooks compile to nothing.
+ */
+namespace tracing
+{
+
+/// Capacity of the span buffer of each thread.
+const std::size_t buffer_capacity = 1u << 12;
+/// Capacity of the buffer holding the spans of the threads which have exited.
+const std::size_t retired_capacity = 1u << 18;
+/// Minimum precision for the evaluation of an elementary function to be traced.
+const long long_evaluation_prec = 4096;
+
+/// Span.
+struct event
+{
+    /// Name (a string with static storage duration).
+    const char          *name;
+    /// Start time, in nanoseconds since an unspecified epoch.
+    std::uint_least64_t begin;
+    /// End time, in nanoseconds since an unspecified epoch.
+    std::uint_least64_t end;
+    /// Identifier of the thread which recorded the span.
+    unsigned            tid;
+};
+
+namespace detail
+{
+
+inline std::uint_least64_t now() noexcept
+{
+    return static_cast<std::uint_least64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Ring buffer of a single thread. Only the owning thread writes, the counter of the recorded
+// spans is published with release semantics.
+struct thread_buffer
+{
+    explicit thread_buffer(unsigned id):m_events(buffer_capacity),m_count(0u),m_tid(id) {}
+    void push(const char *name, std::uint_least64_t begin, std::uint_least64_t end) noexcept
+    {
+        const auto c = m_count.load(std::memory_order_relaxed);
+        m_events[static_cast<std::size_t>(c % buffer_capacity)] = event{name,begin,end,m_tid};
+        m_count.store(c + 1u,std::memory_order_release);
+    }
+    std::vector<event>                  m_events;
+    std::atomic<std::uint_least64_t>    m_count;
+    const unsigned                      m_tid;
+};
+
+template <typename = void>
+struct base_registry
+{
+    struct registry_t
+    {
+        std::mutex                  mutex;
+        std::vector<thread_buffer *> live;
+        std::vector<event>          retired;
+        std::uint_least64_t         n_retired = 0u;
+        std::uint_least64_t         n_dropped = 0u;
+        std::atomic<unsigned>       next_tid{0u};
+    };
+    static registry_t &get()
+    {
+        static registry_t r;
+        return r;
+    }
+};
+
+// Owns the buffer of the calling thread, and moves its content to the global registry on thread exit.
+class buffer_holder
+{
+    public:
+        buffer_holder() = default;
+        buffer_holder(const buffer_holder &) = delete;
+        buffer_holder &operator=(const buffer_holder &) = delete;
+        ~buffer_holder()
+        {
+            if (!m_buffer) {
+                return;
+            }
+            auto &r = base_registry<>::get();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.live.erase(std::remove(r.live.begin(),r.live.end(),m_buffer.get()),r.live.end());
+            const auto c = m_buffer->m_count.load(std::memory_order_relaxed);
+            const auto n = std::min<std::uint_least64_t>(c,buffer_capacity);
+            r.n_dropped += c - n;
+            if (r.retired.empty()) {
+                r.retired.resize(retired_capacity);
+            }
+            for (auto i = c - n; i < c; ++i) {
+                r.retired[static_cast<std::size_t>(r.n_retired % retired_capacity)] =
+                    m_buffer->m_events[static_cast<std::size_t>(i % buffer_capacity)];
+                ++r.n_retired;
+            }
+        }
+        thread_buffer &get()
+        {
+            if (!m_buffer) {
+                auto &r = base_registry<>::get();
+                m_buffer.reset(new thread_buffer(r.next_tid.fetch_add(1u,std::memory_order_relaxed)));
+                std::lock_guard<std::mutex> lock(r.mutex);
+                r.live.push_back(m_buffer.get());
+            }
+            return *m_buffer;
+        }
+    private:
+        std::unique_ptr<thread_buffer> m_buffer;
+};
+
+inline thread_buffer &local_buffer()
+{
+    static thread_local buffer_holder holder;
+    return holder.get();
+}
+
+// Write a number of nanoseconds as microseconds, with three decimal digits.
+inline void write_us(std::ostream &os, std::uint_least64_t ns)
+{
+    const auto frac = static_cast<unsigned>(ns % 1000u);
+    os << ns / 1000u << '.' << frac / 100u << frac / 10u % 10u << frac % 10u;
+}
+
+inline void write_json_string(std::ostream &os, const char *s)
+{
+    os << '"';
+    for (; *s != '\0'; ++s) {
+        if (*s == '"' || *s == '\\') {
+            os << '\\';
+        }
+        os << *s;
+    }
+    os << '"';
+}
+
+}
+
+/// Span recorder.
+/**
+ * The span starts on construction and is recorded on destruction.
+ */
+class span
+{
+    public:
+        /// Constructor.
+        /**
+         * @param[in] name name of the span (must have static storage duration); if null, nothing is recorded.
+         */
+        explicit span(const char *name) noexcept:m_name(name),m_begin(name ? detail::now() : 0u) {}
+        span(const span &) = delete;
+        span &operator=(const span &) = delete;
+        /// Destructor.
+        /**
+         * Records the span in the buffer of the calling thread. Allocation failures while
+         * registering the buffer of a new thread are ignored.
+         */
+        ~span()
+        {
+            if (m_name) {
+                try {
+                    detail::local_buffer().push(m_name,m_begin,detail::now());
+                } catch (...) {}
+            }
+        }
+    private:
+        const char                  *m_name;
+        const std::uint_least64_t   m_begin;
+};
+
+/// Recorded spans.
+/**
+ * \note
+ * The buffers of the running threads are read without synchronisation with their writers, so this function
+ * should be called when no traced operation is running.
+ *
+ * @return the spans recorded by the running threads and retained from the threads which have exited,
+ * in unspecified order.
+ *
+ * @throws unspecified any exception thrown by memory allocation errors.
+ */
+inline std::vector<event> get_events()
+{
+    auto &r = detail::base_registry<>::get();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::vector<event> retval;
+    const auto n_ret = std::min<std::uint_least64_t>(r.n_retired,retired_capacity);
+    for (auto i = r.n_retired - n_ret; i < r.n_retired; ++i) {
+        retval.push_back(r.retired[static_cast<std::size_t>(i % retired_capacity)]);
+    }
+    for (const auto b: r.live) {
+        const auto c = b->m_count.load(std::memory_order_acquire);
+        const auto n = std::min<std::uint_least64_t>(c,buffer_capacity);
+        for (auto i = c - n; i < c; ++i) {
+            retval.push_back(b->m_events[static_cast<std::size_t>(i % buffer_capacity)]);
+        }
+    }
+    return retval;
+}
+
+/// Number of overwritten spans.
+/**
+ * @return the number of spans which have been lost because a buffer was full.
+ */
+inline std::uint_least64_t dropped_events()
+{
+    auto &r = detail::base_registry<>::get();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    auto retval = r.n_dropped + (r.n_retired - std::min<std::uint_least64_t>(r.n_retired,retired_capacity));
+    for (const auto b: r.live) {
+        const auto c = b->m_count.load(std::memory_order_acquire);
+        retval += c - std::min<std::uint_least64_t>(c,buffer_capacity);
+    }
+    return retval;
+}
+
+/// Discard the recorded spans.
+/**
+ * \note
+ * This function must not be called while traced operations are running in other threads.
+ */
+inline void clear()
+{
+    auto &r = detail::base_registry<>::get();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.retired.clear();
+    r.n_retired = 0u;
+    r.n_dropped = 0u;
+    for (const auto b: r.live) {
+        b->m_count.store(0u,std::memory_order_release);
+    }
+}
+
+/// Export in Chrome trace format.
+/**
+ * Writes the recorded spans to \p os as a JSON object containing complete (<tt>"ph":"X"</tt>) events. Times are
+ * expressed in microseconds from the start of the earliest span.
+ *
+ * @param[in,out] os target stream.
+ *
+ * @throws unspecified any exception thrown by get_events() or by the stream.
+ */
+inline void export_chrome_trace(std::ostream &os)
+{
+    auto events = get_events();
+    std::sort(events.begin(),events.end(),[](const event &a, const event &b) {return a.begin < b.begin;});
+    const auto origin = events.empty() ? std::uint_least64_t(0u) : events.front().begin;
+    os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    for (std::size_t i = 0u; i < events.size(); ++i) {
+        const auto &e = events[i];
+        os << (i ? ",\n" : "\n") << "{\"name\":";
+        detail::write_json_string(os,e.name);
+        os << ",\"cat\":\"arbpp\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.tid
+           << ",\"ts\":";
+        detail::write_us(os,e.begin - origin);
+        os << ",\"dur\":";
+        detail::write_us(os,e.end - e.begin);
+        os << '}';
+    }
+    os << "\n]}\n";
+}
+
+}
+
+#define ARBPP_TRACE_SPAN(name) const ::arbpp::tracing::span arbpp_tracing_span(name)
+#define ARBPP_TRACE_SPAN_IF(cond,name) const ::arbpp::tracing::span arbpp_tracing_span((cond) ? (name) : nullptr)
+
+#else
+
+#define ARBPP_TRACE_SPAN(name)
+#define ARBPP_TRACE_SPAN_IF(cond,name)
+
+#endif
+
 // Namespace for implementation details.
 namespace detail
 {
@@ -109,6 +412,32 @@ struct fmpr_raii
     ::fmpr_struct m_fmpr;
 };
 
+struct fmpz_raii
+{
+    fmpz_raii()
+    {
+        // Sets to zero.
+        ::fmpz_init(m_fmpz);
+    }
+    fmpz_raii(const fmpz_raii &) = delete;
+    fmpz_raii(fmpz_raii &&) = delete;
+    fmpz_raii &operator=(const fmpz_raii &) = delete;
+    fmpz_raii &operator=(fmpz_raii &&) = delete;
+    operator ::fmpz *()
+    {
+        return m_fmpz;
+    }
+    operator ::fmpz const *() const
+    {
+        return m_fmpz;
+    }
+    ~fmpz_raii()
+    {
+        ::fmpz_clear(m_fmpz);
+    }
+    ::fmpz_t m_fmpz;
+};
+
 struct mpfr_raii
 {
     explicit mpfr_raii(::mpfr_prec_t prec)
@@ -135,423 +464,1193 @@ struct mpfr_raii
     ::mpfr_t m_mpfr;
 };
 
+// 128-bit integers, available as an extension in GCC and Clang.
+template <typename T>
+struct is_int128: std::false_type {};
+
+#if defined(__SIZEOF_INT128__)
+
+#define ARBPP_HAVE_INT128
+
+__extension__ typedef __int128 int128_t;
+__extension__ typedef unsigned __int128 uint128_t;
+
+template <>
+struct is_int128<int128_t>: std::true_type {};
+
+template <>
+struct is_int128<uint128_t>: std::true_type {};
+
+#endif
+
+// Set f to the non-negative integral value n, when T is not wider than unsigned long.
+template <typename T>
+inline void fmpz_set_nonnegative(::fmpz_t f, const T &n, std::false_type)
+{
+    ::fmpz_set_ui(f,static_cast<unsigned long>(n));
+}
+
+// Set f to the non-negative integral value n, when T is wider than unsigned long.
+template <typename T>
+inline void fmpz_set_nonnegative(::fmpz_t f, T n, std::true_type)
+{
+    const unsigned ul_bits = static_cast<unsigned>(std::numeric_limits<unsigned long>::digits);
+    // Split n into unsigned long chunks, least significant first.
+    unsigned long chunks[sizeof(T) / sizeof(unsigned long) + 1u];
+    std::size_t n_chunks = 0u;
+    while (n != T(0)) {
+        chunks[n_chunks] = static_cast<unsigned long>(n);
+        ++n_chunks;
+        n >>= ul_bits;
+    }
+    ::fmpz_set_ui(f,0u);
+    for (; n_chunks != 0u; --n_chunks) {
+        ::fmpz_mul_2exp(f,f,ul_bits);
+        ::fmpz_add_ui(f,f,chunks[n_chunks - 1u]);
+    }
 }
 
-/// Real number represented as a floating-point ball.
-/**
- * ## Interoperability with fundamental types ##
- * 
- * Interoperability with the following types is provided:
- * - \p char, <tt>signed char</tt>, \p short, \p int, \p long and unsigned counterparts,
- * - \p float and \p double.
- * 
- * ## Exception safety guarantee ##
- * 
- * This class provides the strong exception safety guarantee for all operations.
- * In case of memory allocation errors by
- * lower-level libraries (e.g., GMP), the program will terminate.
- * 
- * ## Move semantics ##
- *
- * Move construction and move assignment will leave the moved-from object in an
- * unspecified but valid state.
- */
-class arb: private detail::base_arb<>
+template <typename T>
+inline void fmpz_set_nonnegative(::fmpz_t f, const T &n)
 {
-        // Import locally the RAII names.
-        typedef detail::arf_raii arf_raii;
-        typedef detail::fmpr_raii fmpr_raii;
-        typedef detail::mpfr_raii mpfr_raii;
-        // Signed integers with which arb can interoperate.
-        template <typename T>
-        struct is_arb_int
-        {
-            static const bool value = std::is_same<T,signed char>::value || std::is_same<T,short>::value ||
-                std::is_same<T,int>::value || std::is_same<T,long>::value ||
-                (std::is_signed<char>::value && std::is_same<T,char>::value);
-        };
-        // Unsigned integers with which arb can interoperate.
-        template <typename T>
-        struct is_arb_uint
-        {
-            static const bool value = std::is_same<T,unsigned char>::value || std::is_same<T,unsigned short>::value ||
-                std::is_same<T,unsigned>::value || std::is_same<T,unsigned long>::value ||
-                (std::is_unsigned<char>::value && std::is_same<T,char>::value);
-        };
-        // Floating-point types with which arb can interoperate.
-        template <typename T>
-        struct is_arb_float
-        {
-            static const bool value = std::is_same<T,float>::value || std::is_same<T,double>::value;
-        };
-        // Interoperable types.
-        template <typename T>
-        struct is_interoperable
-        {
-            static const bool value = is_arb_int<T>::value || is_arb_uint<T>::value || is_arb_float<T>::value;
-        };
-        // Custom is_digit checker.
-        static bool is_digit(char c)
-        {
-            const char digits[] = "0123456789";
-            return std::find(digits,digits + 10,c) != (digits + 10);
+    fmpz_set_nonnegative(f,n,std::integral_constant<bool,(sizeof(T) > sizeof(unsigned long))>());
+}
+
+template <typename T>
+inline void fmpz_set_integral(::fmpz_t f, const T &n, std::true_type)
+{
+    if (n < T(0)) {
+        // NOTE: -(n + 1) is always representable, unlike -n.
+        fmpz_set_nonnegative(f,static_cast<T>(-(n + T(1))));
+        ::fmpz_add_ui(f,f,1u);
+        ::fmpz_neg(f,f);
+    } else {
+        fmpz_set_nonnegative(f,n);
+    }
+}
+
+template <typename T>
+inline void fmpz_set_integral(::fmpz_t f, const T &n, std::false_type)
+{
+    fmpz_set_nonnegative(f,n);
+}
+
+// Set f to the integral value n, of any width.
+// NOTE: signedness is established via T(-1) < T(0), as std::is_signed
+// is not specialised for 128-bit integers in strict ISO mode.
+template <typename T>
+inline void fmpz_set_integral(::fmpz_t f, const T &n)
+{
+    fmpz_set_integral(f,n,std::integral_constant<bool,(T(-1) < T(0))>());
+}
+
+
+// Whether the calling thread is running a block of parallel_for().
+inline bool &in_parallel_for()
+{
+    static thread_local bool flag = false;
+    return flag;
+}
+
+// Run f(begin,end) over a partition of [0,n) in contiguous blocks, using up to n_threads threads.
+// The calling thread processes the first block. The first exception thrown by any block is
+// re-thrown in the calling thread after all the threads have been joined.
+template <typename F>
+inline void parallel_for(std::size_t n, unsigned n_threads, const F &f)
+{
+    if (n_threads == 0u) {
+        throw std::invalid_argument("the number of threads must be positive");
+    }
+    if (n < n_threads) {
+        n_threads = static_cast<unsigned>(n);
+    }
+    if (n_threads <= 1u) {
+        f(std::size_t(0),n);
+        return;
+    }
+    const std::size_t block_size = n / n_threads;
+    std::vector<std::exception_ptr> errors(n_threads);
+    std::vector<std::thread> threads;
+    threads.reserve(n_threads - 1u);
+    auto join_all = [&threads]() {
+        for (auto &t: threads) {
+            t.join();
         }
-        // Smart pointer to handle the string output from mpfr.
-        typedef std::unique_ptr<char,void (*)(char *)> smart_mpfr_str;
-        // Utility function to print an fmpr to stream using mpfr. Will clear f on exit.
-        static void print_fmpr(std::ostream &os, ::fmpr_t f, long prec)
-        {
-            mpfr_raii t(static_cast< ::mpfr_prec_t>(prec));
-            ::fmpr_get_mpfr(t,f,MPFR_RNDN);
-            // Couple of variables used below.
-            const bool is_zero = (mpfr_sgn(t.m_mpfr) == 0);
-            ::mpfr_exp_t exp(0);
-            char *cptr = ::mpfr_get_str(nullptr,&exp,10,0,t,MPFR_RNDN);
-            // Clear before checking, for exception safety.
-            ::fmpr_clear(f);
-            if (!cptr) {
-                throw std::invalid_argument("error while converting arb to string");
-            }
-            smart_mpfr_str str(cptr,::mpfr_free_str);
-            // Copy into C++ string.
-            std::string cpp_str(str.get());
-            // Insert the radix point.
-            auto it = std::find_if(cpp_str.begin(),cpp_str.end(),[](char c) {return is_digit(c);});
-            if (it != cpp_str.end()) {
-                ++it;
-                cpp_str.insert(it,'.');
-                if (exp == std::numeric_limits< ::mpfr_exp_t>::min()) {
-                    throw std::invalid_argument("error while converting arb to string");
-                }
-                --exp;
-                if (exp != ::mpfr_exp_t(0) && !is_zero) {
-                    cpp_str.append(std::string("e") + std::to_string(exp));
+    };
+    try {
+        for (unsigned i = 1u; i < n_threads; ++i) {
+            const std::size_t begin = i * block_size, end = (i == n_threads - 1u) ? n : begin + block_size;
+            threads.emplace_back([&f,&errors,i,begin,end]() {
+                in_parallel_for() = true;
+                try {
+                    ARBPP_TRACE_SPAN("arbpp::parallel_for block");
+                    f(begin,end);
+                } catch (...) {
+                    errors[i] = std::current_exception();
                 }
-            }
-            os << cpp_str;
+                // NOTE: free the thread-local caches of FLINT and Arb.
+                ::flint_cleanup();
+            });
         }
-        static void print_arf(std::ostream &os, const ::arf_t a, long prec)
-        {
-            // Go through the conversion chain arf -> fmpr -> mpfr.
-            ::fmpr_t f;
-            ::fmpr_init(f);
-            ::arf_get_fmpr(f,a);
-            print_fmpr(os,f,prec);
+    } catch (...) {
+        // Thread creation failed: join the threads already running before bailing out.
+        join_all();
+        throw;
+    }
+    const bool nested = in_parallel_for();
+    in_parallel_for() = true;
+    try {
+        ARBPP_TRACE_SPAN("arbpp::parallel_for block");
+        f(std::size_t(0),block_size);
+    } catch (...) {
+        errors[0] = std::current_exception();
+    }
+    in_parallel_for() = nested;
+    join_all();
+    for (const auto &e: errors) {
+        if (e) {
+            std::rethrow_exception(e);
         }
-        static void print_mag(std::ostream &os, const ::mag_t m, long prec)
-        {
-            // Go through the conversion chain mag -> fmpr -> mpfr.
-            ::fmpr_t f;
-            ::fmpr_init(f);
-            ::mag_get_fmpr(f,m);
-            print_fmpr(os,f,prec);
-        }
-        // Generic constructor.
-        template <typename T, typename std::enable_if<is_arb_int<T>::value,int>::type = 0>
-        void construct(const T &n)
+    }
+}
+
+// Decimal radix conversion of large integers. The conversions split the number of digits recursively on powers of
+// two, so that only the powers 10**(2**i) are needed, and delegate the small pieces to FLINT. With the subquadratic
+// division of GMP, the cost is O(M(n) log(n)) for n digits, instead of the O(n**2) of the schoolbook conversion.
+// Above radix_parallel_digits digits, the two halves of each split are converted in parallel.
+
+// Number of digits below which the conversion is delegated to fmpz_get_str()/fmpz_set_str().
+const std::size_t radix_leaf_digits = 1024u;
+
+// Number of digits above which the halves of a split are converted in parallel.
+const std::size_t radix_parallel_digits = 1u << 15;
+
+// Precision (in bits) from which the string constructor and the stream operator of arb use the conversions
+// below instead of the MPFR ones.
+const long radix_conversion_threshold = 1l << 17;
+
+// Table of the powers 10**(2**i), computed on demand by repeated squaring and shared by all threads.
+// NOTE: the powers are kept for the lifetime of the program: their total size is about twice the size
+// of the largest number converted so far.
+class pow10_table
+{
+    public:
+        const ::fmpz *get(unsigned i)
         {
-            ::arb_set_si(&m_arb,static_cast<long>(n));
+            std::lock_guard<std::mutex> lock(m_mutex);
+            while (m_powers.size() <= i) {
+                std::unique_ptr<fmpz_raii> p(new fmpz_raii);
+                if (m_powers.empty()) {
+                    ::fmpz_set_ui(*p,10u);
+                } else {
+                    ::fmpz_mul(*p,*m_powers.back(),*m_powers.back());
+                }
+                m_powers.push_back(std::move(p));
+            }
+            return *m_powers[i];
         }
-        template <typename T, typename std::enable_if<is_arb_uint<T>::value,int>::type = 0>
-        void construct(const T &n)
-        {
-            ::arb_set_ui(&m_arb,static_cast<unsigned long>(n));
+    private:
+        std::mutex                                  m_mutex;
+        std::vector<std::unique_ptr<fmpz_raii>>     m_powers;
+};
+
+inline const ::fmpz *get_pow10(unsigned i)
+{
+    static pow10_table table;
+    return table.get(i);
+}
+
+// Maximum number of threads used by a conversion.
+const unsigned radix_max_threads = 8u;
+
+// Number of threads used by the conversions: a single one within the blocks of parallel_for(), which
+// already keep the hardware busy.
+inline unsigned radix_threads()
+{
+    if (in_parallel_for()) {
+        return 1u;
+    }
+    const unsigned n = std::thread::hardware_concurrency();
+    return n == 0u ? 1u : std::min(n,radix_max_threads);
+}
+
+// Smallest i such that n <= 2**(i + 1), for n > 1. The split point of n digits is 2**i.
+inline unsigned radix_split(std::size_t n)
+{
+    unsigned i = 0u;
+    while ((std::size_t(2u) << i) < n) {
+        ++i;
+    }
+    return i;
+}
+
+// Run f0() and f1() in parallel.
+template <typename F0, typename F1>
+inline void radix_fork(const F0 &f0, const F1 &f1)
+{
+    parallel_for(2u,2u,[&f0,&f1](std::size_t begin, std::size_t end) {
+        for (auto j = begin; j != end; ++j) {
+            if (j == 0u) {
+                f0();
+            } else {
+                f1();
+            }
         }
-        template <typename T, typename std::enable_if<is_arb_float<T>::value,int>::type = 0>
-        void construct(const T &x)
-        {
-            arf_raii tmp_arf;
-            ::arf_set_d(tmp_arf,static_cast<double>(x));
-            ::arb_set_arf(&m_arb,tmp_arf);
+    });
+}
+
+// Write to out the n decimal digits of x, with 0 <= x < 10**n, left-padded with zeroes, using up to
+// n_threads threads.
+inline void fmpz_write_digits(char *out, const ::fmpz_t x, std::size_t n, unsigned n_threads = 1u)
+{
+    if (n <= radix_leaf_digits) {
+        // NOTE: fmpz_get_str() needs room for one digit more than the actual ones (fmpz_sizeinbase() may
+        // overestimate by one), plus the terminator.
+        char buffer[radix_leaf_digits + 2u];
+        ::fmpz_get_str(buffer,10,x);
+        const std::size_t len = std::strlen(buffer);
+        assert(len <= n);
+        std::fill(out,out + (n - len),'0');
+        std::copy(buffer,buffer + len,out + (n - len));
+        return;
+    }
+    const unsigned i = radix_split(n);
+    const std::size_t h = std::size_t(1u) << i;
+    fmpz_raii q, r;
+    ::fmpz_fdiv_qr(q,r,x,get_pow10(i));
+    if (n_threads > 1u && n > radix_parallel_digits) {
+        const unsigned n_hi = n_threads / 2u;
+        radix_fork([&]() {fmpz_write_digits(out,q,n - h,n_hi);},
+            [&]() {fmpz_write_digits(out + (n - h),r,h,n_threads - n_hi);});
+    } else {
+        fmpz_write_digits(out,q,n - h);
+        fmpz_write_digits(out + (n - h),r,h);
+    }
+}
+
+// Set x to the integer whose decimal digits are the n characters starting at digits, using up to
+// n_threads threads.
+inline void fmpz_set_digits(::fmpz_t x, const char *digits, std::size_t n, unsigned n_threads = 1u)
+{
+    if (n <= radix_leaf_digits) {
+        char buffer[radix_leaf_digits + 1u];
+        std::copy(digits,digits + n,buffer);
+        buffer[n] = '\0';
+        ::fmpz_set_str(x,buffer,10);
+        return;
+    }
+    const unsigned i = radix_split(n);
+    const std::size_t h = std::size_t(1u) << i;
+    fmpz_raii hi;
+    if (n_threads > 1u && n > radix_parallel_digits) {
+        const unsigned n_hi = n_threads / 2u;
+        radix_fork([&]() {fmpz_set_digits(hi,digits,n - h,n_hi);},
+            [&]() {fmpz_set_digits(x,digits + (n - h),h,n_threads - n_hi);});
+    } else {
+        fmpz_set_digits(hi,digits,n - h);
+        fmpz_set_digits(x,digits + (n - h),h);
+    }
+    ::fmpz_addmul(x,hi,get_pow10(i));
+}
+
+// Sets n to |x| * 10**s, rounded to an integer towards zero or to nearest (ties to even). x must be finite.
+inline void arf_get_scaled_fmpz(::fmpz_t n, const ::arf_t x, long s, bool nearest)
+{
+    fmpz_raii e, den;
+    // x = n * 2**e.
+    ::arf_get_fmpz_2exp(n,e,x);
+    ::fmpz_abs(n,n);
+    if (!::fmpz_fits_si(e)) {
+        throw std::overflow_error("exponent too large in decimal conversion");
+    }
+    const long ex = ::fmpz_get_si(e);
+    ::fmpz_one(den);
+    if (s >= 0) {
+        fmpz_raii p;
+        ::fmpz_ui_pow_ui(p,10u,static_cast<unsigned long>(s));
+        ::fmpz_mul(n,n,p);
+    } else {
+        ::fmpz_ui_pow_ui(den,10u,static_cast<unsigned long>(-s));
+    }
+    if (ex >= 0) {
+        ::fmpz_mul_2exp(n,n,static_cast<unsigned long>(ex));
+    } else {
+        ::fmpz_mul_2exp(den,den,static_cast<unsigned long>(-ex));
+    }
+    if (::fmpz_is_one(den)) {
+        return;
+    }
+    fmpz_raii r;
+    ::fmpz_fdiv_qr(n,r,n,den);
+    if (nearest) {
+        // Compare the remainder with half of the divisor.
+        ::fmpz_mul_2exp(r,r,1u);
+        const int c = ::fmpz_cmp(r,den);
+        if (c > 0 || (c == 0 && ::fmpz_is_odd(n))) {
+            ::fmpz_add_ui(n,n,1u);
         }
-        // Addition.
-        arb &in_place_add(const arb &other)
-        {
-            // Work with max precision.
-            if (other.m_prec > m_prec) {
-                m_prec = other.m_prec;
-            }
-            ::arb_add(&m_arb,&m_arb,&other.m_arb,m_prec);
-            return *this;
+    }
+}
+
+// Sets n to the nd leading decimal digits of |x| (rounded towards zero or to nearest), and returns the decimal
+// exponent k of the result, so that |x| ~ n * 10**(k - nd + 1) and 10**(nd - 1) <= n < 10**nd. x must be finite
+// and nonzero, and nd positive.
+inline long arf_get_decimal(::fmpz_t n, const ::arf_t x, std::size_t nd, bool nearest)
+{
+    assert(nd > 0u);
+    // 2**(b - 1) <= |x| < 2**b: first estimate of k = floor(log10(|x|)), off by at most one or two.
+    const long b = ::arf_abs_bound_lt_2exp_si(x);
+    long k = static_cast<long>(std::floor(static_cast<double>(b - 1) * 0.30102999566398120));
+    fmpz_raii lower, upper;
+    ::fmpz_ui_pow_ui(lower,10u,static_cast<unsigned long>(nd - 1u));
+    ::fmpz_mul_ui(upper,lower,10u);
+    while (true) {
+        arf_get_scaled_fmpz(n,x,static_cast<long>(nd) - 1 - k,nearest);
+        if (::fmpz_cmp(n,upper) >= 0) {
+            ++k;
+        } else if (::fmpz_cmp(n,lower) < 0) {
+            --k;
+        } else {
+            return k;
         }
-        template <typename T, typename std::enable_if<is_arb_int<T>::value,int>::type = 0>
-        arb &in_place_add(const T &n)
-        {
-            ::arb_add_si(&m_arb,&m_arb,static_cast<long>(n),m_prec);
-            return *this;
+    }
+}
+
+// Write to os the finite and nonzero x, rounded to nearest to the number of digits used by MPFR for a
+// precision of prec bits (1 + ceil(prec * log10(2))), in the same format used for the MPFR output. Returns
+// false without writing if the binary exponent of x is larger than prec in absolute value, as the cost of
+// the scaling grows with the exponent.
+inline bool write_decimal(std::ostream &os, const ::arf_t x, long prec)
+{
+    const long b = ::arf_abs_bound_lt_2exp_si(x);
+    if (b > prec || b < -prec) {
+        return false;
+    }
+    const std::size_t nd = 1u + static_cast<std::size_t>(std::ceil(static_cast<double>(prec) * 0.30102999566398120));
+    fmpz_raii n;
+    const long k = arf_get_decimal(n,x,nd,true);
+    // Write the digits after a placeholder, then move the leading digit in front of the radix point.
+    std::string str(nd + 1u,'.');
+    fmpz_write_digits(&str[1],n,nd,radix_threads());
+    std::swap(str[0],str[1]);
+    if (::arf_sgn(x) < 0) {
+        os << '-';
+    }
+    os << str;
+    if (k != 0) {
+        os << 'e' << k;
+    }
+    return true;
+}
+
+// Parse a string in the format [+|-]digits[.digits][(e|E)[+|-]digits], with at least one digit in the mantissa.
+// On success, digits is set to the digits of the mantissa and e to the decimal exponent, so that the value is
+// (-1)**negative * digits * 10**e. Returns false if str is not in this format (or the exponent overflows).
+inline bool parse_decimal(const std::string &str, std::string &digits, long &e, bool &negative)
+{
+    auto it = str.begin();
+    const auto end = str.end();
+    negative = false;
+    if (it != end && (*it == '+' || *it == '-')) {
+        negative = (*it == '-');
+        ++it;
+    }
+    digits.clear();
+    digits.reserve(str.size());
+    long n_frac = 0;
+    bool point = false;
+    for (; it != end; ++it) {
+        if (*it >= '0' && *it <= '9') {
+            digits.push_back(*it);
+            n_frac += point;
+        } else if (*it == '.' && !point) {
+            point = true;
+        } else {
+            break;
         }
-        template <typename T, typename std::enable_if<is_arb_uint<T>::value,int>::type = 0>
-        arb &in_place_add(const T &n)
-        {
-            ::arb_add_ui(&m_arb,&m_arb,static_cast<unsigned long>(n),m_prec);
-            return *this;
+    }
+    if (digits.empty()) {
+        return false;
+    }
+    e = 0;
+    if (it != end) {
+        if (*it != 'e' && *it != 'E') {
+            return false;
         }
-        template <typename T, typename std::enable_if<is_arb_float<T>::value,int>::type = 0>
-        arb &in_place_add(const T &x)
-        {
-            arf_raii tmp_arf;
-            // Set tmp_arf *exactly* to x.
-            ::arf_set_d(tmp_arf,static_cast<double>(x));
-            // Add with precision m_prec.
-            ::arb_add_arf(&m_arb,&m_arb,tmp_arf,m_prec);
-            return *this;
+        ++it;
+        bool negative_exp = false;
+        if (it != end && (*it == '+' || *it == '-')) {
+            negative_exp = (*it == '-');
+            ++it;
         }
-        static arb binary_add(const arb &a, const arb &b)
-        {
-            arb retval;
-            // Set max precision.
-            if (a.m_prec > b.m_prec) {
-                retval.m_prec = a.m_prec;
-            } else {
-                retval.m_prec = b.m_prec;
+        if (it == end) {
+            return false;
+        }
+        for (; it != end; ++it) {
+            if (*it < '0' || *it > '9' || e > std::numeric_limits<long>::max() / 20) {
+                return false;
             }
-            ::arb_add(&retval.m_arb,&a.m_arb,&b.m_arb,retval.m_prec);
-            return retval;
+            e = e * 10 + (*it - '0');
         }
-        template <typename T, typename std::enable_if<is_arb_int<T>::value,int>::type = 0>
-        static arb binary_add(const arb &a, const T &n)
-        {
-            arb retval;
-            ::arb_add_si(&retval.m_arb,&a.m_arb,static_cast<long>(n),a.m_prec);
-            retval.m_prec = a.m_prec;
-            return retval;
+        if (negative_exp) {
+            e = -e;
         }
-        template <typename T, typename std::enable_if<is_arb_int<T>::value,int>::type = 0>
-        static arb binary_add(const T &n, const arb &a)
+    }
+    // NOTE: no overflow here, as |e| is at most max / 2 and n_frac at most the size of the string.
+    if (n_frac > std::numeric_limits<long>::max() / 2) {
+        return false;
+    }
+    e -= n_frac;
+    return true;
+}
+
+}
+
+/// Exact rational number.
+/**
+ * This class is a thin wrapper around the FLINT \p fmpq_t type, meant to be used as an exact coefficient
+ * in mixed arithmetic with arbpp::arb. The value is always kept in canonical form.
+ *
+ * ## Exception safety guarantee ##
+ *
+ * This class provides the strong exception safety guarantee for all operations.
+ * In case of memory allocation errors by
+ * lower-level libraries (e.g., GMP), the program will terminate.
+ *
+ * ## Move semantics ##
+ *
+ * Move construction and move assignment will leave the moved-from object in an
+ * unspecified but valid state.
+ */
+class rational
+{
+        typedef detail::fmpz_raii fmpz_raii;
+        // Enabler for the constructors from integral types.
+        template <typename T>
+        using integral_enabler = typename std::enable_if<std::is_integral<T>::value ||
+            detail::is_int128<T>::value,int>::type;
+    public:
+        /// Default constructor.
+        /**
+         * The value is initialised to zero.
+         */
+        rational()
         {
-            return binary_add(a,n);
+            ::fmpq_init(&m_fmpq);
         }
-        template <typename T, typename std::enable_if<is_arb_uint<T>::value,int>::type = 0>
-        static arb binary_add(const arb &a, const T &n)
+        /// Copy constructor.
+        /**
+         * @param[in] other construction argument.
+         */
+        rational(const rational &other)
         {
-            arb retval;
-            ::arb_add_ui(&retval.m_arb,&a.m_arb,static_cast<unsigned long>(n),a.m_prec);
-            retval.m_prec = a.m_prec;
-            return retval;
+            ::fmpq_init(&m_fmpq);
+            ::fmpq_set(&m_fmpq,&other.m_fmpq);
         }
-        template <typename T, typename std::enable_if<is_arb_uint<T>::value,int>::type = 0>
-        static arb binary_add(const T &n, const arb &a)
+        /// Move constructor.
+        /**
+         * @param[in] other construction argument.
+         */
+        rational(rational &&other) noexcept
         {
-            return binary_add(a,n);
+            ::fmpq_init(&m_fmpq);
+            swap(other);
         }
-        template <typename T, typename std::enable_if<is_arb_float<T>::value,int>::type = 0>
-        static arb binary_add(const arb &a, const T &x)
+        /// Constructor from integral value.
+        /**
+         * \note
+         * This constructor is enabled only if \p T is an integral type.
+         *
+         * @param[in] n construction argument.
+         */
+        template <typename T, integral_enabler<T> = 0>
+        explicit rational(const T &n)
         {
-            arb retval;
-            arf_raii tmp_arf;
-            ::arf_set_d(tmp_arf,static_cast<double>(x));
-            ::arb_add_arf(&retval.m_arb,&a.m_arb,tmp_arf,a.m_prec);
-            retval.m_prec = a.m_prec;
-            return retval;
+            ::fmpq_init(&m_fmpq);
+            detail::fmpz_set_integral(fmpq_numref((&m_fmpq)),n);
         }
-        template <typename T, typename std::enable_if<is_arb_float<T>::value,int>::type = 0>
-        static arb binary_add(const T &x, const arb &a)
+        /// Constructor from numerator and denominator.
+        /**
+         * \note
+         * This constructor is enabled only if \p T and \p U are integral types.
+         *
+         * The value will be set to <tt>num / den</tt>, in canonical form.
+         *
+         * @param[in] num numerator.
+         * @param[in] den denominator.
+         *
+         * @throws std::invalid_argument if \p den is zero.
+         */
+        template <typename T, typename U, integral_enabler<T> = 0, integral_enabler<U> = 0>
+        explicit rational(const T &num, const U &den)
         {
-            return binary_add(a,x);
+            fmpz_raii n, d;
+            detail::fmpz_set_integral(n,num);
+            detail::fmpz_set_integral(d,den);
+            if (::fmpz_is_zero(d)) {
+                throw std::invalid_argument("zero denominator in rational");
+            }
+            ::fmpq_init(&m_fmpq);
+            ::fmpq_set_fmpz_frac(&m_fmpq,n,d);
         }
-        // Subtraction.
-        arb &in_place_sub(const arb &other)
+        /// Constructor from \p fmpq_t.
+        /**
+         * @param[in] q construction argument, assumed to be in canonical form.
+         */
+        explicit rational(const ::fmpq_t q)
         {
-            // Work with max precision.
-            if (other.m_prec > m_prec) {
-                m_prec = other.m_prec;
-            }
-            ::arb_sub(&m_arb,&m_arb,&other.m_arb,m_prec);
-            return *this;
+            ::fmpq_init(&m_fmpq);
+            ::fmpq_set(&m_fmpq,q);
         }
-        template <typename T, typename std::enable_if<is_arb_int<T>::value,int>::type = 0>
-        arb &in_place_sub(const T &n)
+        /// Destructor.
+        ~rational()
         {
-            ::arb_sub_si(&m_arb,&m_arb,static_cast<long>(n),m_prec);
-            return *this;
+            ::fmpq_clear(&m_fmpq);
         }
-        template <typename T, typename std::enable_if<is_arb_uint<T>::value,int>::type = 0>
-        arb &in_place_sub(const T &n)
+        /// Copy assignment.
+        /**
+         * @param[in] other assignment argument.
+         *
+         * @return reference to \p this.
+         */
+        rational &operator=(const rational &other)
         {
-            ::arb_sub_ui(&m_arb,&m_arb,static_cast<unsigned long>(n),m_prec);
+            if (this == &other) {
+                return *this;
+            }
+            ::fmpq_set(&m_fmpq,&other.m_fmpq);
             return *this;
         }
-        template <typename T, typename std::enable_if<is_arb_float<T>::value,int>::type = 0>
-        arb &in_place_sub(const T &x)
+        /// Move assignment.
+        /**
+         * @param[in] other assignment argument.
+         *
+         * @return reference to \p this.
+         */
+        rational &operator=(rational &&other) noexcept
         {
-            arf_raii tmp_arf;
-            // Set tmp_arf *exactly* to x.
-            ::arf_set_d(tmp_arf,static_cast<double>(x));
-            // Sub with precision m_prec.
-            ::arb_sub_arf(&m_arb,&m_arb,tmp_arf,m_prec);
+            swap(other);
             return *this;
         }
-        static arb binary_sub(const arb &a, const arb &b)
+        /// Swap method.
+        /**
+         * @param[in] other argument for swap.
+         */
+        void swap(rational &other) noexcept
         {
-            arb retval;
-            // Set max precision.
-            if (a.m_prec > b.m_prec) {
-                retval.m_prec = a.m_prec;
-            } else {
-                retval.m_prec = b.m_prec;
+            if (this == &other) {
+                return;
             }
-            ::arb_sub(&retval.m_arb,&a.m_arb,&b.m_arb,retval.m_prec);
-            return retval;
+            ::fmpq_swap(&m_fmpq,&other.m_fmpq);
         }
-        template <typename T, typename std::enable_if<is_arb_int<T>::value,int>::type = 0>
-        static arb binary_sub(const arb &a, const T &n)
+        /// Get a const pointer to the internal \p fmpq.
+        /**
+         * @return const pointer to the internal \p fmpq.
+         */
+        const ::fmpq *get_fmpq_t() const
         {
-            arb retval;
-            ::arb_sub_si(&retval.m_arb,&a.m_arb,static_cast<long>(n),a.m_prec);
-            retval.m_prec = a.m_prec;
-            return retval;
+            return &m_fmpq;
         }
-        template <typename T, typename std::enable_if<is_arb_int<T>::value,int>::type = 0>
-        static arb binary_sub(const T &n, const arb &a)
+        /// Get a mutable pointer to the internal \p fmpq.
+        /**
+         * The value must be left in canonical form.
+         *
+         * @return pointer to the internal \p fmpq.
+         */
+        ::fmpq *get_fmpq_t()
         {
-            auto retval = binary_sub(a,n);
-            retval.negate();
-            return retval;
-        }
-        template <typename T, typename std::enable_if<is_arb_uint<T>::value,int>::type = 0>
-        static arb binary_sub(const arb &a, const T &n)
-        {
-            arb retval;
-            ::arb_sub_ui(&retval.m_arb,&a.m_arb,static_cast<unsigned long>(n),a.m_prec);
-            retval.m_prec = a.m_prec;
-            return retval;
+            return &m_fmpq;
         }
-        template <typename T, typename std::enable_if<is_arb_uint<T>::value,int>::type = 0>
-        static arb binary_sub(const T &n, const arb &a)
+    private:
+        ::fmpq m_fmpq;
+};
+
+/// Swap.
+/**
+ * Equivalent to <tt>q0.swap(q1)</tt>.
+ *
+ * @param[in] q0 first argument.
+ * @param[in] q1 second argument.
+ */
+inline void swap(rational &q0, rational &q1) noexcept
+{
+    q0.swap(q1);
+}
+
+/// Rounding modes for the conversion of arbpp::arb to floating-point.
+enum class rounding_mode
+{
+    /// The midpoint is rounded to the nearest value.
+    nearest,
+    /// The result is a lower bound for all the values in the ball.
+    downward,
+    /// The result is an upper bound for all the values in the ball.
+    upward
+};
+
+/// Three-state boolean.
+/**
+ * This is the result type of the comparison operators of arbpp::arb. A comparison between balls
+ * is \p true if it holds for all the points of the balls, \p false if it holds for none of them,
+ * and indeterminate otherwise.
+ *
+ * The conversion to \p bool is explicit and it yields \p true only in the \p true state,
+ * so that, e.g., <tt>if (a < b)</tt> executes the branch only if \p a is certainly less than \p b.
+ * The negation operator swaps \p true and \p false and leaves the indeterminate state unchanged.
+ */
+class tribool
+{
+        enum class state : unsigned char
         {
-            auto retval = binary_sub(a,n);
-            retval.negate();
-            return retval;
-        }
-        template <typename T, typename std::enable_if<is_arb_float<T>::value,int>::type = 0>
-        static arb binary_sub(const arb &a, const T &x)
+            false_state,
+            true_state,
+            indeterminate_state
+        };
+        explicit constexpr tribool(state s) : m_state(s) {}
+    public:
+        /// Constructor from \p bool.
+        /**
+         * @param[in] b construction argument.
+         */
+        constexpr tribool(bool b = false) : m_state(b ? state::true_state : state::false_state) {}
+        /// Indeterminate value.
+        /**
+         * @return a tribool in the indeterminate state.
+         */
+        static constexpr tribool indeterminate()
         {
-            arb retval;
-            arf_raii tmp_arf;
-            ::arf_set_d(tmp_arf,static_cast<double>(x));
-            ::arb_sub_arf(&retval.m_arb,&a.m_arb,tmp_arf,a.m_prec);
-            retval.m_prec = a.m_prec;
-            return retval;
+            return tribool{state::indeterminate_state};
         }
-        template <typename T, typename std::enable_if<is_arb_float<T>::value,int>::type = 0>
-        static arb binary_sub(const T &x, const arb &a)
+        /// Conversion to \p bool.
+        /**
+         * @return \p true if \p this is in the \p true state, \p false otherwise.
+         */
+        constexpr explicit operator bool() const
         {
-            auto retval = binary_sub(a,x);
-            retval.negate();
-            return retval;
+            return m_state == state::true_state;
         }
-        // Multiplication.
-        arb &in_place_mul(const arb &other)
+        /// Negation.
+        /**
+         * @return \p false if \p this is \p true, \p true if \p this is \p false, indeterminate otherwise.
+         */
+        constexpr tribool operator!() const
         {
-            if (other.m_prec > m_prec) {
-                m_prec = other.m_prec;
-            }
-            ::arb_mul(&m_arb,&m_arb,&other.m_arb,m_prec);
-            return *this;
+            return tribool{m_state == state::true_state ? state::false_state :
+                (m_state == state::false_state ? state::true_state : state::indeterminate_state)};
         }
-        template <typename T, typename std::enable_if<is_arb_int<T>::value,int>::type = 0>
-        arb &in_place_mul(const T &n)
+        /// Test for the \p true state.
+        /**
+         * @return \p true if \p this is in the \p true state.
+         */
+        constexpr bool is_true() const
         {
-            ::arb_mul_si(&m_arb,&m_arb,static_cast<long>(n),m_prec);
-            return *this;
+            return m_state == state::true_state;
         }
-        template <typename T, typename std::enable_if<is_arb_uint<T>::value,int>::type = 0>
-        arb &in_place_mul(const T &n)
+        /// Test for the \p false state.
+        /**
+         * @return \p true if \p this is in the \p false state.
+         */
+        constexpr bool is_false() const
         {
-            ::arb_mul_ui(&m_arb,&m_arb,static_cast<unsigned long>(n),m_prec);
-            return *this;
+            return m_state == state::false_state;
         }
-        template <typename T, typename std::enable_if<is_arb_float<T>::value,int>::type = 0>
-        arb &in_place_mul(const T &x)
+        /// Test for the indeterminate state.
+        /**
+         * @return \p true if \p this is in the indeterminate state.
+         */
+        constexpr bool is_indeterminate() const
         {
-            arf_raii tmp_arf;
-            ::arf_set_d(tmp_arf,static_cast<double>(x));
-            ::arb_mul_arf(&m_arb,&m_arb,tmp_arf,m_prec);
-            return *this;
+            return m_state == state::indeterminate_state;
         }
-        static arb binary_mul(const arb &a, const arb &b)
+    private:
+        state m_state;
+};
+
+/// Test for the indeterminate state.
+/**
+ * @param[in] t argument.
+ *
+ * @return <tt>t.is_indeterminate()</tt>.
+ */
+constexpr inline bool is_indeterminate(const tribool &t)
+{
+    return t.is_indeterminate();
+}
+
+class arb;
+class precision_watchdog;
+
+/// Operations on arbpp::arb.
+/**
+ * Identifiers for the operations tracked by the instrumentation layer and by arbpp::precision_watchdog.
+ */
+enum class operation : unsigned
+{
+    /// Construction (default, generic and from string).
+    construct,
+    /// Copy construction and copy assignment.
+    copy,
+    /// Move construction and move assignment.
+    move,
+    /// Binary addition.
+    binary_add,
+    /// Binary subtraction.
+    binary_sub,
+    /// Binary multiplication.
+    binary_mul,
+    /// Binary division.
+    binary_div,
+    /// In-place addition.
+    in_place_add,
+    /// In-place subtraction.
+    in_place_sub,
+    /// In-place multiplication.
+    in_place_mul,
+    /// In-place division.
+    in_place_div,
+    /// Fused multiply-adds (arbpp::arb::addmul() and arbpp::arb::mul_add()).
+    addmul,
+    /// Cosine.
+    cos,
+    /// Square root.
+    sqrt,
+    /// Absolute value.
+    abs,
+    /// Conversion of an \p fmpr to decimal string, as done by the stream operator.
+    print_fmpr
+};
+
+/// Name of an operation.
+/**
+ * @param[in] op operation.
+ *
+ * @return a string representation of \p op.
+ */
+inline const char *operation_name(operation op)
+{
+    static const char *names[] = {"construct","copy","move","binary_add","binary_sub","binary_mul",
+        "binary_div","in_place_add","in_place_sub","in_place_mul","in_place_div","addmul","cos","sqrt","abs",
+        "print_fmpr"};
+    return names[static_cast<std::size_t>(op)];
+}
+
+namespace detail
+{
+
+inline precision_watchdog *&active_watchdog();
+inline void watchdog_check(operation, const arb &);
+
+}
+
+#define ARBPP_WATCHDOG(op,res) ::arbpp::detail::watchdog_check(::arbpp::operation::op,res)
+
+#if defined(ARBPP_ENABLE_INSTRUMENTATION)
+
+/// Instrumentation.
+/**
+ * This namespace is available only if the \p ARBPP_ENABLE_INSTRUMENTATION macro is defined before including arbpp.hpp.
+ * In that case, each thread counts the calls to the main operations of arbpp::arb, bucketed by the precision of the
+ * result, and records a histogram of the relative accuracy lost by each operation (i.e., the difference between the
+ * minimum relative accuracy of the operands and the relative accuracy of the result, both capped at the precision).
+ * The counters can be read and dumped at any time. When the macro is not defined, the instrumentation hooks compile
+ * to nothing.
+ */
+namespace instrumentation
+{
+
+using arbpp::operation;
+
+/// Number of instrumented operations.
+const std::size_t n_operations = static_cast<std::size_t>(operation::print_fmpr) + 1u;
+/// Number of precision buckets.
+/**
+ * Bucket \p i collects the operations whose result has a precision in the range <tt>[2**i,2**(i+1))</tt>.
+ * The last bucket is open-ended.
+ */
+const std::size_t n_precision_buckets = 24u;
+/// Number of buckets in the histogram of lost accuracy.
+/**
+ * Bucket 0 collects the operations which did not lose accuracy, bucket \p i the operations which lost
+ * a number of bits in the range <tt>[2**(i-1),2**i)</tt>. The last bucket is open-ended.
+ */
+const std::size_t n_loss_buckets = 16u;
+
+namespace detail
+{
+
+template <typename ... Args>
+inline void record(operation, const arb &, const Args & ...) noexcept;
+
+inline void record(operation, long) noexcept;
+
+// Records on destruction the operation whose result is the referenced object. The accuracy
+// of the operands is sampled on construction, so that in-place operations can be tracked.
+class scope
+{
+    public:
+        template <typename ... Args>
+        scope(operation, const arb &, const Args & ...) noexcept;
+        scope(const scope &) = delete;
+        scope &operator=(const scope &) = delete;
+        ~scope();
+    private:
+        operation   m_op;
+        const arb   &m_res;
+        long        m_in_acc;
+};
+
+}
+
+}
+
+#define ARBPP_INSTRUMENT(op,...) ::arbpp::instrumentation::detail::record(::arbpp::operation::op,__VA_ARGS__)
+#define ARBPP_INSTRUMENT_SCOPE(op,...) const ::arbpp::instrumentation::detail::scope \
+    arbpp_instrumentation_scope(::arbpp::operation::op,__VA_ARGS__)
+
+#else
+
+#define ARBPP_INSTRUMENT(op,...)
+#define ARBPP_INSTRUMENT_SCOPE(op,...)
+
+#endif
+
+/// Real number represented as a floating-point ball.
+/**
+ * ## Interoperability with fundamental types ##
+ * 
+ * Interoperability with the following types is provided:
+ * - \p char, <tt>signed char</tt>, \p short, \p int, \p long, <tt>long long</tt> and unsigned counterparts,
+ * - \p __int128 and <tt>unsigned __int128</tt>, if supported by the compiler (in which case the
+ *   \p ARBPP_HAVE_INT128 macro is defined),
+ * - \p float, \p double and <tt>long double</tt>,
+ * - the GMP and FLINT multiprecision types \p mpz_t, \p fmpz_t and \p fmpq_t,
+ * - arbpp::rational.
+ *
+ * Conversions from these types never go through a string representation: integers are converted exactly
+ * via \p fmpz, floating-point values exactly via \p arf, and rationals are rounded directly to the target
+ * precision. Arithmetic operations with rational operands are performed on the numerator and the
+ * denominator with extra bits of precision, and they round to the target precision once. Note that the GMP
+ * and FLINT types must be passed as the array types declared by the respective libraries (e.g., a variable
+ * of type \p mpz_t), not as decayed pointers.
+ * 
+ * ## Comparisons ##
+ *
+ * The comparison operators are certified and return an arbpp::tribool: the result is \p true or \p false only
+ * if it holds for all the points of the operands, and indeterminate otherwise. For ordering purposes
+ * (e.g., sorting), use instead arbpp::less_by_midpoint or arbpp::sort().
+ *
+ * ## Exception safety guarantee ##
+ * 
+ * This class provides the strong exception safety guarantee for all operations.
+ * In case of memory allocation errors by
+ * lower-level libraries (e.g., GMP), the program will terminate.
+ * 
+ * ## Move semantics ##
+ *
+ * Move construction and move assignment will leave the moved-from object in an
+ * unspecified but valid state.
+ */
+class arb: private detail::base_arb<>
+{
+        // Import locally the RAII names.
+        typedef detail::arf_raii arf_raii;
+        typedef detail::fmpr_raii fmpr_raii;
+        typedef detail::fmpz_raii fmpz_raii;
+        typedef detail::mpfr_raii mpfr_raii;
+        // Signed integers with which arb can interoperate.
+        template <typename T>
+        struct is_arb_int
         {
-            arb retval;
-            // Set max precision.
-            if (a.m_prec > b.m_prec) {
-                retval.m_prec = a.m_prec;
-            } else {
-                retval.m_prec = b.m_prec;
-            }
-            ::arb_mul(&retval.m_arb,&a.m_arb,&b.m_arb,retval.m_prec);
-            return retval;
-        }
-        template <typename T, typename std::enable_if<is_arb_int<T>::value,int>::type = 0>
-        static arb binary_mul(const arb &a, const T &n)
+            static const bool value = std::is_same<T,signed char>::value || std::is_same<T,short>::value ||
+                std::is_same<T,int>::value || std::is_same<T,long>::value ||
+                (std::is_signed<char>::value && std::is_same<T,char>::value);
+        };
+        // Unsigned integers with which arb can interoperate.
+        template <typename T>
+        struct is_arb_uint
         {
-            arb retval;
-            ::arb_mul_si(&retval.m_arb,&a.m_arb,static_cast<long>(n),a.m_prec);
-            retval.m_prec = a.m_prec;
-            return retval;
-        }
-        template <typename T, typename std::enable_if<is_arb_int<T>::value,int>::type = 0>
-        static arb binary_mul(const T &n, const arb &a)
+            static const bool value = std::is_same<T,unsigned char>::value || std::is_same<T,unsigned short>::value ||
+                std::is_same<T,unsigned>::value || std::is_same<T,unsigned long>::value ||
+                (std::is_unsigned<char>::value && std::is_same<T,char>::value);
+        };
+        // Floating-point types with which arb can interoperate.
+        template <typename T>
+        struct is_arb_float
         {
-            return binary_mul(a,n);
-        }
-        template <typename T, typename std::enable_if<is_arb_uint<T>::value,int>::type = 0>
-        static arb binary_mul(const arb &a, const T &n)
+            static const bool value = std::is_same<T,float>::value || std::is_same<T,double>::value ||
+                std::is_same<T,long double>::value;
+        };
+        // Integral types wider than long.
+        template <typename T>
+        struct is_arb_wide_int
         {
-            arb retval;
-            ::arb_mul_ui(&retval.m_arb,&a.m_arb,static_cast<unsigned long>(n),a.m_prec);
-            retval.m_prec = a.m_prec;
-            return retval;
-        }
-        template <typename T, typename std::enable_if<is_arb_uint<T>::value,int>::type = 0>
-        static arb binary_mul(const T &n, const arb &a)
+            static const bool value = std::is_same<T,long long>::value || std::is_same<T,unsigned long long>::value ||
+                detail::is_int128<T>::value;
+        };
+        // Integral types with which arb interoperates via fmpz.
+        template <typename T>
+        struct is_arb_fmpz
         {
-            return binary_mul(a,n);
-        }
-        template <typename T, typename std::enable_if<is_arb_float<T>::value,int>::type = 0>
-        static arb binary_mul(const arb &a, const T &x)
+            static const bool value = is_arb_wide_int<T>::value || std::is_same<T,::mpz_t>::value ||
+                std::is_same<T,::fmpz_t>::value;
+        };
+        // Rational types with which arb can interoperate.
+        template <typename T>
+        struct is_arb_fmpq
         {
-            arb retval;
-            arf_raii tmp_arf;
-            ::arf_set_d(tmp_arf,static_cast<double>(x));
-            ::arb_mul_arf(&retval.m_arb,&a.m_arb,tmp_arf,a.m_prec);
-            retval.m_prec = a.m_prec;
-            return retval;
-        }
-        template <typename T, typename std::enable_if<is_arb_float<T>::value,int>::type = 0>
-        static arb binary_mul(const T &x, const arb &a)
+            static const bool value = std::is_same<T,::fmpq_t>::value || std::is_same<T,rational>::value;
+        };
+        // Interoperable types.
+        template <typename T>
+        struct is_interoperable
         {
-            return binary_mul(a,x);
-        }
-        // Division.
-        arb &in_place_div(const arb &other)
+            static const bool value = is_arb_int<T>::value || is_arb_uint<T>::value || is_arb_float<T>::value ||
+                is_arb_fmpz<T>::value || is_arb_fmpq<T>::value;
+        };
+        // Custom is_digit checker.
+        static bool is_digit(char c)
         {
-            if (other.m_prec > m_prec) {
-                m_prec = other.m_prec;
-            }
-            ::arb_div(&m_arb,&m_arb,&other.m_arb,m_prec);
-            return *this;
+            const char digits[] = "0123456789";
+            return std::find(digits,digits + 10,c) != (digits + 10);
         }
-        template <typename T, typename std::enable_if<is_arb_int<T>::value,int>::type = 0>
-        arb &in_place_div(const T &n)
+        // Smart pointer to handle the string output from mpfr.
+        typedef std::unique_ptr<char,void (*)(char *)> smart_mpfr_str;
+        // Utility function to print an fmpr to stream using mpfr. Will clear f on exit.
+        static void print_fmpr(std::ostream &os, ::fmpr_t f, long prec)
         {
-            ::arb_div_si(&m_arb,&m_arb,static_cast<long>(n),m_prec);
+            ARBPP_INSTRUMENT(print_fmpr,prec);
+            mpfr_raii t(static_cast< ::mpfr_prec_t>(prec));
+            ::fmpr_get_mpfr(t,f,MPFR_RNDN);
+            // Couple of variables used below.
+            const bool is_zero = (mpfr_sgn(t.m_mpfr) == 0);
+            ::mpfr_exp_t exp(0);
+            char *cptr = ::mpfr_get_str(nullptr,&exp,10,0,t,MPFR_RNDN);
+            // Clear before checking, for exception safety.
+            ::fmpr_clear(f);
+            if (!cptr) {
+                throw std::invalid_argument("error while converting arb to string");
+            }
+            smart_mpfr_str str(cptr,::mpfr_free_str);
+            // Copy into C++ string.
+            std::string cpp_str(str.get());
+            // Insert the radix point.
+            auto it = std::find_if(cpp_str.begin(),cpp_str.end(),[](char c) {return is_digit(c);});
+            if (it != cpp_str.end()) {
+                ++it;
+                cpp_str.insert(it,'.');
+                if (exp == std::numeric_limits< ::mpfr_exp_t>::min()) {
+                    throw std::invalid_argument("error while converting arb to string");
+                }
+                --exp;
+                if (exp != ::mpfr_exp_t(0) && !is_zero) {
+                    cpp_str.append(std::string("e") + std::to_string(exp));
+                }
+            }
+            os << cpp_str;
+        }
+        static void print_arf(std::ostream &os, const ::arf_t a, long prec)
+        {
+            if (prec >= detail::radix_conversion_threshold && ::arf_is_finite(a) && !::arf_is_zero(a)) {
+                // Parallel divide-and-conquer conversion for large precisions.
+                ARBPP_INSTRUMENT(print_fmpr,prec);
+                if (detail::write_decimal(os,a,prec)) {
+                    return;
+                }
+            }
+            // Go through the conversion chain arf -> fmpr -> mpfr.
+            ::fmpr_t f;
+            ::fmpr_init(f);
+            ::arf_get_fmpr(f,a);
+            print_fmpr(os,f,prec);
+        }
+        static void print_mag(std::ostream &os, const ::mag_t m, long prec)
+        {
+            // Go through the conversion chain mag -> fmpr -> mpfr.
+            ::fmpr_t f;
+            ::fmpr_init(f);
+            ::mag_get_fmpr(f,m);
+            print_fmpr(os,f,prec);
+        }
+        // Exact conversion of floating-point values to arf.
+        static void set_arf(::arf_t a, float x)
+        {
+            ::arf_set_d(a,static_cast<double>(x));
+        }
+        static void set_arf(::arf_t a, double x)
+        {
+            ::arf_set_d(a,x);
+        }
+        static void set_arf(::arf_t a, long double x)
+        {
+            // NOTE: the mantissa of long double fits exactly in an mpfr with this precision.
+            mpfr_raii m(static_cast< ::mpfr_prec_t>(std::numeric_limits<long double>::digits));
+            ::mpfr_set_ld(m,x,MPFR_RNDN);
+            ::arf_set_mpfr(a,m);
+        }
+        // Exact conversion of integral values to fmpz. tmp is used as storage when a conversion
+        // is needed, and the return value points to an fmpz holding the value of n.
+        static const ::fmpz *get_fmpz(fmpz_raii &, const ::fmpz_t n)
+        {
+            return n;
+        }
+        static const ::fmpz *get_fmpz(fmpz_raii &tmp, const ::mpz_t n)
+        {
+            ::fmpz_set_mpz(tmp,n);
+            return tmp;
+        }
+        template <typename T, typename std::enable_if<is_arb_wide_int<T>::value,int>::type = 0>
+        static const ::fmpz *get_fmpz(fmpz_raii &tmp, const T &n)
+        {
+            detail::fmpz_set_integral(tmp,n);
+            return tmp;
+        }
+        // Generic constructor.
+        template <typename T, typename std::enable_if<is_arb_int<T>::value,int>::type = 0>
+        void construct(const T &n)
+        {
+            ::arb_set_si(&m_arb,static_cast<long>(n));
+        }
+        template <typename T, typename std::enable_if<is_arb_uint<T>::value,int>::type = 0>
+        void construct(const T &n)
+        {
+            ::arb_set_ui(&m_arb,static_cast<unsigned long>(n));
+        }
+        template <typename T, typename std::enable_if<is_arb_float<T>::value,int>::type = 0>
+        void construct(const T &x)
+        {
+            arf_raii tmp_arf;
+            set_arf(tmp_arf,x);
+            ::arb_set_arf(&m_arb,tmp_arf);
+        }
+        template <typename T, typename std::enable_if<is_arb_fmpz<T>::value,int>::type = 0>
+        void construct(const T &n)
+        {
+            fmpz_raii tmp;
+            ::arb_set_fmpz(&m_arb,get_fmpz(tmp,n));
+        }
+        // NOTE: rationals are rounded directly to the current precision.
+        template <typename T, typename std::enable_if<is_arb_fmpq<T>::value,int>::type = 0>
+        void construct(const T &q)
+        {
+            ::arb_set_fmpq(&m_arb,get_fmpq(q),m_prec);
+        }
+        // Access to the fmpq in rational types.
+        static const ::fmpq *get_fmpq(const ::fmpq_t q)
+        {
+            return q;
+        }
+        static const ::fmpq *get_fmpq(const rational &q)
+        {
+            return q.get_fmpq_t();
+        }
+        // Arithmetic with rationals. The operations on numerator and denominator are carried out with
+        // fmpq_prec() bits, and only the final step rounds to prec. Aliasing between r and a is allowed.
+        // NOTE: the intermediate steps are not exact, as an exact sum of operands with distant exponents
+        // would need an unbounded amount of memory.
+        static const long fmpq_guard_bits = 16;
+        static long fmpq_prec(const ::fmpq *q, long prec)
+        {
+            return prec + static_cast<long>(::fmpz_bits(fmpq_denref(q))) + fmpq_guard_bits;
+        }
+        static void add_fmpq(::arb_struct *r, const ::arb_struct *a, const ::fmpq *q, long prec)
+        {
+            if (::fmpz_is_one(fmpq_denref(q))) {
+                ::arb_add_fmpz(r,a,fmpq_numref(q),prec);
+                return;
+            }
+            // (a * den + num) / den.
+            const long wp = fmpq_prec(q,prec);
+            ::arb_mul_fmpz(r,a,fmpq_denref(q),wp);
+            ::arb_add_fmpz(r,r,fmpq_numref(q),wp);
+            ::arb_div_fmpz(r,r,fmpq_denref(q),prec);
+        }
+        static void sub_fmpq(::arb_struct *r, const ::arb_struct *a, const ::fmpq *q, long prec)
+        {
+            if (::fmpz_is_one(fmpq_denref(q))) {
+                ::arb_sub_fmpz(r,a,fmpq_numref(q),prec);
+                return;
+            }
+            // (a * den - num) / den.
+            const long wp = fmpq_prec(q,prec);
+            ::arb_mul_fmpz(r,a,fmpq_denref(q),wp);
+            ::arb_sub_fmpz(r,r,fmpq_numref(q),wp);
+            ::arb_div_fmpz(r,r,fmpq_denref(q),prec);
+        }
+        static void mul_fmpq(::arb_struct *r, const ::arb_struct *a, const ::fmpq *q, long prec)
+        {
+            if (::fmpz_is_one(fmpq_denref(q))) {
+                ::arb_mul_fmpz(r,a,fmpq_numref(q),prec);
+                return;
+            }
+            // (a * num) / den.
+            ::arb_mul_fmpz(r,a,fmpq_numref(q),fmpq_prec(q,prec));
+            ::arb_div_fmpz(r,r,fmpq_denref(q),prec);
+        }
+        static void div_fmpq(::arb_struct *r, const ::arb_struct *a, const ::fmpq *q, long prec)
+        {
+            if (::fmpz_is_one(fmpq_denref(q))) {
+                ::arb_div_fmpz(r,a,fmpq_numref(q),prec);
+                return;
+            }
+            // (a * den) / num.
+            ::arb_mul_fmpz(r,a,fmpq_denref(q),fmpq_prec(q,prec));
+            ::arb_div_fmpz(r,r,fmpq_numref(q),prec);
+        }
+        // q / a.
+        static void fmpq_div(::arb_struct *r, const ::fmpq *q, const ::arb_struct *a, long prec)
+        {
+            // num * (1 / (a * den)), without temporaries.
+            const long wp = fmpq_prec(q,prec);
+            ::arb_mul_fmpz(r,a,fmpq_denref(q),wp);
+            ::arb_inv(r,r,wp);
+            ::arb_mul_fmpz(r,r,fmpq_numref(q),prec);
+        }
+        // Addition.
+        arb &in_place_add(const arb &other)
+        {
+            // Work with max precision.
+            if (other.m_prec > m_prec) {
+                m_prec = other.m_prec;
+            }
+            ::arb_add(&m_arb,&m_arb,&other.m_arb,m_prec);
+            return *this;
+        }
+        template <typename T, typename std::enable_if<is_arb_int<T>::value,int>::type = 0>
+        arb &in_place_add(const T &n)
+        {
+            ::arb_add_si(&m_arb,&m_arb,static_cast<long>(n),m_prec);
             return *this;
         }
         template <typename T, typename std::enable_if<is_arb_uint<T>::value,int>::type = 0>
-        arb &in_place_div(const T &n)
+        arb &in_place_add(const T &n)
         {
-            ::arb_div_ui(&m_arb,&m_arb,static_cast<unsigned long>(n),m_prec);
+            ::arb_add_ui(&m_arb,&m_arb,static_cast<unsigned long>(n),m_prec);
             return *this;
         }
         template <typename T, typename std::enable_if<is_arb_float<T>::value,int>::type = 0>
-        arb &in_place_div(const T &x)
+        arb &in_place_add(const T &x)
         {
             arf_raii tmp_arf;
-            ::arf_set_d(tmp_arf,static_cast<double>(x));
-            ::arb_div_arf(&m_arb,&m_arb,tmp_arf,m_prec);
+            // Set tmp_arf *exactly* to x.
+            set_arf(tmp_arf,x);
+            // Add with precision m_prec.
+            ::arb_add_arf(&m_arb,&m_arb,tmp_arf,m_prec);
             return *this;
         }
-        static arb binary_div(const arb &a, const arb &b)
+        template <typename T, typename std::enable_if<is_arb_fmpz<T>::value,int>::type = 0>
+        arb &in_place_add(const T &n)
+        {
+            fmpz_raii tmp;
+            ::arb_add_fmpz(&m_arb,&m_arb,get_fmpz(tmp,n),m_prec);
+            return *this;
+        }
+        template <typename T, typename std::enable_if<is_arb_fmpq<T>::value,int>::type = 0>
+        arb &in_place_add(const T &q)
+        {
+            add_fmpq(&m_arb,&m_arb,get_fmpq(q),m_prec);
+            return *this;
+        }
+        static arb binary_add(const arb &a, const arb &b)
         {
             arb retval;
             // Set max precision.
@@ -560,629 +1659,3098 @@ class arb: private detail::base_arb<>
             } else {
                 retval.m_prec = b.m_prec;
             }
-            ::arb_div(&retval.m_arb,&a.m_arb,&b.m_arb,retval.m_prec);
+            ::arb_add(&retval.m_arb,&a.m_arb,&b.m_arb,retval.m_prec);
             return retval;
         }
         template <typename T, typename std::enable_if<is_arb_int<T>::value,int>::type = 0>
-        static arb binary_div(const arb &a, const T &n)
+        static arb binary_add(const arb &a, const T &n)
         {
             arb retval;
-            ::arb_div_si(&retval.m_arb,&a.m_arb,static_cast<long>(n),a.m_prec);
+            ::arb_add_si(&retval.m_arb,&a.m_arb,static_cast<long>(n),a.m_prec);
             retval.m_prec = a.m_prec;
             return retval;
         }
         template <typename T, typename std::enable_if<is_arb_int<T>::value,int>::type = 0>
-        static arb binary_div(const T &n, const arb &a)
+        static arb binary_add(const T &n, const arb &a)
         {
-            auto retval = binary_div(a,n);
-            ::arb_inv(&retval.m_arb,&retval.m_arb,retval.m_prec);
-            return retval;
+            return binary_add(a,n);
         }
         template <typename T, typename std::enable_if<is_arb_uint<T>::value,int>::type = 0>
-        static arb binary_div(const arb &a, const T &n)
+        static arb binary_add(const arb &a, const T &n)
         {
             arb retval;
-            ::arb_div_ui(&retval.m_arb,&a.m_arb,static_cast<unsigned long>(n),a.m_prec);
+            ::arb_add_ui(&retval.m_arb,&a.m_arb,static_cast<unsigned long>(n),a.m_prec);
             retval.m_prec = a.m_prec;
             return retval;
         }
         template <typename T, typename std::enable_if<is_arb_uint<T>::value,int>::type = 0>
-        static arb binary_div(const T &n, const arb &a)
+        static arb binary_add(const T &n, const arb &a)
         {
-            auto retval = binary_div(a,n);
-            ::arb_inv(&retval.m_arb,&retval.m_arb,retval.m_prec);
-            return retval;
+            return binary_add(a,n);
         }
         template <typename T, typename std::enable_if<is_arb_float<T>::value,int>::type = 0>
-        static arb binary_div(const arb &a, const T &x)
+        static arb binary_add(const arb &a, const T &x)
         {
             arb retval;
             arf_raii tmp_arf;
-            ::arf_set_d(tmp_arf,static_cast<double>(x));
-            ::arb_div_arf(&retval.m_arb,&a.m_arb,tmp_arf,a.m_prec);
+            set_arf(tmp_arf,x);
+            ::arb_add_arf(&retval.m_arb,&a.m_arb,tmp_arf,a.m_prec);
             retval.m_prec = a.m_prec;
             return retval;
         }
         template <typename T, typename std::enable_if<is_arb_float<T>::value,int>::type = 0>
-        static arb binary_div(const T &x, const arb &a)
+        static arb binary_add(const T &x, const arb &a)
         {
-            auto retval = binary_div(a,x);
-            ::arb_inv(&retval.m_arb,&retval.m_arb,retval.m_prec);
-            return retval;
+            return binary_add(a,x);
         }
-        // Implementation of precision value setter with checking.
-        void set_prec_value(long prec)
+        template <typename T, typename std::enable_if<is_arb_fmpz<T>::value,int>::type = 0>
+        static arb binary_add(const arb &a, const T &n)
         {
-            // NOTE: this precision is to be used within mpfr routines as well, so check that
-            // the value we are setting is not outside the mpfr bounds.
-            // The mpfr headers say that mpfr_prec_t is always a signed int,
-            // so there is no danger here in comparing to long.
-            if (prec < 1 || prec < MPFR_PREC_MIN || prec > MPFR_PREC_MAX) {
-                throw std::invalid_argument("invalid precision value");
-            }
-            m_prec = prec;
+            arb retval;
+            fmpz_raii tmp;
+            ::arb_add_fmpz(&retval.m_arb,&a.m_arb,get_fmpz(tmp,n),a.m_prec);
+            retval.m_prec = a.m_prec;
+            return retval;
         }
-        // Enabler for the generic ctor.
-        template <typename T>
-        using generic_enabler = typename std::enable_if<is_interoperable<T>::value,int>::type;
-    public:
-        /// Default precision.
-        /**
-         * @return default precision for arbpp::arb objects.
-         */
-        static long get_default_precision()
+        template <typename T, typename std::enable_if<is_arb_fmpz<T>::value,int>::type = 0>
+        static arb binary_add(const T &n, const arb &a)
         {
-            return detail::base_arb<>::default_prec;
+            return binary_add(a,n);
         }
-        /// Default constructor.
-        /**
-         * The value is initialised with both midpoint and radius equal to zero.
-         * The precision is set to the default value.
-         */
-        arb() : m_prec(get_default_precision())
+        template <typename T, typename std::enable_if<is_arb_fmpq<T>::value,int>::type = 0>
+        static arb binary_add(const arb &a, const T &q)
         {
-            ::arb_init(&m_arb);
+            arb retval;
+            add_fmpq(&retval.m_arb,&a.m_arb,get_fmpq(q),a.m_prec);
+            retval.m_prec = a.m_prec;
+            return retval;
         }
-        /// Copy constructor.
-        /**
-         * @param[in] other construction argument.
-         */
-        arb(const arb &other) : m_prec(other.m_prec)
+        template <typename T, typename std::enable_if<is_arb_fmpq<T>::value,int>::type = 0>
+        static arb binary_add(const T &q, const arb &a)
         {
-            ::arb_init(&m_arb);
-            ::arb_set(&m_arb,&other.m_arb);
+            return binary_add(a,q);
         }
-        /// Move constructor.
-        /**
-         * @param[in] other construction argument.
-         */
-        arb(arb &&other) noexcept : m_prec(get_default_precision())
+        // Subtraction.
+        arb &in_place_sub(const arb &other)
         {
-            // Init a default arb, swap it out with other.
-            ::arb_init(&m_arb);
-            swap(other);
+            // Work with max precision.
+            if (other.m_prec > m_prec) {
+                m_prec = other.m_prec;
+            }
+            ::arb_sub(&m_arb,&m_arb,&other.m_arb,m_prec);
+            return *this;
         }
-        /// Generic constructor.
-        /**
-         * \note
-         * This constructor is enabled only if \p T is an interoperable type.
-         * 
-         * This constructor will first initialise \p this to \p x, and then it will round \p this
-         * to the precision \p prec. The precision of \p this will also be set to \p prec.
-         * 
-         * @param[in] x construction argument.
-         * @param[in] prec desired precision.
-         * 
-         * @throws unspecified any exception thrown by arb::set_precision().
-         */
-        template <typename T, generic_enabler<T> = 0>
-        explicit arb(const T &x, long prec = arb::get_default_precision())
+        template <typename T, typename std::enable_if<is_arb_int<T>::value,int>::type = 0>
+        arb &in_place_sub(const T &n)
         {
-            // Set the value of the prec member before doing anything, for exception safety.
-            set_prec_value(prec);
-            // Construct the instance.
-            ::arb_init(&m_arb);
-            construct(x);
-            // Round-set self.
-            ::arb_set_round(&m_arb,&m_arb,m_prec);
+            ::arb_sub_si(&m_arb,&m_arb,static_cast<long>(n),m_prec);
+            return *this;
         }
-        /// Constructor from string.
-        /**
-         * This constructor will set the midpoint to a value represented
-         * by the string \p str and rounded to a precision of \p prec bits.
-         * The expected string format is the same described in the MPFR documentation,
-         * and base 10 representation is assumed.
-         * 
-         * If the value of the input string can be represented exactly with \p prec
-         * bits of precision, then the midpoint will be set to that value
-         * and the radius will be set to zero. Otherwise, the midpoint will be set
-         * to the nearest representable value and the radius is guaranteed to include
-         * the original value.
-         * 
-         * Please note that the entire string must represent a valid floating-point
-         * value.
-         * 
-         * @param[in] str string used for construction.
-         * @param[in] prec desired precision.
-         * 
-         * @throws std::invalid_argument in case of an invalid input string.
-         * @throws std::underflow_error in case of underflow.
-         * @throws unspecified any exception thrown by arb::set_precision().
-         */
-        explicit arb(const std::string &str, long prec = arb::get_default_precision())
-        {
-            // Try to parse an mpfr from the input string.
-            mpfr_raii m(prec);
-            char *endptr;
-            const int retval = ::mpfr_strtofr(m,str.c_str(),&endptr,10,MPFR_RNDN);
-            // NOTE: the first case corresponds to invalid string input, the second
-            // to valid input only for a subset of the string.
-            if (endptr == str.c_str() || endptr != str.c_str() + str.size()) {
-                throw std::invalid_argument("invalid string input");
-            }
-            // Set precision.
-            set_prec_value(prec);
-            // NOTE: here we could have non-finite number in the following cases:
-            // - the passed string was already representing a non-finite ("inf", "nan", etc.),
-            // - the passed string represents a number which gets rounded to +-inf.
-            // In both cases it does not make sense to do the radius calculation, just leave
-            // the non-finite midpoint and a zero radius.
-            if (retval && ::mpfr_number_p(m)) {
-                // Clear the underflow flag.
-                ::mpfr_clear_underflow();
-                mpfr_raii tmp0(prec), tmp1(prec);
-                ::mpfr_set(tmp0.m_mpfr,m.m_mpfr,MPFR_RNDN);
-                ::mpfr_set(tmp1.m_mpfr,m.m_mpfr,MPFR_RNDN);
-                if (retval < 0) {
-                    // Converted value is lower than the exact value.
-                    ::mpfr_nextabove(tmp0);
-                    // NOTE: it seems like the behaviour of mpfr when
-                    // the exact value is above the max or below the min is always to round to +-inf,
-                    // so we should never enter here in a situation in which going above/below would lead
-                    // to a nonfinite value.
-                    assert(::mpfr_number_p(tmp0));
-                    ::mpfr_sub(tmp1,tmp0,m,MPFR_RNDN);
-                } else {
-                    // Converted value is higher than the exact value.
-                    ::mpfr_nextbelow(tmp0);
-                    assert(::mpfr_number_p(tmp0));
-                    ::mpfr_sub(tmp1,m,tmp0,MPFR_RNDN);
-                }
-                // Check if any underflow happened.
-                if (::mpfr_underflow_p()) {
-                    ::mpfr_clear_underflow();
-                    throw std::underflow_error("underflow in the calculation of the radius");
-                }
-                // NOTE: nothing throws after this.
-                // Construct an empty instance and set the midpoint.
-                ::arb_init(&m_arb);
-                ::arf_set_mpfr(arb_midref((&m_arb)),m);
-                // Set the radius via a temporary fmpr.
-                fmpr_raii f;
-                ::fmpr_set_mpfr(f,tmp1);
-                ::mag_set_fmpr(arb_radref((&m_arb)),f);
-            } else {
-                // Just construct empty instance and set the midpoint.
-                // NOTE: we need to repeat these two lines here for exception safety (instead
-                // of sharing them outside the if block).
-                ::arb_init(&m_arb);
-                ::arf_set_mpfr(arb_midref((&m_arb)),m);
-            }
-        }
-        /// Destructor.
-        ~arb()
+        template <typename T, typename std::enable_if<is_arb_uint<T>::value,int>::type = 0>
+        arb &in_place_sub(const T &n)
         {
-            ::arb_clear(&m_arb);
+            ::arb_sub_ui(&m_arb,&m_arb,static_cast<unsigned long>(n),m_prec);
+            return *this;
         }
-        /// Copy assignment.
-        /**
-         * @param[in] other assignment argument.
-         * 
-         * @return reference to \p this.
-         */
-        arb &operator=(const arb &other)
+        template <typename T, typename std::enable_if<is_arb_float<T>::value,int>::type = 0>
+        arb &in_place_sub(const T &x)
         {
-            if (this == &other) {
-                return *this;
-            }
-            ::arb_set(&m_arb,&other.m_arb);
-            m_prec = other.m_prec;
+            arf_raii tmp_arf;
+            // Set tmp_arf *exactly* to x.
+            set_arf(tmp_arf,x);
+            // Sub with precision m_prec.
+            ::arb_sub_arf(&m_arb,&m_arb,tmp_arf,m_prec);
             return *this;
         }
-        /// Move assignment.
-        /**
-         * @param[in] other assignment argument.
-         * 
-         * @return reference to \p this.
-         */
-        arb &operator=(arb &&other) noexcept
+        template <typename T, typename std::enable_if<is_arb_fmpz<T>::value,int>::type = 0>
+        arb &in_place_sub(const T &n)
         {
-            // this == &other check already in swap().
-            swap(other);
+            fmpz_raii tmp;
+            ::arb_sub_fmpz(&m_arb,&m_arb,get_fmpz(tmp,n),m_prec);
             return *this;
         }
-        /// Generic assignment.
-        /**
-         * \note
-         * This assignment operator is enabled only if \p T is an interoperable type.
-         * 
-         * The operation is equivalent to an assignment from an arbpp::arb object constructed from \p x.
-         * 
-         * @param[in] x assignment argument.
-         * 
-         * @return reference to \p this.
-         */
-        template <typename T, generic_enabler<T> = 0>
-        arb &operator=(const T &x)
+        template <typename T, typename std::enable_if<is_arb_fmpq<T>::value,int>::type = 0>
+        arb &in_place_sub(const T &q)
         {
-            m_prec = get_default_precision();
-            construct(x);
-            // Round-set self.
-            ::arb_set_round(&m_arb,&m_arb,m_prec);
+            sub_fmpq(&m_arb,&m_arb,get_fmpq(q),m_prec);
             return *this;
         }
-        /// Add error.
-        /**
-         * Add \p err to the radius.
-         * 
-         * @param[in] err error value.
-         * 
-         * @throws std::invalid_argument if \p err is negative or NaN.
-         */
-        void add_error(double err)
+        static arb binary_sub(const arb &a, const arb &b)
         {
-            if (std::isnan(err) || err <= 0.) {
-                throw std::invalid_argument("an error value must be positive and not NaN");
+            arb retval;
+            // Set max precision.
+            if (a.m_prec > b.m_prec) {
+                retval.m_prec = a.m_prec;
+            } else {
+                retval.m_prec = b.m_prec;
             }
-            arf_raii tmp_arf;
-            ::arf_set_d(tmp_arf,err);
-            ::arb_add_error_arf(&m_arb,tmp_arf);
+            ::arb_sub(&retval.m_arb,&a.m_arb,&b.m_arb,retval.m_prec);
+            return retval;
         }
-        /// Precision setter.
-        /**
-         * Set the precision of \p this to \p prec bits.
-         * 
-         * @param[in] prec desired value for the precision.
-         * 
-         * @throws std::invalid_argument if \p prec is not positive or not within
-         * an implementation-defined range.
-         */
-        void set_precision(long prec)
+        template <typename T, typename std::enable_if<is_arb_int<T>::value,int>::type = 0>
+        static arb binary_sub(const arb &a, const T &n)
         {
-            // NOTE: this precision is to be used within mpfr routines as well, so check that
-            // the value we are setting is not outside the mpfr bounds.
-            // The mpfr headers say that mpfr_prec_t is always a signed int,
-            // so there is no danger here in comparing to long.
-            if (prec < 1 || prec < MPFR_PREC_MIN || prec > MPFR_PREC_MAX) {
-                throw std::invalid_argument("invalid precision value");
-            }
-            m_prec = prec;
-            // Self-set with rounding.
-            ::arb_set_round(&m_arb,&m_arb,m_prec);
+            arb retval;
+            ::arb_sub_si(&retval.m_arb,&a.m_arb,static_cast<long>(n),a.m_prec);
+            retval.m_prec = a.m_prec;
+            return retval;
         }
-        /// Precision getter.
-        /**
-         * @return precision associated to \p this.
-         */
-        long get_precision() const
+        template <typename T, typename std::enable_if<is_arb_int<T>::value,int>::type = 0>
+        static arb binary_sub(const T &n, const arb &a)
         {
-            return m_prec;
+            auto retval = binary_sub(a,n);
+            retval.negate();
+            return retval;
         }
-        /// Swap method.
-        /**
-         * Swap efficiently \p this with \p other.
-         * 
-         * @param[in] other argument for swap.
-         */
-        void swap(arb &other) noexcept
+        template <typename T, typename std::enable_if<is_arb_uint<T>::value,int>::type = 0>
+        static arb binary_sub(const arb &a, const T &n)
         {
-            if (this == &other) {
-                return;
-            }
-            ::arb_swap(&m_arb,&other.m_arb);
-            std::swap(m_prec,other.m_prec);
+            arb retval;
+            ::arb_sub_ui(&retval.m_arb,&a.m_arb,static_cast<unsigned long>(n),a.m_prec);
+            retval.m_prec = a.m_prec;
+            return retval;
         }
-        /// Get a const pointer to the internal \p arb_struct.
-        /**
-         * @return const pointer to the internal \p arb_struct.
-         */
-        const ::arb_struct *get_arb_t() const
+        template <typename T, typename std::enable_if<is_arb_uint<T>::value,int>::type = 0>
+        static arb binary_sub(const T &n, const arb &a)
         {
-            return &m_arb;
+            auto retval = binary_sub(a,n);
+            retval.negate();
+            return retval;
         }
-        /// Get a mutable pointer to the internal \p arb_struct.
-        /**
-         * @return pointer to the internal \p arb_struct.
-         */
-        ::arb_struct *get_arb_t()
+        template <typename T, typename std::enable_if<is_arb_float<T>::value,int>::type = 0>
+        static arb binary_sub(const arb &a, const T &x)
         {
-            return &m_arb;
+            arb retval;
+            arf_raii tmp_arf;
+            set_arf(tmp_arf,x);
+            ::arb_sub_arf(&retval.m_arb,&a.m_arb,tmp_arf,a.m_prec);
+            retval.m_prec = a.m_prec;
+            return retval;
         }
-        /// Stream operator.
-        /**
-         * This function will print to stream a human-readable representation
-         * of \p a.
-         * 
-         * @param[in,out] os target stream.
-         * @param[in] a arbpp::arb to be streamed.
-         * 
-         * @return reference to \p os.
-         * 
-         * @throws std::invalid_argument in case of any error in the conversion
-         * of \p a to string.
-         */
-        friend std::ostream &operator<<(std::ostream &os, const arb &a)
+        template <typename T, typename std::enable_if<is_arb_float<T>::value,int>::type = 0>
+        static arb binary_sub(const T &x, const arb &a)
         {
-            if (::mag_is_zero(arb_radref((&a.m_arb)))) {
-                // Print only the arf.
-                print_arf(os,arb_midref((&a.m_arb)),a.m_prec);
-            } else {
-                os << '(';
-                // First print the arf.
-                print_arf(os,arb_midref((&a.m_arb)),a.m_prec);
-                os << " +/- ";
-                // Now print the mag.
-                // NOTE: the mag has a fixed-size mantissa of 30 bits.
-                print_mag(os,arb_radref((&a.m_arb)),30);
-                os << ')';
+            auto retval = binary_sub(a,x);
+            retval.negate();
+            return retval;
+        }
+        template <typename T, typename std::enable_if<is_arb_fmpz<T>::value,int>::type = 0>
+        static arb binary_sub(const arb &a, const T &n)
+        {
+            arb retval;
+            fmpz_raii tmp;
+            ::arb_sub_fmpz(&retval.m_arb,&a.m_arb,get_fmpz(tmp,n),a.m_prec);
+            retval.m_prec = a.m_prec;
+            return retval;
+        }
+        template <typename T, typename std::enable_if<is_arb_fmpz<T>::value,int>::type = 0>
+        static arb binary_sub(const T &n, const arb &a)
+        {
+            auto retval = binary_sub(a,n);
+            retval.negate();
+            return retval;
+        }
+        template <typename T, typename std::enable_if<is_arb_fmpq<T>::value,int>::type = 0>
+        static arb binary_sub(const arb &a, const T &q)
+        {
+            arb retval;
+            sub_fmpq(&retval.m_arb,&a.m_arb,get_fmpq(q),a.m_prec);
+            retval.m_prec = a.m_prec;
+            return retval;
+        }
+        template <typename T, typename std::enable_if<is_arb_fmpq<T>::value,int>::type = 0>
+        static arb binary_sub(const T &q, const arb &a)
+        {
+            auto retval = binary_sub(a,q);
+            retval.negate();
+            return retval;
+        }
+        // Multiplication.
+        arb &in_place_mul(const arb &other)
+        {
+            if (other.m_prec > m_prec) {
+                m_prec = other.m_prec;
             }
-            return os;
+            ::arb_mul(&m_arb,&m_arb,&other.m_arb,m_prec);
+            return *this;
         }
-        /// Midpoint getter.
-        /**
-         * @return the midpoint of \p this, rounded to \p double in an unspecified
-         * direction.
-         */
-        double get_midpoint() const
+        template <typename T, typename std::enable_if<is_arb_int<T>::value,int>::type = 0>
+        arb &in_place_mul(const T &n)
         {
-            return ::arf_get_d(arb_midref((&m_arb)),ARF_RND_DOWN);
+            ::arb_mul_si(&m_arb,&m_arb,static_cast<long>(n),m_prec);
+            return *this;
         }
-        /// Radius getter.
-        /**
-         * @return the radius of \p this, rounded to \p double in an unspecified
-         * direction.
-         */
-        double get_radius() const
+        template <typename T, typename std::enable_if<is_arb_uint<T>::value,int>::type = 0>
+        arb &in_place_mul(const T &n)
         {
-            fmpr_raii tmp;
-            ::mag_get_fmpr(tmp,arb_radref((&m_arb)));
-            return ::fmpr_get_d(tmp,FMPR_RND_UP);
+            ::arb_mul_ui(&m_arb,&m_arb,static_cast<unsigned long>(n),m_prec);
+            return *this;
         }
-        /// Identity operator.
-        /**
-         * @return a copy of \p this.
-         */
-        arb operator+() const
+        template <typename T, typename std::enable_if<is_arb_float<T>::value,int>::type = 0>
+        arb &in_place_mul(const T &x)
         {
+            arf_raii tmp_arf;
+            set_arf(tmp_arf,x);
+            ::arb_mul_arf(&m_arb,&m_arb,tmp_arf,m_prec);
             return *this;
         }
-        /// In-place addition.
-        /**
-         * \note
-         * This operator is enabled only if \p T is an interoperable type
-         * or arbpp::arb.
-         * 
-         * This method will set \p this to <tt>this + x</tt>. In case \p T is arbpp::arb, then
-         * the operation is carried out with a precision corresponding to the maximum between
-         * the precisions of \p this and \p x. Otherwise, the operation is carried out with the
-         * precision of \p this.
-         * 
-         * @param[in] x addition argument.
-         * 
-         * @return reference to \p this.
-         */
-        template <typename T>
-        auto operator+=(const T &x) -> decltype(this->in_place_add(x))
+        template <typename T, typename std::enable_if<is_arb_fmpz<T>::value,int>::type = 0>
+        arb &in_place_mul(const T &n)
+        {
+            fmpz_raii tmp;
+            ::arb_mul_fmpz(&m_arb,&m_arb,get_fmpz(tmp,n),m_prec);
+            return *this;
+        }
+        template <typename T, typename std::enable_if<is_arb_fmpq<T>::value,int>::type = 0>
+        arb &in_place_mul(const T &q)
+        {
+            mul_fmpq(&m_arb,&m_arb,get_fmpq(q),m_prec);
+            return *this;
+        }
+        static arb binary_mul(const arb &a, const arb &b)
+        {
+            arb retval;
+            // Set max precision.
+            if (a.m_prec > b.m_prec) {
+                retval.m_prec = a.m_prec;
+            } else {
+                retval.m_prec = b.m_prec;
+            }
+            ::arb_mul(&retval.m_arb,&a.m_arb,&b.m_arb,retval.m_prec);
+            return retval;
+        }
+        template <typename T, typename std::enable_if<is_arb_int<T>::value,int>::type = 0>
+        static arb binary_mul(const arb &a, const T &n)
+        {
+            arb retval;
+            ::arb_mul_si(&retval.m_arb,&a.m_arb,static_cast<long>(n),a.m_prec);
+            retval.m_prec = a.m_prec;
+            return retval;
+        }
+        template <typename T, typename std::enable_if<is_arb_int<T>::value,int>::type = 0>
+        static arb binary_mul(const T &n, const arb &a)
+        {
+            return binary_mul(a,n);
+        }
+        template <typename T, typename std::enable_if<is_arb_uint<T>::value,int>::type = 0>
+        static arb binary_mul(const arb &a, const T &n)
+        {
+            arb retval;
+            ::arb_mul_ui(&retval.m_arb,&a.m_arb,static_cast<unsigned long>(n),a.m_prec);
+            retval.m_prec = a.m_prec;
+            return retval;
+        }
+        template <typename T, typename std::enable_if<is_arb_uint<T>::value,int>::type = 0>
+        static arb binary_mul(const T &n, const arb &a)
+        {
+            return binary_mul(a,n);
+        }
+        template <typename T, typename std::enable_if<is_arb_float<T>::value,int>::type = 0>
+        static arb binary_mul(const arb &a, const T &x)
+        {
+            arb retval;
+            arf_raii tmp_arf;
+            set_arf(tmp_arf,x);
+            ::arb_mul_arf(&retval.m_arb,&a.m_arb,tmp_arf,a.m_prec);
+            retval.m_prec = a.m_prec;
+            return retval;
+        }
+        template <typename T, typename std::enable_if<is_arb_float<T>::value,int>::type = 0>
+        static arb binary_mul(const T &x, const arb &a)
+        {
+            return binary_mul(a,x);
+        }
+        template <typename T, typename std::enable_if<is_arb_fmpz<T>::value,int>::type = 0>
+        static arb binary_mul(const arb &a, const T &n)
+        {
+            arb retval;
+            fmpz_raii tmp;
+            ::arb_mul_fmpz(&retval.m_arb,&a.m_arb,get_fmpz(tmp,n),a.m_prec);
+            retval.m_prec = a.m_prec;
+            return retval;
+        }
+        template <typename T, typename std::enable_if<is_arb_fmpz<T>::value,int>::type = 0>
+        static arb binary_mul(const T &n, const arb &a)
+        {
+            return binary_mul(a,n);
+        }
+        template <typename T, typename std::enable_if<is_arb_fmpq<T>::value,int>::type = 0>
+        static arb binary_mul(const arb &a, const T &q)
+        {
+            arb retval;
+            mul_fmpq(&retval.m_arb,&a.m_arb,get_fmpq(q),a.m_prec);
+            retval.m_prec = a.m_prec;
+            return retval;
+        }
+        template <typename T, typename std::enable_if<is_arb_fmpq<T>::value,int>::type = 0>
+        static arb binary_mul(const T &q, const arb &a)
+        {
+            return binary_mul(a,q);
+        }
+        // Division.
+        arb &in_place_div(const arb &other)
+        {
+            if (other.m_prec > m_prec) {
+                m_prec = other.m_prec;
+            }
+            ::arb_div(&m_arb,&m_arb,&other.m_arb,m_prec);
+            return *this;
+        }
+        template <typename T, typename std::enable_if<is_arb_int<T>::value,int>::type = 0>
+        arb &in_place_div(const T &n)
+        {
+            ::arb_div_si(&m_arb,&m_arb,static_cast<long>(n),m_prec);
+            return *this;
+        }
+        template <typename T, typename std::enable_if<is_arb_uint<T>::value,int>::type = 0>
+        arb &in_place_div(const T &n)
+        {
+            ::arb_div_ui(&m_arb,&m_arb,static_cast<unsigned long>(n),m_prec);
+            return *this;
+        }
+        template <typename T, typename std::enable_if<is_arb_float<T>::value,int>::type = 0>
+        arb &in_place_div(const T &x)
+        {
+            arf_raii tmp_arf;
+            set_arf(tmp_arf,x);
+            ::arb_div_arf(&m_arb,&m_arb,tmp_arf,m_prec);
+            return *this;
+        }
+        template <typename T, typename std::enable_if<is_arb_fmpz<T>::value,int>::type = 0>
+        arb &in_place_div(const T &n)
+        {
+            fmpz_raii tmp;
+            ::arb_div_fmpz(&m_arb,&m_arb,get_fmpz(tmp,n),m_prec);
+            return *this;
+        }
+        template <typename T, typename std::enable_if<is_arb_fmpq<T>::value,int>::type = 0>
+        arb &in_place_div(const T &q)
+        {
+            div_fmpq(&m_arb,&m_arb,get_fmpq(q),m_prec);
+            return *this;
+        }
+        static arb binary_div(const arb &a, const arb &b)
+        {
+            arb retval;
+            // Set max precision.
+            if (a.m_prec > b.m_prec) {
+                retval.m_prec = a.m_prec;
+            } else {
+                retval.m_prec = b.m_prec;
+            }
+            ::arb_div(&retval.m_arb,&a.m_arb,&b.m_arb,retval.m_prec);
+            return retval;
+        }
+        template <typename T, typename std::enable_if<is_arb_int<T>::value,int>::type = 0>
+        static arb binary_div(const arb &a, const T &n)
+        {
+            arb retval;
+            ::arb_div_si(&retval.m_arb,&a.m_arb,static_cast<long>(n),a.m_prec);
+            retval.m_prec = a.m_prec;
+            return retval;
+        }
+        template <typename T, typename std::enable_if<is_arb_int<T>::value,int>::type = 0>
+        static arb binary_div(const T &n, const arb &a)
+        {
+            auto retval = binary_div(a,n);
+            ::arb_inv(&retval.m_arb,&retval.m_arb,retval.m_prec);
+            return retval;
+        }
+        template <typename T, typename std::enable_if<is_arb_uint<T>::value,int>::type = 0>
+        static arb binary_div(const arb &a, const T &n)
+        {
+            arb retval;
+            ::arb_div_ui(&retval.m_arb,&a.m_arb,static_cast<unsigned long>(n),a.m_prec);
+            retval.m_prec = a.m_prec;
+            return retval;
+        }
+        template <typename T, typename std::enable_if<is_arb_uint<T>::value,int>::type = 0>
+        static arb binary_div(const T &n, const arb &a)
+        {
+            auto retval = binary_div(a,n);
+            ::arb_inv(&retval.m_arb,&retval.m_arb,retval.m_prec);
+            return retval;
+        }
+        template <typename T, typename std::enable_if<is_arb_float<T>::value,int>::type = 0>
+        static arb binary_div(const arb &a, const T &x)
+        {
+            arb retval;
+            arf_raii tmp_arf;
+            set_arf(tmp_arf,x);
+            ::arb_div_arf(&retval.m_arb,&a.m_arb,tmp_arf,a.m_prec);
+            retval.m_prec = a.m_prec;
+            return retval;
+        }
+        template <typename T, typename std::enable_if<is_arb_float<T>::value,int>::type = 0>
+        static arb binary_div(const T &x, const arb &a)
+        {
+            auto retval = binary_div(a,x);
+            ::arb_inv(&retval.m_arb,&retval.m_arb,retval.m_prec);
+            return retval;
+        }
+        template <typename T, typename std::enable_if<is_arb_fmpz<T>::value,int>::type = 0>
+        static arb binary_div(const arb &a, const T &n)
+        {
+            arb retval;
+            fmpz_raii tmp;
+            ::arb_div_fmpz(&retval.m_arb,&a.m_arb,get_fmpz(tmp,n),a.m_prec);
+            retval.m_prec = a.m_prec;
+            return retval;
+        }
+        template <typename T, typename std::enable_if<is_arb_fmpz<T>::value,int>::type = 0>
+        static arb binary_div(const T &n, const arb &a)
+        {
+            auto retval = binary_div(a,n);
+            ::arb_inv(&retval.m_arb,&retval.m_arb,retval.m_prec);
+            return retval;
+        }
+        template <typename T, typename std::enable_if<is_arb_fmpq<T>::value,int>::type = 0>
+        static arb binary_div(const arb &a, const T &q)
+        {
+            arb retval;
+            div_fmpq(&retval.m_arb,&a.m_arb,get_fmpq(q),a.m_prec);
+            retval.m_prec = a.m_prec;
+            return retval;
+        }
+        template <typename T, typename std::enable_if<is_arb_fmpq<T>::value,int>::type = 0>
+        static arb binary_div(const T &q, const arb &a)
+        {
+            arb retval;
+            fmpq_div(&retval.m_arb,get_fmpq(q),&a.m_arb,a.m_prec);
+            retval.m_prec = a.m_prec;
+            return retval;
+        }
+        // Implementation of precision value setter with checking.
+        void set_prec_value(long prec)
+        {
+            // NOTE: this precision is to be used within mpfr routines as well, so check that
+            // the value we are setting is not outside the mpfr bounds.
+            // The mpfr headers say that mpfr_prec_t is always a signed int,
+            // so there is no danger here in comparing to long.
+            if (prec < 1 || prec < MPFR_PREC_MIN || prec > MPFR_PREC_MAX) {
+                throw std::invalid_argument("invalid precision value");
+            }
+            m_prec = prec;
+        }
+        // Construction from a plain decimal string, via the parallel divide-and-conquer conversion. Returns false
+        // without constructing if str is not in the format accepted by detail::parse_decimal(), or if its exponent
+        // is too large for an exact conversion. The midpoint is rounded to nearest, and the radius is one ulp if
+        // the conversion is inexact.
+        bool construct_decimal(const std::string &str, long prec)
+        {
+            std::string digits;
+            long e;
+            bool negative;
+            if (!detail::parse_decimal(str,digits,e,negative) || e > prec || e < -prec) {
+                return false;
+            }
+            set_prec_value(prec);
+            fmpz_raii m, p;
+            detail::fmpz_set_digits(m,digits.data(),digits.size(),detail::radix_threads());
+            arf_raii mid;
+            int inexact;
+            if (e >= 0) {
+                ::fmpz_ui_pow_ui(p,10u,static_cast<unsigned long>(e));
+                ::fmpz_mul(m,m,p);
+                inexact = ::arf_set_round_fmpz(mid,m,prec,ARF_RND_NEAR);
+            } else {
+                ::fmpz_ui_pow_ui(p,10u,static_cast<unsigned long>(-e));
+                arf_raii num, den;
+                ::arf_set_fmpz(num,m);
+                ::arf_set_fmpz(den,p);
+                inexact = ::arf_div(mid,num,den,prec,ARF_RND_NEAR);
+            }
+            if (negative) {
+                ::arf_neg(mid,mid);
+            }
+            // NOTE: nothing throws after this.
+            ::arb_init(&m_arb);
+            ::arf_swap(arb_midref((&m_arb)),mid);
+            if (inexact) {
+                ::arf_mag_set_ulp(arb_radref((&m_arb)),arb_midref((&m_arb)),prec);
+            }
+            ARBPP_INSTRUMENT(construct,*this);
+            return true;
+        }
+        // Enabler for the generic ctor.
+        template <typename T>
+        using generic_enabler = typename std::enable_if<is_interoperable<T>::value,int>::type;
+    public:
+        /// Default precision.
+        /**
+         * @return default precision for arbpp::arb objects.
+         */
+        static long get_default_precision()
+        {
+            return detail::base_arb<>::default_prec;
+        }
+        /// Default constructor.
+        /**
+         * The value is initialised with both midpoint and radius equal to zero.
+         * The precision is set to the default value.
+         */
+        arb() : m_prec(get_default_precision())
+        {
+            ::arb_init(&m_arb);
+            ARBPP_INSTRUMENT(construct,*this);
+        }
+        /// Copy constructor.
+        /**
+         * @param[in] other construction argument.
+         */
+        arb(const arb &other) : m_prec(other.m_prec)
+        {
+            ::arb_init(&m_arb);
+            ::arb_set(&m_arb,&other.m_arb);
+            ARBPP_INSTRUMENT(copy,*this);
+        }
+        /// Move constructor.
+        /**
+         * @param[in] other construction argument.
+         */
+        arb(arb &&other) noexcept : m_prec(get_default_precision())
+        {
+            // Init a default arb, swap it out with other.
+            ::arb_init(&m_arb);
+            swap(other);
+            ARBPP_INSTRUMENT(move,*this);
+        }
+        /// Generic constructor.
+        /**
+         * \note
+         * This constructor is enabled only if \p T is an interoperable type.
+         * 
+         * This constructor will first initialise \p this to \p x, and then it will round \p this
+         * to the precision \p prec. The precision of \p this will also be set to \p prec.
+         * 
+         * @param[in] x construction argument.
+         * @param[in] prec desired precision.
+         * 
+         * @throws unspecified any exception thrown by arb::set_precision().
+         */
+        template <typename T, generic_enabler<T> = 0>
+        explicit arb(const T &x, long prec = arb::get_default_precision())
+        {
+            // Set the value of the prec member before doing anything, for exception safety.
+            set_prec_value(prec);
+            // Construct the instance.
+            ::arb_init(&m_arb);
+            construct(x);
+            // Round-set self.
+            ::arb_set_round(&m_arb,&m_arb,m_prec);
+            ARBPP_INSTRUMENT(construct,*this);
+        }
+        /// Constructor from string.
+        /**
+         * This constructor will set the midpoint to a value represented
+         * by the string \p str and rounded to a precision of \p prec bits.
+         * The expected string format is the same described in the MPFR documentation,
+         * and base 10 representation is assumed.
+         * 
+         * If the value of the input string can be represented exactly with \p prec
+         * bits of precision, then the midpoint will be set to that value
+         * and the radius will be set to zero. Otherwise, the midpoint will be set
+         * to the nearest representable value and the radius is guaranteed to include
+         * the original value.
+         * 
+         * Please note that the entire string must represent a valid floating-point
+         * value.
+         * 
+         * For large precisions (at least 2**17 bits), plain decimal strings (optional sign, digits with an
+         * optional radix point, optional exponent) are converted with a parallel divide-and-conquer
+         * algorithm instead of MPFR. The conversion uses as many threads as the available hardware threads, up to
+         * a maximum of 8. When invoked from a function evaluated by one of the multithreaded routines of arbpp (e.g.,
+         * arbpp::bound_range()), which already keep the hardware busy, the conversion runs in the calling thread.
+         * 
+         * @param[in] str string used for construction.
+         * @param[in] prec desired precision.
+         * 
+         * @throws std::invalid_argument in case of an invalid input string.
+         * @throws std::underflow_error in case of underflow.
+         * @throws unspecified any exception thrown by arb::set_precision().
+         */
+        explicit arb(const std::string &str, long prec = arb::get_default_precision())
+        {
+            if (prec >= detail::radix_conversion_threshold && construct_decimal(str,prec)) {
+                return;
+            }
+            // Try to parse an mpfr from the input string.
+            mpfr_raii m(prec);
+            char *endptr;
+            const int retval = ::mpfr_strtofr(m,str.c_str(),&endptr,10,MPFR_RNDN);
+            // NOTE: the first case corresponds to invalid string input, the second
+            // to valid input only for a subset of the string.
+            if (endptr == str.c_str() || endptr != str.c_str() + str.size()) {
+                throw std::invalid_argument("invalid string input");
+            }
+            // Set precision.
+            set_prec_value(prec);
+            // NOTE: here we could have non-finite number in the following cases:
+            // - the passed string was already representing a non-finite ("inf", "nan", etc.),
+            // - the passed string represents a number which gets rounded to +-inf.
+            // In both cases it does not make sense to do the radius calculation, just leave
+            // the non-finite midpoint and a zero radius.
+            if (retval && ::mpfr_number_p(m)) {
+                // Clear the underflow flag.
+                ::mpfr_clear_underflow();
+                mpfr_raii tmp0(prec), tmp1(prec);
+                ::mpfr_set(tmp0.m_mpfr,m.m_mpfr,MPFR_RNDN);
+                ::mpfr_set(tmp1.m_mpfr,m.m_mpfr,MPFR_RNDN);
+                if (retval < 0) {
+                    // Converted value is lower than the exact value.
+                    ::mpfr_nextabove(tmp0);
+                    // NOTE: it seems like the behaviour of mpfr when
+                    // the exact value is above the max or below the min is always to round to +-inf,
+                    // so we should never enter here in a situation in which going above/below would lead
+                    // to a nonfinite value.
+                    assert(::mpfr_number_p(tmp0));
+                    ::mpfr_sub(tmp1,tmp0,m,MPFR_RNDN);
+                } else {
+                    // Converted value is higher than the exact value.
+                    ::mpfr_nextbelow(tmp0);
+                    assert(::mpfr_number_p(tmp0));
+                    ::mpfr_sub(tmp1,m,tmp0,MPFR_RNDN);
+                }
+                // Check if any underflow happened.
+                if (::mpfr_underflow_p()) {
+                    ::mpfr_clear_underflow();
+                    throw std::underflow_error("underflow in the calculation of the radius");
+                }
+                // NOTE: nothing throws after this.
+                // Construct an empty instance and set the midpoint.
+                ::arb_init(&m_arb);
+                ::arf_set_mpfr(arb_midref((&m_arb)),m);
+                // Set the radius via a temporary fmpr.
+                fmpr_raii f;
+                ::fmpr_set_mpfr(f,tmp1);
+                ::mag_set_fmpr(arb_radref((&m_arb)),f);
+            } else {
+                // Just construct empty instance and set the midpoint.
+                // NOTE: we need to repeat these two lines here for exception safety (instead
+                // of sharing them outside the if block).
+                ::arb_init(&m_arb);
+                ::arf_set_mpfr(arb_midref((&m_arb)),m);
+            }
+            ARBPP_INSTRUMENT(construct,*this);
+        }
+        /// Destructor.
+        ~arb()
+        {
+            ::arb_clear(&m_arb);
+        }
+        /// Copy assignment.
+        /**
+         * @param[in] other assignment argument.
+         * 
+         * @return reference to \p this.
+         */
+        arb &operator=(const arb &other)
+        {
+            if (this == &other) {
+                return *this;
+            }
+            ::arb_set(&m_arb,&other.m_arb);
+            m_prec = other.m_prec;
+            ARBPP_INSTRUMENT(copy,*this);
+            return *this;
+        }
+        /// Move assignment.
+        /**
+         * @param[in] other assignment argument.
+         * 
+         * @return reference to \p this.
+         */
+        arb &operator=(arb &&other) noexcept
+        {
+            // this == &other check already in swap().
+            swap(other);
+            ARBPP_INSTRUMENT(move,*this);
+            return *this;
+        }
+        /// Generic assignment.
+        /**
+         * \note
+         * This assignment operator is enabled only if \p T is an interoperable type.
+         * 
+         * The operation is equivalent to an assignment from an arbpp::arb object constructed from \p x.
+         * 
+         * @param[in] x assignment argument.
+         * 
+         * @return reference to \p this.
+         */
+        template <typename T, generic_enabler<T> = 0>
+        arb &operator=(const T &x)
+        {
+            m_prec = get_default_precision();
+            construct(x);
+            // Round-set self.
+            ::arb_set_round(&m_arb,&m_arb,m_prec);
+            return *this;
+        }
+        /// Add error.
+        /**
+         * Add \p err to the radius.
+         * 
+         * @param[in] err error value.
+         * 
+         * @throws std::invalid_argument if \p err is negative or NaN.
+         */
+        void add_error(double err)
+        {
+            if (std::isnan(err) || err <= 0.) {
+                throw std::invalid_argument("an error value must be positive and not NaN");
+            }
+            arf_raii tmp_arf;
+            ::arf_set_d(tmp_arf,err);
+            ::arb_add_error_arf(&m_arb,tmp_arf);
+        }
+        /// Precision setter.
+        /**
+         * Set the precision of \p this to \p prec bits.
+         * 
+         * @param[in] prec desired value for the precision.
+         * 
+         * @throws std::invalid_argument if \p prec is not positive or not within
+         * an implementation-defined range.
+         */
+        void set_precision(long prec)
+        {
+            // NOTE: this precision is to be used within mpfr routines as well, so check that
+            // the value we are setting is not outside the mpfr bounds.
+            // The mpfr headers say that mpfr_prec_t is always a signed int,
+            // so there is no danger here in comparing to long.
+            if (prec < 1 || prec < MPFR_PREC_MIN || prec > MPFR_PREC_MAX) {
+                throw std::invalid_argument("invalid precision value");
+            }
+            m_prec = prec;
+            // Self-set with rounding.
+            ::arb_set_round(&m_arb,&m_arb,m_prec);
+        }
+        /// Precision getter.
+        /**
+         * @return precision associated to \p this.
+         */
+        long get_precision() const
+        {
+            return m_prec;
+        }
+        /// Swap method.
+        /**
+         * Swap efficiently \p this with \p other.
+         * 
+         * @param[in] other argument for swap.
+         */
+        void swap(arb &other) noexcept
+        {
+            if (this == &other) {
+                return;
+            }
+            ::arb_swap(&m_arb,&other.m_arb);
+            std::swap(m_prec,other.m_prec);
+        }
+        /// Get a const pointer to the internal \p arb_struct.
+        /**
+         * @return const pointer to the internal \p arb_struct.
+         */
+        const ::arb_struct *get_arb_t() const
+        {
+            return &m_arb;
+        }
+        /// Get a mutable pointer to the internal \p arb_struct.
+        /**
+         * @return pointer to the internal \p arb_struct.
+         */
+        ::arb_struct *get_arb_t()
+        {
+            return &m_arb;
+        }
+        /// Stream operator.
+        /**
+         * This function will print to stream a human-readable representation
+         * of \p a. For large precisions (at least 2**17 bits), the midpoint is converted
+         * with a parallel divide-and-conquer algorithm instead of MPFR.
+         * 
+         * @param[in,out] os target stream.
+         * @param[in] a arbpp::arb to be streamed.
+         * 
+         * @return reference to \p os.
+         * 
+         * @throws std::invalid_argument in case of any error in the conversion
+         * of \p a to string.
+         */
+        friend std::ostream &operator<<(std::ostream &os, const arb &a)
+        {
+            if (::mag_is_zero(arb_radref((&a.m_arb)))) {
+                // Print only the arf.
+                print_arf(os,arb_midref((&a.m_arb)),a.m_prec);
+            } else {
+                os << '(';
+                // First print the arf.
+                print_arf(os,arb_midref((&a.m_arb)),a.m_prec);
+                os << " +/- ";
+                // Now print the mag.
+                // NOTE: the mag has a fixed-size mantissa of 30 bits.
+                print_mag(os,arb_radref((&a.m_arb)),30);
+                os << ')';
+            }
+            return os;
+        }
+        /// Midpoint getter.
+        /**
+         * @return the midpoint of \p this, rounded to \p double in an unspecified
+         * direction.
+         */
+        double get_midpoint() const
+        {
+            return ::arf_get_d(arb_midref((&m_arb)),ARF_RND_DOWN);
+        }
+        /// Radius getter.
+        /**
+         * @return the radius of \p this, rounded to \p double in an unspecified
+         * direction.
+         */
+        double get_radius() const
+        {
+            // NOTE: a mag always fits in the inline storage of an arf, thus
+            // this does not allocate.
+            arf_raii tmp;
+            ::arf_set_mag(tmp,arb_radref((&m_arb)));
+            return ::arf_get_d(tmp,ARF_RND_UP);
+        }
+        /// Relative accuracy.
+        /**
+         * The relative accuracy is computed via \p arb_rel_accuracy_bits(), and it is approximately
+         * <tt>-log2(radius / |midpoint|)</tt>. If the radius is zero, the return value is a large positive number;
+         * if the ball contains zero, the return value is zero or negative.
+         *
+         * @return the relative accuracy of \p this in bits.
+         */
+        long get_rel_accuracy_bits() const
+        {
+            return static_cast<long>(::arb_rel_accuracy_bits(&m_arb));
+        }
+        /// Heap memory usage.
+        /**
+         * The returned value counts the limbs of the midpoint and of the radius allocated on the heap (as
+         * computed by \p arb_allocated_bytes()), and it does not include <tt>sizeof(arb)</tt>.
+         *
+         * @return the number of bytes of heap memory owned by \p this.
+         */
+        std::size_t allocated_bytes() const
+        {
+            return static_cast<std::size_t>(::arb_allocated_bytes(&m_arb));
+        }
+        /// Certified conversion to \p double.
+        /**
+         * The behaviour depends on \p rnd:
+         * - with arbpp::rounding_mode::nearest, the midpoint is rounded to the nearest \p double,
+         * - with arbpp::rounding_mode::downward, the return value is the largest \p double which is not greater than
+         *   any value in the ball,
+         * - with arbpp::rounding_mode::upward, the return value is the smallest \p double which is not less than
+         *   any value in the ball.
+         *
+         * Values outside the range of \p double are rounded to the largest finite value or to an infinity,
+         * according to the rounding direction.
+         *
+         * @param[in] rnd rounding mode.
+         *
+         * @return \p this converted to \p double according to \p rnd.
+         */
+        double to_double(rounding_mode rnd = rounding_mode::nearest) const
+        {
+            const bool exact = ::mag_is_zero(arb_radref((&m_arb)));
+            switch (rnd) {
+                case rounding_mode::downward:
+                    if (!exact) {
+                        arf_raii tmp;
+                        ::arb_get_lbound_arf(tmp,&m_arb,std::numeric_limits<double>::digits);
+                        return ::arf_get_d(tmp,ARF_RND_FLOOR);
+                    }
+                    return ::arf_get_d(arb_midref((&m_arb)),ARF_RND_FLOOR);
+                case rounding_mode::upward:
+                    if (!exact) {
+                        arf_raii tmp;
+                        ::arb_get_ubound_arf(tmp,&m_arb,std::numeric_limits<double>::digits);
+                        return ::arf_get_d(tmp,ARF_RND_CEIL);
+                    }
+                    return ::arf_get_d(arb_midref((&m_arb)),ARF_RND_CEIL);
+                default:
+                    return ::arf_get_d(arb_midref((&m_arb)),ARF_RND_NEAR);
+            }
+        }
+        /// Certified enclosure in \p double.
+        /**
+         * @return a pair <tt>(lo,hi)</tt> of \p double values such that all the values in the ball
+         * belong to the interval <tt>[lo,hi]</tt>. The result is equivalent to
+         * <tt>(to_double(rounding_mode::downward),to_double(rounding_mode::upward))</tt>.
+         */
+        std::pair<double,double> to_double_interval() const
+        {
+            if (::mag_is_zero(arb_radref((&m_arb)))) {
+                return std::make_pair(::arf_get_d(arb_midref((&m_arb)),ARF_RND_FLOOR),
+                    ::arf_get_d(arb_midref((&m_arb)),ARF_RND_CEIL));
+            }
+            arf_raii tmp;
+            ::arb_get_lbound_arf(tmp,&m_arb,std::numeric_limits<double>::digits);
+            const double lo = ::arf_get_d(tmp,ARF_RND_FLOOR);
+            ::arb_get_ubound_arf(tmp,&m_arb,std::numeric_limits<double>::digits);
+            return std::make_pair(lo,::arf_get_d(tmp,ARF_RND_CEIL));
+        }
+        /// Identity operator.
+        /**
+         * @return a copy of \p this.
+         */
+        arb operator+() const
+        {
+            return *this;
+        }
+        /// In-place addition.
+        /**
+         * \note
+         * This operator is enabled only if \p T is an interoperable type
+         * or arbpp::arb.
+         * 
+         * This method will set \p this to <tt>this + x</tt>. In case \p T is arbpp::arb, then
+         * the operation is carried out with a precision corresponding to the maximum between
+         * the precisions of \p this and \p x. Otherwise, the operation is carried out with the
+         * precision of \p this.
+         * 
+         * @param[in] x addition argument.
+         * 
+         * @return reference to \p this.
+         */
+        template <typename T>
+        auto operator+=(const T &x) -> decltype(this->in_place_add(x))
+        {
+            ARBPP_INSTRUMENT_SCOPE(in_place_add,*this,*this,x);
+            watched_in_place(operation::in_place_add,[&x](arb &r) {r.in_place_add(x);});
+            return *this;
+        }
+        /// Generic binary addition involving arbpp::arb.
+        /**
+         * \note
+         * This template operator is enabled only if either:
+         * - \p T is arbpp::arb and \p U is an interoperable type,
+         * - \p U is arbpp::arb and \p T is an interoperable type,
+         * - both \p T and \p U are arbpp::arb.
+         * 
+         * This method will compute <tt>a + b</tt> and return it as an arbpp::arb. In case \p T and \p U are both
+         * arbpp::arb, then the operation is carried out with a precision corresponding to the maximum between
+         * the precisions of \p a and \p b. Otherwise, the result will have the precision of the
+         * arbpp::arb argument.
+         * 
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         * 
+         * @return <tt>a + b</tt>.
+         */
+        template <typename T, typename U>
+        friend auto operator+(const T &a, const U &b) -> decltype(arb::binary_add(a,b))
+        {
+            auto retval = binary_add(a,b);
+            ARBPP_INSTRUMENT(binary_add,retval,a,b);
+            ARBPP_WATCHDOG(binary_add,retval);
+            return retval;
+        }
+        /// Negation.
+        /**
+         * Negate in-place.
+         */
+        void negate()
+        {
+            ::arb_neg(&m_arb,&m_arb);
+        }
+        /// Negated copy.
+        /**
+         * @return a negated copy of \p this.
+         */
+        arb operator-() const
+        {
+            arb retval{*this};
+            retval.negate();
+            return retval;
+        }
+        /// In-place subtraction.
+        /**
+         * \note
+         * This operator is enabled only if \p T is an interoperable type
+         * or arbpp::arb.
+         * 
+         * This method will set \p this to <tt>this - x</tt>. In case \p T is arbpp::arb, then
+         * the operation is carried out with a precision corresponding to the maximum between
+         * the precisions of \p this and \p x. Otherwise, the operation is carried out with the
+         * precision of \p this.
+         * 
+         * @param[in] x subtraction argument.
+         * 
+         * @return reference to \p this.
+         */
+        template <typename T>
+        auto operator-=(const T &x) -> decltype(this->in_place_sub(x))
+        {
+            ARBPP_INSTRUMENT_SCOPE(in_place_sub,*this,*this,x);
+            watched_in_place(operation::in_place_sub,[&x](arb &r) {r.in_place_sub(x);});
+            return *this;
+        }
+        /// Generic binary subtraction involving arbpp::arb.
+        /**
+         * \note
+         * This template operator is enabled only if either:
+         * - \p T is arbpp::arb and \p U is an interoperable type,
+         * - \p U is arbpp::arb and \p T is an interoperable type,
+         * - both \p T and \p U are arbpp::arb.
+         * 
+         * This method will compute <tt>a - b</tt> and return it as an arbpp::arb. In case \p T and \p U are both
+         * arbpp::arb, then the operation is carried out with a precision corresponding to the maximum between
+         * the precisions of \p a and \p b. Otherwise, the result will have the precision of the
+         * arbpp::arb argument.
+         * 
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         * 
+         * @return <tt>a - b</tt>.
+         */
+        template <typename T, typename U>
+        friend auto operator-(const T &a, const U &b) -> decltype(arb::binary_sub(a,b))
+        {
+            auto retval = binary_sub(a,b);
+            ARBPP_INSTRUMENT(binary_sub,retval,a,b);
+            ARBPP_WATCHDOG(binary_sub,retval);
+            return retval;
+        }
+        /// In-place multiplication.
+        /**
+         * \note
+         * This operator is enabled only if \p T is an interoperable type
+         * or arbpp::arb.
+         * 
+         * This method will set \p this to <tt>this * x</tt>. In case \p T is arbpp::arb, then
+         * the operation is carried out with a precision corresponding to the maximum between
+         * the precisions of \p this and \p x. Otherwise, the operation is carried out with the
+         * precision of \p this.
+         * 
+         * @param[in] x multiplication argument.
+         * 
+         * @return reference to \p this.
+         */
+        template <typename T>
+        auto operator*=(const T &x) -> decltype(this->in_place_mul(x))
+        {
+            ARBPP_INSTRUMENT_SCOPE(in_place_mul,*this,*this,x);
+            watched_in_place(operation::in_place_mul,[&x](arb &r) {r.in_place_mul(x);});
+            return *this;
+        }
+        /// Generic binary multiplication involving arbpp::arb.
+        /**
+         * \note
+         * This template operator is enabled only if either:
+         * - \p T is arbpp::arb and \p U is an interoperable type,
+         * - \p U is arbpp::arb and \p T is an interoperable type,
+         * - both \p T and \p U are arbpp::arb.
+         * 
+         * This method will compute <tt>a * b</tt> and return it as an arbpp::arb. In case \p T and \p U are both
+         * arbpp::arb, then the operation is carried out with a precision corresponding to the maximum between
+         * the precisions of \p a and \p b. Otherwise, the result will have the precision of the
+         * arbpp::arb argument.
+         * 
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         * 
+         * @return <tt>a * b</tt>.
+         */
+        template <typename T, typename U>
+        friend auto operator*(const T &a, const U &b) -> decltype(arb::binary_mul(a,b))
+        {
+            auto retval = binary_mul(a,b);
+            ARBPP_INSTRUMENT(binary_mul,retval,a,b);
+            ARBPP_WATCHDOG(binary_mul,retval);
+            return retval;
+        }
+        /// In-place division.
+        /**
+         * \note
+         * This operator is enabled only if \p T is an interoperable type
+         * or arbpp::arb.
+         * 
+         * This method will set \p this to <tt>this / x</tt>. In case \p T is arbpp::arb, then
+         * the operation is carried out with a precision corresponding to the maximum between
+         * the precisions of \p this and \p x. Otherwise, the operation is carried out with the
+         * precision of \p this.
+         * 
+         * @param[in] x division argument.
+         * 
+         * @return reference to \p this.
+         */
+        template <typename T>
+        auto operator/=(const T &x) -> decltype(this->in_place_div(x))
+        {
+            ARBPP_INSTRUMENT_SCOPE(in_place_div,*this,*this,x);
+            watched_in_place(operation::in_place_div,[&x](arb &r) {r.in_place_div(x);});
+            return *this;
+        }
+        /// Generic binary division involving arbpp::arb.
+        /**
+         * \note
+         * This template operator is enabled only if either:
+         * - \p T is arbpp::arb and \p U is an interoperable type,
+         * - \p U is arbpp::arb and \p T is an interoperable type,
+         * - both \p T and \p U are arbpp::arb.
+         * 
+         * This method will compute <tt>a / b</tt> and return it as an arbpp::arb. In case \p T and \p U are both
+         * arbpp::arb, then the operation is carried out with a precision corresponding to the maximum between
+         * the precisions of \p a and \p b. Otherwise, the result will have the precision of the
+         * arbpp::arb argument.
+         * 
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         * 
+         * @return <tt>a / b</tt>.
+         */
+        template <typename T, typename U>
+        friend auto operator/(const T &a, const U &b) -> decltype(arb::binary_div(a,b))
+        {
+            auto retval = binary_div(a,b);
+            ARBPP_INSTRUMENT(binary_div,retval,a,b);
+            ARBPP_WATCHDOG(binary_div,retval);
+            return retval;
+        }
+        /// Less-than operator.
+        /**
+         * The comparison is certified: the result is \p true if every point of \p a is less than
+         * every point of \p b (see \p arb_lt()), \p false if no point of \p a is less than any point of \p b,
+         * indeterminate otherwise.
+         * 
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         * 
+         * @return the result of the comparison.
+         */
+        friend tribool operator<(const arb &a, const arb &b)
+        {
+            return make_tribool(::arb_lt(&a.m_arb,&b.m_arb),::arb_ge(&a.m_arb,&b.m_arb));
+        }
+        /// Less-than or equal operator.
+        /**
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         * 
+         * @return the result of the comparison (see operator<()).
+         */
+        friend tribool operator<=(const arb &a, const arb &b)
+        {
+            return make_tribool(::arb_le(&a.m_arb,&b.m_arb),::arb_gt(&a.m_arb,&b.m_arb));
+        }
+        /// Greater-than operator.
+        /**
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         * 
+         * @return the result of the comparison (see operator<()).
+         */
+        friend tribool operator>(const arb &a, const arb &b)
+        {
+            return make_tribool(::arb_gt(&a.m_arb,&b.m_arb),::arb_le(&a.m_arb,&b.m_arb));
+        }
+        /// Greater-than or equal operator.
+        /**
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         * 
+         * @return the result of the comparison (see operator<()).
+         */
+        friend tribool operator>=(const arb &a, const arb &b)
+        {
+            return make_tribool(::arb_ge(&a.m_arb,&b.m_arb),::arb_lt(&a.m_arb,&b.m_arb));
+        }
+        /// Equality operator.
+        /**
+         * The result is \p true if \p a and \p b are both exact and their midpoints coincide (see \p arb_eq()),
+         * \p false if the two balls do not overlap, indeterminate otherwise.
+         * 
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         * 
+         * @return the result of the comparison.
+         */
+        friend tribool operator==(const arb &a, const arb &b)
+        {
+            return make_tribool(::arb_eq(&a.m_arb,&b.m_arb),!::arb_overlaps(&a.m_arb,&b.m_arb));
+        }
+        /// Inequality operator.
+        /**
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         * 
+         * @return the negation of <tt>a == b</tt>.
+         */
+        friend tribool operator!=(const arb &a, const arb &b)
+        {
+            return !(a == b);
+        }
+        /// Fused multiply-add.
+        /**
+         * This method will set \p this to <tt>this + x * y</tt> via \p arb_addmul(), rounding only once and
+         * without creating temporaries. The operation is carried out with a precision corresponding to the
+         * maximum between the precisions of \p this, \p x and \p y.
+         * 
+         * @param[in] x first factor.
+         * @param[in] y second factor.
+         * 
+         * @return reference to \p this.
+         */
+        arb &addmul(const arb &x, const arb &y)
+        {
+            ARBPP_INSTRUMENT_SCOPE(addmul,*this,*this,x,y);
+            watched_in_place(operation::addmul,[&x,&y](arb &r) {
+                r.m_prec = std::max(r.m_prec,std::max(x.m_prec,y.m_prec));
+                ::arb_addmul(&r.m_arb,&x.m_arb,&y.m_arb,r.m_prec);
+            });
+            return *this;
+        }
+        /// Fused multiply-add with a rational coefficient.
+        /**
+         * \note
+         * This method is enabled only if \p T is \p fmpq_t or arbpp::rational.
+         *
+         * This method will set \p this to <tt>this + x * q</tt>. The product and the sum are computed on the
+         * numerator and the denominator of \p q with extra bits of precision (as many as the bits of the
+         * denominator, plus a few guard bits), and the result is rounded to the target precision once.
+         * The operation is carried out with a precision corresponding to the maximum between
+         * the precisions of \p this and \p x.
+         *
+         * @param[in] x ball factor.
+         * @param[in] q rational factor.
+         *
+         * @return reference to \p this.
+         */
+        template <typename T, typename std::enable_if<is_arb_fmpq<T>::value,int>::type = 0>
+        arb &addmul(const arb &x, const T &q)
+        {
+            ARBPP_INSTRUMENT_SCOPE(addmul,*this,*this,x,q);
+            const ::fmpq *f = get_fmpq(q);
+            watched_in_place(operation::addmul,[&x,f](arb &r) {
+                if (x.m_prec > r.m_prec) {
+                    r.m_prec = x.m_prec;
+                }
+                if (::fmpz_is_one(fmpq_denref(f))) {
+                    ::arb_addmul_fmpz(&r.m_arb,&x.m_arb,fmpq_numref(f),r.m_prec);
+                    return;
+                }
+                // (this * den + x * num) / den.
+                const long wp = fmpq_prec(f,r.m_prec);
+                ::arb_mul_fmpz(&r.m_arb,&r.m_arb,fmpq_denref(f),wp);
+                ::arb_addmul_fmpz(&r.m_arb,&x.m_arb,fmpq_numref(f),wp);
+                ::arb_div_fmpz(&r.m_arb,&r.m_arb,fmpq_denref(f),r.m_prec);
+            });
+            return *this;
+        }
+        /// Horner step with a rational coefficient.
+        /**
+         * \note
+         * This method is enabled only if \p T is \p fmpq_t or arbpp::rational.
+         *
+         * This method will set \p this to <tt>this * x + q</tt>, with extra bits of precision in the intermediate
+         * steps and a single rounding to the target precision. It is meant to be used as the step of a Horner
+         * scheme with exact rational coefficients:
+         * @code
+         * arb acc{c[n]};
+         * for (auto i = n; i > 0; --i) {
+         *     acc.mul_add(x,c[i - 1]);
+         * }
+         * @endcode
+         * The operation is carried out with a precision corresponding to the maximum between
+         * the precisions of \p this and \p x.
+         *
+         * @param[in] x ball factor.
+         * @param[in] q rational addend.
+         *
+         * @return reference to \p this.
+         */
+        template <typename T, typename std::enable_if<is_arb_fmpq<T>::value,int>::type = 0>
+        arb &mul_add(const arb &x, const T &q)
+        {
+            ARBPP_INSTRUMENT_SCOPE(addmul,*this,*this,x,q);
+            const ::fmpq *f = get_fmpq(q);
+            watched_in_place(operation::addmul,[&x,f](arb &r) {
+                if (x.m_prec > r.m_prec) {
+                    r.m_prec = x.m_prec;
+                }
+                // The product carries the guard bits, the final rounding happens in add_fmpq().
+                ::arb_mul(&r.m_arb,&r.m_arb,&x.m_arb,fmpq_prec(f,r.m_prec));
+                add_fmpq(&r.m_arb,&r.m_arb,f,r.m_prec);
+            });
+            return *this;
+        }
+        /// Cosine.
+        /**
+         * @return the cosine of \p this.
+         */
+        arb cos() const
+        {
+            ARBPP_TRACE_SPAN_IF(m_prec >= tracing::long_evaluation_prec,"arbpp::arb::cos");
+            arb retval;
+            ::arb_cos(&retval.m_arb,&m_arb,m_prec);
+            retval.m_prec = m_prec;
+            ARBPP_INSTRUMENT(cos,retval,*this);
+            ARBPP_WATCHDOG(cos,retval);
+            return retval;
+        }
+        /// Square root.
+        /**
+         * If \p this contains negative numbers, the result will be an indeterminate ball.
+         * 
+         * @return the square root of \p this.
+         */
+        arb sqrt() const
+        {
+            ARBPP_TRACE_SPAN_IF(m_prec >= tracing::long_evaluation_prec,"arbpp::arb::sqrt");
+            arb retval;
+            ::arb_sqrt(&retval.m_arb,&m_arb,m_prec);
+            retval.m_prec = m_prec;
+            ARBPP_INSTRUMENT(sqrt,retval,*this);
+            ARBPP_WATCHDOG(sqrt,retval);
+            return retval;
+        }
+        /// Absolute value.
+        /**
+         * @return the absolute value of \p this.
+         */
+        arb abs() const
+        {
+            arb retval;
+            ::arb_abs(&retval.m_arb,&m_arb);
+            retval.m_prec = m_prec;
+            ARBPP_INSTRUMENT(abs,retval,*this);
+            ARBPP_WATCHDOG(abs,retval);
+            return retval;
+        }
+    private:
+        // Apply the in-place operation f to this. When a watchdog is active, f is applied to a copy
+        // which replaces this only after the accuracy check, so that a throwing check (or callback)
+        // leaves this unchanged.
+        template <typename F>
+        void watched_in_place(operation op, const F &f)
+        {
+            if (detail::active_watchdog() == nullptr) {
+                f(*this);
+                return;
+            }
+            arb tmp{*this};
+            f(tmp);
+            detail::watchdog_check(op,tmp);
+            swap(tmp);
+        }
+        // Build the result of a comparison from the results of the Arb predicates
+        // for the certainly true and the certainly false cases.
+        static tribool make_tribool(int t, int f)
+        {
+            return t ? tribool{true} : (f ? tribool{false} : tribool::indeterminate());
+        }
+        ::arb_struct    m_arb;
+        long            m_prec;
+};
+
+/// Cosine.
+/**
+ * @param[in] a cosine argument.
+ * 
+ * @return <tt>a.cos()</tt>.
+ */
+inline arb cos(const arb &a)
+{
+    return a.cos();
+}
+
+/// Square root.
+/**
+ * @param[in] a square root argument.
+ * 
+ * @return <tt>a.sqrt()</tt>.
+ */
+inline arb sqrt(const arb &a)
+{
+    return a.sqrt();
+}
+
+/// Absolute value.
+/**
+ * @param[in] a absolute value argument.
+ * 
+ * @return <tt>a.abs()</tt>.
+ */
+inline arb abs(const arb &a)
+{
+    return a.abs();
+}
+
+/// Swap.
+/**
+ * Equivalent to <tt>a0.swap(a1)</tt>.
+ * 
+ * @param[in] a0 first argument.
+ * @param[in] a1 second argument.
+ */
+inline void swap(arb &a0, arb &a1) noexcept
+{
+    a0.swap(a1);
+}
+
+namespace detail
+{
+
+// Scalar operands of the mixed operations of the types built on top of arbpp::arb: arbpp::arb and the types
+// interoperable with it.
+template <typename T>
+struct is_arb_scalar
+{
+    static const bool value = std::is_same<T,arb>::value || (std::is_constructible<arb,const T &>::value &&
+        !std::is_convertible<const T &,std::string>::value);
+};
+
+template <typename T>
+using arb_scalar_enabler = typename std::enable_if<is_arb_scalar<T>::value,int>::type;
+
+// Conversion of the scalar operands to arbpp::arb, with precision prec for the interoperable types.
+inline const arb &scalar_to_arb(const arb &x, long)
+{
+    return x;
+}
+
+template <typename T>
+inline arb scalar_to_arb(const T &x, long prec)
+{
+    return arb{x,prec};
+}
+
+// Precision of a mixed operation between a scalar and an object with precision prec.
+inline long scalar_prec(const arb &x, long prec)
+{
+    return std::max(x.get_precision(),prec);
+}
+
+template <typename T>
+inline long scalar_prec(const T &, long prec)
+{
+    return prec;
+}
+
+// Mixed arithmetic operators, for a type Derived built on top of arbpp::arb (CRTP). Derived must define the
+// arithmetic operators and unary minus among its own objects, make this class a friend, and provide the
+// members:
+// - long m_prec, the precision;
+// - void add_scalar(const arb &x, long prec), void mul_scalar(const arb &x, long prec) and
+//   void div_scalar(const arb &x, long prec), which set this to this + x, this * x and this / x, and the
+//   precision to prec;
+// - Derived rdiv_scalar(const arb &x, long prec) const, which returns x / this with precision prec.
+template <typename Derived>
+class arb_scalar_ops
+{
+        static Derived add(const Derived &a, const arb &x, long prec)
+        {
+            Derived retval{a};
+            retval.add_scalar(x,prec);
+            return retval;
+        }
+        static Derived mul(const Derived &a, const arb &x, long prec)
+        {
+            Derived retval{a};
+            retval.mul_scalar(x,prec);
+            return retval;
+        }
+        static Derived div(const Derived &a, const arb &x, long prec)
+        {
+            Derived retval{a};
+            retval.div_scalar(x,prec);
+            return retval;
+        }
+        static Derived rdiv(const arb &x, const Derived &a, long prec)
+        {
+            return a.rdiv_scalar(x,prec);
+        }
+        static long prec(const Derived &a)
+        {
+            return a.m_prec;
+        }
+        template <typename T>
+        using compound_enabler = typename std::enable_if<is_arb_scalar<T>::value ||
+            std::is_same<T,Derived>::value,int>::type;
+    public:
+        /// Mixed addition.
+        /**
+         * \note
+         * This operator is enabled only if \p T is arbpp::arb or an interoperable type.
+         *
+         * @param[in] a first operand.
+         * @param[in] x second operand.
+         *
+         * @return <tt>a + x</tt>, with the maximum precision of the operands (the precision of \p a if \p T
+         * is not arbpp::arb).
+         */
+        template <typename T, arb_scalar_enabler<T> = 0>
+        friend Derived operator+(const Derived &a, const T &x)
+        {
+            return add(a,scalar_to_arb(x,prec(a)),scalar_prec(x,prec(a)));
+        }
+        /// Mixed addition.
+        /**
+         * \note
+         * This operator is enabled only if \p T is arbpp::arb or an interoperable type.
+         *
+         * @param[in] x first operand.
+         * @param[in] a second operand.
+         *
+         * @return <tt>x + a</tt>.
+         */
+        template <typename T, arb_scalar_enabler<T> = 0>
+        friend Derived operator+(const T &x, const Derived &a)
+        {
+            return a + x;
+        }
+        /// Mixed subtraction.
+        /**
+         * \note
+         * This operator is enabled only if \p T is arbpp::arb or an interoperable type.
+         *
+         * @param[in] a first operand.
+         * @param[in] x second operand.
+         *
+         * @return <tt>a - x</tt>.
+         */
+        template <typename T, arb_scalar_enabler<T> = 0>
+        friend Derived operator-(const Derived &a, const T &x)
+        {
+            return add(a,-scalar_to_arb(x,prec(a)),scalar_prec(x,prec(a)));
+        }
+        /// Mixed subtraction.
+        /**
+         * \note
+         * This operator is enabled only if \p T is arbpp::arb or an interoperable type.
+         *
+         * @param[in] x first operand.
+         * @param[in] a second operand.
+         *
+         * @return <tt>x - a</tt>.
+         */
+        template <typename T, arb_scalar_enabler<T> = 0>
+        friend Derived operator-(const T &x, const Derived &a)
+        {
+            return -a + x;
+        }
+        /// Mixed multiplication.
+        /**
+         * \note
+         * This operator is enabled only if \p T is arbpp::arb or an interoperable type.
+         *
+         * @param[in] a first operand.
+         * @param[in] x second operand.
+         *
+         * @return <tt>a * x</tt>.
+         */
+        template <typename T, arb_scalar_enabler<T> = 0>
+        friend Derived operator*(const Derived &a, const T &x)
+        {
+            return mul(a,scalar_to_arb(x,prec(a)),scalar_prec(x,prec(a)));
+        }
+        /// Mixed multiplication.
+        /**
+         * \note
+         * This operator is enabled only if \p T is arbpp::arb or an interoperable type.
+         *
+         * @param[in] x first operand.
+         * @param[in] a second operand.
+         *
+         * @return <tt>x * a</tt>.
+         */
+        template <typename T, arb_scalar_enabler<T> = 0>
+        friend Derived operator*(const T &x, const Derived &a)
+        {
+            return a * x;
+        }
+        /// Mixed division.
+        /**
+         * \note
+         * This operator is enabled only if \p T is arbpp::arb or an interoperable type.
+         *
+         * @param[in] a first operand.
+         * @param[in] x second operand.
+         *
+         * @return <tt>a / x</tt>.
+         */
+        template <typename T, arb_scalar_enabler<T> = 0>
+        friend Derived operator/(const Derived &a, const T &x)
+        {
+            return div(a,scalar_to_arb(x,prec(a)),scalar_prec(x,prec(a)));
+        }
+        /// Mixed division.
+        /**
+         * \note
+         * This operator is enabled only if \p T is arbpp::arb or an interoperable type.
+         *
+         * @param[in] x first operand.
+         * @param[in] a second operand.
+         *
+         * @return <tt>x / a</tt>.
+         */
+        template <typename T, arb_scalar_enabler<T> = 0>
+        friend Derived operator/(const T &x, const Derived &a)
+        {
+            return rdiv(scalar_to_arb(x,prec(a)),a,scalar_prec(x,prec(a)));
+        }
+        /// In-place addition.
+        /**
+         * \note
+         * This operator is enabled only if \p T is \p Derived, arbpp::arb or an interoperable type.
+         *
+         * @param[in] x argument.
+         *
+         * @return reference to \p this.
+         */
+        template <typename T, compound_enabler<T> = 0>
+        Derived &operator+=(const T &x)
+        {
+            auto &d = static_cast<Derived &>(*this);
+            return d = d + x;
+        }
+        /// In-place subtraction.
+        /**
+         * \note
+         * This operator is enabled only if \p T is \p Derived, arbpp::arb or an interoperable type.
+         *
+         * @param[in] x argument.
+         *
+         * @return reference to \p this.
+         */
+        template <typename T, compound_enabler<T> = 0>
+        Derived &operator-=(const T &x)
+        {
+            auto &d = static_cast<Derived &>(*this);
+            return d = d - x;
+        }
+        /// In-place multiplication.
+        /**
+         * \note
+         * This operator is enabled only if \p T is \p Derived, arbpp::arb or an interoperable type.
+         *
+         * @param[in] x argument.
+         *
+         * @return reference to \p this.
+         */
+        template <typename T, compound_enabler<T> = 0>
+        Derived &operator*=(const T &x)
+        {
+            auto &d = static_cast<Derived &>(*this);
+            return d = d * x;
+        }
+        /// In-place division.
+        /**
+         * \note
+         * This operator is enabled only if \p T is \p Derived, arbpp::arb or an interoperable type.
+         *
+         * @param[in] x argument.
+         *
+         * @return reference to \p this.
+         */
+        template <typename T, compound_enabler<T> = 0>
+        Derived &operator/=(const T &x)
+        {
+            auto &d = static_cast<Derived &>(*this);
+            return d = d / x;
+        }
+};
+
+}
+
+/// Bulk export of midpoints.
+/**
+ * \note
+ * \p It must be a random-access iterator to arbpp::arb.
+ *
+ * The midpoints of the values in the range <tt>[first,last)</tt> will be written into the array
+ * starting at \p out, rounded as in arbpp::arb::get_midpoint(). The work is split among \p n_threads
+ * threads.
+ *
+ * @param[in] first beginning of the range.
+ * @param[in] last end of the range.
+ * @param[out] out output array, which must have room for at least <tt>last - first</tt> values.
+ * @param[in] n_threads number of threads to be used.
+ *
+ * @throws std::invalid_argument if \p n_threads is zero.
+ * @throws unspecified any exception thrown by threading primitives.
+ */
+template <typename It>
+inline void get_midpoints(It first, It last, double *out, unsigned n_threads = 1u)
+{
+    ARBPP_TRACE_SPAN("arbpp::get_midpoints");
+    detail::parallel_for(static_cast<std::size_t>(last - first),n_threads,[first,out](std::size_t b, std::size_t e) {
+        for (; b != e; ++b) {
+            out[b] = ::arf_get_d(arb_midref(first[b].get_arb_t()),ARF_RND_DOWN);
+        }
+    });
+}
+
+/// Bulk export of radii.
+/**
+ * \note
+ * \p It must be a random-access iterator to arbpp::arb.
+ *
+ * The radii of the values in the range <tt>[first,last)</tt> will be written into the array
+ * starting at \p out, rounded upwards. The work is split among \p n_threads threads.
+ *
+ * @param[in] first beginning of the range.
+ * @param[in] last end of the range.
+ * @param[out] out output array, which must have room for at least <tt>last - first</tt> values.
+ * @param[in] n_threads number of threads to be used.
+ *
+ * @throws std::invalid_argument if \p n_threads is zero.
+ * @throws unspecified any exception thrown by threading primitives.
+ */
+template <typename It>
+inline void get_radii(It first, It last, double *out, unsigned n_threads = 1u)
+{
+    ARBPP_TRACE_SPAN("arbpp::get_radii");
+    detail::parallel_for(static_cast<std::size_t>(last - first),n_threads,[first,out](std::size_t b, std::size_t e) {
+        // NOTE: a mag always fits in the inline storage of an arf, so the scratch
+        // value never allocates.
+        detail::arf_raii tmp;
+        for (; b != e; ++b) {
+            ::arf_set_mag(tmp,arb_radref(first[b].get_arb_t()));
+            out[b] = ::arf_get_d(tmp,ARF_RND_UP);
+        }
+    });
+}
+
+/// Bulk certified conversion to \p double.
+/**
+ * \note
+ * \p It must be a random-access iterator to arbpp::arb.
+ *
+ * The values in the range <tt>[first,last)</tt> will be converted with arbpp::arb::to_double() using the rounding
+ * mode \p rnd, and written into the array starting at \p out. The work is split among \p n_threads threads.
+ *
+ * @param[in] first beginning of the range.
+ * @param[in] last end of the range.
+ * @param[out] out output array, which must have room for at least <tt>last - first</tt> values.
+ * @param[in] rnd rounding mode.
+ * @param[in] n_threads number of threads to be used.
+ *
+ * @throws std::invalid_argument if \p n_threads is zero.
+ * @throws unspecified any exception thrown by threading primitives.
+ */
+template <typename It>
+inline void to_double(It first, It last, double *out, rounding_mode rnd = rounding_mode::nearest,
+    unsigned n_threads = 1u)
+{
+    ARBPP_TRACE_SPAN("arbpp::to_double");
+    detail::parallel_for(static_cast<std::size_t>(last - first),n_threads,[first,out,rnd](std::size_t b, std::size_t e) {
+        for (; b != e; ++b) {
+            out[b] = first[b].to_double(rnd);
+        }
+    });
+}
+
+/// Bulk certified enclosure in \p double.
+/**
+ * \note
+ * \p It must be a random-access iterator to arbpp::arb.
+ *
+ * The enclosures computed by arbpp::arb::to_double_interval() for the values in the range <tt>[first,last)</tt>
+ * will be written into the arrays starting at \p lo and \p hi. The work is split among \p n_threads threads.
+ *
+ * @param[in] first beginning of the range.
+ * @param[in] last end of the range.
+ * @param[out] lo output array for the lower bounds, which must have room for at least <tt>last - first</tt> values.
+ * @param[out] hi output array for the upper bounds, which must have room for at least <tt>last - first</tt> values.
+ * @param[in] n_threads number of threads to be used.
+ *
+ * @throws std::invalid_argument if \p n_threads is zero.
+ * @throws unspecified any exception thrown by threading primitives.
+ */
+template <typename It>
+inline void to_double_interval(It first, It last, double *lo, double *hi, unsigned n_threads = 1u)
+{
+    ARBPP_TRACE_SPAN("arbpp::to_double_interval");
+    detail::parallel_for(static_cast<std::size_t>(last - first),n_threads,[first,lo,hi](std::size_t b, std::size_t e) {
+        for (; b != e; ++b) {
+            const auto p = first[b].to_double_interval();
+            lo[b] = p.first;
+            hi[b] = p.second;
+        }
+    });
+}
+
+/// Bulk export of lower bounds.
+/**
+ * Equivalent to arbpp::to_double() with arbpp::rounding_mode::downward.
+ *
+ * @param[in] first beginning of the range.
+ * @param[in] last end of the range.
+ * @param[out] out output array, which must have room for at least <tt>last - first</tt> values.
+ * @param[in] n_threads number of threads to be used.
+ *
+ * @throws unspecified any exception thrown by arbpp::to_double().
+ */
+template <typename It>
+inline void get_lower_bounds(It first, It last, double *out, unsigned n_threads = 1u)
+{
+    arbpp::to_double(first,last,out,rounding_mode::downward,n_threads);
+}
+
+/// Bulk export of upper bounds.
+/**
+ * Equivalent to arbpp::to_double() with arbpp::rounding_mode::upward.
+ *
+ * @param[in] first beginning of the range.
+ * @param[in] last end of the range.
+ * @param[out] out output array, which must have room for at least <tt>last - first</tt> values.
+ * @param[in] n_threads number of threads to be used.
+ *
+ * @throws unspecified any exception thrown by arbpp::to_double().
+ */
+template <typename It>
+inline void get_upper_bounds(It first, It last, double *out, unsigned n_threads = 1u)
+{
+    arbpp::to_double(first,last,out,rounding_mode::upward,n_threads);
+}
+
+/// Bulk import from \p double.
+/**
+ * \note
+ * \p It must be a random-access iterator to arbpp::arb.
+ *
+ * Each value in the range <tt>[first,last)</tt> will be set to the corresponding element of the array starting at
+ * \p in, with precision \p prec. The result is the same as assigning from an arbpp::arb constructed
+ * from the element and \p prec. The work is split among \p n_threads threads.
+ *
+ * @param[in] first beginning of the range.
+ * @param[in] last end of the range.
+ * @param[in] in input array, containing at least <tt>last - first</tt> values.
+ * @param[in] prec desired precision.
+ * @param[in] n_threads number of threads to be used.
+ *
+ * @throws std::invalid_argument if \p n_threads is zero or \p prec is invalid.
+ * @throws unspecified any exception thrown by threading primitives.
+ */
+template <typename It>
+inline void set_values(It first, It last, const double *in, long prec = arb::get_default_precision(),
+    unsigned n_threads = 1u)
+{
+    ARBPP_TRACE_SPAN("arbpp::set_values");
+    // Check the precision before touching the output.
+    arb{}.set_precision(prec);
+    detail::parallel_for(static_cast<std::size_t>(last - first),n_threads,[first,in,prec](std::size_t b, std::size_t e) {
+        for (; b != e; ++b) {
+            ::arb_set_d(first[b].get_arb_t(),in[b]);
+            first[b].set_precision(prec);
+        }
+    });
+}
+
+/// Bulk import from \p mpfr_t.
+/**
+ * \note
+ * \p It must be a random-access iterator to arbpp::arb.
+ *
+ * Each value in the range <tt>[first,last)</tt> will be set exactly to the corresponding element of the array
+ * starting at \p in, and then rounded to the precision \p prec. The work is split among \p n_threads threads.
+ *
+ * @param[in] first beginning of the range.
+ * @param[in] last end of the range.
+ * @param[in] in input array, containing at least <tt>last - first</tt> values.
+ * @param[in] prec desired precision.
+ * @param[in] n_threads number of threads to be used.
+ *
+ * @throws std::invalid_argument if \p n_threads is zero or \p prec is invalid.
+ * @throws unspecified any exception thrown by threading primitives.
+ */
+template <typename It>
+inline void set_values(It first, It last, const ::mpfr_t *in, long prec = arb::get_default_precision(),
+    unsigned n_threads = 1u)
+{
+    ARBPP_TRACE_SPAN("arbpp::set_values");
+    arb{}.set_precision(prec);
+    detail::parallel_for(static_cast<std::size_t>(last - first),n_threads,[first,in,prec](std::size_t b, std::size_t e) {
+        for (; b != e; ++b) {
+            ::arf_set_mpfr(arb_midref(first[b].get_arb_t()),in[b]);
+            ::mag_zero(arb_radref(first[b].get_arb_t()));
+            first[b].set_precision(prec);
+        }
+    });
+}
+
+/// Midpoint comparator.
+/**
+ * Function object that compares two arbpp::arb by their midpoints, exactly (via \p arf_cmp()) and
+ * without any conversion to floating-point. The radii are ignored. Balls with a NaN midpoint
+ * compare greater than all the other balls, and equivalent among themselves, so that this comparator
+ * is a strict weak ordering suitable for the algorithms of the standard library.
+ */
+struct less_by_midpoint
+{
+    /// Call operator.
+    /**
+     * @param[in] a first argument.
+     * @param[in] b second argument.
+     *
+     * @return \p true if the midpoint of \p a is less than the midpoint of \p b, \p false otherwise.
+     */
+    bool operator()(const arb &a, const arb &b) const
+    {
+        const ::arf_struct *ma = arb_midref(a.get_arb_t()), *mb = arb_midref(b.get_arb_t());
+        if (::arf_is_nan(ma)) {
+            return false;
+        }
+        if (::arf_is_nan(mb)) {
+            return true;
+        }
+        return ::arf_cmp(ma,mb) < 0;
+    }
+};
+
+namespace detail
+{
+
+// Sort key for arbpp::sort(): a lower bound of the midpoint rounded to double, and the index
+// of the element in the original range.
+struct arb_sort_key
+{
+    double      approx;
+    std::size_t idx;
+};
+
+}
+
+/// Sort a range of arbpp::arb by midpoint.
+/**
+ * \note
+ * \p It must be a random-access iterator to arbpp::arb.
+ *
+ * The range <tt>[first,last)</tt> will be sorted according to arbpp::less_by_midpoint. The sort is stable.
+ *
+ * The midpoints are rounded downwards to \p double once per element, and the keys are sorted instead of the
+ * balls themselves: since the rounding is monotonic, the exact comparison of the midpoints is needed only
+ * when two keys coincide. The keys are sorted in \p n_threads blocks in parallel, and the blocks are then merged.
+ * Finally, the elements of the range are permuted via swaps, without any copy.
+ *
+ * @param[in] first beginning of the range.
+ * @param[in] last end of the range.
+ * @param[in] n_threads number of threads to be used.
+ *
+ * @throws std::invalid_argument if \p n_threads is zero.
+ * @throws unspecified any exception thrown by memory allocation errors or by threading primitives.
+ * If an exception is thrown, the range is left unchanged.
+ */
+template <typename It>
+inline void sort(It first, It last, unsigned n_threads = 1u)
+{
+    ARBPP_TRACE_SPAN("arbpp::sort");
+    if (n_threads == 0u) {
+        throw std::invalid_argument("the number of threads must be positive");
+    }
+    const auto n = static_cast<std::size_t>(last - first);
+    if (n < 2u) {
+        return;
+    }
+    std::vector<detail::arb_sort_key> keys(n);
+    detail::parallel_for(n,n_threads,[first,&keys](std::size_t b, std::size_t e) {
+        for (; b != e; ++b) {
+            keys[b].approx = ::arf_get_d(arb_midref(first[b].get_arb_t()),ARF_RND_FLOOR);
+            keys[b].idx = b;
+        }
+    });
+    auto comp = [first](const detail::arb_sort_key &a, const detail::arb_sort_key &b) -> bool {
+        // NOTE: NaN keys always fall through to the exact comparison.
+        if (a.approx < b.approx) {
+            return true;
+        }
+        if (b.approx < a.approx) {
+            return false;
+        }
+        const less_by_midpoint exact;
+        if (exact(first[a.idx],first[b.idx])) {
+            return true;
+        }
+        if (exact(first[b.idx],first[a.idx])) {
+            return false;
+        }
+        return a.idx < b.idx;
+    };
+    // Sort the blocks.
+    const std::size_t n_blocks = std::min<std::size_t>(n_threads,n);
+    std::vector<std::size_t> bounds(n_blocks + 1u);
+    for (std::size_t i = 0u; i <= n_blocks; ++i) {
+        bounds[i] = (n / n_blocks) * i + std::min(i,n % n_blocks);
+    }
+    detail::parallel_for(n_blocks,static_cast<unsigned>(n_blocks),[&keys,&bounds,&comp](std::size_t b, std::size_t e) {
+        for (; b != e; ++b) {
+            std::sort(keys.begin() + bounds[b],keys.begin() + bounds[b + 1u],comp);
+        }
+    });
+    // Merge pairs of adjacent sorted runs, doubling the run length at each step.
+    for (std::size_t width = 1u; width < n_blocks; width *= 2u) {
+        const std::size_t n_merges = (n_blocks + 2u * width - 1u) / (2u * width);
+        detail::parallel_for(n_merges,n_threads,[&keys,&bounds,&comp,width,n_blocks](std::size_t b, std::size_t e) {
+            for (; b != e; ++b) {
+                const std::size_t lo = 2u * width * b, mid = std::min(lo + width,n_blocks),
+                    hi = std::min(lo + 2u * width,n_blocks);
+                if (mid < hi) {
+                    std::inplace_merge(keys.begin() + bounds[lo],keys.begin() + bounds[mid],
+                        keys.begin() + bounds[hi],comp);
+                }
+            }
+        });
+    }
+    // Apply the permutation. Nothing throws after the allocation of tmp.
+    std::vector<arb> tmp(n);
+    for (std::size_t i = 0u; i < n; ++i) {
+        tmp[i].swap(first[keys[i].idx]);
+    }
+    for (std::size_t i = 0u; i < n; ++i) {
+        first[i].swap(tmp[i]);
+    }
+}
+
+/// Summation methods.
+/**
+ * See arbpp::sum().
+ */
+enum class summation_method
+{
+    /// Left-to-right accumulation, equivalent to a loop over <tt>operator+=()</tt>.
+    serial,
+    /// Recursive halving of the range: each summand goes through a logarithmic number of roundings.
+    pairwise,
+    /// Serial sums over blocks of about <tt>sqrt(n)</tt> elements, followed by the serial sum of the partial sums.
+    blocked,
+    /// Exact accumulation of the midpoints and of the radii via \p arb_dot(), with a single final rounding.
+    exact
+};
+
+namespace detail
+{
+
+// Serial accumulation of [first,last) into retval at precision prec.
+template <typename It>
+inline void serial_sum(arb &retval, It first, It last, long prec)
+{
+    for (; first != last; ++first) {
+        ::arb_add(retval.get_arb_t(),retval.get_arb_t(),(*first).get_arb_t(),prec);
+    }
+}
+
+// Pairwise summation of [first,last) into retval (which must be zero on entry).
+template <typename It>
+inline void pairwise_sum(arb &retval, It first, It last, long prec)
+{
+    const auto n = last - first;
+    // NOTE: below this size the recursion overhead is not worth it, and the number of roundings
+    // per summand stays bounded anyway.
+    if (n <= 8) {
+        serial_sum(retval,first,last,prec);
+        return;
+    }
+    arb tmp;
+    pairwise_sum(retval,first,first + n / 2,prec);
+    pairwise_sum(tmp,first + n / 2,last,prec);
+    ::arb_add(retval.get_arb_t(),retval.get_arb_t(),tmp.get_arb_t(),prec);
+}
+
+}
+
+/// Summation.
+/**
+ * \note
+ * \p It must be a random-access iterator to arbpp::arb.
+ *
+ * This function will compute the sum of the values in the range <tt>[first,last)</tt> with the working precision
+ * \p prec, using the summation method \p method (see arbpp::summation_method). The precision of the result will
+ * be \p prec.
+ *
+ * With the serial method, the rounding errors accumulated in the radius of the result grow linearly with the number
+ * of summands. The pairwise and blocked methods reduce this growth to, respectively, logarithmic and square root,
+ * at no extra cost. The exact method, based on \p arb_dot(), rounds only once and it is usually also the fastest
+ * for large ranges at moderate precision, but it needs a temporary array of <tt>last - first</tt> elements.
+ * With the last three methods a lower working precision is often enough to obtain the same final accuracy as
+ * a serial sum: the accuracy actually achieved can be checked on the result via arbpp::arb::get_rel_accuracy_bits().
+ *
+ * @param[in] first beginning of the range.
+ * @param[in] last end of the range.
+ * @param[in] prec working precision.
+ * @param[in] method summation method.
+ *
+ * @return the sum of the values in the range.
+ *
+ * @throws std::invalid_argument if \p prec is invalid.
+ * @throws unspecified any exception thrown by memory allocation errors.
+ */
+template <typename It>
+inline arb sum(It first, It last, long prec, summation_method method = summation_method::pairwise)
+{
+    ARBPP_TRACE_SPAN("arbpp::sum");
+    arb retval;
+    retval.set_precision(prec);
+    switch (method) {
+        case summation_method::serial:
+            detail::serial_sum(retval,first,last,prec);
+            break;
+        case summation_method::pairwise:
+            detail::pairwise_sum(retval,first,last,prec);
+            break;
+        case summation_method::blocked:
+        {
+            const auto n = last - first;
+            const auto block_size = std::max(decltype(n)(1),static_cast<decltype(n)>(std::sqrt(static_cast<double>(n))));
+            arb partial;
+            for (auto i = decltype(n)(0); i < n; i += block_size) {
+                ::arb_zero(partial.get_arb_t());
+                detail::serial_sum(partial,first + i,first + std::min(i + block_size,n),prec);
+                ::arb_add(retval.get_arb_t(),retval.get_arb_t(),partial.get_arb_t(),prec);
+            }
+            break;
+        }
+        case summation_method::exact:
+        {
+            const auto n = static_cast<std::size_t>(last - first);
+            // NOTE: arb_dot() needs a strided array of arb_struct, which a range of arbpp::arb is not.
+            // The structs are copied shallowly: arb_dot() only reads them, and the copies are never cleared,
+            // so the limbs stay owned by the original objects.
+            std::vector<::arb_struct> tmp(n);
+            for (std::size_t i = 0u; i < n; ++i) {
+                tmp[i] = *first[i].get_arb_t();
+            }
+            const arb one{1};
+            ::arb_dot(retval.get_arb_t(),nullptr,0,tmp.data(),1,one.get_arb_t(),0,static_cast<long>(n),prec);
+            break;
+        }
+    }
+    return retval;
+}
+
+/// Summation at the maximum precision of the summands.
+/**
+ * \note
+ * \p It must be a random-access iterator to arbpp::arb.
+ *
+ * Equivalent to arbpp::sum() with a working precision equal to the maximum precision of the values in the
+ * range <tt>[first,last)</tt> (or the default precision, if the range is empty). This mirrors the behaviour of the
+ * binary arithmetic operators.
+ *
+ * @param[in] first beginning of the range.
+ * @param[in] last end of the range.
+ * @param[in] method summation method.
+ *
+ * @return the sum of the values in the range.
+ *
+ * @throws unspecified any exception thrown by memory allocation errors.
+ */
+template <typename It>
+inline arb sum(It first, It last, summation_method method = summation_method::pairwise)
+{
+    long prec = 0;
+    for (auto it = first; it != last; ++it) {
+        prec = std::max(prec,(*it).get_precision());
+    }
+    return sum(first,last,prec == 0 ? arb::get_default_precision() : prec,method);
+}
+
+/// Progressive decimal output.
+/**
+ * \note
+ * \p F must be callable with a \p long argument (the working precision), returning an arbpp::arb.
+ *
+ * Writes to \p os the first \p n_digits significant decimal digits of a number, in the format
+ * <tt>[-]d.ddd...e[-]k</tt> (the exponent is omitted if zero). The number is defined by \p f, which must return
+ * an enclosure of it computed at the requested precision. \p f is called with precisions starting from 64 bits and
+ * doubling at each step: after each call, the leading digits certified by the returned ball which have not been
+ * written yet are written to \p os, and \p os is flushed. Thus the first digits are available after the
+ * cheap low-precision evaluations, while the final evaluations refine only the tail.
+ *
+ * The digits are those of the decimal expansion of the number truncated to \p n_digits digits (i.e., they are
+ * not rounded). The conversion of the binary results to decimal uses a divide-and-conquer algorithm, whose cost is
+ * subquadratic in the number of digits.
+ *
+ * If a ball of precision \p max_prec still does not certify all the requested digits (e.g., because the number
+ * is zero, but \p f does not return an exact zero, or because the number has a finite decimal expansion which is
+ * not exactly representable in binary), the digits certified so far are written, followed by the exponent,
+ * and the function returns. As long as the balls contain a power of ten, not even the leading digit (nor the
+ * exponent) is certified: if the number is a power of ten and \p f never returns it exactly, nothing is written
+ * and the function returns zero. If \p f returns an exact zero, <tt>"0"</tt> is written.
+ *
+ * @param[in,out] os target stream.
+ * @param[in] f function returning an enclosure of the number at a given precision.
+ * @param[in] n_digits number of significant digits.
+ * @param[in] max_prec maximum precision (if zero, four times the precision needed to represent \p n_digits
+ * decimal digits, plus 256).
+ *
+ * @return the number of digits written (\p n_digits if \p f returned an exact zero).
+ *
+ * @throws std::invalid_argument if \p n_digits is zero or \p max_prec is negative.
+ * @throws std::overflow_error if the exponent of the number is too large to be converted.
+ * @throws unspecified any exception thrown by \p f, or by memory allocation errors.
+ */
+template <typename F>
+inline std::size_t stream_digits(std::ostream &os, const F &f, std::size_t n_digits, long max_prec = 0)
+{
+    if (n_digits == 0u || max_prec < 0) {
+        throw std::invalid_argument("invalid number of digits or maximum precision");
+    }
+    if (max_prec == 0) {
+        // NOTE: log2(10) ~ 3.3219.
+        max_prec = static_cast<long>(static_cast<double>(n_digits) * 3.3219280948873623 * 4.) + 256;
+    }
+    std::size_t n_written = 0u;
+    long k = 0;
+    for (long prec = std::min(64l,max_prec);; prec = std::min(prec * 2,max_prec)) {
+        const arb x = f(prec);
+        if (::arb_is_zero(x.get_arb_t())) {
+            os << '0' << std::flush;
+            return n_digits;
+        }
+        const long acc = x.get_rel_accuracy_bits();
+        if (::arb_is_finite(x.get_arb_t()) && !::arb_contains_zero(x.get_arb_t()) && acc > 0) {
+            // Endpoints of the ball, in absolute value: a <= |x| <= b.
+            detail::arf_raii a, b;
+            const bool negative = ::arf_sgn(arb_midref(x.get_arb_t())) < 0;
+            ::arb_get_lbound_arf(negative ? b : a,x.get_arb_t(),x.get_precision());
+            ::arb_get_ubound_arf(negative ? a : b,x.get_arb_t(),x.get_precision());
+            // Number of digits which may be certified: log10(2) ~ 0.30103.
+            const std::size_t nd = std::min(n_digits,static_cast<std::size_t>(static_cast<double>(acc) * 0.30103) + 2u);
+            detail::fmpz_raii na, nb;
+            const long ka = detail::arf_get_decimal(na,a,nd,false), kb = detail::arf_get_decimal(nb,b,nd,false);
+            // NOTE: if the ball straddles a power of ten (ka != kb), not even the leading digit is certified:
+            // refine until the exponents agree.
+            if (ka == kb) {
+                assert(n_written == 0u || ka == k);
+                // The certified digits are the common leading digits of the truncated endpoints: convert both
+                // endpoints and compare the strings.
+                std::string da(nd,'0'), db(nd,'0');
+                detail::fmpz_write_digits(&da[0],na,nd,detail::radix_threads());
+                detail::fmpz_write_digits(&db[0],nb,nd,detail::radix_threads());
+                const std::size_t c = static_cast<std::size_t>(std::mismatch(da.begin(),da.end(),db.begin()).first -
+                    da.begin());
+                if (c > n_written) {
+                    if (n_written == 0u) {
+                        k = ka;
+                        if (negative) {
+                            os << '-';
+                        }
+                        os << da[0];
+                        n_written = 1u;
+                    }
+                    if (c > n_written) {
+                        if (n_written == 1u) {
+                            os << '.';
+                        }
+                        os.write(da.data() + n_written,static_cast<std::streamsize>(c - n_written));
+                        n_written = c;
+                    }
+                    os.flush();
+                }
+            }
+        }
+        if (n_written == n_digits || prec == max_prec) {
+            break;
+        }
+    }
+    if (n_written != 0u && k != 0) {
+        os << 'e' << k << std::flush;
+    }
+    return n_written;
+}
+
+#if defined(ARBPP_ENABLE_INSTRUMENTATION)
+
+namespace instrumentation
+{
+
+/// Snapshot of the instrumentation counters.
+struct counters
+{
+    /// Number of calls, for each operation and precision bucket.
+    std::array<std::array<unsigned long long,n_precision_buckets>,n_operations> calls;
+    /// Histogram of the number of bits of relative accuracy lost by the operations.
+    std::array<unsigned long long,n_loss_buckets> bits_lost;
+    /// Total number of calls to an operation.
+    /**
+     * @param[in] op operation.
+     *
+     * @return the number of calls to \p op, summed over all the precision buckets.
+     */
+    unsigned long long total(operation op) const
+    {
+        unsigned long long retval = 0u;
+        for (auto n: calls[static_cast<std::size_t>(op)]) {
+            retval += n;
+        }
+        return retval;
+    }
+    /// In-place addition.
+    /**
+     * @param[in] other counters to be added to \p this.
+     *
+     * @return reference to \p this.
+     */
+    counters &operator+=(const counters &other)
+    {
+        for (std::size_t i = 0u; i < n_operations; ++i) {
+            for (std::size_t j = 0u; j < n_precision_buckets; ++j) {
+                calls[i][j] += other.calls[i][j];
+            }
+        }
+        for (std::size_t i = 0u; i < n_loss_buckets; ++i) {
+            bits_lost[i] += other.bits_lost[i];
+        }
+        return *this;
+    }
+};
+
+using arbpp::operation_name;
+
+namespace detail
+{
+
+// Per-thread counters. Each thread is the only writer of its own counters, so the updates are plain
+// relaxed load/store pairs (no read-modify-write): the atomics are only needed to make the concurrent
+// reads of the dumping thread well defined.
+struct thread_counters
+{
+    std::array<std::array<std::atomic<unsigned long long>,n_precision_buckets>,n_operations>  calls;
+    std::array<std::atomic<unsigned long long>,n_loss_buckets>                                bits_lost;
+    thread_counters();
+    ~thread_counters();
+    counters snapshot() const
+    {
+        counters retval{};
+        for (std::size_t i = 0u; i < n_operations; ++i) {
+            for (std::size_t j = 0u; j < n_precision_buckets; ++j) {
+                retval.calls[i][j] = calls[i][j].load(std::memory_order_relaxed);
+            }
+        }
+        for (std::size_t i = 0u; i < n_loss_buckets; ++i) {
+            retval.bits_lost[i] = bits_lost[i].load(std::memory_order_relaxed);
+        }
+        return retval;
+    }
+};
+
+// Registry of the counters of the live threads, plus the accumulated counters of the threads
+// which have already exited.
+struct registry
+{
+    std::mutex                      mutex;
+    std::vector<thread_counters *>  live;
+    counters                        retired{};
+};
+
+inline registry &get_registry()
+{
+    static registry r;
+    return r;
+}
+
+inline thread_counters::thread_counters()
+{
+    for (auto &a: calls) {
+        for (auto &n: a) {
+            n.store(0u,std::memory_order_relaxed);
+        }
+    }
+    for (auto &n: bits_lost) {
+        n.store(0u,std::memory_order_relaxed);
+    }
+    auto &r = get_registry();
+    try {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.live.push_back(this);
+    } catch (...) {
+        // NOTE: if the registration fails, the counters of this thread will be visible only
+        // via get_thread_counters().
+    }
+}
+
+inline thread_counters::~thread_counters()
+{
+    auto &r = get_registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    auto it = std::find(r.live.begin(),r.live.end(),this);
+    if (it != r.live.end()) {
+        r.live.erase(it);
+        r.retired += snapshot();
+    }
+}
+
+inline thread_counters &get_thread_counters()
+{
+    static thread_local thread_counters tc;
+    return tc;
+}
+
+inline void increment(std::atomic<unsigned long long> &n)
+{
+    n.store(n.load(std::memory_order_relaxed) + 1u,std::memory_order_relaxed);
+}
+
+inline std::size_t precision_bucket(long prec)
+{
+    std::size_t retval = 0u;
+    for (; prec > 1 && retval + 1u < n_precision_buckets; prec >>= 1) {
+        ++retval;
+    }
+    return retval;
+}
+
+inline std::size_t loss_bucket(long lost)
+{
+    std::size_t retval = 0u;
+    for (; lost > 0 && retval + 1u < n_loss_buckets; lost >>= 1) {
+        ++retval;
+    }
+    return retval;
+}
+
+// Relative accuracy of an operand, clamped to [0,prec] (a ball containing zero has no relative accuracy).
+// Non-arb operands are exact.
+inline long input_accuracy(const arb &x)
+{
+    return std::max(0l,std::min(x.get_rel_accuracy_bits(),x.get_precision()));
+}
+
+template <typename T>
+inline long input_accuracy(const T &)
+{
+    return std::numeric_limits<long>::max();
+}
+
+inline long min_accuracy()
+{
+    return std::numeric_limits<long>::max();
+}
+
+template <typename T, typename ... Args>
+inline long min_accuracy(const T &x, const Args & ... args)
+{
+    return std::min(input_accuracy(x),min_accuracy(args...));
+}
+
+inline void record_impl(operation op, const arb &res, long in_acc) noexcept
+{
+    try {
+        auto &tc = get_thread_counters();
+        increment(tc.calls[static_cast<std::size_t>(op)][precision_bucket(res.get_precision())]);
+        const long in = std::min(in_acc,res.get_precision()), out = input_accuracy(res);
+        increment(tc.bits_lost[loss_bucket(in > out ? in - out : 0)]);
+    } catch (...) {}
+}
+
+template <typename ... Args>
+inline void record(operation op, const arb &res, const Args & ... inputs) noexcept
+{
+    if (sizeof...(Args) == 0u) {
+        // Constructors, copies and moves: count only.
+        try {
+            increment(get_thread_counters().calls[static_cast<std::size_t>(op)][precision_bucket(res.get_precision())]);
+        } catch (...) {}
+        return;
+    }
+    record_impl(op,res,min_accuracy(inputs...));
+}
+
+inline void record(operation op, long prec) noexcept
+{
+    try {
+        increment(get_thread_counters().calls[static_cast<std::size_t>(op)][precision_bucket(prec)]);
+    } catch (...) {}
+}
+
+template <typename ... Args>
+inline scope::scope(operation op, const arb &res, const Args & ... inputs) noexcept:
+    m_op(op),m_res(res),m_in_acc(min_accuracy(inputs...))
+{}
+
+inline scope::~scope()
+{
+    record_impl(m_op,m_res,m_in_acc);
+}
+
+}
+
+/// Counters of the calling thread.
+/**
+ * @return a snapshot of the instrumentation counters of the calling thread.
+ */
+inline counters get_thread_counters()
+{
+    return detail::get_thread_counters().snapshot();
+}
+
+/// Counters of all threads.
+/**
+ * The counters of the threads that have already exited are included.
+ *
+ * @return a snapshot of the instrumentation counters, summed over all threads.
+ */
+inline counters get_counters()
+{
+    auto &r = detail::get_registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    counters retval = r.retired;
+    for (auto ptr: r.live) {
+        retval += ptr->snapshot();
+    }
+    return retval;
+}
+
+/// Dump counters.
+/**
+ * Print to \p os a human-readable table of the counters \p c: one line per operation which was called
+ * at least once, with the total number of calls followed by the nonzero precision buckets, and the nonzero
+ * buckets of the histogram of lost accuracy.
+ *
+ * @param[in] os target stream.
+ * @param[in] c counters to be printed.
+ */
+inline void dump(std::ostream &os, const counters &c)
+{
+    os << "operation       calls           [precision range]: calls\n";
+    for (std::size_t i = 0u; i < n_operations; ++i) {
+        const auto op = static_cast<operation>(i);
+        const auto tot = c.total(op);
+        if (!tot) {
+            continue;
+        }
+        std::string name(operation_name(op));
+        name.resize(16u,' ');
+        std::string tot_str(std::to_string(tot));
+        tot_str.resize(16u,' ');
+        os << name << tot_str;
+        for (std::size_t j = 0u; j < n_precision_buckets; ++j) {
+            if (c.calls[i][j]) {
+                os << '[' << (1ull << j) << ',';
+                if (j + 1u == n_precision_buckets) {
+                    os << "inf";
+                } else {
+                    os << (1ull << (j + 1u));
+                }
+                os << "): " << c.calls[i][j] << ' ';
+            }
+        }
+        os << '\n';
+    }
+    os << "bits lost       [range]: calls\n";
+    for (std::size_t i = 0u; i < n_loss_buckets; ++i) {
+        if (c.bits_lost[i]) {
+            if (i == 0u) {
+                os << "                0: ";
+            } else {
+                os << "                [" << (1ull << (i - 1u)) << ',';
+                if (i + 1u == n_loss_buckets) {
+                    os << "inf";
+                } else {
+                    os << (1ull << i);
+                }
+                os << "): ";
+            }
+            os << c.bits_lost[i] << '\n';
+        }
+    }
+}
+
+/// Dump the counters of all threads.
+/**
+ * Equivalent to <tt>dump(os,get_counters())</tt>.
+ *
+ * @param[in] os target stream.
+ */
+inline void dump(std::ostream &os = std::cerr)
+{
+    dump(os,get_counters());
+}
+
+}
+
+#endif
+
+/// Memory statistics.
+/**
+ * This namespace provides a facility to track the heap memory used by GMP, MPFR, FLINT and Arb. After a call to
+ * memory::enable_tracking(), the allocation functions of GMP and FLINT are replaced by wrappers which forward to the
+ * original functions and update a set of counters, both per thread and global. The tracking cannot be disabled.
+ */
+namespace memory
+{
+
+/// Memory statistics.
+struct stats
+{
+    /// Number of allocations (reallocations are included).
+    unsigned long long  allocations;
+    /// Number of deallocations.
+    unsigned long long  deallocations;
+    /// Total number of bytes requested by the allocations.
+    unsigned long long  allocated_bytes;
+    /// Number of bytes currently in use.
+    /**
+     * \note
+     * For per-thread statistics, this value is the difference between the bytes allocated and the bytes freed
+     * by the thread, and it can be negative if the thread frees memory allocated by another thread.
+     */
+    long long           current_bytes;
+    /// Maximum value reached by \p current_bytes.
+    long long           peak_bytes;
+};
+
+namespace detail
+{
+
+struct allocator_state
+{
+    // The original allocation functions.
+    void *(*gmp_alloc)(std::size_t);
+    void *(*gmp_realloc)(void *, std::size_t, std::size_t);
+    void (*gmp_free)(void *, std::size_t);
+    void *(*flint_alloc)(std::size_t);
+    void *(*flint_calloc)(std::size_t, std::size_t);
+    void *(*flint_realloc)(void *, std::size_t);
+    void (*flint_free)(void *);
+    // Global counters.
+    std::atomic<unsigned long long> allocations;
+    std::atomic<unsigned long long> deallocations;
+    std::atomic<unsigned long long> allocated_bytes;
+    std::atomic<long long>          current_bytes;
+    std::atomic<long long>          peak_bytes;
+    std::atomic<bool>               enabled;
+    std::once_flag                  flag;
+};
+
+inline allocator_state &get_state()
+{
+    static allocator_state s;
+    return s;
+}
+
+inline stats &get_thread_stats()
+{
+    static thread_local stats s = stats();
+    return s;
+}
+
+inline void on_alloc(std::size_t n)
+{
+    auto &ts = get_thread_stats();
+    ++ts.allocations;
+    ts.allocated_bytes += n;
+    ts.current_bytes += static_cast<long long>(n);
+    ts.peak_bytes = std::max(ts.peak_bytes,ts.current_bytes);
+    auto &s = get_state();
+    s.allocations.fetch_add(1u,std::memory_order_relaxed);
+    s.allocated_bytes.fetch_add(n,std::memory_order_relaxed);
+    const long long cur = s.current_bytes.fetch_add(static_cast<long long>(n),std::memory_order_relaxed) +
+        static_cast<long long>(n);
+    long long peak = s.peak_bytes.load(std::memory_order_relaxed);
+    while (cur > peak && !s.peak_bytes.compare_exchange_weak(peak,cur,std::memory_order_relaxed)) {}
+}
+
+inline void on_free(std::size_t n)
+{
+    auto &ts = get_thread_stats();
+    ++ts.deallocations;
+    ts.current_bytes -= static_cast<long long>(n);
+    auto &s = get_state();
+    s.deallocations.fetch_add(1u,std::memory_order_relaxed);
+    s.current_bytes.fetch_sub(static_cast<long long>(n),std::memory_order_relaxed);
+}
+
+// GMP passes the size of the blocks to realloc and free.
+inline void *gmp_alloc(std::size_t n)
+{
+    void *retval = get_state().gmp_alloc(n);
+    on_alloc(n);
+    return retval;
+}
+
+inline void *gmp_realloc(void *p, std::size_t old_size, std::size_t new_size)
+{
+    void *retval = get_state().gmp_realloc(p,old_size,new_size);
+    on_free(old_size);
+    on_alloc(new_size);
+    return retval;
+}
+
+inline void gmp_free(void *p, std::size_t n)
+{
+    get_state().gmp_free(p,n);
+    on_free(n);
+}
+
+// FLINT does not, so the sizes of the blocks allocated by the wrappers are kept in a side table, split into
+// shards in order to limit the contention between threads. The blocks themselves are passed unchanged to and
+// from the original functions: a block which is not in the table (because it was allocated before the tracking
+// was enabled) is forwarded to the original functions and left out of the statistics.
+class size_table
+{
+        static const std::size_t n_shards = 64u;
+        struct shard
+        {
+            std::mutex                                      mutex;
+            std::unordered_map<const void *,std::size_t>    sizes;
+        };
+        shard &get_shard(const void *p)
+        {
+            // NOTE: the low bits of the addresses are zero because of alignment.
+            return m_shards[(reinterpret_cast<std::uintptr_t>(p) >> 4u) % n_shards];
+        }
+    public:
+        // Record the size of p, returning false if the table could not be updated.
+        bool insert(const void *p, std::size_t n)
         {
-            return in_place_add(x);
+            auto &sh = get_shard(p);
+            try {
+                std::lock_guard<std::mutex> lock(sh.mutex);
+                sh.sizes[p] = n;
+            } catch (...) {
+                // NOTE: the wrappers are called from C code, exceptions must not escape.
+                return false;
+            }
+            return true;
         }
-        /// Generic binary addition involving arbpp::arb.
-        /**
-         * \note
-         * This template operator is enabled only if either:
-         * - \p T is arbpp::arb and \p U is an interoperable type,
-         * - \p U is arbpp::arb and \p T is an interoperable type,
-         * - both \p T and \p U are arbpp::arb.
-         * 
-         * This method will compute <tt>a + b</tt> and return it as an arbpp::arb. In case \p T and \p U are both
-         * arbpp::arb, then the operation is carried out with a precision corresponding to the maximum between
-         * the precisions of \p a and \p b. Otherwise, the result will have the precision of the
-         * arbpp::arb argument.
-         * 
-         * @param[in] a first operand.
-         * @param[in] b second operand.
-         * 
-         * @return <tt>a + b</tt>.
-         */
-        template <typename T, typename U>
-        friend auto operator+(const T &a, const U &b) -> decltype(arb::binary_add(a,b))
+        // Remove p from the table and fetch its size, returning false if p is not in the table.
+        bool erase(const void *p, std::size_t &n)
         {
-            return binary_add(a,b);
+            auto &sh = get_shard(p);
+            std::lock_guard<std::mutex> lock(sh.mutex);
+            const auto it = sh.sizes.find(p);
+            if (it == sh.sizes.end()) {
+                return false;
+            }
+            n = it->second;
+            sh.sizes.erase(it);
+            return true;
         }
-        /// Negation.
+    private:
+        shard m_shards[n_shards];
+};
+
+inline size_table &get_flint_sizes()
+{
+    // NOTE: never destroyed, as FLINT can free memory during the destruction of the static and thread-local
+    // objects.
+    static size_table *t = new size_table;
+    return *t;
+}
+
+inline void flint_track(void *p, std::size_t n)
+{
+    if (p && get_flint_sizes().insert(p,n)) {
+        on_alloc(n);
+    }
+}
+
+inline void flint_untrack(void *p)
+{
+    std::size_t n;
+    if (p && get_flint_sizes().erase(p,n)) {
+        on_free(n);
+    }
+}
+
+inline void *flint_alloc(std::size_t n)
+{
+    void *retval = get_state().flint_alloc(n);
+    flint_track(retval,n);
+    return retval;
+}
+
+inline void *flint_calloc(std::size_t num, std::size_t size)
+{
+    void *retval = get_state().flint_calloc(num,size);
+    // NOTE: the original function fails if num * size overflows.
+    flint_track(retval,num * size);
+    return retval;
+}
+
+inline void *flint_realloc(void *p, std::size_t n)
+{
+    void *retval = get_state().flint_realloc(p,n);
+    if (retval || !n) {
+        flint_untrack(p);
+        flint_track(retval,n);
+    }
+    return retval;
+}
+
+inline void flint_free(void *p)
+{
+    flint_untrack(p);
+    get_state().flint_free(p);
+}
+
+}
+
+/// Enable memory tracking.
+/**
+ * This function will replace the memory allocation functions of GMP and FLINT with wrappers that update the
+ * statistics returned by get_thread_stats() and get_global_stats(). Calling this function more than once
+ * has no effect.
+ *
+ * \note
+ * The wrappers do not change the layout of the blocks, so the blocks allocated before the call can be freed
+ * afterwards (and vice versa). The blocks allocated by FLINT before the call are left out of the statistics,
+ * while the sizes of the blocks allocated by GMP before the call are subtracted from counters which never
+ * included them: for accurate statistics, this function should be called at the beginning of \p main(),
+ * before other threads are started.
+ */
+inline void enable_tracking()
+{
+    auto &s = detail::get_state();
+    std::call_once(s.flag,[&s]() {
+        ::mp_get_memory_functions(&s.gmp_alloc,&s.gmp_realloc,&s.gmp_free);
+        ::__flint_get_memory_functions(&s.flint_alloc,&s.flint_calloc,&s.flint_realloc,&s.flint_free);
+        ::mp_set_memory_functions(detail::gmp_alloc,detail::gmp_realloc,detail::gmp_free);
+        ::__flint_set_memory_functions(detail::flint_alloc,detail::flint_calloc,detail::flint_realloc,detail::flint_free);
+        s.enabled.store(true);
+    });
+}
+
+/// Test if memory tracking is enabled.
+/**
+ * @return \p true if enable_tracking() has been called, \p false otherwise.
+ */
+inline bool tracking_enabled()
+{
+    return detail::get_state().enabled.load();
+}
+
+/// Memory statistics of the calling thread.
+/**
+ * @return the memory statistics of the calling thread since the beginning of the tracking.
+ */
+inline stats get_thread_stats()
+{
+    return detail::get_thread_stats();
+}
+
+/// Global memory statistics.
+/**
+ * @return the memory statistics of all threads since the beginning of the tracking.
+ */
+inline stats get_global_stats()
+{
+    const auto &s = detail::get_state();
+    stats retval;
+    retval.allocations = s.allocations.load(std::memory_order_relaxed);
+    retval.deallocations = s.deallocations.load(std::memory_order_relaxed);
+    retval.allocated_bytes = s.allocated_bytes.load(std::memory_order_relaxed);
+    retval.current_bytes = s.current_bytes.load(std::memory_order_relaxed);
+    retval.peak_bytes = s.peak_bytes.load(std::memory_order_relaxed);
+    return retval;
+}
+
+/// Reset the peak counters.
+/**
+ * The peak of the calling thread and the global peak are reset to the current values, so that the peak memory
+ * usage of a phase of the computation can be measured.
+ */
+inline void reset_peak()
+{
+    auto &ts = detail::get_thread_stats();
+    ts.peak_bytes = ts.current_bytes;
+    auto &s = detail::get_state();
+    s.peak_bytes.store(s.current_bytes.load(std::memory_order_relaxed),std::memory_order_relaxed);
+}
+
+}
+
+/// Precision collapse event.
+/**
+ * Description of an operation whose result fell below the accuracy floor of an arbpp::precision_watchdog.
+ */
+struct precision_event
+{
+    /// The operation.
+    operation   op;
+    /// Relative accuracy of the result, in bits (see arbpp::arb::get_rel_accuracy_bits()).
+    long        accuracy;
+    /// Precision of the result.
+    long        precision;
+};
+
+/// Exception for catastrophic losses of precision.
+/**
+ * This exception is thrown by the operations of arbpp::arb when an arbpp::precision_watchdog without callback
+ * is active and the accuracy of the result falls below the floor.
+ */
+class precision_loss_error: public std::runtime_error
+{
+    public:
+        /// Constructor.
         /**
-         * Negate in-place.
+         * @param[in] e the event which triggered the exception.
          */
-        void negate()
-        {
-            ::arb_neg(&m_arb,&m_arb);
-        }
-        /// Negated copy.
+        explicit precision_loss_error(const precision_event &e):
+            std::runtime_error(std::string("catastrophic loss of precision in operation '") + operation_name(e.op) +
+            "': the relative accuracy of the result is " + std::to_string(e.accuracy) + " bits at a precision of " +
+            std::to_string(e.precision) + " bits"),m_event(e)
+        {}
+        /// Event getter.
         /**
-         * @return a negated copy of \p this.
+         * @return the event which triggered the exception.
          */
-        arb operator-() const
+        const precision_event &get_event() const
         {
-            arb retval{*this};
-            retval.negate();
-            return retval;
+            return m_event;
         }
-        /// In-place subtraction.
+    private:
+        precision_event m_event;
+};
+
+/// Precision-loss watchdog.
+/**
+ * While an object of this class is alive, the arithmetic operators, the fused multiply-adds and the elementary
+ * functions of arbpp::arb executed in the thread that created it will check the relative accuracy of their result
+ * (see arbpp::arb::get_rel_accuracy_bits()) against the floor passed on construction. When the accuracy falls below
+ * the floor:
+ * - if no callback was provided, an arbpp::precision_loss_error is thrown, thus aborting the computation as soon
+ *   as the collapse happens;
+ * - otherwise, the callback is invoked with a description of the event, the first time only, and the computation
+ *   continues (unless the callback throws).
+ *
+ * In both cases, the first event is recorded and it can be retrieved via get_event(), so that the computation
+ * can be restarted at a higher precision straight away. The in-place operations (compound assignment operators
+ * and fused multiply-adds) are computed on a copy while a watchdog is active, so that if the check throws
+ * the operand is left unchanged (strong exception safety guarantee).
+ *
+ * Watchdogs can be nested: only the innermost one is active, and the previous one is restored on destruction.
+ * Watchdogs must be destroyed in the same thread and in reverse order of creation (as happens naturally for local
+ * variables). When no watchdog is active, the cost of the checks is a thread-local load per operation.
+ *
+ * Example:
+ * @code
+ * long prec = 64;
+ * while (true) {
+ *     try {
+ *         precision_watchdog w{20};
+ *         result = compute(prec);
+ *         break;
+ *     } catch (const precision_loss_error &) {
+ *         prec *= 2;
+ *     }
+ * }
+ * @endcode
+ */
+class precision_watchdog
+{
+        friend void detail::watchdog_check(operation, const arb &);
+    public:
+        /// Callback type.
+        typedef std::function<void(const precision_event &)> callback_type;
+        /// Constructor.
         /**
-         * \note
-         * This operator is enabled only if \p T is an interoperable type
-         * or arbpp::arb.
-         * 
-         * This method will set \p this to <tt>this - x</tt>. In case \p T is arbpp::arb, then
-         * the operation is carried out with a precision corresponding to the maximum between
-         * the precisions of \p this and \p x. Otherwise, the operation is carried out with the
-         * precision of \p this.
-         * 
-         * @param[in] x subtraction argument.
-         * 
-         * @return reference to \p this.
+         * The watchdog will throw an arbpp::precision_loss_error when the relative accuracy of a result falls
+         * below \p floor bits.
+         *
+         * @param[in] floor the accuracy floor.
          */
-        template <typename T>
-        auto operator-=(const T &x) -> decltype(this->in_place_sub(x))
-        {
-            return in_place_sub(x);
-        }
-        /// Generic binary subtraction involving arbpp::arb.
+        explicit precision_watchdog(long floor):precision_watchdog(floor,callback_type{}) {}
+        /// Constructor with callback.
         /**
-         * \note
-         * This template operator is enabled only if either:
-         * - \p T is arbpp::arb and \p U is an interoperable type,
-         * - \p U is arbpp::arb and \p T is an interoperable type,
-         * - both \p T and \p U are arbpp::arb.
-         * 
-         * This method will compute <tt>a - b</tt> and return it as an arbpp::arb. In case \p T and \p U are both
-         * arbpp::arb, then the operation is carried out with a precision corresponding to the maximum between
-         * the precisions of \p a and \p b. Otherwise, the result will have the precision of the
-         * arbpp::arb argument.
-         * 
-         * @param[in] a first operand.
-         * @param[in] b second operand.
-         * 
-         * @return <tt>a - b</tt>.
+         * The watchdog will call \p cb the first time the relative accuracy of a result falls
+         * below \p floor bits. If \p cb is empty, the behaviour is the same as the other constructor.
+         *
+         * @param[in] floor the accuracy floor.
+         * @param[in] cb callback.
          */
-        template <typename T, typename U>
-        friend auto operator-(const T &a, const U &b) -> decltype(arb::binary_sub(a,b))
+        precision_watchdog(long floor, callback_type cb):m_floor(floor),m_callback(std::move(cb)),
+            m_prev(detail::active_watchdog()),m_triggered(false),m_event()
         {
-            return binary_sub(a,b);
+            detail::active_watchdog() = this;
         }
-        /// In-place multiplication.
+        /// Deleted copy constructor.
+        precision_watchdog(const precision_watchdog &) = delete;
+        /// Deleted copy assignment.
+        precision_watchdog &operator=(const precision_watchdog &) = delete;
+        /// Destructor.
         /**
-         * \note
-         * This operator is enabled only if \p T is an interoperable type
-         * or arbpp::arb.
-         * 
-         * This method will set \p this to <tt>this * x</tt>. In case \p T is arbpp::arb, then
-         * the operation is carried out with a precision corresponding to the maximum between
-         * the precisions of \p this and \p x. Otherwise, the operation is carried out with the
-         * precision of \p this.
-         * 
-         * @param[in] x multiplication argument.
-         * 
-         * @return reference to \p this.
+         * Will restore the previously active watchdog, if any.
          */
-        template <typename T>
-        auto operator*=(const T &x) -> decltype(this->in_place_mul(x))
+        ~precision_watchdog()
         {
-            return in_place_mul(x);
+            detail::active_watchdog() = m_prev;
         }
-        /// Generic binary multiplication involving arbpp::arb.
+        /// Floor getter.
         /**
-         * \note
-         * This template operator is enabled only if either:
-         * - \p T is arbpp::arb and \p U is an interoperable type,
-         * - \p U is arbpp::arb and \p T is an interoperable type,
-         * - both \p T and \p U are arbpp::arb.
-         * 
-         * This method will compute <tt>a * b</tt> and return it as an arbpp::arb. In case \p T and \p U are both
-         * arbpp::arb, then the operation is carried out with a precision corresponding to the maximum between
-         * the precisions of \p a and \p b. Otherwise, the result will have the precision of the
-         * arbpp::arb argument.
-         * 
-         * @param[in] a first operand.
-         * @param[in] b second operand.
-         * 
-         * @return <tt>a * b</tt>.
+         * @return the accuracy floor.
          */
-        template <typename T, typename U>
-        friend auto operator*(const T &a, const U &b) -> decltype(arb::binary_mul(a,b))
+        long get_floor() const
         {
-            return binary_mul(a,b);
+            return m_floor;
         }
-        /// In-place division.
+        /// Test if the watchdog was triggered.
         /**
-         * \note
-         * This operator is enabled only if \p T is an interoperable type
-         * or arbpp::arb.
-         * 
-         * This method will set \p this to <tt>this / x</tt>. In case \p T is arbpp::arb, then
-         * the operation is carried out with a precision corresponding to the maximum between
-         * the precisions of \p this and \p x. Otherwise, the operation is carried out with the
-         * precision of \p this.
-         * 
-         * @param[in] x division argument.
-         * 
-         * @return reference to \p this.
+         * @return \p true if the accuracy of a result fell below the floor, \p false otherwise.
          */
-        template <typename T>
-        auto operator/=(const T &x) -> decltype(this->in_place_div(x))
+        bool triggered() const
         {
-            return in_place_div(x);
+            return m_triggered;
         }
-        /// Generic binary division involving arbpp::arb.
+        /// Get the first collapse event.
         /**
-         * \note
-         * This template operator is enabled only if either:
-         * - \p T is arbpp::arb and \p U is an interoperable type,
-         * - \p U is arbpp::arb and \p T is an interoperable type,
-         * - both \p T and \p U are arbpp::arb.
-         * 
-         * This method will compute <tt>a / b</tt> and return it as an arbpp::arb. In case \p T and \p U are both
-         * arbpp::arb, then the operation is carried out with a precision corresponding to the maximum between
-         * the precisions of \p a and \p b. Otherwise, the result will have the precision of the
-         * arbpp::arb argument.
-         * 
-         * @param[in] a first operand.
-         * @param[in] b second operand.
-         * 
-         * @return <tt>a / b</tt>.
+         * @return the first event recorded by the watchdog.
+         *
+         * @throws std::logic_error if the watchdog was not triggered.
          */
-        template <typename T, typename U>
-        friend auto operator/(const T &a, const U &b) -> decltype(arb::binary_div(a,b))
+        const precision_event &get_event() const
         {
-            return binary_div(a,b);
+            if (!m_triggered) {
+                throw std::logic_error("the precision watchdog was not triggered");
+            }
+            return m_event;
         }
-        /// Cosine.
-        /**
-         * @return the cosine of \p this.
-         */
-        arb cos() const
+    private:
+        void check(operation op, const arb &res)
         {
-            arb retval;
-            ::arb_cos(&retval.m_arb,&m_arb,m_prec);
-            retval.m_prec = m_prec;
-            return retval;
+            if (m_triggered && m_callback) {
+                return;
+            }
+            const long acc = res.get_rel_accuracy_bits();
+            if (acc >= m_floor) {
+                return;
+            }
+            const precision_event e{op,acc,res.get_precision()};
+            if (!m_triggered) {
+                // NOTE: set the flag before invoking the callback, so that the operations
+                // performed by the callback itself do not trigger it again.
+                m_triggered = true;
+                m_event = e;
+            }
+            if (m_callback) {
+                m_callback(e);
+            } else {
+                throw precision_loss_error(e);
+            }
         }
     private:
-        ::arb_struct    m_arb;
-        long            m_prec;
+        long                m_floor;
+        callback_type       m_callback;
+        precision_watchdog  *m_prev;
+        bool                m_triggered;
+        precision_event     m_event;
 };
 
-/// Cosine.
-/**
- * @param[in] a cosine argument.
- * 
- * @return <tt>a.cos()</tt>.
- */
-inline arb cos(const arb &a)
+namespace detail
 {
-    return a.cos();
+
+inline precision_watchdog *&active_watchdog()
+{
+    static thread_local precision_watchdog *ptr = nullptr;
+    return ptr;
 }
 
-/// Swap.
-/**
- * Equivalent to <tt>a0.swap(a1)</tt>.
- * 
- * @param[in] a0 first argument.
- * @param[in] a1 second argument.
- */
-inline void swap(arb &a0, arb &a1) noexcept
+inline void watchdog_check(operation op, const arb &res)
 {
-    a0.swap(a1);
+    if (auto w = active_watchdog()) {
+        w->check(op,res);
+    }
+}
+
 }
 
 /// Literal namespace.
@@ -0,0 +1,677 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#ifndef ARBPP_BOOST_MULTIPRECISION_HPP
+#define ARBPP_BOOST_MULTIPRECISION_HPP
+
+#include <arb.h>
+#include <arf.h>
+#include <boost/multiprecision/number.hpp>
+#include <boost/version.hpp>
+#include <cmath>
+#include <fmpz.h>
+#include <ios>
+#include <limits>
+#include <mpfr.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#if BOOST_VERSION < 107600
+#include <boost/mpl/list.hpp>
+#else
+#include <tuple>
+#endif
+
+#include "arbpp.hpp"
+
+namespace arbpp
+{
+
+namespace detail
+{
+
+#if BOOST_VERSION < 107600
+template <typename ... Args>
+using mp_type_list = boost::mpl::list<Args...>;
+#else
+template <typename ... Args>
+using mp_type_list = std::tuple<Args...>;
+#endif
+
+// Absolute value of an integer as an unsigned long long. The absolute value must fit,
+// unsigned long might be narrower than unsigned long long.
+inline unsigned long long fmpz_abs_get_ull(const ::fmpz *f)
+{
+    const unsigned ul_bits = static_cast<unsigned>(std::numeric_limits<unsigned long>::digits);
+    fmpz_raii tmp, r;
+    ::fmpz_abs(tmp,f);
+    unsigned long long retval = 0u;
+    for (unsigned shift = 0u; !::fmpz_is_zero(tmp); shift += ul_bits) {
+        ::fmpz_tdiv_r_2exp(r,tmp,ul_bits);
+        retval += static_cast<unsigned long long>(::fmpz_get_ui(r)) << shift;
+        ::fmpz_tdiv_q_2exp(tmp,tmp,ul_bits);
+    }
+    return retval;
+}
+
+}
+
+/// Boost.Multiprecision backend for arbpp::arb.
+/**
+ * This class allows to use arbpp::arb as a backend for <tt>boost::multiprecision::number</tt>, with a fixed
+ * precision of \p Prec bits. All the values handled by the backend have precision \p Prec, and the
+ * arithmetic operations are routed directly to the corresponding Arb functions. The arbpp::mp_arb alias
+ * provides a <tt>boost::multiprecision::number</tt> with expression templates enabled.
+ *
+ * Construction from interoperable types and from strings, and conversion to string, go through
+ * the corresponding facilities of arbpp::arb. In particular, the string representation of a value
+ * is the one produced by the stream operator of arbpp::arb, irrespective of the requested digits and
+ * format flags.
+ *
+ * Comparisons are performed on the midpoints of the balls. They are thus not certified: two overlapping
+ * balls might compare as different, and the result of a comparison between balls with distinct midpoints
+ * is not guaranteed to hold for all the values in the balls.
+ */
+template <long Prec>
+class arbpp_backend
+{
+        static_assert(Prec >= MPFR_PREC_MIN && Prec <= MPFR_PREC_MAX,"Invalid precision.");
+    public:
+        /// Signed integral types used for construction.
+        typedef detail::mp_type_list<long,long long> signed_types;
+        /// Unsigned integral types used for construction.
+        typedef detail::mp_type_list<unsigned long,unsigned long long> unsigned_types;
+        /// Floating-point types used for construction.
+        typedef detail::mp_type_list<double,long double> float_types;
+        /// Exponent type.
+        typedef long exponent_type;
+        /// Default constructor.
+        /**
+         * The value is initialised to zero.
+         */
+        arbpp_backend():m_value(0,Prec) {}
+        /// Defaulted copy constructor.
+        arbpp_backend(const arbpp_backend &) = default;
+        /// Defaulted move constructor.
+        arbpp_backend(arbpp_backend &&) = default;
+        /// Defaulted copy assignment.
+        arbpp_backend &operator=(const arbpp_backend &) = default;
+        /// Defaulted move assignment.
+        arbpp_backend &operator=(arbpp_backend &&) = default;
+        /// Generic assignment.
+        /**
+         * \note
+         * This operator is enabled only if arbpp::arb can be constructed from \p T and a precision value.
+         *
+         * @param[in] x assignment argument.
+         *
+         * @return reference to \p this.
+         *
+         * @throws unspecified any exception thrown by the constructor of arbpp::arb.
+         */
+        template <typename T, typename std::enable_if<std::is_constructible<arb,const T &,long>::value,int>::type = 0>
+        arbpp_backend &operator=(const T &x)
+        {
+            m_value = arb(x,Prec);
+            return *this;
+        }
+        /// Assignment from string.
+        /**
+         * @param[in] s assignment argument.
+         *
+         * @return reference to \p this.
+         *
+         * @throws unspecified any exception thrown by the constructor of arbpp::arb from string.
+         */
+        arbpp_backend &operator=(const char *s)
+        {
+            m_value = arb(std::string(s),Prec);
+            return *this;
+        }
+        /// Swap.
+        /**
+         * @param[in] other swap argument.
+         */
+        void swap(arbpp_backend &other) noexcept
+        {
+            m_value.swap(other.m_value);
+        }
+        /// String representation.
+        /**
+         * @return the representation of the internal arbpp::arb produced by its stream operator.
+         *
+         * @throws unspecified any exception thrown by the stream operator of arbpp::arb.
+         */
+        std::string str(std::streamsize, std::ios_base::fmtflags) const
+        {
+            std::ostringstream oss;
+            oss << m_value;
+            return oss.str();
+        }
+        /// Negation.
+        void negate()
+        {
+            m_value.negate();
+        }
+        /// Comparison.
+        /**
+         * @param[in] other comparison argument.
+         *
+         * @return a negative value, zero or a positive value if the midpoint of \p this is less than,
+         * equal to or greater than the midpoint of \p other.
+         */
+        int compare(const arbpp_backend &other) const
+        {
+            return ::arf_cmp(arb_midref(m_value.get_arb_t()),arb_midref(other.m_value.get_arb_t()));
+        }
+        /// Const reference to the internal value.
+        /**
+         * @return const reference to the internal arbpp::arb.
+         */
+        const arb &value() const
+        {
+            return m_value;
+        }
+        /// Mutable reference to the internal value.
+        /**
+         * The precision of the internal value must be left equal to \p Prec.
+         *
+         * @return reference to the internal arbpp::arb.
+         */
+        arb &value()
+        {
+            return m_value;
+        }
+        /// Internal \p arb_struct.
+        /**
+         * @return pointer to the \p arb_struct of the internal value.
+         */
+        ::arb_struct *get_arb_t()
+        {
+            return m_value.get_arb_t();
+        }
+        /// Const internal \p arb_struct.
+        /**
+         * @return const pointer to the \p arb_struct of the internal value.
+         */
+        const ::arb_struct *get_arb_t() const
+        {
+            return m_value.get_arb_t();
+        }
+    private:
+        arb m_value;
+};
+
+/// Boost.Multiprecision number based on arbpp::arb, with expression templates enabled.
+template <long Prec>
+using mp_arb = boost::multiprecision::number<arbpp_backend<Prec>,boost::multiprecision::et_on>;
+
+// Backend functions for Boost.Multiprecision, found via ADL.
+
+template <long Prec>
+inline void eval_add(arbpp_backend<Prec> &r, const arbpp_backend<Prec> &a)
+{
+    ::arb_add(r.get_arb_t(),r.get_arb_t(),a.get_arb_t(),Prec);
+}
+
+template <long Prec>
+inline void eval_add(arbpp_backend<Prec> &r, const arbpp_backend<Prec> &a, const arbpp_backend<Prec> &b)
+{
+    ::arb_add(r.get_arb_t(),a.get_arb_t(),b.get_arb_t(),Prec);
+}
+
+template <long Prec>
+inline void eval_add(arbpp_backend<Prec> &r, long n)
+{
+    ::arb_add_si(r.get_arb_t(),r.get_arb_t(),n,Prec);
+}
+
+template <long Prec>
+inline void eval_add(arbpp_backend<Prec> &r, unsigned long n)
+{
+    ::arb_add_ui(r.get_arb_t(),r.get_arb_t(),n,Prec);
+}
+
+template <long Prec>
+inline void eval_subtract(arbpp_backend<Prec> &r, const arbpp_backend<Prec> &a)
+{
+    ::arb_sub(r.get_arb_t(),r.get_arb_t(),a.get_arb_t(),Prec);
+}
+
+template <long Prec>
+inline void eval_subtract(arbpp_backend<Prec> &r, const arbpp_backend<Prec> &a, const arbpp_backend<Prec> &b)
+{
+    ::arb_sub(r.get_arb_t(),a.get_arb_t(),b.get_arb_t(),Prec);
+}
+
+template <long Prec>
+inline void eval_subtract(arbpp_backend<Prec> &r, long n)
+{
+    ::arb_sub_si(r.get_arb_t(),r.get_arb_t(),n,Prec);
+}
+
+template <long Prec>
+inline void eval_subtract(arbpp_backend<Prec> &r, unsigned long n)
+{
+    ::arb_sub_ui(r.get_arb_t(),r.get_arb_t(),n,Prec);
+}
+
+template <long Prec>
+inline void eval_multiply(arbpp_backend<Prec> &r, const arbpp_backend<Prec> &a)
+{
+    ::arb_mul(r.get_arb_t(),r.get_arb_t(),a.get_arb_t(),Prec);
+}
+
+template <long Prec>
+inline void eval_multiply(arbpp_backend<Prec> &r, const arbpp_backend<Prec> &a, const arbpp_backend<Prec> &b)
+{
+    ::arb_mul(r.get_arb_t(),a.get_arb_t(),b.get_arb_t(),Prec);
+}
+
+template <long Prec>
+inline void eval_multiply(arbpp_backend<Prec> &r, long n)
+{
+    ::arb_mul_si(r.get_arb_t(),r.get_arb_t(),n,Prec);
+}
+
+template <long Prec>
+inline void eval_multiply(arbpp_backend<Prec> &r, unsigned long n)
+{
+    ::arb_mul_ui(r.get_arb_t(),r.get_arb_t(),n,Prec);
+}
+
+template <long Prec>
+inline void eval_multiply_add(arbpp_backend<Prec> &r, const arbpp_backend<Prec> &a, const arbpp_backend<Prec> &b)
+{
+    ::arb_addmul(r.get_arb_t(),a.get_arb_t(),b.get_arb_t(),Prec);
+}
+
+template <long Prec>
+inline void eval_multiply_subtract(arbpp_backend<Prec> &r, const arbpp_backend<Prec> &a,
+    const arbpp_backend<Prec> &b)
+{
+    ::arb_submul(r.get_arb_t(),a.get_arb_t(),b.get_arb_t(),Prec);
+}
+
+template <long Prec>
+inline void eval_divide(arbpp_backend<Prec> &r, const arbpp_backend<Prec> &a)
+{
+    ::arb_div(r.get_arb_t(),r.get_arb_t(),a.get_arb_t(),Prec);
+}
+
+template <long Prec>
+inline void eval_divide(arbpp_backend<Prec> &r, const arbpp_backend<Prec> &a, const arbpp_backend<Prec> &b)
+{
+    ::arb_div(r.get_arb_t(),a.get_arb_t(),b.get_arb_t(),Prec);
+}
+
+template <long Prec>
+inline void eval_divide(arbpp_backend<Prec> &r, long n)
+{
+    ::arb_div_si(r.get_arb_t(),r.get_arb_t(),n,Prec);
+}
+
+template <long Prec>
+inline void eval_divide(arbpp_backend<Prec> &r, unsigned long n)
+{
+    ::arb_div_ui(r.get_arb_t(),r.get_arb_t(),n,Prec);
+}
+
+template <long Prec>
+inline bool eval_is_zero(const arbpp_backend<Prec> &a)
+{
+    return ::arb_is_zero(a.get_arb_t()) != 0;
+}
+
+template <long Prec>
+inline int eval_get_sign(const arbpp_backend<Prec> &a)
+{
+    return ::arf_sgn(arb_midref(a.get_arb_t()));
+}
+
+template <long Prec>
+inline int eval_fpclassify(const arbpp_backend<Prec> &a)
+{
+    const ::arf_struct *mid = arb_midref(a.get_arb_t());
+    if (::arf_is_nan(mid)) {
+        return FP_NAN;
+    }
+    if (::arf_is_inf(mid)) {
+        return FP_INFINITE;
+    }
+    if (::arf_is_zero(mid)) {
+        return FP_ZERO;
+    }
+    return FP_NORMAL;
+}
+
+// Conversions. They act on the midpoint.
+template <long Prec>
+inline void eval_convert_to(double *res, const arbpp_backend<Prec> &a)
+{
+    *res = a.value().to_double();
+}
+
+template <long Prec>
+inline void eval_convert_to(long double *res, const arbpp_backend<Prec> &a)
+{
+    detail::mpfr_raii m(static_cast< ::mpfr_prec_t>(std::numeric_limits<long double>::digits));
+    ::arf_get_mpfr(m,arb_midref(a.get_arb_t()),MPFR_RNDN);
+    *res = ::mpfr_get_ld(m,MPFR_RNDN);
+}
+
+// NOTE: integral conversions truncate the midpoint and saturate on overflow.
+template <long Prec>
+inline void eval_convert_to(long long *res, const arbpp_backend<Prec> &a)
+{
+    if (!::arf_is_finite(arb_midref(a.get_arb_t()))) {
+        throw std::domain_error("cannot convert a non-finite value to an integral type");
+    }
+    detail::fmpz_raii f;
+    ::arf_get_fmpz(f,arb_midref(a.get_arb_t()),ARF_RND_DOWN);
+    // NOTE: the only value with more bits than long long which fits is its minimum, where we saturate anyway.
+    if (::fmpz_bits(f) > static_cast<unsigned>(std::numeric_limits<long long>::digits)) {
+        *res = (::fmpz_sgn(f) > 0) ? std::numeric_limits<long long>::max() : std::numeric_limits<long long>::min();
+    } else {
+        const long long m = static_cast<long long>(detail::fmpz_abs_get_ull(f));
+        *res = (::fmpz_sgn(f) < 0) ? -m : m;
+    }
+}
+
+template <long Prec>
+inline void eval_convert_to(unsigned long long *res, const arbpp_backend<Prec> &a)
+{
+    if (!::arf_is_finite(arb_midref(a.get_arb_t()))) {
+        throw std::domain_error("cannot convert a non-finite value to an integral type");
+    }
+    detail::fmpz_raii f;
+    ::arf_get_fmpz(f,arb_midref(a.get_arb_t()),ARF_RND_DOWN);
+    if (::fmpz_sgn(f) < 0) {
+        *res = 0u;
+    } else if (::fmpz_bits(f) <= static_cast<unsigned>(std::numeric_limits<unsigned long long>::digits)) {
+        *res = detail::fmpz_abs_get_ull(f);
+    } else {
+        *res = std::numeric_limits<unsigned long long>::max();
+    }
+}
+
+// Write a as r * 2**e, with the midpoint of r in [1/2,1).
+template <long Prec>
+inline void eval_frexp(arbpp_backend<Prec> &r, const arbpp_backend<Prec> &a, long *e)
+{
+    const ::arf_struct *mid = arb_midref(a.get_arb_t());
+    if (::arf_is_special(mid)) {
+        *e = 0;
+        r = a;
+        return;
+    }
+    if (!::fmpz_fits_si(ARF_EXPREF(mid))) {
+        throw std::overflow_error("exponent overflow in frexp()");
+    }
+    const long exp = ::fmpz_get_si(ARF_EXPREF(mid));
+    ::arb_mul_2exp_si(r.get_arb_t(),a.get_arb_t(),-exp);
+    *e = exp;
+}
+
+template <long Prec>
+inline void eval_frexp(arbpp_backend<Prec> &r, const arbpp_backend<Prec> &a, int *e)
+{
+    long tmp;
+    eval_frexp(r,a,&tmp);
+    if (tmp > std::numeric_limits<int>::max() || tmp < std::numeric_limits<int>::min()) {
+        throw std::overflow_error("exponent overflow in frexp()");
+    }
+    *e = static_cast<int>(tmp);
+}
+
+template <long Prec>
+inline void eval_ldexp(arbpp_backend<Prec> &r, const arbpp_backend<Prec> &a, long e)
+{
+    ::arb_mul_2exp_si(r.get_arb_t(),a.get_arb_t(),e);
+}
+
+template <long Prec>
+inline void eval_floor(arbpp_backend<Prec> &r, const arbpp_backend<Prec> &a)
+{
+    ::arb_floor(r.get_arb_t(),a.get_arb_t(),Prec);
+}
+
+template <long Prec>
+inline void eval_ceil(arbpp_backend<Prec> &r, const arbpp_backend<Prec> &a)
+{
+    ::arb_ceil(r.get_arb_t(),a.get_arb_t(),Prec);
+}
+
+template <long Prec>
+inline void eval_abs(arbpp_backend<Prec> &r, const arbpp_backend<Prec> &a)
+{
+    ::arb_abs(r.get_arb_t(),a.get_arb_t());
+}
+
+template <long Prec>
+inline void eval_fabs(arbpp_backend<Prec> &r, const arbpp_backend<Prec> &a)
+{
+    ::arb_abs(r.get_arb_t(),a.get_arb_t());
+}
+
+// Elementary functions, computed rigorously by Arb.
+template <long Prec>
+inline void eval_sqrt(arbpp_backend<Prec> &r, const arbpp_backend<Prec> &a)
+{
+    ::arb_sqrt(r.get_arb_t(),a.get_arb_t(),Prec);
+}
+
+template <long Prec>
+inline void eval_cos(arbpp_backend<Prec> &r, const arbpp_backend<Prec> &a)
+{
+    ::arb_cos(r.get_arb_t(),a.get_arb_t(),Prec);
+}
+
+template <long Prec>
+inline void eval_sin(arbpp_backend<Prec> &r, const arbpp_backend<Prec> &a)
+{
+    ::arb_sin(r.get_arb_t(),a.get_arb_t(),Prec);
+}
+
+template <long Prec>
+inline void eval_exp(arbpp_backend<Prec> &r, const arbpp_backend<Prec> &a)
+{
+    ::arb_exp(r.get_arb_t(),a.get_arb_t(),Prec);
+}
+
+template <long Prec>
+inline void eval_log(arbpp_backend<Prec> &r, const arbpp_backend<Prec> &a)
+{
+    ::arb_log(r.get_arb_t(),a.get_arb_t(),Prec);
+}
+
+}
+
+namespace boost
+{
+
+namespace multiprecision
+{
+
+template <long Prec>
+struct number_category<arbpp::arbpp_backend<Prec>>: std::integral_constant<int,number_kind_floating_point> {};
+
+}
+
+}
+
+namespace std
+{
+
+/// Specialisation of \p std::numeric_limits for arbpp::arbpp_backend.
+/**
+ * The exponent range of arbpp::arb is unbounded, hence \p min(), \p max() and \p lowest() return zero,
+ * as for the other unbounded types.
+ */
+template <long Prec, boost::multiprecision::expression_template_option ET>
+class numeric_limits<boost::multiprecision::number<arbpp::arbpp_backend<Prec>,ET>>
+{
+        typedef boost::multiprecision::number<arbpp::arbpp_backend<Prec>,ET> number_type;
+    public:
+        static const bool is_specialized = true;
+        static const int digits = static_cast<int>(Prec);
+        // NOTE: 301/1000 is a lower bound for log10(2).
+        static const int digits10 = static_cast<int>((Prec - 1) * 301 / 1000);
+        static const int max_digits10 = static_cast<int>(Prec * 301 / 1000 + 2);
+        static const bool is_signed = true;
+        static const bool is_integer = false;
+        static const bool is_exact = false;
+        static const int radix = 2;
+        static const int min_exponent = 0;
+        static const int min_exponent10 = 0;
+        static const int max_exponent = 0;
+        static const int max_exponent10 = 0;
+        static const bool has_infinity = true;
+        static const bool has_quiet_NaN = true;
+        static const bool has_signaling_NaN = false;
+        static const float_denorm_style has_denorm = denorm_absent;
+        static const bool has_denorm_loss = false;
+        static const bool is_iec559 = false;
+        static const bool is_bounded = false;
+        static const bool is_modulo = false;
+        static const bool traps = false;
+        static const bool tinyness_before = false;
+        static const float_round_style round_style = round_to_nearest;
+        static number_type min()
+        {
+            return number_type();
+        }
+        static number_type max()
+        {
+            return number_type();
+        }
+        static number_type lowest()
+        {
+            return number_type();
+        }
+        static number_type epsilon()
+        {
+            number_type retval(1);
+            ::arb_mul_2exp_si(retval.backend().get_arb_t(),retval.backend().get_arb_t(),1 - Prec);
+            return retval;
+        }
+        static number_type round_error()
+        {
+            number_type retval(1);
+            ::arb_mul_2exp_si(retval.backend().get_arb_t(),retval.backend().get_arb_t(),-1);
+            return retval;
+        }
+        static number_type infinity()
+        {
+            number_type retval;
+            ::arf_pos_inf(arb_midref(retval.backend().get_arb_t()));
+            return retval;
+        }
+        static number_type quiet_NaN()
+        {
+            number_type retval;
+            ::arf_nan(arb_midref(retval.backend().get_arb_t()));
+            return retval;
+        }
+        static number_type signaling_NaN()
+        {
+            return number_type();
+        }
+        static number_type denorm_min()
+        {
+            return number_type();
+        }
+};
+
+template <long Prec, boost::multiprecision::expression_template_option ET>
+const bool numeric_limits<boost::multiprecision::number<arbpp::arbpp_backend<Prec>,ET>>::is_specialized;
+
+template <long Prec, boost::multiprecision::expression_template_option ET>
+const int numeric_limits<boost::multiprecision::number<arbpp::arbpp_backend<Prec>,ET>>::digits;
+
+template <long Prec, boost::multiprecision::expression_template_option ET>
+const int numeric_limits<boost::multiprecision::number<arbpp::arbpp_backend<Prec>,ET>>::digits10;
+
+template <long Prec, boost::multiprecision::expression_template_option ET>
+const int numeric_limits<boost::multiprecision::number<arbpp::arbpp_backend<Prec>,ET>>::max_digits10;
+
+template <long Prec, boost::multiprecision::expression_template_option ET>
+const bool numeric_limits<boost::multiprecision::number<arbpp::arbpp_backend<Prec>,ET>>::is_signed;
+
+template <long Prec, boost::multiprecision::expression_template_option ET>
+const bool numeric_limits<boost::multiprecision::number<arbpp::arbpp_backend<Prec>,ET>>::is_integer;
+
+template <long Prec, boost::multiprecision::expression_template_option ET>
+const bool numeric_limits<boost::multiprecision::number<arbpp::arbpp_backend<Prec>,ET>>::is_exact;
+
+template <long Prec, boost::multiprecision::expression_template_option ET>
+const int numeric_limits<boost::multiprecision::number<arbpp::arbpp_backend<Prec>,ET>>::radix;
+
+template <long Prec, boost::multiprecision::expression_template_option ET>
+const int numeric_limits<boost::multiprecision::number<arbpp::arbpp_backend<Prec>,ET>>::min_exponent;
+
+template <long Prec, boost::multiprecision::expression_template_option ET>
+const int numeric_limits<boost::multiprecision::number<arbpp::arbpp_backend<Prec>,ET>>::min_exponent10;
+
+template <long Prec, boost::multiprecision::expression_template_option ET>
+const int numeric_limits<boost::multiprecision::number<arbpp::arbpp_backend<Prec>,ET>>::max_exponent;
+
+template <long Prec, boost::multiprecision::expression_template_option ET>
+const int numeric_limits<boost::multiprecision::number<arbpp::arbpp_backend<Prec>,ET>>::max_exponent10;
+
+template <long Prec, boost::multiprecision::expression_template_option ET>
+const bool numeric_limits<boost::multiprecision::number<arbpp::arbpp_backend<Prec>,ET>>::has_infinity;
+
+template <long Prec, boost::multiprecision::expression_template_option ET>
+const bool numeric_limits<boost::multiprecision::number<arbpp::arbpp_backend<Prec>,ET>>::has_quiet_NaN;
+
+template <long Prec, boost::multiprecision::expression_template_option ET>
+const bool numeric_limits<boost::multiprecision::number<arbpp::arbpp_backend<Prec>,ET>>::has_signaling_NaN;
+
+template <long Prec, boost::multiprecision::expression_template_option ET>
+const float_denorm_style numeric_limits<boost::multiprecision::number<arbpp::arbpp_backend<Prec>,ET>>::has_denorm;
+
+template <long Prec, boost::multiprecision::expression_template_option ET>
+const bool numeric_limits<boost::multiprecision::number<arbpp::arbpp_backend<Prec>,ET>>::has_denorm_loss;
+
+template <long Prec, boost::multiprecision::expression_template_option ET>
+const bool numeric_limits<boost::multiprecision::number<arbpp::arbpp_backend<Prec>,ET>>::is_iec559;
+
+template <long Prec, boost::multiprecision::expression_template_option ET>
+const bool numeric_limits<boost::multiprecision::number<arbpp::arbpp_backend<Prec>,ET>>::is_bounded;
+
+template <long Prec, boost::multiprecision::expression_template_option ET>
+const bool numeric_limits<boost::multiprecision::number<arbpp::arbpp_backend<Prec>,ET>>::is_modulo;
+
+template <long Prec, boost::multiprecision::expression_template_option ET>
+const bool numeric_limits<boost::multiprecision::number<arbpp::arbpp_backend<Prec>,ET>>::traps;
+
+template <long Prec, boost::multiprecision::expression_template_option ET>
+const bool numeric_limits<boost::multiprecision::number<arbpp::arbpp_backend<Prec>,ET>>::tinyness_before;
+
+template <long Prec, boost::multiprecision::expression_template_option ET>
+const float_round_style numeric_limits<boost::multiprecision::number<arbpp::arbpp_backend<Prec>,ET>>::round_style;
+
+}
+
+#endif
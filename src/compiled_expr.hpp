@@ -0,0 +1,711 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#ifndef ARBPP_COMPILED_EXPR_HPP
+#define ARBPP_COMPILED_EXPR_HPP
+
+#include <algorithm>
+#include <arb.h>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mpfr.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "arbpp.hpp"
+
+namespace arbpp
+{
+
+/// Compiled expression.
+/**
+ * This class parses a formula once and compiles it into a linear sequence of instructions operating on a fixed set
+ * of registers. Each evaluation runs the instructions as in-place Arb calls on the registers, which are allocated
+ * once at construction and reused, so that the evaluation of an expression does not construct any temporary
+ * arbpp::arb (after the first evaluation has grown the limbs of the registers, it typically does not allocate
+ * at all).
+ *
+ * The compiler:
+ * - merges common subexpressions and folds the subexpressions which depend only on constants;
+ * - fuses the sums of the form <tt>c + a*b</tt> and <tt>c - a*b</tt> into a single multiply-accumulate
+ *   (<tt>arb_addmul()</tt> / <tt>arb_submul()</tt>), which updates \p c in place when \p c is not needed anymore;
+ * - removes the dead code and assigns the registers by liveness, so that a register is reused as soon as the value
+ *   it holds is dead.
+ *
+ * ## Syntax ##
+ *
+ * Formulas are made of decimal numbers (with the syntax accepted by the constructor of arbpp::arb from string),
+ * the variables passed on construction, the constant \p pi, the binary operators <tt>+ - * / ^</tt>,
+ * unary plus and minus, parentheses and the functions \p sqrt, \p abs, \p exp, \p log, \p sin, \p cos, \p tan and
+ * \p atan. The usual precedence rules apply, and <tt>^</tt> is right-associative and binds more tightly than
+ * unary minus (<tt>-x^2</tt> is <tt>-(x^2)</tt>). Integral exponents are evaluated by repeated squaring.
+ *
+ * ## Thread safety ##
+ *
+ * Evaluation mutates the registers: an object must not be evaluated concurrently from multiple threads. Copies
+ * are independent, and they are cheap compared to a compilation.
+ */
+class compiled_expr
+{
+        enum class opcode : unsigned char
+        {
+            mov, neg, add, sub, mul, div, sqr, pow_si, pow, addmul, submul, sqrt, abs, exp, log, sin, cos, tan, atan
+        };
+        static const char *opcode_name(opcode op)
+        {
+            static const char *names[] = {"mov","neg","add","sub","mul","div","sqr","pow_si","pow","addmul",
+                "submul","sqrt","abs","exp","log","sin","cos","tan","atan"};
+            return names[static_cast<std::size_t>(op)];
+        }
+        // Location of an operand.
+        enum class loc : unsigned char
+        {
+            none, reg, input, constant
+        };
+        struct operand
+        {
+            loc             l;
+            std::uint32_t   idx;
+        };
+        struct instruction
+        {
+            opcode          op;
+            std::uint32_t   dst;
+            operand         a;
+            operand         b;
+            operand         c;
+            long            imm;
+        };
+        // Node of the SSA graph built by the parser. Leaves are inputs and constants.
+        struct node
+        {
+            loc             l;
+            std::uint32_t   idx;
+            opcode          op;
+            std::size_t     args[3];
+            unsigned        n_args;
+            long            imm;
+            // Integral constants (used to detect integral exponents).
+            bool            integral;
+        };
+        // Execute a single instruction. For the multiply-accumulate instructions, the accumulator
+        // c is first copied into dst, unless it is already there.
+        static void exec(opcode op, ::arb_struct *dst, const ::arb_struct *a, const ::arb_struct *b,
+            const ::arb_struct *c, long imm, long prec)
+        {
+            switch (op) {
+                case opcode::mov:
+                    ::arb_set(dst,a);
+                    break;
+                case opcode::neg:
+                    ::arb_neg(dst,a);
+                    break;
+                case opcode::add:
+                    ::arb_add(dst,a,b,prec);
+                    break;
+                case opcode::sub:
+                    ::arb_sub(dst,a,b,prec);
+                    break;
+                case opcode::mul:
+                    ::arb_mul(dst,a,b,prec);
+                    break;
+                case opcode::div:
+                    ::arb_div(dst,a,b,prec);
+                    break;
+                case opcode::sqr:
+                    ::arb_sqr(dst,a,prec);
+                    break;
+                case opcode::pow_si:
+                    ::arb_pow_ui(dst,a,static_cast<unsigned long>(imm < 0 ? -imm : imm),prec);
+                    if (imm < 0) {
+                        ::arb_inv(dst,dst,prec);
+                    }
+                    break;
+                case opcode::pow:
+                    ::arb_pow(dst,a,b,prec);
+                    break;
+                case opcode::addmul:
+                    if (dst != c) {
+                        ::arb_set(dst,c);
+                    }
+                    ::arb_addmul(dst,a,b,prec);
+                    break;
+                case opcode::submul:
+                    if (dst != c) {
+                        ::arb_set(dst,c);
+                    }
+                    ::arb_submul(dst,a,b,prec);
+                    break;
+                case opcode::sqrt:
+                    ::arb_sqrt(dst,a,prec);
+                    break;
+                case opcode::abs:
+                    ::arb_abs(dst,a);
+                    break;
+                case opcode::exp:
+                    ::arb_exp(dst,a,prec);
+                    break;
+                case opcode::log:
+                    ::arb_log(dst,a,prec);
+                    break;
+                case opcode::sin:
+                    ::arb_sin(dst,a,prec);
+                    break;
+                case opcode::cos:
+                    ::arb_cos(dst,a,prec);
+                    break;
+                case opcode::tan:
+                    ::arb_tan(dst,a,prec);
+                    break;
+                case opcode::atan:
+                    ::arb_atan(dst,a,prec);
+            }
+        }
+        // Recursive descent parser, building the SSA graph with common subexpression
+        // elimination and constant folding.
+        class parser
+        {
+            public:
+                parser(compiled_expr &e, const std::string &s, const std::vector<std::string> &vars):
+                    m_e(e),m_s(s),m_vars(vars),m_pos(0u) {}
+                std::size_t parse()
+                {
+                    const auto retval = expr();
+                    skip_ws();
+                    if (m_pos != m_s.size()) {
+                        error("unexpected character");
+                    }
+                    return retval;
+                }
+                std::vector<node> m_nodes;
+            private:
+                [[noreturn]] void error(const std::string &msg) const
+                {
+                    throw std::invalid_argument("invalid expression '" + m_s + "': " + msg + " at position " +
+                        std::to_string(m_pos));
+                }
+                void skip_ws()
+                {
+                    while (m_pos < m_s.size() && std::isspace(static_cast<unsigned char>(m_s[m_pos]))) {
+                        ++m_pos;
+                    }
+                }
+                bool accept(char c)
+                {
+                    skip_ws();
+                    if (m_pos < m_s.size() && m_s[m_pos] == c) {
+                        ++m_pos;
+                        return true;
+                    }
+                    return false;
+                }
+                bool is_const(std::size_t n) const
+                {
+                    return m_nodes[n].l == loc::constant;
+                }
+                std::size_t leaf(loc l, std::uint32_t idx, bool integral = false, long value = 0)
+                {
+                    const auto key = std::make_tuple(l,idx,opcode::mov,std::size_t(0u),std::size_t(0u),std::size_t(0u),0l);
+                    const auto it = m_cse.find(key);
+                    if (it != m_cse.end()) {
+                        return it->second;
+                    }
+                    m_nodes.push_back(node{l,idx,opcode::mov,{0u,0u,0u},0u,value,integral});
+                    m_cse.emplace(key,m_nodes.size() - 1u);
+                    return m_nodes.size() - 1u;
+                }
+                std::size_t constant(arb &&value, bool integral = false, long int_value = 0)
+                {
+                    m_e.m_consts.push_back(std::move(value));
+                    return leaf(loc::constant,static_cast<std::uint32_t>(m_e.m_consts.size() - 1u),integral,int_value);
+                }
+                std::size_t op(opcode o, std::size_t a, std::size_t b = 0u, std::size_t c = 0u, long imm = 0)
+                {
+                    static const unsigned arity[] = {1u,1u,2u,2u,2u,2u,1u,1u,2u,3u,3u,1u,1u,1u,1u,1u,1u,1u,1u};
+                    const unsigned n_args = arity[static_cast<std::size_t>(o)];
+                    // Constant folding.
+                    if (is_const(a) && (n_args < 2u || is_const(b)) && (n_args < 3u || is_const(c))) {
+                        if (o == opcode::neg && m_nodes[a].integral) {
+                            arb tmp{m_e.m_consts[m_nodes[a].idx]};
+                            tmp.negate();
+                            return constant(std::move(tmp),true,-m_nodes[a].imm);
+                        }
+                        arb tmp;
+                        auto cptr = [this](std::size_t n) {
+                            return m_e.m_consts[m_nodes[n].idx].get_arb_t();
+                        };
+                        exec(o,tmp.get_arb_t(),cptr(a),cptr(n_args > 1u ? b : a),cptr(n_args > 2u ? c : a),imm,
+                            m_e.m_prec);
+                        return constant(std::move(tmp));
+                    }
+                    if (n_args < 2u) {
+                        b = 0u;
+                    }
+                    if (n_args < 3u) {
+                        c = 0u;
+                    }
+                    const auto key = std::make_tuple(loc::none,std::uint32_t(0u),o,a,b,c,imm);
+                    const auto it = m_cse.find(key);
+                    if (it != m_cse.end()) {
+                        return it->second;
+                    }
+                    m_nodes.push_back(node{loc::none,0u,o,{a,b,c},n_args,imm,false});
+                    m_cse.emplace(key,m_nodes.size() - 1u);
+                    return m_nodes.size() - 1u;
+                }
+                std::size_t expr()
+                {
+                    auto retval = term();
+                    while (true) {
+                        if (accept('+')) {
+                            retval = op(opcode::add,retval,term());
+                        } else if (accept('-')) {
+                            retval = op(opcode::sub,retval,term());
+                        } else {
+                            return retval;
+                        }
+                    }
+                }
+                std::size_t term()
+                {
+                    auto retval = unary();
+                    while (true) {
+                        if (accept('*')) {
+                            retval = op(opcode::mul,retval,unary());
+                        } else if (accept('/')) {
+                            retval = op(opcode::div,retval,unary());
+                        } else {
+                            return retval;
+                        }
+                    }
+                }
+                std::size_t unary()
+                {
+                    if (accept('-')) {
+                        return op(opcode::neg,unary());
+                    }
+                    if (accept('+')) {
+                        return unary();
+                    }
+                    return power();
+                }
+                std::size_t power()
+                {
+                    const auto base = primary();
+                    if (!accept('^')) {
+                        return base;
+                    }
+                    const auto exponent = unary();
+                    if (m_nodes[exponent].l == loc::constant && m_nodes[exponent].integral) {
+                        const long n = m_nodes[exponent].imm;
+                        if (n == 1) {
+                            return base;
+                        }
+                        return n == 2 ? op(opcode::sqr,base) : op(opcode::pow_si,base,0u,0u,n);
+                    }
+                    return op(opcode::pow,base,exponent);
+                }
+                std::size_t primary()
+                {
+                    skip_ws();
+                    if (m_pos == m_s.size()) {
+                        error("unexpected end of input");
+                    }
+                    const char c = m_s[m_pos];
+                    if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+                        return number();
+                    }
+                    if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+                        const auto begin = m_pos;
+                        while (m_pos < m_s.size() && (std::isalnum(static_cast<unsigned char>(m_s[m_pos])) ||
+                            m_s[m_pos] == '_'))
+                        {
+                            ++m_pos;
+                        }
+                        const std::string name = m_s.substr(begin,m_pos - begin);
+                        if (accept('(')) {
+                            const auto arg = expr();
+                            if (!accept(')')) {
+                                error("expected ')'");
+                            }
+                            return op(function(name,begin),arg);
+                        }
+                        for (std::size_t i = 0u; i < m_vars.size(); ++i) {
+                            if (m_vars[i] == name) {
+                                return leaf(loc::input,static_cast<std::uint32_t>(i));
+                            }
+                        }
+                        if (name == "pi") {
+                            const auto it = m_literals.find(name);
+                            if (it != m_literals.end()) {
+                                return it->second;
+                            }
+                            arb tmp;
+                            ::arb_const_pi(tmp.get_arb_t(),m_e.m_prec);
+                            const auto retval = constant(std::move(tmp));
+                            m_literals.emplace(name,retval);
+                            return retval;
+                        }
+                        m_pos = begin;
+                        error("unknown identifier '" + name + "'");
+                    }
+                    if (accept('(')) {
+                        const auto retval = expr();
+                        if (!accept(')')) {
+                            error("expected ')'");
+                        }
+                        return retval;
+                    }
+                    error("unexpected character");
+                }
+                opcode function(const std::string &name, std::size_t pos)
+                {
+                    static const std::pair<const char *,opcode> functions[] = {{"sqrt",opcode::sqrt},
+                        {"abs",opcode::abs},{"exp",opcode::exp},{"log",opcode::log},{"sin",opcode::sin},
+                        {"cos",opcode::cos},{"tan",opcode::tan},{"atan",opcode::atan}};
+                    for (const auto &p: functions) {
+                        if (name == p.first) {
+                            return p.second;
+                        }
+                    }
+                    m_pos = pos;
+                    error("unknown function '" + name + "'");
+                }
+                std::size_t number()
+                {
+                    const auto begin = m_pos;
+                    bool integral = true;
+                    auto digits = [this]() {
+                        while (m_pos < m_s.size() && std::isdigit(static_cast<unsigned char>(m_s[m_pos]))) {
+                            ++m_pos;
+                        }
+                    };
+                    digits();
+                    if (m_pos < m_s.size() && m_s[m_pos] == '.') {
+                        integral = false;
+                        ++m_pos;
+                        digits();
+                    }
+                    if (m_pos < m_s.size() && (m_s[m_pos] == 'e' || m_s[m_pos] == 'E')) {
+                        integral = false;
+                        ++m_pos;
+                        if (m_pos < m_s.size() && (m_s[m_pos] == '+' || m_s[m_pos] == '-')) {
+                            ++m_pos;
+                        }
+                        digits();
+                    }
+                    const std::string lit = m_s.substr(begin,m_pos - begin);
+                    // NOTE: integral literals are exponents candidates only if they fit comfortably in a long.
+                    integral = integral && lit.size() < 10u;
+                    const auto it = m_literals.find(lit);
+                    if (it != m_literals.end()) {
+                        return it->second;
+                    }
+                    arb value{0};
+                    try {
+                        value = arb{lit,m_e.m_prec};
+                    } catch (const std::invalid_argument &) {
+                        m_pos = begin;
+                        error("invalid number '" + lit + "'");
+                    }
+                    const auto retval = constant(std::move(value),integral,integral ? std::stol(lit) : 0l);
+                    m_literals.emplace(lit,retval);
+                    return retval;
+                }
+                compiled_expr                       &m_e;
+                const std::string                   &m_s;
+                const std::vector<std::string>      &m_vars;
+                std::size_t                         m_pos;
+                std::map<std::tuple<loc,std::uint32_t,opcode,std::size_t,std::size_t,std::size_t,long>,
+                    std::size_t>                    m_cse;
+                // Numeric literals and named constants already parsed.
+                std::map<std::string,std::size_t>   m_literals;
+        };
+        // Multiply-accumulate fusion: c + a*b and c - a*b, when the product is not used elsewhere.
+        static void fuse(std::vector<node> &nodes, std::vector<std::size_t> &uses)
+        {
+            for (auto &n: nodes) {
+                if (n.l != loc::none || (n.op != opcode::add && n.op != opcode::sub)) {
+                    continue;
+                }
+                auto fusable = [&nodes,&uses](std::size_t i) {
+                    return nodes[i].l == loc::none && nodes[i].op == opcode::mul && uses[i] == 1u;
+                };
+                std::size_t prod, acc;
+                if (fusable(n.args[1u])) {
+                    prod = n.args[1u];
+                    acc = n.args[0u];
+                } else if (n.op == opcode::add && fusable(n.args[0u])) {
+                    prod = n.args[0u];
+                    acc = n.args[1u];
+                } else {
+                    continue;
+                }
+                n.op = (n.op == opcode::add) ? opcode::addmul : opcode::submul;
+                n.args[0u] = nodes[prod].args[0u];
+                n.args[1u] = nodes[prod].args[1u];
+                n.args[2u] = acc;
+                n.n_args = 3u;
+                // NOTE: the operands of the product are now used by the fused node instead.
+                uses[prod] = 0u;
+            }
+        }
+    public:
+        /// Constructor.
+        /**
+         * Compiles \p formula with respect to the variables in \p variables. The constants appearing in the formula
+         * are computed at precision \p prec, which is also the working precision of the evaluations.
+         *
+         * @param[in] formula formula to be compiled.
+         * @param[in] variables names of the variables, in the order of the arguments of the evaluation.
+         * @param[in] prec working precision.
+         *
+         * @throws std::invalid_argument if \p formula is invalid or \p prec is not a valid precision.
+         * @throws unspecified any exception thrown by memory allocation errors.
+         */
+        explicit compiled_expr(const std::string &formula, const std::vector<std::string> &variables = {},
+            long prec = arb::get_default_precision()):m_prec(prec),m_n_vars(variables.size()),m_result(0u)
+        {
+            if (prec < 1 || prec < MPFR_PREC_MIN || prec > MPFR_PREC_MAX) {
+                throw std::invalid_argument("invalid precision value");
+            }
+            parser p(*this,formula,variables);
+            const auto root = p.parse();
+            auto &nodes = p.m_nodes;
+            // Count the uses, the root counting as used by the caller.
+            std::vector<std::size_t> uses(nodes.size(),0u);
+            for (const auto &n: nodes) {
+                for (unsigned j = 0u; j < n.n_args; ++j) {
+                    ++uses[n.args[j]];
+                }
+            }
+            ++uses[root];
+            fuse(nodes,uses);
+            // Liveness: walk back from the root.
+            std::vector<char> live(nodes.size(),0);
+            live[root] = 1;
+            for (auto i = nodes.size(); i-- > 0u;) {
+                if (live[i] && nodes[i].l == loc::none) {
+                    for (unsigned j = 0u; j < nodes[i].n_args; ++j) {
+                        live[nodes[i].args[j]] = 1;
+                    }
+                }
+            }
+            std::vector<std::size_t> last_use(nodes.size(),0u);
+            for (std::size_t i = 0u; i < nodes.size(); ++i) {
+                if (live[i] && nodes[i].l == loc::none) {
+                    for (unsigned j = 0u; j < nodes[i].n_args; ++j) {
+                        last_use[nodes[i].args[j]] = i;
+                    }
+                }
+            }
+            last_use[root] = nodes.size();
+            // Register allocation and code generation.
+            std::vector<std::uint32_t> reg_of(nodes.size(),0u), free_regs;
+            std::uint32_t n_regs = 0u;
+            auto alloc = [&free_regs,&n_regs]() -> std::uint32_t {
+                if (free_regs.empty()) {
+                    return n_regs++;
+                }
+                const auto retval = free_regs.back();
+                free_regs.pop_back();
+                return retval;
+            };
+            auto to_operand = [&nodes,&reg_of](std::size_t n) {
+                return nodes[n].l == loc::none ? operand{loc::reg,reg_of[n]} : operand{nodes[n].l,nodes[n].idx};
+            };
+            if (nodes[root].l != loc::none) {
+                // Trivial expression.
+                m_code.push_back(instruction{opcode::mov,alloc(),to_operand(root),operand{loc::none,0u},
+                    operand{loc::none,0u},0});
+            }
+            for (std::size_t i = 0u; i < nodes.size(); ++i) {
+                const auto &n = nodes[i];
+                if (!live[i] || n.l != loc::none) {
+                    continue;
+                }
+                instruction ins{n.op,0u,to_operand(n.args[0u]),operand{loc::none,0u},operand{loc::none,0u},n.imm};
+                if (n.n_args > 1u) {
+                    ins.b = to_operand(n.args[1u]);
+                }
+                if (n.n_args > 2u) {
+                    ins.c = to_operand(n.args[2u]);
+                }
+                // Registers of the operands which die here.
+                std::vector<std::uint32_t> dying;
+                for (unsigned j = 0u; j < n.n_args; ++j) {
+                    const auto a = n.args[j];
+                    if (nodes[a].l == loc::none && last_use[a] == i &&
+                        std::find(dying.begin(),dying.end(),reg_of[a]) == dying.end())
+                    {
+                        dying.push_back(reg_of[a]);
+                    }
+                }
+                const bool mac = (n.op == opcode::addmul || n.op == opcode::submul);
+                if (mac && ins.c.l == loc::reg && last_use[n.args[2u]] == i) {
+                    // Accumulate in place.
+                    ins.dst = ins.c.idx;
+                    dying.erase(std::find(dying.begin(),dying.end(),ins.dst));
+                    free_regs.insert(free_regs.end(),dying.begin(),dying.end());
+                } else if (mac) {
+                    // The accumulator is copied into the destination before the product is computed:
+                    // the destination must not be the register of a factor.
+                    ins.dst = alloc();
+                    free_regs.insert(free_regs.end(),dying.begin(),dying.end());
+                } else {
+                    free_regs.insert(free_regs.end(),dying.begin(),dying.end());
+                    ins.dst = alloc();
+                }
+                reg_of[i] = ins.dst;
+                m_code.push_back(ins);
+            }
+            m_result = m_code.back().dst;
+            m_regs.resize(n_regs);
+        }
+        /// Evaluation.
+        /**
+         * \note
+         * The evaluation is performed at the precision of \p this, regardless of the precision of the arguments.
+         * The result is written into \p out, whose precision is set to the precision of \p this.
+         *
+         * @param[out] out return value.
+         * @param[in] args pointer to an array of at least get_n_variables() values, in the order of the variables
+         * passed on construction.
+         */
+        void evaluate(arb &out, const arb *args)
+        {
+            for (const auto &ins: m_code) {
+                exec(ins.op,m_regs[ins.dst].get_arb_t(),resolve(ins.a,args),resolve(ins.b,args),
+                    resolve(ins.c,args),ins.imm,m_prec);
+            }
+            if (out.get_precision() != m_prec) {
+                out.set_precision(m_prec);
+            }
+            ::arb_set(out.get_arb_t(),m_regs[m_result].get_arb_t());
+        }
+        /// Evaluation.
+        /**
+         * @param[in] args values of the variables, in the order of the variables passed on construction.
+         *
+         * @return the value of the expression.
+         *
+         * @throws std::invalid_argument if the size of \p args differs from the number of variables.
+         * @throws unspecified any exception thrown by memory allocation errors.
+         */
+        arb operator()(const std::vector<arb> &args)
+        {
+            if (args.size() != m_n_vars) {
+                throw std::invalid_argument("the number of arguments (" + std::to_string(args.size()) +
+                    ") differs from the number of variables (" + std::to_string(m_n_vars) + ")");
+            }
+            arb retval;
+            evaluate(retval,args.data());
+            return retval;
+        }
+        /// Precision getter.
+        /**
+         * @return the working precision of \p this.
+         */
+        long get_precision() const
+        {
+            return m_prec;
+        }
+        /// Number of variables.
+        /**
+         * @return the number of variables of the expression.
+         */
+        std::size_t get_n_variables() const
+        {
+            return m_n_vars;
+        }
+        /// Number of registers.
+        /**
+         * @return the number of registers used by the evaluation.
+         */
+        std::size_t get_n_registers() const
+        {
+            return m_regs.size();
+        }
+        /// Number of instructions.
+        /**
+         * @return the number of instructions run by an evaluation.
+         */
+        std::size_t get_n_instructions() const
+        {
+            return m_code.size();
+        }
+        /// Disassembly.
+        /**
+         * @return a human-readable listing of the compiled code, one instruction per line (for debugging purposes).
+         */
+        std::string disassemble() const
+        {
+            std::ostringstream oss;
+            auto print = [&oss](const operand &o) {
+                static const char prefixes[] = {'?','r','x','k'};
+                oss << prefixes[static_cast<std::size_t>(o.l)] << o.idx;
+            };
+            for (const auto &ins: m_code) {
+                oss << 'r' << ins.dst << " = " << opcode_name(ins.op) << ' ';
+                print(ins.a);
+                for (const auto o: {ins.b,ins.c}) {
+                    if (o.l != loc::none) {
+                        oss << ", ";
+                        print(o);
+                    }
+                }
+                if (ins.op == opcode::pow_si) {
+                    oss << ", " << ins.imm;
+                }
+                oss << '\n';
+            }
+            return oss.str();
+        }
+    private:
+        const ::arb_struct *resolve(const operand &o, const arb *args) const
+        {
+            switch (o.l) {
+                case loc::reg:
+                    return m_regs[o.idx].get_arb_t();
+                case loc::input:
+                    return args[o.idx].get_arb_t();
+                case loc::constant:
+                    return m_consts[o.idx].get_arb_t();
+                default:
+                    return nullptr;
+            }
+        }
+        long                        m_prec;
+        std::size_t                 m_n_vars;
+        std::uint32_t               m_result;
+        std::vector<instruction>    m_code;
+        std::vector<arb>            m_regs;
+        std::vector<arb>            m_consts;
+};
+
+}
+
+#endif
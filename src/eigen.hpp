@@ -0,0 +1,277 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#ifndef ARBPP_EIGEN_HPP
+#define ARBPP_EIGEN_HPP
+
+#include <Eigen/Core>
+#include <arb.h>
+#include <arf.h>
+
+#include "arbpp.hpp"
+
+// NOTE: this header makes arbpp::arb usable as the scalar type of Eigen's dense matrices. Besides the
+// NumTraits specialisation, it hooks into Eigen's packet primitives and into the traits of the blocked
+// matrix product kernel (Eigen >= 3.4), so that the inner loops of products, LU and QR accumulate
+// in place via arb_addmul() instead of going through a temporary product and a temporary sum
+// (two allocations and two roundings per step).
+
+namespace arbpp
+{
+
+namespace detail
+{
+
+// Ball of radius zero centred on 2**e.
+inline arb eigen_pow2(long e)
+{
+    arb retval{1};
+    ::arb_mul_2exp_si(retval.get_arb_t(),retval.get_arb_t(),e);
+    return retval;
+}
+
+#if defined(ARBPP_ENABLE_TRACING)
+
+// Traces the calls of the blocked matrix product kernel. The kernel instantiates its traits once per call, and
+// then copies them around or instantiates them again in the inner loops: only the outermost instance on each
+// thread records a span.
+class eigen_kernel_span
+{
+    public:
+        eigen_kernel_span():m_owner(!is_open()),m_span(m_owner ? "eigen::gebp_kernel" : nullptr)
+        {
+            if (m_owner) {
+                is_open() = true;
+            }
+        }
+        eigen_kernel_span(const eigen_kernel_span &):m_owner(false),m_span(nullptr) {}
+        eigen_kernel_span &operator=(const eigen_kernel_span &)
+        {
+            return *this;
+        }
+        ~eigen_kernel_span()
+        {
+            if (m_owner) {
+                is_open() = false;
+            }
+        }
+    private:
+        static bool &is_open()
+        {
+            static thread_local bool retval = false;
+            return retval;
+        }
+        const bool      m_owner;
+        tracing::span   m_span;
+};
+
+#endif
+
+}
+
+}
+
+namespace Eigen
+{
+
+/// Numerical traits for arbpp::arb.
+/**
+ * The precision-dependent quantities (epsilon, dummy precision, number of decimal digits) are
+ * computed from the current default precision, as returned by arbpp::arb::get_default_precision().
+ */
+template <>
+struct NumTraits<arbpp::arb>: GenericNumTraits<arbpp::arb>
+{
+    typedef arbpp::arb Real;
+    typedef arbpp::arb NonInteger;
+    typedef arbpp::arb Literal;
+    typedef arbpp::arb Nested;
+    enum {
+        IsComplex = 0,
+        IsInteger = 0,
+        IsSigned = 1,
+        RequireInitialization = 1,
+        ReadCost = 1,
+        AddCost = 10,
+        MulCost = 40
+    };
+    static Real epsilon()
+    {
+        return arbpp::detail::eigen_pow2(1 - arbpp::arb::get_default_precision());
+    }
+    static Real dummy_precision()
+    {
+        // Same choice as Eigen's own MPFR support: use 90% of the bits.
+        return arbpp::detail::eigen_pow2(1 - (arbpp::arb::get_default_precision() * 90) / 100);
+    }
+    static int digits10()
+    {
+        // log10(2) ~ 0.30103.
+        return static_cast<int>(((arbpp::arb::get_default_precision() - 1) * 30103l) / 100000l);
+    }
+    static Real highest()
+    {
+        Real retval;
+        ::arb_pos_inf(retval.get_arb_t());
+        return retval;
+    }
+    static Real lowest()
+    {
+        Real retval;
+        ::arb_neg_inf(retval.get_arb_t());
+        return retval;
+    }
+    static Real infinity()
+    {
+        return highest();
+    }
+    static Real quiet_NaN()
+    {
+        Real retval;
+        ::arb_indeterminate(retval.get_arb_t());
+        return retval;
+    }
+};
+
+namespace numext
+{
+
+// Eigen uses these to skip work on exact zeroes and similar representational checks. The comparison
+// operators of arb are certified (and return a tribool), here instead we need identity of the balls:
+// a ball that merely overlaps zero must not be skipped.
+template <>
+inline bool equal_strict<arbpp::arb,arbpp::arb>(const arbpp::arb &x, const arbpp::arb &y)
+{
+    return ::arb_equal(x.get_arb_t(),y.get_arb_t()) != 0;
+}
+
+template <>
+inline bool not_equal_strict<arbpp::arb,arbpp::arb>(const arbpp::arb &x, const arbpp::arb &y)
+{
+    return ::arb_equal(x.get_arb_t(),y.get_arb_t()) == 0;
+}
+
+}
+
+namespace internal
+{
+
+// Fused multiply-add used by Eigen's scalar fallbacks of the packet primitives
+// (matrix-vector products, triangular solves, etc.).
+template <>
+inline arbpp::arb pmadd<arbpp::arb>(const arbpp::arb &a, const arbpp::arb &b, const arbpp::arb &c)
+{
+    arbpp::arb retval{c};
+    retval.addmul(a,b);
+    return retval;
+}
+
+#if EIGEN_VERSION_AT_LEAST(3,4,0)
+
+// Traits for the blocked matrix-matrix product kernel. The generic version returns the accumulators
+// by value, we update them in place instead. arb is never vectorised, so all packets are scalars.
+// NOTE: the conjugation flags are irrelevant for a real type.
+template <bool ConjLhs_, bool ConjRhs_, int Arch, int PacketSize_>
+class gebp_traits<arbpp::arb,arbpp::arb,ConjLhs_,ConjRhs_,Arch,PacketSize_>
+{
+    public:
+        typedef arbpp::arb LhsScalar;
+        typedef arbpp::arb RhsScalar;
+        typedef arbpp::arb ResScalar;
+        enum {
+            ConjLhs = ConjLhs_,
+            ConjRhs = ConjRhs_,
+            Vectorizable = false,
+            LhsPacketSize = 1,
+            RhsPacketSize = 1,
+            ResPacketSize = 1,
+            NumberOfRegisters = EIGEN_ARCH_DEFAULT_NUMBER_OF_REGISTERS,
+            nr = 4,
+            default_mr = EIGEN_PLAIN_ENUM_MIN(16,NumberOfRegisters) / 2 / nr,
+            mr = default_mr,
+            LhsProgress = 1,
+            RhsProgress = 1
+        };
+        typedef arbpp::arb LhsPacket;
+        typedef arbpp::arb RhsPacket;
+        typedef arbpp::arb ResPacket;
+        typedef LhsPacket LhsPacket4Packing;
+        typedef QuadPacket<RhsPacket> RhsPacketx4;
+        typedef ResPacket AccPacket;
+        void initAcc(AccPacket &p) const
+        {
+            p = AccPacket{};
+        }
+        void loadRhs(const RhsScalar *b, RhsPacket &dest) const
+        {
+            dest = *b;
+        }
+        void loadRhs(const RhsScalar *b, RhsPacketx4 &dest) const
+        {
+            dest.B_0 = b[0];
+            dest.B1 = b[1];
+            dest.B2 = b[2];
+            dest.B3 = b[3];
+        }
+        void updateRhs(const RhsScalar *b, RhsPacket &dest) const
+        {
+            loadRhs(b,dest);
+        }
+        void updateRhs(const RhsScalar *, RhsPacketx4 &) const {}
+        void loadRhsQuad(const RhsScalar *b, RhsPacket &dest) const
+        {
+            dest = *b;
+        }
+        void loadLhs(const LhsScalar *a, LhsPacket &dest) const
+        {
+            dest = *a;
+        }
+        void loadLhsUnaligned(const LhsScalar *a, LhsPacket &dest) const
+        {
+            dest = *a;
+        }
+        template <typename LaneIdType>
+        void madd(const LhsPacket &a, const RhsPacket &b, AccPacket &c, RhsPacket &, const LaneIdType &) const
+        {
+            c.addmul(a,b);
+        }
+        template <typename LaneIdType>
+        void madd(const LhsPacket &a, const RhsPacketx4 &b, AccPacket &c, RhsPacket &, const LaneIdType &lane) const
+        {
+            c.addmul(a,b.get(lane));
+        }
+        void acc(const AccPacket &c, const ResPacket &alpha, ResPacket &r) const
+        {
+            r.addmul(c,alpha);
+        }
+#if defined(ARBPP_ENABLE_TRACING)
+    private:
+        arbpp::detail::eigen_kernel_span m_trace;
+#endif
+};
+
+#endif
+
+}
+
+}
+
+#endif
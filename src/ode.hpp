@@ -0,0 +1,767 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#ifndef ARBPP_ODE_HPP
+#define ARBPP_ODE_HPP
+
+#include <algorithm>
+#include <arb.h>
+#include <arb_poly.h>
+#include <arf.h>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "arbpp.hpp"
+
+namespace arbpp
+{
+
+/// Truncated power series.
+/**
+ * A power series in one variable \f$ x \f$ with arbpp::arb coefficients, known modulo \f$ x^n \f$, where \f$ n \f$
+ * is the length of the series. The arithmetic operators and the functions (cos(), sin(), exp(), log(), sqrt())
+ * are implemented on top of the series arithmetic of Arb's \p arb_poly module, and the mixed operations with arbpp::arb
+ * and with the types interoperable with it are supported. The result of a binary operation between two series has
+ * the minimum length and the maximum precision of the operands.
+ *
+ * The series are the building block of arbpp::ode_solve(), which evaluates the right-hand side of the ODE system over
+ * them in order to generate the Taylor expansions of the solution.
+ */
+class arb_series: public detail::arb_scalar_ops<arb_series>
+{
+        friend class detail::arb_scalar_ops<arb_series>;
+        // Tag for the constructor of the zero series.
+        struct zero_tag {};
+        arb_series(long length, long prec, zero_tag):m_len(length),m_prec(prec)
+        {
+            ::arb_poly_init(m_poly);
+        }
+        static void check_length(long length)
+        {
+            if (length <= 0) {
+                throw std::invalid_argument("the length of a series must be positive, but it is " +
+                    std::to_string(length));
+            }
+        }
+        // Zero series for the result of a binary operation between a and b.
+        static arb_series result(const arb_series &a, const arb_series &b)
+        {
+            return arb_series(std::min(a.m_len,b.m_len),std::max(a.m_prec,b.m_prec),zero_tag{});
+        }
+        void set_indeterminate()
+        {
+            arb x;
+            ::arb_indeterminate(x.get_arb_t());
+            for (long i = 0; i < m_len; ++i) {
+                ::arb_poly_set_coeff_arb(m_poly,i,x.get_arb_t());
+            }
+        }
+        // Implementation of the mixed operations.
+        void add_scalar(const arb &x, long prec)
+        {
+            m_prec = prec;
+            arb c;
+            ::arb_poly_get_coeff_arb(c.get_arb_t(),m_poly,0);
+            ::arb_add(c.get_arb_t(),c.get_arb_t(),x.get_arb_t(),m_prec);
+            ::arb_poly_set_coeff_arb(m_poly,0,c.get_arb_t());
+        }
+        void mul_scalar(const arb &x, long prec)
+        {
+            m_prec = prec;
+            ::arb_poly_scalar_mul(m_poly,m_poly,x.get_arb_t(),m_prec);
+        }
+        void div_scalar(const arb &x, long prec)
+        {
+            m_prec = prec;
+            ::arb_poly_scalar_div(m_poly,m_poly,x.get_arb_t(),m_prec);
+        }
+        arb_series rdiv_scalar(const arb &x, long) const
+        {
+            return arb_series{x,m_len} / *this;
+        }
+        // Functions whose expansion is not defined for the zero series (Arb aborts on them).
+        template <typename Fn>
+        static arb_series nonzero_function(const arb_series &x, const Fn &fn)
+        {
+            arb_series retval(x.m_len,x.m_prec,zero_tag{});
+            if (::arb_poly_length(x.m_poly) == 0) {
+                retval.set_indeterminate();
+            } else {
+                fn(retval.m_poly,x.m_poly,x.m_len,x.m_prec);
+            }
+            return retval;
+        }
+    public:
+        /// Default constructor.
+        /**
+         * Initialises the zero series of length 1, with the default precision.
+         */
+        arb_series():arb_series(1,arb::get_default_precision(),zero_tag{}) {}
+        /// Copy constructor.
+        /**
+         * @param[in] other the series to be copied.
+         */
+        arb_series(const arb_series &other):arb_series(other.m_len,other.m_prec,zero_tag{})
+        {
+            ::arb_poly_set(m_poly,other.m_poly);
+        }
+        /// Move constructor.
+        /**
+         * @param[in] other the series to be moved.
+         */
+        arb_series(arb_series &&other) noexcept:arb_series(other.m_len,other.m_prec,zero_tag{})
+        {
+            ::arb_poly_swap(m_poly,other.m_poly);
+        }
+        /// Constant series.
+        /**
+         * @param[in] x the constant term.
+         * @param[in] length the length of the series.
+         *
+         * The precision of the series is the precision of \p x.
+         *
+         * @throws std::invalid_argument if \p length is not positive.
+         */
+        explicit arb_series(const arb &x, long length = 1):arb_series(length,x.get_precision(),zero_tag{})
+        {
+            check_length(length);
+            ::arb_poly_set_coeff_arb(m_poly,0,x.get_arb_t());
+        }
+        /// Destructor.
+        ~arb_series()
+        {
+            ::arb_poly_clear(m_poly);
+        }
+        /// Copy assignment operator.
+        /**
+         * @param[in] other the assignment argument.
+         *
+         * @return reference to \p this.
+         */
+        arb_series &operator=(const arb_series &other)
+        {
+            if (this != &other) {
+                ::arb_poly_set(m_poly,other.m_poly);
+                m_len = other.m_len;
+                m_prec = other.m_prec;
+            }
+            return *this;
+        }
+        /// Move assignment operator.
+        /**
+         * @param[in] other the assignment argument.
+         *
+         * @return reference to \p this.
+         */
+        arb_series &operator=(arb_series &&other) noexcept
+        {
+            if (this != &other) {
+                ::arb_poly_swap(m_poly,other.m_poly);
+                m_len = other.m_len;
+                m_prec = other.m_prec;
+            }
+            return *this;
+        }
+        /// Series of the variable.
+        /**
+         * @param[in] x the expansion point.
+         * @param[in] length the length of the series.
+         *
+         * @return the series <tt>x + 1 * x**1</tt> (just \p x if \p length is 1), with the precision of \p x.
+         *
+         * @throws std::invalid_argument if \p length is not positive.
+         */
+        static arb_series variable(const arb &x, long length)
+        {
+            arb_series retval{x,length};
+            if (length > 1) {
+                ::arb_poly_set_coeff_arb(retval.m_poly,1,arb{1}.get_arb_t());
+            }
+            return retval;
+        }
+        /// Length getter.
+        /**
+         * @return the length of the series.
+         */
+        long get_length() const
+        {
+            return m_len;
+        }
+        /// Precision getter.
+        /**
+         * @return the precision of the series.
+         */
+        long get_precision() const
+        {
+            return m_prec;
+        }
+        /// Length setter.
+        /**
+         * The coefficients beyond \p length are discarded. If \p length is greater than the current length, the new
+         * coefficients are zero.
+         *
+         * @param[in] length the new length.
+         *
+         * @throws std::invalid_argument if \p length is not positive.
+         */
+        void set_length(long length)
+        {
+            check_length(length);
+            ::arb_poly_truncate(m_poly,length);
+            m_len = length;
+        }
+        /// Coefficient getter.
+        /**
+         * @param[in] i the degree of the term.
+         *
+         * @return the coefficient of <tt>x**i</tt>.
+         *
+         * @throws std::invalid_argument if \p i is negative or not less than the length of the series.
+         */
+        arb get_coefficient(long i) const
+        {
+            if (i < 0 || i >= m_len) {
+                throw std::invalid_argument("invalid coefficient index " + std::to_string(i) + " for a series of length " +
+                    std::to_string(m_len));
+            }
+            arb retval;
+            retval.set_precision(m_prec);
+            ::arb_poly_get_coeff_arb(retval.get_arb_t(),m_poly,i);
+            return retval;
+        }
+        /// Evaluation.
+        /**
+         * @param[in] x the value of the variable.
+         *
+         * @return the sum of the known terms of the series at \p x.
+         */
+        arb evaluate(const arb &x) const
+        {
+            arb retval;
+            retval.set_precision(m_prec);
+            ::arb_poly_evaluate(retval.get_arb_t(),m_poly,x.get_arb_t(),m_prec);
+            return retval;
+        }
+        /// Get a const pointer to the internal \p arb_poly_struct.
+        /**
+         * @return const pointer to the internal \p arb_poly_struct.
+         */
+        const ::arb_poly_struct *get_arb_poly_t() const
+        {
+            return m_poly;
+        }
+        /// Get a mutable pointer to the internal \p arb_poly_struct.
+        /**
+         * The coefficients beyond the length of the series are ignored by the operations on \p this.
+         *
+         * @return pointer to the internal \p arb_poly_struct.
+         */
+        ::arb_poly_struct *get_arb_poly_t()
+        {
+            return m_poly;
+        }
+        /// Identity operator.
+        /**
+         * @return a copy of \p this.
+         */
+        arb_series operator+() const
+        {
+            return *this;
+        }
+        /// Negated copy.
+        /**
+         * @return a negated copy of \p this.
+         */
+        arb_series operator-() const
+        {
+            arb_series retval{*this};
+            ::arb_poly_neg(retval.m_poly,retval.m_poly);
+            return retval;
+        }
+        /// Addition.
+        /**
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         *
+         * @return <tt>a + b</tt>.
+         */
+        friend arb_series operator+(const arb_series &a, const arb_series &b)
+        {
+            arb_series retval = result(a,b);
+            ::arb_poly_add_series(retval.m_poly,a.m_poly,b.m_poly,retval.m_len,retval.m_prec);
+            return retval;
+        }
+        /// Subtraction.
+        /**
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         *
+         * @return <tt>a - b</tt>.
+         */
+        friend arb_series operator-(const arb_series &a, const arb_series &b)
+        {
+            arb_series retval = result(a,b);
+            ::arb_poly_sub_series(retval.m_poly,a.m_poly,b.m_poly,retval.m_len,retval.m_prec);
+            return retval;
+        }
+        /// Multiplication.
+        /**
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         *
+         * @return <tt>a * b</tt>.
+         */
+        friend arb_series operator*(const arb_series &a, const arb_series &b)
+        {
+            arb_series retval = result(a,b);
+            ::arb_poly_mullow(retval.m_poly,a.m_poly,b.m_poly,retval.m_len,retval.m_prec);
+            return retval;
+        }
+        /// Division.
+        /**
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         *
+         * @return <tt>a / b</tt>. The coefficients are indeterminate if the constant term of \p b contains zero.
+         */
+        friend arb_series operator/(const arb_series &a, const arb_series &b)
+        {
+            arb_series retval = result(a,b);
+            if (::arb_poly_length(b.m_poly) == 0) {
+                retval.set_indeterminate();
+            } else {
+                ::arb_poly_div_series(retval.m_poly,a.m_poly,b.m_poly,retval.m_len,retval.m_prec);
+            }
+            return retval;
+        }
+        /// Cosine.
+        /**
+         * @param[in] x argument.
+         *
+         * @return the cosine of \p x.
+         */
+        friend arb_series cos(const arb_series &x)
+        {
+            arb_series retval(x.m_len,x.m_prec,zero_tag{});
+            ::arb_poly_cos_series(retval.m_poly,x.m_poly,x.m_len,x.m_prec);
+            return retval;
+        }
+        /// Sine.
+        /**
+         * @param[in] x argument.
+         *
+         * @return the sine of \p x.
+         */
+        friend arb_series sin(const arb_series &x)
+        {
+            arb_series retval(x.m_len,x.m_prec,zero_tag{});
+            ::arb_poly_sin_series(retval.m_poly,x.m_poly,x.m_len,x.m_prec);
+            return retval;
+        }
+        /// Exponential.
+        /**
+         * @param[in] x argument.
+         *
+         * @return the exponential of \p x.
+         */
+        friend arb_series exp(const arb_series &x)
+        {
+            arb_series retval(x.m_len,x.m_prec,zero_tag{});
+            ::arb_poly_exp_series(retval.m_poly,x.m_poly,x.m_len,x.m_prec);
+            return retval;
+        }
+        /// Natural logarithm.
+        /**
+         * @param[in] x argument.
+         *
+         * @return the logarithm of \p x. The coefficients are indeterminate if the constant term of \p x is not
+         * positive.
+         */
+        friend arb_series log(const arb_series &x)
+        {
+            return nonzero_function(x,[](::arb_poly_struct *r, const ::arb_poly_struct *a, long n, long prec) {
+                ::arb_poly_log_series(r,a,n,prec);
+            });
+        }
+        /// Square root.
+        /**
+         * @param[in] x argument.
+         *
+         * @return the square root of \p x. The coefficients are indeterminate if the constant term of \p x is not
+         * positive.
+         */
+        friend arb_series sqrt(const arb_series &x)
+        {
+            return nonzero_function(x,[](::arb_poly_struct *r, const ::arb_poly_struct *a, long n, long prec) {
+                ::arb_poly_sqrt_series(r,a,n,prec);
+            });
+        }
+        /// Stream operator.
+        /**
+         * Prints the terms of the series, followed by the order of the truncation.
+         *
+         * @param[in,out] os target stream.
+         * @param[in] x arbpp::arb_series to be streamed.
+         *
+         * @return reference to \p os.
+         */
+        friend std::ostream &operator<<(std::ostream &os, const arb_series &x)
+        {
+            for (long i = 0; i < x.m_len; ++i) {
+                os << x.get_coefficient(i);
+                if (i > 0) {
+                    os << "*x";
+                    if (i > 1) {
+                        os << '^' << i;
+                    }
+                }
+                os << " + ";
+            }
+            os << "O(x^" << x.m_len << ')';
+            return os;
+        }
+    private:
+        ::arb_poly_t    m_poly;
+        long            m_len;
+        long            m_prec;
+};
+
+/// Result of arbpp::ode_solve().
+struct ode_solution
+{
+    /// Mesh of the integration, from the initial to the final time (exact balls).
+    std::vector<arb>                times;
+    /// Enclosures of the solution at the times of the mesh.
+    std::vector<std::vector<arb>>   values;
+    /// Enclosures of the solution over the steps (the i-th element covers <tt>[times[i],times[i + 1]]</tt>).
+    std::vector<std::vector<arb>>   enclosures;
+};
+
+namespace detail
+{
+
+// Scratch space of the integrator, allocated once and reused by all the steps: the series of the time and of the
+// solution, the values of the right-hand side, the Taylor coefficients at the start of the step, the balls of
+// the Picard iteration for the a priori enclosure and the coefficients of the remainder with the enclosure they
+// were computed over.
+struct ode_workspace
+{
+    arb_series                  t;
+    std::vector<arb_series>     y;
+    std::vector<arb_series>     f;
+    std::vector<arb_series>     coeffs;
+    std::vector<arb>            b;
+    std::vector<arb>            b_next;
+    std::vector<arb>            rem_coeffs;
+    std::vector<arb>            rem_b;
+    arb                         tmp;
+};
+
+template <typename F>
+inline void ode_call_rhs(const F &rhs, ode_workspace &ws)
+{
+    const ode_workspace &cws = ws;
+    ws.f = rhs(cws.t,cws.y);
+    if (ws.f.size() != ws.y.size()) {
+        throw std::invalid_argument("the right-hand side returned " + std::to_string(ws.f.size()) + " values, but the "
+            "system has " + std::to_string(ws.y.size()) + " equations");
+    }
+    for (const auto &s: ws.f) {
+        if (s.get_length() < ws.t.get_length()) {
+            throw std::invalid_argument("the right-hand side returned a series of length " +
+                std::to_string(s.get_length()) + ", but its arguments have length " +
+                std::to_string(ws.t.get_length()));
+        }
+    }
+}
+
+// Taylor expansion of the solution through (t0,y0), up to the term of degree length - 1, into ws.y. The expansion is
+// computed via Picard iteration on truncated power series: each pass of y <- y0 + integral(rhs(t0 + x,y)) makes one
+// more coefficient exact. If t0 and y0 are wide balls, the coefficients enclose the ones of all the solutions through
+// the points of (t0,y0).
+// NOTE: a Newton doubling of the number of exact coefficients would need the Jacobian of rhs, which is not
+// available through the series interface.
+template <typename F>
+inline void ode_expand(const F &rhs, const arb &t0, const std::vector<arb> &y0, long length, long prec, ode_workspace &ws)
+{
+    ws.y.resize(y0.size());
+    for (std::size_t i = 0u; i < y0.size(); ++i) {
+        ws.y[i] = arb_series{y0[i]};
+    }
+    for (long len = 2; len <= length; ++len) {
+        ws.t = arb_series::variable(t0,len);
+        for (auto &s: ws.y) {
+            s.set_length(len);
+        }
+        ode_call_rhs(rhs,ws);
+        for (std::size_t i = 0u; i < y0.size(); ++i) {
+            ::arb_poly_integral(ws.y[i].get_arb_poly_t(),ws.f[i].get_arb_poly_t(),prec);
+            ::arb_poly_truncate(ws.y[i].get_arb_poly_t(),len);
+            ::arb_poly_set_coeff_arb(ws.y[i].get_arb_poly_t(),0,y0[i].get_arb_t());
+        }
+    }
+}
+
+// A priori enclosure of the solution over the time range t_range of a step of size h, starting from y0, into ws.b.
+// If y0 + [0,h] * rhs(t_range,b) is contained in b, then the solution stays in b over the whole step (and in the
+// tighter y0 + [0,h] * rhs(t_range,b) as well). The iteration starts from y0, and the guess is inflated whenever
+// the containment fails. Returns false if the containment cannot be established.
+template <typename F>
+inline bool ode_enclosure(const F &rhs, const arb &t_range, const arb &h, const std::vector<arb> &y0, long prec,
+    ode_workspace &ws)
+{
+    const std::size_t n = y0.size();
+    arb h_range{0,prec};
+    ::arb_union(h_range.get_arb_t(),h_range.get_arb_t(),h.get_arb_t(),prec);
+    ws.t = arb_series{t_range};
+    ws.b = y0;
+    ws.b_next = y0;
+    ws.y.resize(n);
+    for (unsigned k = 0u; k < 10u; ++k) {
+        for (std::size_t i = 0u; i < n; ++i) {
+            ws.y[i] = arb_series{ws.b[i]};
+        }
+        ode_call_rhs(rhs,ws);
+        bool contained = true;
+        for (std::size_t i = 0u; i < n; ++i) {
+            ::arb_struct *c = ws.b_next[i].get_arb_t();
+            ::arb_poly_get_coeff_arb(c,ws.f[i].get_arb_poly_t(),0);
+            ::arb_mul(c,c,h_range.get_arb_t(),prec);
+            ::arb_add(c,c,y0[i].get_arb_t(),prec);
+            if (!::arb_is_finite(c)) {
+                return false;
+            }
+            contained = contained && ::arb_contains(ws.b[i].get_arb_t(),c);
+        }
+        if (contained) {
+            ws.b.swap(ws.b_next);
+            return true;
+        }
+        // Inflate the hull of the two guesses by 1/8 of its radius, plus a small absolute amount so that
+        // the point guesses can grow.
+        for (std::size_t i = 0u; i < n; ++i) {
+            ::arb_struct *c = ws.b[i].get_arb_t();
+            ::arb_union(c,c,ws.b_next[i].get_arb_t(),prec);
+            ::arb_get_rad_arb(ws.tmp.get_arb_t(),c);
+            ::arb_mul_2exp_si(ws.tmp.get_arb_t(),ws.tmp.get_arb_t(),-3);
+            ::arb_add_error(c,ws.tmp.get_arb_t());
+            ::arb_add_error_2exp_si(c,-prec / 2);
+        }
+    }
+    return false;
+}
+
+// Whether each ball of b is contained in the corresponding ball of a.
+inline bool ode_contains(const std::vector<arb> &a, const std::vector<arb> &b)
+{
+    for (std::size_t i = 0u; i < a.size(); ++i) {
+        if (!::arb_contains(a[i].get_arb_t(),b[i].get_arb_t())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// z = a + b, exactly (a and b are exact).
+inline void ode_exact_add(arb &z, const arb &a, const arb &b)
+{
+    ::arb_zero(z.get_arb_t());
+    ::arf_add(arb_midref(z.get_arb_t()),arb_midref(a.get_arb_t()),arb_midref(b.get_arb_t()),ARF_PREC_EXACT,ARF_RND_DOWN);
+}
+
+inline void ode_exact_sub(arb &z, const arb &a, const arb &b)
+{
+    ::arb_zero(z.get_arb_t());
+    ::arf_sub(arb_midref(z.get_arb_t()),arb_midref(a.get_arb_t()),arb_midref(b.get_arb_t()),ARF_PREC_EXACT,ARF_RND_DOWN);
+}
+
+inline double ode_abs_bound(const arb &x)
+{
+    if (!::arb_is_finite(x.get_arb_t())) {
+        return std::numeric_limits<double>::infinity();
+    }
+    arf_raii u;
+    ::arb_get_abs_ubound_arf(u,x.get_arb_t(),x.get_precision());
+    return ::arf_get_d(u,ARF_RND_UP);
+}
+
+}
+
+/// Validated ODE integration.
+/**
+ * Computes rigorous enclosures of the solution of the initial value problem \f$ y' = f(t,y) \f$, \f$ y(t_0) = y_0 \f$
+ * over \f$ [t_0,t_1] \f$ (or \f$ [t_1,t_0] \f$, for backward integration) via an interval Taylor series method. At
+ * each step:
+ * - the Taylor expansion of order \f$ p \f$ of the solution at the current time is generated by Picard iteration on
+ *   truncated power series (arbpp::arb_series);
+ * - the step size \f$ h \f$ is estimated from the magnitude of the last two coefficients of the expansion;
+ * - an a priori enclosure \f$ B \f$ of the solution over the step is found via the Picard operator, checking that
+ *   \f$ y(t) + [0,h] f([t,t + h],B) \subseteq B \f$;
+ * - the Lagrange remainder is bounded by the coefficient of order \f$ p + 1 \f$ of the expansions through all
+ *   the points of \f$ [t,t + h] \times B \f$.
+ *
+ * If the a priori enclosure cannot be established, or if the remainder exceeds \p tolerance, the step is halved and
+ * tried again. The order \f$ p \f$ is chosen from \p tolerance as \f$ \lceil -\ln(\mathrm{tolerance}) / 2 \rceil + 1 \f$
+ * (between 4 and 60), which balances the number of steps with the cost of each of them. The series and the balls
+ * used by the steps live in a workspace which is allocated once for the whole integration.
+ *
+ * \p rhs is called with the series of the time (an <tt>const arbpp::arb_series &</tt>) and the series of the
+ * components of the solution (a <tt>const std::vector<arbpp::arb_series> &</tt>), and it must return a
+ * <tt>std::vector<arbpp::arb_series></tt> with the series of the components of \f$ f \f$, computed via the
+ * operations of arbpp::arb_series. The returned series must not be shorter than the arguments: constant terms
+ * should be added via the mixed operations (e.g., <tt>y[0] + 1</tt>), or built with the length of the arguments.
+ *
+ * The enclosures are propagated directly as balls, so that their width grows with the wrapping effect: the method
+ * is best suited to problems which are not too sensitive to the initial conditions.
+ *
+ * @param[in] rhs the right-hand side of the system.
+ * @param[in] y0 the initial conditions.
+ * @param[in] t0 the initial time.
+ * @param[in] t1 the final time.
+ * @param[in] tolerance the maximum contribution of the remainder to the enclosure of each component at each step.
+ *
+ * @return the mesh of the integration, the enclosures of the solution at its times and the enclosures over the
+ * steps. The precision of the results is the maximum precision of \p y0, \p t0 and \p t1.
+ *
+ * @throws std::invalid_argument if \p y0 is empty, if \p t0 or \p t1 are not exact and finite, if \p tolerance
+ * is not positive or if \p rhs returns the wrong number of components or series which are too short.
+ * @throws std::runtime_error if the step size cannot be reduced enough to satisfy \p tolerance (e.g., because of a
+ * singularity of the solution).
+ * @throws unspecified any exception thrown by \p rhs or by memory allocation errors.
+ */
+template <typename F>
+inline ode_solution ode_solve(const F &rhs, const std::vector<arb> &y0, const arb &t0, const arb &t1, double tolerance)
+{
+    if (y0.empty()) {
+        throw std::invalid_argument("cannot integrate a system with no equations");
+    }
+    if (!::arb_is_exact(t0.get_arb_t()) || !::arb_is_finite(t0.get_arb_t()) ||
+        !::arb_is_exact(t1.get_arb_t()) || !::arb_is_finite(t1.get_arb_t()))
+    {
+        throw std::invalid_argument("the initial and final times must be exact and finite");
+    }
+    if (!(tolerance > 0.)) {
+        throw std::invalid_argument("the tolerance must be positive, but it is " + std::to_string(tolerance));
+    }
+    long prec = std::max(t0.get_precision(),t1.get_precision());
+    for (const auto &x: y0) {
+        prec = std::max(prec,x.get_precision());
+    }
+    const long order = std::min(std::max(static_cast<long>(std::ceil(-std::log(tolerance) / 2.)) + 1,4l),60l);
+    // Maximum number of halvings of the step size.
+    const unsigned max_halvings = 30u;
+    auto with_prec = [prec](const arb &x) {
+        arb retval{x};
+        retval.set_precision(prec);
+        return retval;
+    };
+    ode_solution retval;
+    arb t = with_prec(t0), t_end = with_prec(t1), t_next = with_prec(t0), remaining = with_prec(t0);
+    std::vector<arb> y;
+    for (const auto &x: y0) {
+        y.push_back(with_prec(x));
+    }
+    retval.times.push_back(t);
+    retval.values.push_back(y);
+    const bool forward = ::arf_cmp(arb_midref(t1.get_arb_t()),arb_midref(t0.get_arb_t())) >= 0;
+    detail::ode_workspace ws;
+    ws.tmp.set_precision(prec);
+    arb h{0,prec}, t_range{0,prec}, rem{0,prec};
+    std::vector<arb> rems(y.size(),rem);
+    ws.rem_coeffs.resize(y.size());
+    while (!::arb_equal(t.get_arb_t(),t_end.get_arb_t())) {
+        detail::ode_expand(rhs,t,y,order + 1,prec,ws);
+        ws.coeffs.swap(ws.y);
+        // Step size from the last two coefficients: |c_k| * h**k ~ tolerance.
+        double hd = std::numeric_limits<double>::infinity();
+        for (long k = order - 1; k <= order; ++k) {
+            double m = 0.;
+            for (const auto &c: ws.coeffs) {
+                m = std::max(m,detail::ode_abs_bound(c.get_coefficient(k)));
+            }
+            if (m > 0.) {
+                hd = std::min(hd,std::pow(tolerance / m,1. / static_cast<double>(k)));
+            }
+        }
+        hd *= .9;
+        detail::ode_exact_sub(remaining,t_end,t);
+        if (hd >= std::abs(remaining.get_midpoint())) {
+            h = remaining;
+        } else if (hd > 0.) {
+            ::arb_zero(h.get_arb_t());
+            ::arf_set_d(arb_midref(h.get_arb_t()),forward ? hd : -hd);
+        } else {
+            throw std::runtime_error("the Taylor coefficients of the solution are not finite at t = " +
+                std::to_string(t.get_midpoint()));
+        }
+        bool accepted = false, have_rem = false;
+        for (unsigned k = 0u; k <= max_halvings && !accepted; ++k) {
+            if (k > 0u) {
+                ::arb_mul_2exp_si(h.get_arb_t(),h.get_arb_t(),-1);
+            }
+            detail::ode_exact_add(t_next,t,h);
+            ::arb_union(t_range.get_arb_t(),t.get_arb_t(),t_next.get_arb_t(),prec);
+            if (!detail::ode_enclosure(rhs,t_range,h,y,prec,ws)) {
+                continue;
+            }
+            // Remainder: c_{p + 1}([t,t + h],B) * h**(p + 1). The coefficients computed for a longer step still
+            // enclose the ones over the halved step if the new enclosure is contained in the old one, in which
+            // case the expansion is not recomputed.
+            if (!have_rem || !detail::ode_contains(ws.rem_b,ws.b)) {
+                detail::ode_expand(rhs,t_range,ws.b,order + 2,prec,ws);
+                for (std::size_t i = 0u; i < y.size(); ++i) {
+                    ::arb_poly_get_coeff_arb(ws.rem_coeffs[i].get_arb_t(),ws.y[i].get_arb_poly_t(),order + 1);
+                }
+                ws.rem_b = ws.b;
+                have_rem = true;
+            }
+            ::arb_pow_ui(rem.get_arb_t(),h.get_arb_t(),static_cast<unsigned long>(order) + 1u,prec);
+            accepted = true;
+            for (std::size_t i = 0u; i < y.size(); ++i) {
+                ::arb_mul(rems[i].get_arb_t(),ws.rem_coeffs[i].get_arb_t(),rem.get_arb_t(),prec);
+                accepted = accepted && detail::ode_abs_bound(rems[i]) <= tolerance;
+            }
+        }
+        if (!accepted) {
+            throw std::runtime_error("the step size underflowed at t = " + std::to_string(t.get_midpoint()));
+        }
+        for (std::size_t i = 0u; i < y.size(); ++i) {
+            ::arb_poly_evaluate(y[i].get_arb_t(),ws.coeffs[i].get_arb_poly_t(),h.get_arb_t(),prec);
+            ::arb_add(y[i].get_arb_t(),y[i].get_arb_t(),rems[i].get_arb_t(),prec);
+        }
+        t = t_next;
+        retval.times.push_back(t);
+        retval.values.push_back(y);
+        retval.enclosures.push_back(ws.b);
+    }
+    return retval;
+}
+
+}
+
+#endif
@@ -0,0 +1,476 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#ifndef ARBPP_REAL_HPP
+#define ARBPP_REAL_HPP
+
+#include <arb.h>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "arbpp.hpp"
+
+namespace arbpp
+{
+
+/// Lazy real number.
+/**
+ * An arbpp::real records the computation which defines it as a directed acyclic graph of operations on arbpp::arb,
+ * and it is evaluated on demand, to any requested relative accuracy, by evaluate(). Each node of the graph caches
+ * the most accurate ball computed so far, together with the working precision used: a subsequent request for a
+ * higher accuracy re-evaluates only the nodes whose cached ball is not accurate enough, while the subgraphs which
+ * are already sufficiently accurate (exact inputs, or shared subexpressions refined by a previous request) are
+ * reused as they are.
+ *
+ * When a node has to be re-evaluated, its working precision grows geometrically: asking repeatedly for "a few more
+ * digits" costs a bounded number of re-evaluations per doubling of the precision.
+ *
+ * The leaves of the graph are:
+ * - exact values (fundamental integral and floating-point types), which are never re-evaluated;
+ * - decimal strings, parsed with the string constructor of arbpp::arb at the needed precision;
+ * - generators, i.e., functions returning an enclosure of a number at a given precision (e.g., a constant);
+ * - fixed balls (constructed from an arbpp::arb), whose accuracy cannot be improved.
+ *
+ * The available operations are the arithmetic operators, cos(), sqrt() and abs().
+ *
+ * ## Thread safety ##
+ *
+ * Copies of an arbpp::real share the graph, and evaluation updates the caches of the nodes: objects sharing
+ * nodes must not be evaluated concurrently.
+ */
+class real
+{
+        enum class kind
+        {
+            exact, fixed, string, generator, neg, add, sub, mul, div, cos, sqrt, abs
+        };
+        struct node
+        {
+            explicit node(kind k):m_kind(k),m_acc(0),m_prec(0) {}
+            node(kind k, std::shared_ptr<node> a, std::shared_ptr<node> b = nullptr):
+                m_kind(k),m_a(std::move(a)),m_b(std::move(b)),m_acc(0),m_prec(0) {}
+            node(const node &) = delete;
+            node &operator=(const node &) = delete;
+            ~node()
+            {
+                // NOTE: release the operands iteratively, the implicit destructor would recurse once per node
+                // of a long chain of operations (e.g., one built by repeated +=).
+                std::vector<std::shared_ptr<node>> pending;
+                pending.push_back(std::move(m_a));
+                pending.push_back(std::move(m_b));
+                while (!pending.empty()) {
+                    std::shared_ptr<node> p = std::move(pending.back());
+                    pending.pop_back();
+                    if (p && p.use_count() == 1) {
+                        pending.push_back(std::move(p->m_a));
+                        pending.push_back(std::move(p->m_b));
+                    }
+                }
+            }
+            const kind                      m_kind;
+            std::shared_ptr<node>           m_a;
+            std::shared_ptr<node>           m_b;
+            std::string                     m_str;
+            std::function<arb(long)>        m_gen;
+            // Cached ball, its relative accuracy and the working precision used to compute it.
+            arb                             m_value;
+            long                            m_acc;
+            long                            m_prec;
+        };
+        template <typename T>
+        struct is_exact_type
+        {
+            static const bool value = std::is_floating_point<T>::value || (std::is_integral<T>::value &&
+                !std::is_same<T,bool>::value && !std::is_same<T,wchar_t>::value &&
+                !std::is_same<T,char16_t>::value && !std::is_same<T,char32_t>::value);
+        };
+        // Guard bits added to the target accuracy to get the working precision.
+        static const long guard_bits = 16;
+        // Guard bits added to the target accuracy of a node to get the target accuracy of its operands.
+        // NOTE: this is deliberately smaller than guard_bits, as it accumulates along the depth of the graph.
+        static const long operand_guard_bits = 4;
+        explicit real(std::shared_ptr<node> n):m_node(std::move(n)) {}
+        void set_cache(node &n, arb &&value, long prec) const
+        {
+            const long acc = value.get_rel_accuracy_bits();
+            // NOTE: keep the most accurate ball, but record the precision attempted, so that
+            // the next re-evaluation goes further.
+            if (acc > n.m_acc || n.m_prec == 0) {
+                n.m_value = std::move(value);
+                n.m_acc = acc;
+            }
+            n.m_prec = std::max(n.m_prec,prec);
+        }
+        void compute(node &n, long prec) const
+        {
+            arb retval;
+            retval.set_precision(prec);
+            switch (n.m_kind) {
+                case kind::string:
+                    retval = arb{n.m_str,prec};
+                    break;
+                case kind::generator:
+                    retval = n.m_gen(prec);
+                    break;
+                case kind::neg:
+                    ::arb_neg(retval.get_arb_t(),n.m_a->m_value.get_arb_t());
+                    break;
+                case kind::add:
+                    ::arb_add(retval.get_arb_t(),n.m_a->m_value.get_arb_t(),n.m_b->m_value.get_arb_t(),prec);
+                    break;
+                case kind::sub:
+                    ::arb_sub(retval.get_arb_t(),n.m_a->m_value.get_arb_t(),n.m_b->m_value.get_arb_t(),prec);
+                    break;
+                case kind::mul:
+                    ::arb_mul(retval.get_arb_t(),n.m_a->m_value.get_arb_t(),n.m_b->m_value.get_arb_t(),prec);
+                    break;
+                case kind::div:
+                    ::arb_div(retval.get_arb_t(),n.m_a->m_value.get_arb_t(),n.m_b->m_value.get_arb_t(),prec);
+                    break;
+                case kind::cos:
+                    ::arb_cos(retval.get_arb_t(),n.m_a->m_value.get_arb_t(),prec);
+                    break;
+                case kind::sqrt:
+                    ::arb_sqrt(retval.get_arb_t(),n.m_a->m_value.get_arb_t(),prec);
+                    break;
+                case kind::abs:
+                    ::arb_abs(retval.get_arb_t(),n.m_a->m_value.get_arb_t());
+                    break;
+                default:
+                    // Exact and fixed leaves are never recomputed.
+                    return;
+            }
+            set_cache(n,std::move(retval),prec);
+        }
+        // Make sure that the cached ball of n has a relative accuracy of at least acc bits, if possible
+        // with a working precision not exceeding max_prec.
+        // NOTE: the graph is traversed depth-first with an explicit stack, so that long chains of operations
+        // do not overflow the call stack.
+        void refine(node &root, long acc, long max_prec) const
+        {
+            struct frame
+            {
+                node    *n;
+                long    acc;
+                long    prec;
+                // Target accuracy of the operands.
+                long    op_acc;
+                int     state;
+            };
+            enum {entry, operands, evaluation};
+            std::vector<frame> stack{frame{&root,acc,0,0,entry}};
+            while (!stack.empty()) {
+                frame &f = stack.back();
+                node &n = *f.n;
+                switch (f.state) {
+                    case entry:
+                        if (n.m_acc >= f.acc || n.m_prec >= max_prec || n.m_kind == kind::exact ||
+                            n.m_kind == kind::fixed)
+                        {
+                            stack.pop_back();
+                            break;
+                        }
+                        // Grow the working precision geometrically with respect to the previous evaluation.
+                        f.prec = std::max(f.acc + guard_bits,n.m_prec + n.m_prec / 2);
+                        f.op_acc = f.acc + operand_guard_bits;
+                        f.state = operands;
+                        break;
+                    case operands:
+                    {
+                        f.prec = std::min(f.prec,max_prec);
+                        f.state = evaluation;
+                        const long op_acc = f.op_acc;
+                        // NOTE: push the second operand first, so that the first one is refined first.
+                        if (n.m_b) {
+                            stack.push_back(frame{n.m_b.get(),op_acc,0,0,entry});
+                        }
+                        if (n.m_a) {
+                            stack.push_back(frame{n.m_a.get(),op_acc,0,0,entry});
+                        }
+                        break;
+                    }
+                    default:
+                        compute(n,f.prec);
+                        if (n.m_acc >= f.acc || f.prec >= max_prec) {
+                            stack.pop_back();
+                            break;
+                        }
+                        // Not enough: cancellation or ill-conditioning, retry with more bits. The operands
+                        // need the bits which were lost, capped to the current precision in case of total
+                        // cancellation.
+                        f.op_acc += std::min(f.acc - n.m_acc,f.prec);
+                        f.prec *= 2;
+                        f.state = operands;
+                }
+            }
+        }
+        template <typename T>
+        using exact_enabler = typename std::enable_if<is_exact_type<T>::value,int>::type;
+    public:
+        /// Default constructor.
+        /**
+         * Constructs an exact zero.
+         */
+        real():real(0) {}
+        /// Constructor from exact values.
+        /**
+         * \note
+         * This constructor is enabled only if \p T is a fundamental integral (other than \p bool and the wide
+         * character types) or floating-point type.
+         *
+         * @param[in] x value.
+         *
+         * @throws unspecified any exception thrown by memory allocation errors.
+         */
+        template <typename T, exact_enabler<T> = 0>
+        real(const T &x):m_node(std::make_shared<node>(kind::exact))
+        {
+            // NOTE: 128 bits are enough for all the fundamental types.
+            m_node->m_value = arb{x,128};
+            m_node->m_acc = m_node->m_value.get_rel_accuracy_bits();
+        }
+        /// Constructor from a ball.
+        /**
+         * The accuracy of the resulting object cannot exceed the accuracy of \p x.
+         *
+         * @param[in] x ball.
+         *
+         * @throws unspecified any exception thrown by memory allocation errors.
+         */
+        explicit real(const arb &x):m_node(std::make_shared<node>(kind::fixed))
+        {
+            m_node->m_value = x;
+            m_node->m_acc = x.get_rel_accuracy_bits();
+        }
+        /// Constructor from decimal string.
+        /**
+         * The string is parsed by the constructor of arbpp::arb from string, at the precision needed by each
+         * evaluation.
+         *
+         * @param[in] str decimal representation of the number.
+         *
+         * @throws std::invalid_argument if \p str is not a valid representation.
+         * @throws unspecified any exception thrown by memory allocation errors.
+         */
+        explicit real(const std::string &str):m_node(std::make_shared<node>(kind::string))
+        {
+            // Validate the input.
+            arb{str};
+            m_node->m_str = str;
+        }
+        /// Constructor from generator.
+        /**
+         * @param[in] gen function returning an enclosure of the number, computed at the precision passed as
+         * argument.
+         *
+         * @throws std::invalid_argument if \p gen is empty.
+         * @throws unspecified any exception thrown by memory allocation errors.
+         */
+        explicit real(std::function<arb(long)> gen):m_node(std::make_shared<node>(kind::generator))
+        {
+            if (!gen) {
+                throw std::invalid_argument("cannot construct a real from an empty generator");
+            }
+            m_node->m_gen = std::move(gen);
+        }
+        /// Pi.
+        /**
+         * @return the constant pi.
+         */
+        static real pi()
+        {
+            return real(std::function<arb(long)>([](long prec) {
+                arb retval;
+                retval.set_precision(prec);
+                ::arb_const_pi(retval.get_arb_t(),prec);
+                return retval;
+            }));
+        }
+        /// Evaluation.
+        /**
+         * Computes an enclosure of \p this with a relative accuracy of at least \p acc bits, re-evaluating the
+         * nodes of the graph whose cached ball is not accurate enough. If the accuracy cannot be reached with
+         * a working precision up to \p max_prec (e.g., for a value equal to zero which is not computed exactly,
+         * or for a leaf constructed from a ball), the most accurate enclosure found is returned: the accuracy of
+         * the result can be checked with arb::get_rel_accuracy_bits().
+         *
+         * @param[in] acc target relative accuracy, in bits.
+         * @param[in] max_prec maximum working precision (if zero, it defaults to <tt>8 * max(acc, 128)</tt>).
+         *
+         * @return an enclosure of \p this.
+         *
+         * @throws std::invalid_argument if \p acc is not positive or \p max_prec is negative.
+         * @throws unspecified any exception thrown by memory allocation errors, or by the generators.
+         */
+        arb evaluate(long acc, long max_prec = 0) const
+        {
+            if (acc <= 0 || max_prec < 0) {
+                throw std::invalid_argument("invalid target accuracy or maximum precision");
+            }
+            if (max_prec == 0) {
+                max_prec = std::max(acc,128l) * 8;
+            }
+            refine(*m_node,acc,max_prec);
+            return m_node->m_value;
+        }
+        /// Identity operator.
+        /**
+         * @return a copy of \p this.
+         */
+        real operator+() const
+        {
+            return *this;
+        }
+        /// Negation.
+        /**
+         * @return the opposite of \p this.
+         */
+        real operator-() const
+        {
+            return real(std::make_shared<node>(kind::neg,m_node));
+        }
+        /// Addition.
+        /**
+         * @param[in] a first argument.
+         * @param[in] b second argument.
+         *
+         * @return <tt>a + b</tt>.
+         */
+        friend real operator+(const real &a, const real &b)
+        {
+            return real(std::make_shared<node>(kind::add,a.m_node,b.m_node));
+        }
+        /// Subtraction.
+        /**
+         * @param[in] a first argument.
+         * @param[in] b second argument.
+         *
+         * @return <tt>a - b</tt>.
+         */
+        friend real operator-(const real &a, const real &b)
+        {
+            return real(std::make_shared<node>(kind::sub,a.m_node,b.m_node));
+        }
+        /// Multiplication.
+        /**
+         * @param[in] a first argument.
+         * @param[in] b second argument.
+         *
+         * @return <tt>a * b</tt>.
+         */
+        friend real operator*(const real &a, const real &b)
+        {
+            return real(std::make_shared<node>(kind::mul,a.m_node,b.m_node));
+        }
+        /// Division.
+        /**
+         * @param[in] a first argument.
+         * @param[in] b second argument.
+         *
+         * @return <tt>a / b</tt>.
+         */
+        friend real operator/(const real &a, const real &b)
+        {
+            return real(std::make_shared<node>(kind::div,a.m_node,b.m_node));
+        }
+        /// In-place addition.
+        /**
+         * @param[in] x argument.
+         *
+         * @return reference to \p this.
+         */
+        real &operator+=(const real &x)
+        {
+            return *this = *this + x;
+        }
+        /// In-place subtraction.
+        /**
+         * @param[in] x argument.
+         *
+         * @return reference to \p this.
+         */
+        real &operator-=(const real &x)
+        {
+            return *this = *this - x;
+        }
+        /// In-place multiplication.
+        /**
+         * @param[in] x argument.
+         *
+         * @return reference to \p this.
+         */
+        real &operator*=(const real &x)
+        {
+            return *this = *this * x;
+        }
+        /// In-place division.
+        /**
+         * @param[in] x argument.
+         *
+         * @return reference to \p this.
+         */
+        real &operator/=(const real &x)
+        {
+            return *this = *this / x;
+        }
+        /// Cosine.
+        /**
+         * @param[in] x argument.
+         *
+         * @return the cosine of \p x.
+         */
+        friend real cos(const real &x)
+        {
+            return real(std::make_shared<node>(kind::cos,x.m_node));
+        }
+        /// Square root.
+        /**
+         * @param[in] x argument.
+         *
+         * @return the square root of \p x.
+         */
+        friend real sqrt(const real &x)
+        {
+            return real(std::make_shared<node>(kind::sqrt,x.m_node));
+        }
+        /// Absolute value.
+        /**
+         * @param[in] x argument.
+         *
+         * @return the absolute value of \p x.
+         */
+        friend real abs(const real &x)
+        {
+            return real(std::make_shared<node>(kind::abs,x.m_node));
+        }
+    private:
+        std::shared_ptr<node> m_node;
+};
+
+}
+
+#endif
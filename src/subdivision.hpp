@@ -0,0 +1,585 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#ifndef ARBPP_SUBDIVISION_HPP
+#define ARBPP_SUBDIVISION_HPP
+
+#include <algorithm>
+#include <arb.h>
+#include <arf.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <mag.h>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "arbpp.hpp"
+
+// NOTE: this header provides algorithms which subdivide the domain of a function into boxes of arbpp::arb
+// intervals (one ball per coordinate, a ball with centre c and radius r standing for [c - r, c + r]), evaluate
+// the function over the pieces in parallel and combine the results into rigorous enclosures.
+
+namespace arbpp
+{
+
+/// Result of arbpp::global_minimize().
+struct minimize_result
+{
+    /// Enclosure of the global minimum.
+    arb                             minimum;
+    /// Boxes covering all the global minimisers, sorted by the lower bound of the function over them.
+    std::vector<std::vector<arb>>   minimizers;
+    /// Number of boxes over which the function was evaluated.
+    std::size_t                     n_boxes;
+};
+
+namespace detail
+{
+
+// Lower and upper bounds of a ball as doubles, rounded outwards. Non-finite balls give infinite bounds.
+inline double lower_bound_d(const arb &x)
+{
+    if (!::arb_is_finite(x.get_arb_t())) {
+        return -std::numeric_limits<double>::infinity();
+    }
+    arf_raii l;
+    ::arb_get_lbound_arf(l,x.get_arb_t(),x.get_precision());
+    return ::arf_get_d(l,ARF_RND_FLOOR);
+}
+
+inline double upper_bound_d(const arb &x)
+{
+    if (!::arb_is_finite(x.get_arb_t())) {
+        return std::numeric_limits<double>::infinity();
+    }
+    arf_raii u;
+    ::arb_get_ubound_arf(u,x.get_arb_t(),x.get_precision());
+    return ::arf_get_d(u,ARF_RND_CEIL);
+}
+
+// Lock-free update of a shared bound.
+inline void atomic_min(std::atomic<double> &a, double x)
+{
+    double cur = a.load();
+    while (x < cur && !a.compare_exchange_weak(cur,x)) {}
+}
+
+// Smallest radius of the pieces into which x is subdivided, as the radius of a ball centred at zero: about 2**-prec
+// times the radius of x. Without a limit, the subdivision would never end around the points where the enclosures
+// of the function stay non-finite although its values are finite, e.g., around the pole of 1 / x over [0,1], where
+// the pieces [0,2**-k] can always be split exactly.
+inline arb min_radius(const arb &x)
+{
+    arb retval;
+    retval.set_precision(x.get_precision());
+    ::mag_set(arb_radref(retval.get_arb_t()),arb_radref(x.get_arb_t()));
+    ::arb_mul_2exp_si(retval.get_arb_t(),retval.get_arb_t(),-x.get_precision());
+    return retval;
+}
+
+// Split x in two halves. Returns false if x cannot be split any further at its precision, or if it is not
+// wider than min_rad.
+inline bool bisect_ball(const arb &x, const arb &min_rad, arb &lo, arb &hi)
+{
+    const ::arb_struct *p = x.get_arb_t();
+    if (::mag_cmp(arb_radref(p),arb_radref(min_rad.get_arb_t())) <= 0 || !::arb_is_finite(p)) {
+        return false;
+    }
+    const long prec = x.get_precision();
+    arf_raii l, u;
+    ::arb_get_lbound_arf(l,p,prec);
+    ::arb_get_ubound_arf(u,p,prec);
+    lo.set_precision(prec);
+    hi.set_precision(prec);
+    ::arb_set_interval_arf(lo.get_arb_t(),l,arb_midref(p),prec);
+    ::arb_set_interval_arf(hi.get_arb_t(),arb_midref(p),u,prec);
+    // With the outward rounding, at low precision the halves may be as wide as x.
+    return ::mag_cmp(arb_radref(lo.get_arb_t()),arb_radref(p)) < 0 &&
+        ::mag_cmp(arb_radref(hi.get_arb_t()),arb_radref(p)) < 0;
+}
+
+// Split b in two halves along its widest coordinate among the ones wider than their minimum radius. Returns false
+// if b cannot be split any further.
+inline bool bisect_box(const std::vector<arb> &b, const std::vector<arb> &min_rad, std::vector<arb> &lo,
+    std::vector<arb> &hi)
+{
+    std::size_t k = b.size();
+    for (std::size_t i = 0u; i < b.size(); ++i) {
+        const ::mag_struct *r = arb_radref(b[i].get_arb_t());
+        if (::mag_cmp(r,arb_radref(min_rad[i].get_arb_t())) > 0 &&
+            (k == b.size() || ::mag_cmp(r,arb_radref(b[k].get_arb_t())) > 0))
+        {
+            k = i;
+        }
+    }
+    if (k == b.size()) {
+        return false;
+    }
+    lo = b;
+    hi = b;
+    return bisect_ball(b[k],min_rad[k],lo[k],hi[k]);
+}
+
+// Midpoint of a box, as a box of exact balls.
+inline std::vector<arb> box_midpoint(const std::vector<arb> &b)
+{
+    std::vector<arb> retval(b);
+    for (auto &x: retval) {
+        ::mag_zero(arb_radref(x.get_arb_t()));
+    }
+    return retval;
+}
+
+// Piece of the domain of bound_range(), with the enclosures of the function over it and at its midpoint.
+struct range_piece
+{
+    arb x;
+    arb value;
+    arb mid_value;
+};
+
+// a = min(a,b) or a = max(a,b).
+inline void arf_update_min(::arf_t a, const ::arf_t b)
+{
+    if (::arf_cmp(b,a) < 0) {
+        ::arf_set(a,b);
+    }
+}
+
+inline void arf_update_max(::arf_t a, const ::arf_t b)
+{
+    if (::arf_cmp(b,a) > 0) {
+        ::arf_set(a,b);
+    }
+}
+
+struct no_gradient {};
+
+// Monotonicity test: if f is strictly monotone in the coordinate i over b, a minimiser in b must lie on the face
+// of the initial box where f decreases, and b is either discarded or reduced to that face. Returns false if b
+// can be discarded.
+// NOTE: the bisections round outwards, so a box touching the face may extend slightly beyond it: such a box
+// is kept, and its coordinate is set to the one of the face, so that f is not evaluated outside the domain.
+inline bool monotonicity_test(const no_gradient *, std::vector<arb> &, const std::vector<arb> &)
+{
+    return true;
+}
+
+template <typename G>
+inline bool monotonicity_test(const G *grad, std::vector<arb> &b, const std::vector<arb> &initial)
+{
+    const std::vector<arb> g = (*grad)(static_cast<const std::vector<arb> &>(b));
+    if (g.size() != b.size()) {
+        throw std::invalid_argument("the gradient has " + std::to_string(g.size()) + " components, but the box has " +
+            std::to_string(b.size()) + " coordinates");
+    }
+    arf_raii e, e0;
+    for (std::size_t i = 0u; i < b.size(); ++i) {
+        const bool pos = ::arb_is_positive(g[i].get_arb_t()) != 0, neg = ::arb_is_negative(g[i].get_arb_t()) != 0;
+        if (!pos && !neg) {
+            continue;
+        }
+        const long prec = b[i].get_precision();
+        if (pos) {
+            ::arb_get_lbound_arf(e,b[i].get_arb_t(),prec);
+            ::arb_get_lbound_arf(e0,initial[i].get_arb_t(),prec);
+        } else {
+            ::arb_get_ubound_arf(e,b[i].get_arb_t(),prec);
+            ::arb_get_ubound_arf(e0,initial[i].get_arb_t(),prec);
+        }
+        const int c = ::arf_cmp(e,e0);
+        if (pos ? c > 0 : c < 0) {
+            return false;
+        }
+        ::arb_set_arf(b[i].get_arb_t(),e0);
+    }
+    return true;
+}
+
+// Box of the branch-and-bound, with the enclosure of the function over it.
+struct bb_box
+{
+    double              lower;
+    arb                 value;
+    std::vector<arb>    box;
+};
+
+struct bb_box_greater
+{
+    bool operator()(const bb_box &a, const bb_box &b) const
+    {
+        return a.lower > b.lower;
+    }
+};
+
+template <typename F, typename G>
+inline minimize_result global_minimize_impl(const F &f, const G *grad, const std::vector<arb> &initial, double tolerance,
+    unsigned n_threads)
+{
+    if (initial.empty()) {
+        throw std::invalid_argument("cannot minimise over an empty box");
+    }
+    if (!(tolerance > 0.)) {
+        throw std::invalid_argument("the tolerance must be positive, but it is " + std::to_string(tolerance));
+    }
+    if (n_threads == 0u) {
+        throw std::invalid_argument("the number of threads must be positive");
+    }
+    long prec = 0;
+    std::vector<arb> min_rad;
+    for (const auto &x: initial) {
+        prec = std::max(prec,x.get_precision());
+        min_rad.push_back(min_radius(x));
+    }
+    // The boxes to be processed, as a binary heap on the lower bounds, and the boxes which are within the
+    // tolerance or cannot be split any further.
+    std::vector<bb_box> heap, candidates;
+    std::mutex mutex;
+    std::condition_variable cond;
+    unsigned busy = 0u;
+    bool stop = false;
+    // Upper bound for the minimum, shared by all the threads and used for the pruning. Each thread also keeps
+    // its best upper bound at full precision, for the final result.
+    std::atomic<double> best(std::numeric_limits<double>::infinity());
+    std::vector<arb> best_upper(n_threads);
+    for (auto &x: best_upper) {
+        ::arb_pos_inf(x.get_arb_t());
+    }
+    std::atomic<std::size_t> n_boxes(0u);
+    auto update_upper = [&best](arb &best_up, const arb &v) {
+        if (!::arb_is_finite(v.get_arb_t())) {
+            return;
+        }
+        arf_raii u;
+        ::arb_get_ubound_arf(u,v.get_arb_t(),v.get_precision());
+        if (::arf_cmp(u,arb_midref(best_up.get_arb_t())) < 0) {
+            ::arb_set_arf(best_up.get_arb_t(),u);
+        }
+        atomic_min(best,::arf_get_d(u,ARF_RND_CEIL));
+    };
+    // Evaluate f over b. Returns false if b can be discarded.
+    auto examine = [&](std::vector<arb> &b, arb &best_up, bb_box &out) -> bool {
+        if (!monotonicity_test(grad,b,initial)) {
+            return false;
+        }
+        ++n_boxes;
+        arb value = f(static_cast<const std::vector<arb> &>(b));
+        update_upper(best_up,value);
+        // Midpoint test.
+        update_upper(best_up,f(static_cast<const std::vector<arb> &>(box_midpoint(b))));
+        const double lower = lower_bound_d(value);
+        if (lower > best.load()) {
+            return false;
+        }
+        out.lower = lower;
+        out.value = std::move(value);
+        out.box = std::move(b);
+        return true;
+    };
+    auto worker = [&](std::size_t t) {
+        std::vector<arb> lo, hi;
+        bb_box item, child;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cond.wait(lock,[&]() {return stop || !heap.empty() || busy == 0u;});
+                if (stop || heap.empty()) {
+                    stop = true;
+                    cond.notify_all();
+                    return;
+                }
+                std::pop_heap(heap.begin(),heap.end(),bb_box_greater{});
+                item = std::move(heap.back());
+                heap.pop_back();
+                ++busy;
+            }
+            std::vector<bb_box> children, finals;
+            try {
+                if (item.lower <= best.load()) {
+                    if (best.load() - item.lower <= tolerance || !bisect_box(item.box,min_rad,lo,hi)) {
+                        finals.push_back(std::move(item));
+                    } else {
+                        if (examine(lo,best_upper[t],child)) {
+                            children.push_back(std::move(child));
+                        }
+                        if (examine(hi,best_upper[t],child)) {
+                            children.push_back(std::move(child));
+                        }
+                    }
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                stop = true;
+                cond.notify_all();
+                throw;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto &c: children) {
+                heap.push_back(std::move(c));
+                std::push_heap(heap.begin(),heap.end(),bb_box_greater{});
+            }
+            std::move(finals.begin(),finals.end(),std::back_inserter(candidates));
+            --busy;
+            cond.notify_all();
+        }
+    };
+    std::vector<arb> root(initial);
+    bb_box item;
+    if (examine(root,best_upper[0],item)) {
+        heap.push_back(std::move(item));
+    }
+    parallel_for(n_threads,n_threads,[&worker](std::size_t begin, std::size_t end) {
+        for (auto t = begin; t < end; ++t) {
+            worker(t);
+        }
+    });
+    // Assemble the result: the minimum lies between the smallest lower bound of the candidates and the best
+    // upper bound.
+    minimize_result retval;
+    retval.n_boxes = n_boxes.load();
+    arb upper{best_upper[0]};
+    for (const auto &x: best_upper) {
+        if (::arf_cmp(arb_midref(x.get_arb_t()),arb_midref(upper.get_arb_t())) < 0) {
+            upper = x;
+        }
+    }
+    std::sort(candidates.begin(),candidates.end(),[](const bb_box &a, const bb_box &b) {return a.lower < b.lower;});
+    arf_raii lower, l;
+    ::arf_pos_inf(lower);
+    for (auto &c: candidates) {
+        ::arb_get_lbound_arf(l,c.value.get_arb_t(),prec);
+        if (::arb_is_finite(c.value.get_arb_t()) && ::arf_cmp(l,arb_midref(upper.get_arb_t())) > 0) {
+            continue;
+        }
+        if (!::arb_is_finite(c.value.get_arb_t())) {
+            ::arf_neg_inf(l);
+        }
+        if (::arf_cmp(l,lower) < 0) {
+            ::arf_set(lower,l);
+        }
+        retval.minimizers.push_back(std::move(c.box));
+    }
+    retval.minimum.set_precision(prec);
+    if (retval.minimizers.empty()) {
+        ::arb_indeterminate(retval.minimum.get_arb_t());
+    } else {
+        ::arb_set_interval_arf(retval.minimum.get_arb_t(),lower,arb_midref(upper.get_arb_t()),prec);
+    }
+    return retval;
+}
+
+}
+
+/// Global minimisation.
+/**
+ * Branch-and-bound minimisation of \p f over \p box. The boxes are kept in a priority queue ordered by the lower
+ * bound of \p f over them, and shared by \p n_threads threads. Each thread repeatedly takes the most promising box,
+ * bisects it along its widest coordinate and evaluates \p f over the halves. The values of \p f over the boxes and
+ * at their midpoints provide upper bounds for the minimum: the best one is shared via an atomic variable, and the boxes
+ * whose lower bound exceeds it are discarded. A box is not split any further once its lower bound is within
+ * \p tolerance of the best upper bound, or when it cannot be split at the precision of its coordinates. The
+ * coordinates are not split below about \f$ 2^{-p} \f$ times their initial width, where \f$ p \f$ is their precision:
+ * the boxes reaching this limit are kept as they are, so that the subdivision terminates also where the enclosures
+ * of \p f stay non-finite (e.g., around a pole), at the cost of a non-finite lower bound for the minimum.
+ *
+ * \p f is called with a box (a <tt>const std::vector<arbpp::arb> &</tt>), possibly concurrently from several threads, and
+ * it must return an arbpp::arb enclosing the values of the function over the box. The tighter the enclosures, the
+ * fewer the boxes to be processed: \p f can, e.g., compute its result via arbpp::taylor_model::variables() and
+ * arbpp::taylor_model::bound() instead of plain ball arithmetic.
+ *
+ * @param[in] f the function to be minimised.
+ * @param[in] box the domain, one ball for each variable (a ball with centre \f$ c \f$ and radius \f$ r \f$ represents
+ * the interval \f$ [c - r, c + r] \f$).
+ * @param[in] tolerance the target width of the enclosure of the minimum.
+ * @param[in] n_threads number of threads to be used.
+ *
+ * @return the enclosure of the global minimum, the boxes which contain all the global minimisers and the number
+ * of evaluated boxes. The enclosure of the minimum has the maximum precision of the coordinates of \p box.
+ *
+ * @throws std::invalid_argument if \p box is empty, if \p tolerance is not positive or if \p n_threads is zero.
+ * @throws unspecified any exception thrown by \p f, by threading primitives or by memory allocation errors.
+ */
+template <typename F>
+inline minimize_result global_minimize(const F &f, const std::vector<arb> &box, double tolerance, unsigned n_threads = 1u)
+{
+    return detail::global_minimize_impl(f,static_cast<const detail::no_gradient *>(nullptr),box,tolerance,n_threads);
+}
+
+/// Global minimisation with gradient.
+/**
+ * Same as global_minimize(const F &, const std::vector<arb> &, double, unsigned), but the boxes are also pruned via the
+ * monotonicity test: \p grad is called with a box, and it must return the enclosures of the partial derivatives of
+ * the function over it. If a partial derivative does not vanish over a box, the box cannot contain a minimiser unless
+ * it touches the face of \p box where the function decreases, and in that case it is reduced to the face.
+ *
+ * @param[in] f the function to be minimised.
+ * @param[in] grad the gradient of \p f.
+ * @param[in] box the domain.
+ * @param[in] tolerance the target width of the enclosure of the minimum.
+ * @param[in] n_threads number of threads to be used.
+ *
+ * @return the enclosure of the global minimum, the boxes which contain all the global minimisers and the number
+ * of evaluated boxes.
+ *
+ * @throws std::invalid_argument if \p box is empty, if \p tolerance is not positive, if \p n_threads is zero or
+ * if the size of the gradient is not the number of variables.
+ * @throws unspecified any exception thrown by \p f, by \p grad, by threading primitives or by memory allocation errors.
+ */
+template <typename F, typename G>
+inline minimize_result global_minimize(const F &f, const G &grad, const std::vector<arb> &box, double tolerance,
+    unsigned n_threads = 1u)
+{
+    return detail::global_minimize_impl(f,&grad,box,tolerance,n_threads);
+}
+
+/// Range bounding.
+/**
+ * Enclosure of the range of \p f over \p interval, computed via adaptive bisection. At each round, \p f is evaluated
+ * over the active pieces of \p interval and at their midpoints, in parallel over \p n_threads threads. The values at
+ * the midpoints give inner bounds for the range (the minimum is not greater than any of them, the maximum not smaller),
+ * and a piece is split further only if its enclosure extends more than <tt>target_width / 2</tt> beyond them. The
+ * pieces which are already tight are not evaluated again, and their enclosures are merged into the result. The
+ * bisection stops when no piece needs to be split, or when the pieces cannot be split at the precision of
+ * \p interval, or when they are narrower than about \f$ 2^{-p} \f$ times \p interval, where \f$ p \f$ is the
+ * precision of \p interval. The latter limit ensures termination where the enclosures of \p f stay non-finite
+ * (e.g., around a pole), and in that case the result is not finite.
+ *
+ * Hence, unless the precision is exhausted, the result is wider than the range of \p f by at most \p target_width.
+ * \p f is called with an arbpp::arb, possibly concurrently from several threads, and it must return an arbpp::arb
+ * enclosing the values of the function over it. The values of \p f are moved into storage which is reused across
+ * the rounds, and the balls for the midpoints are scratch space owned by each thread.
+ *
+ * @param[in] f the function.
+ * @param[in] interval the domain (a ball with centre \f$ c \f$ and radius \f$ r \f$ represents the interval
+ * \f$ [c - r, c + r] \f$).
+ * @param[in] target_width the maximum overestimation of the range.
+ * @param[in] n_threads number of threads to be used.
+ *
+ * @return an enclosure of the range of \p f over \p interval, with the precision of \p interval. The result is
+ * indeterminate if \p f is not finite at the midpoint of a piece.
+ *
+ * @throws std::invalid_argument if \p target_width is not positive or if \p n_threads is zero.
+ * @throws unspecified any exception thrown by \p f, by threading primitives or by memory allocation errors.
+ */
+template <typename F>
+inline arb bound_range(const F &f, const arb &interval, double target_width, unsigned n_threads = 1u)
+{
+    if (!(target_width > 0.)) {
+        throw std::invalid_argument("the target width must be positive, but it is " + std::to_string(target_width));
+    }
+    if (n_threads == 0u) {
+        throw std::invalid_argument("the number of threads must be positive");
+    }
+    const long prec = interval.get_precision();
+    arb retval;
+    retval.set_precision(prec);
+    // Split the interval so that all the threads have work from the first round.
+    const arb min_rad = detail::min_radius(interval);
+    std::vector<detail::range_piece> active(1u), next;
+    active[0].x = interval;
+    while (active.size() < n_threads) {
+        next.clear();
+        for (const auto &p: active) {
+            next.emplace_back();
+            next.emplace_back();
+            if (!detail::bisect_ball(p.x,min_rad,next[next.size() - 2u].x,next.back().x)) {
+                next.pop_back();
+                next.back().x = p.x;
+            }
+        }
+        if (next.size() == active.size()) {
+            break;
+        }
+        active.swap(next);
+    }
+    // Inner bounds from the midpoints, and outer bounds from the pieces which are not split any further.
+    detail::arf_raii tol, inner_lo, inner_hi, outer_lo, outer_hi, l, u, t;
+    ::arf_set_d(tol,target_width);
+    ::arf_mul_2exp_si(tol,tol,-1);
+    ::arf_pos_inf(inner_lo);
+    ::arf_neg_inf(inner_hi);
+    ::arf_pos_inf(outer_lo);
+    ::arf_neg_inf(outer_hi);
+    while (!active.empty()) {
+        detail::parallel_for(active.size(),n_threads,[&active,&f](std::size_t begin, std::size_t end) {
+            arb mid;
+            for (auto i = begin; i < end; ++i) {
+                auto &p = active[i];
+                p.value = f(static_cast<const arb &>(p.x));
+                mid = p.x;
+                ::mag_zero(arb_radref(mid.get_arb_t()));
+                p.mid_value = f(static_cast<const arb &>(mid));
+            }
+        });
+        for (const auto &p: active) {
+            if (!::arb_is_finite(p.mid_value.get_arb_t())) {
+                ::arb_indeterminate(retval.get_arb_t());
+                return retval;
+            }
+            ::arb_get_ubound_arf(u,p.mid_value.get_arb_t(),prec);
+            ::arb_get_lbound_arf(l,p.mid_value.get_arb_t(),prec);
+            detail::arf_update_min(inner_lo,u);
+            detail::arf_update_max(inner_hi,l);
+        }
+        next.clear();
+        for (const auto &p: active) {
+            if (::arb_is_finite(p.value.get_arb_t())) {
+                ::arb_get_lbound_arf(l,p.value.get_arb_t(),prec);
+                ::arb_get_ubound_arf(u,p.value.get_arb_t(),prec);
+            } else {
+                ::arf_neg_inf(l);
+                ::arf_pos_inf(u);
+            }
+            ::arf_sub(t,inner_lo,tol,prec,ARF_RND_FLOOR);
+            bool split = ::arf_cmp(l,t) < 0;
+            if (!split) {
+                ::arf_add(t,inner_hi,tol,prec,ARF_RND_CEIL);
+                split = ::arf_cmp(u,t) > 0;
+            }
+            if (split) {
+                next.emplace_back();
+                next.emplace_back();
+                split = detail::bisect_ball(p.x,min_rad,next[next.size() - 2u].x,next.back().x);
+                if (!split) {
+                    next.pop_back();
+                    next.pop_back();
+                }
+            }
+            if (!split) {
+                detail::arf_update_min(outer_lo,l);
+                detail::arf_update_max(outer_hi,u);
+            }
+        }
+        active.swap(next);
+    }
+    ::arb_set_interval_arf(retval.get_arb_t(),outer_lo,outer_hi,prec);
+    return retval;
+}
+
+}
+
+#endif
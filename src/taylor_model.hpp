@@ -0,0 +1,634 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#ifndef ARBPP_TAYLOR_MODEL_HPP
+#define ARBPP_TAYLOR_MODEL_HPP
+
+#include <algorithm>
+#include <arb.h>
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "arbpp.hpp"
+
+namespace arbpp
+{
+
+/// Taylor model.
+/**
+ * A Taylor model encloses a function of \f$ n \f$ variables over a box \f$ B = \prod_i [c_i - r_i, c_i + r_i] \f$
+ * as a polynomial \f$ p \f$ of bounded total degree (the order of the model) in the normalised deviations
+ * \f$ u_i = (x_i - c_i) / r_i \in [-1,1] \f$, plus a remainder ball \f$ R \f$: for all the points of the box, the value of
+ * the function belongs to \f$ p(u) + R \f$. The coefficients of \f$ p \f$ are arbpp::arb balls.
+ *
+ * Since the dependency on the inputs is kept symbolically in \f$ p \f$, the cancellations between multiple
+ * occurrences of the same variable (e.g., in <tt>x - x</tt> or <tt>x * (1 - x)</tt>) happen on the polynomial,
+ * and only the higher order terms are bounded crudely. Over wide boxes this gives far tighter enclosures than the
+ * evaluation with plain balls, which treats each occurrence of a variable as independent. A model can also be
+ * evaluated cheaply over sub-boxes via evaluate(), so that the function needs to be computed only once for all the
+ * pieces of a subdivision.
+ *
+ * The models are created by variables(), which returns one model for each coordinate of the box. All the models
+ * combined in a binary operation must come from the same box and have the same order. The arithmetic operators
+ * and the functions (cos(), sqrt()) mirror the ones of arbpp::arb, including the mixed operations with arbpp::arb
+ * and with the types interoperable with it. The terms whose degree exceeds the order are bounded and moved into the
+ * remainder. The operations are carried out with the maximum precision of the operands.
+ *
+ * If a function is evaluated where it is not defined (e.g., a division by a model whose range contains zero),
+ * the remainder becomes non-finite, mirroring the behaviour of arbpp::arb.
+ */
+class taylor_model: public detail::arb_scalar_ops<taylor_model>
+{
+        friend class detail::arb_scalar_ops<taylor_model>;
+        // Exponents of a monomial in the normalised variables.
+        typedef std::vector<unsigned> monomial;
+        typedef std::map<monomial,arb> poly_type;
+    public:
+        /// Box type.
+        typedef std::vector<arb> box_type;
+    private:
+        taylor_model(std::shared_ptr<const box_type> box, unsigned order, long prec):
+            m_box(std::move(box)),m_order(order),m_prec(prec),m_rem(zero(prec)) {}
+        static arb zero(long prec)
+        {
+            arb retval;
+            retval.set_precision(prec);
+            return retval;
+        }
+        static unsigned degree(const monomial &m)
+        {
+            unsigned retval = 0u;
+            for (auto e: m) {
+                retval += e;
+            }
+            return retval;
+        }
+        // Enclosure of the range of c * u**m over [-1,1]**n.
+        arb term_bound(const monomial &m, const arb &c) const
+        {
+            arb retval{zero(m_prec)};
+            if (degree(m) == 0u) {
+                ::arb_set(retval.get_arb_t(),c.get_arb_t());
+                return retval;
+            }
+            if (std::all_of(m.begin(),m.end(),[](unsigned e) {return e % 2u == 0u;})) {
+                // [0,1].
+                ::arb_set_si(retval.get_arb_t(),1);
+                ::arb_mul_2exp_si(retval.get_arb_t(),retval.get_arb_t(),-1);
+                ::arb_add_error_2exp_si(retval.get_arb_t(),-1);
+            } else {
+                // [-1,1].
+                ::arb_add_error_2exp_si(retval.get_arb_t(),0);
+            }
+            ::arb_mul(retval.get_arb_t(),retval.get_arb_t(),c.get_arb_t(),m_prec);
+            return retval;
+        }
+        // Enclosure of the range of the polynomial part.
+        arb poly_bound() const
+        {
+            arb retval{zero(m_prec)};
+            for (const auto &t: m_poly) {
+                const arb b = term_bound(t.first,t.second);
+                ::arb_add(retval.get_arb_t(),retval.get_arb_t(),b.get_arb_t(),m_prec);
+            }
+            return retval;
+        }
+        // Add c * u**m, moving it into the remainder if its degree exceeds the order.
+        void add_term(const monomial &m, const arb &c)
+        {
+            if (degree(m) > m_order) {
+                const arb b = term_bound(m,c);
+                ::arb_add(m_rem.get_arb_t(),m_rem.get_arb_t(),b.get_arb_t(),m_prec);
+                return;
+            }
+            const auto it = m_poly.find(m);
+            if (it == m_poly.end()) {
+                arb &t = m_poly.emplace(m,zero(m_prec)).first->second;
+                ::arb_set_round(t.get_arb_t(),c.get_arb_t(),m_prec);
+            } else {
+                ::arb_add(it->second.get_arb_t(),it->second.get_arb_t(),c.get_arb_t(),m_prec);
+            }
+        }
+        // Constant model with the same box and order as this.
+        taylor_model constant(const arb &c, long prec) const
+        {
+            taylor_model retval(m_box,m_order,prec);
+            retval.add_term(monomial(get_n_variables(),0u),c);
+            return retval;
+        }
+        // Empty model for the result of a binary operation between a and b.
+        static taylor_model result(const taylor_model &a, const taylor_model &b)
+        {
+            if (a.m_order != b.m_order || !same_box(*a.m_box,*b.m_box)) {
+                throw std::invalid_argument("incompatible Taylor models: the box and the order must be the same");
+            }
+            return taylor_model(a.m_box,a.m_order,std::max(a.m_prec,b.m_prec));
+        }
+        static bool same_box(const box_type &a, const box_type &b)
+        {
+            return &a == &b || (a.size() == b.size() && std::equal(a.begin(),a.end(),b.begin(),
+                [](const arb &x, const arb &y) {return ::arb_equal(x.get_arb_t(),y.get_arb_t()) != 0;}));
+        }
+        // Implementation of the arithmetic operations.
+        static taylor_model binary_add(const taylor_model &a, const taylor_model &b, bool negate_b)
+        {
+            taylor_model retval = result(a,b);
+            for (const auto &t: a.m_poly) {
+                retval.add_term(t.first,t.second);
+            }
+            for (const auto &t: b.m_poly) {
+                if (negate_b) {
+                    retval.add_term(t.first,-t.second);
+                } else {
+                    retval.add_term(t.first,t.second);
+                }
+            }
+            if (negate_b) {
+                ::arb_sub(retval.m_rem.get_arb_t(),a.m_rem.get_arb_t(),b.m_rem.get_arb_t(),retval.m_prec);
+            } else {
+                ::arb_add(retval.m_rem.get_arb_t(),a.m_rem.get_arb_t(),b.m_rem.get_arb_t(),retval.m_prec);
+            }
+            return retval;
+        }
+        static taylor_model binary_mul(const taylor_model &a, const taylor_model &b)
+        {
+            taylor_model retval = result(a,b);
+            const long prec = retval.m_prec;
+            arb c{zero(prec)};
+            monomial m(a.get_n_variables());
+            for (const auto &ta: a.m_poly) {
+                for (const auto &tb: b.m_poly) {
+                    std::transform(ta.first.begin(),ta.first.end(),tb.first.begin(),m.begin(),
+                        [](unsigned x, unsigned y) {return x + y;});
+                    ::arb_mul(c.get_arb_t(),ta.second.get_arb_t(),tb.second.get_arb_t(),prec);
+                    retval.add_term(m,c);
+                }
+            }
+            // Remainder: B(p_a) * R_b + B(p_b) * R_a + R_a * R_b.
+            const arb ba = a.poly_bound(), bb = b.poly_bound();
+            arb r{zero(prec)};
+            ::arb_mul(r.get_arb_t(),ba.get_arb_t(),b.m_rem.get_arb_t(),prec);
+            ::arb_addmul(r.get_arb_t(),bb.get_arb_t(),a.m_rem.get_arb_t(),prec);
+            ::arb_addmul(r.get_arb_t(),a.m_rem.get_arb_t(),b.m_rem.get_arb_t(),prec);
+            ::arb_add(retval.m_rem.get_arb_t(),retval.m_rem.get_arb_t(),r.get_arb_t(),prec);
+            return retval;
+        }
+        void add_scalar(const arb &x, long prec)
+        {
+            m_prec = prec;
+            add_term(monomial(get_n_variables(),0u),x);
+            ::arb_set_round(m_rem.get_arb_t(),m_rem.get_arb_t(),m_prec);
+        }
+        void mul_scalar(const arb &x, long prec)
+        {
+            m_prec = prec;
+            for (auto &t: m_poly) {
+                ::arb_mul(t.second.get_arb_t(),t.second.get_arb_t(),x.get_arb_t(),m_prec);
+            }
+            ::arb_mul(m_rem.get_arb_t(),m_rem.get_arb_t(),x.get_arb_t(),m_prec);
+        }
+        void div_scalar(const arb &x, long prec)
+        {
+            m_prec = prec;
+            for (auto &t: m_poly) {
+                ::arb_div(t.second.get_arb_t(),t.second.get_arb_t(),x.get_arb_t(),m_prec);
+            }
+            ::arb_div(m_rem.get_arb_t(),m_rem.get_arb_t(),x.get_arb_t(),m_prec);
+        }
+        taylor_model rdiv_scalar(const arb &x, long prec) const
+        {
+            taylor_model retval = reciprocal();
+            retval.mul_scalar(x,prec);
+            return retval;
+        }
+        // Midpoint of the constant term, the expansion point of the elementary functions.
+        arb center() const
+        {
+            arb retval{zero(m_prec)};
+            const auto it = m_poly.find(monomial(get_n_variables(),0u));
+            if (it != m_poly.end()) {
+                ::arb_get_mid_arb(retval.get_arb_t(),it->second.get_arb_t());
+            }
+            return retval;
+        }
+        // phi(this), given coeffs[k] = phi^(k)(c) / k! (k = 0, ..., order) at the point c = center(), and
+        // an enclosure rem_coeff of phi^(order + 1)(xi) / (order + 1)! for xi in the range of this.
+        taylor_model compose(const arb &c, const std::vector<arb> &coeffs, const arb &rem_coeff) const
+        {
+            const taylor_model h = *this - c;
+            // Horner scheme.
+            taylor_model retval = constant(coeffs[m_order],m_prec);
+            for (auto k = m_order; k > 0u; --k) {
+                retval = retval * h;
+                retval.add_scalar(coeffs[k - 1u],m_prec);
+            }
+            // Lagrange remainder.
+            arb r = h.bound();
+            ::arb_pow_ui(r.get_arb_t(),r.get_arb_t(),static_cast<unsigned long>(m_order) + 1u,m_prec);
+            ::arb_addmul(retval.m_rem.get_arb_t(),r.get_arb_t(),rem_coeff.get_arb_t(),m_prec);
+            return retval;
+        }
+        taylor_model reciprocal() const
+        {
+            // phi(x) = 1 / x, phi^(k)(x) / k! = (-1)**k / x**(k + 1).
+            const arb c = center();
+            std::vector<arb> coeffs(m_order + 1u,zero(m_prec));
+            arb inv{zero(m_prec)};
+            ::arb_inv(inv.get_arb_t(),c.get_arb_t(),m_prec);
+            ::arb_set(coeffs[0].get_arb_t(),inv.get_arb_t());
+            for (unsigned k = 1u; k <= m_order; ++k) {
+                ::arb_mul(coeffs[k].get_arb_t(),coeffs[k - 1u].get_arb_t(),inv.get_arb_t(),m_prec);
+                ::arb_neg(coeffs[k].get_arb_t(),coeffs[k].get_arb_t());
+            }
+            arb r{bound()}, rem{zero(m_prec)};
+            ::arb_inv(r.get_arb_t(),r.get_arb_t(),m_prec);
+            ::arb_pow_ui(rem.get_arb_t(),r.get_arb_t(),static_cast<unsigned long>(m_order) + 2u,m_prec);
+            if (m_order % 2u == 0u) {
+                ::arb_neg(rem.get_arb_t(),rem.get_arb_t());
+            }
+            return compose(c,coeffs,rem);
+        }
+    public:
+        /// Variables of a box.
+        /**
+         * @param[in] box the box, one ball for each variable (a ball with centre \f$ c \f$ and radius \f$ r \f$ represents
+         * the interval \f$ [c - r, c + r] \f$).
+         * @param[in] order the order of the models.
+         *
+         * @return a vector containing, for each coordinate of \p box, the model of the corresponding variable. The
+         * precision of the models is the maximum precision of the balls in \p box.
+         *
+         * @throws std::invalid_argument if \p box is empty.
+         * @throws unspecified any exception thrown by memory allocation errors.
+         */
+        static std::vector<taylor_model> variables(const box_type &box, unsigned order)
+        {
+            if (box.empty()) {
+                throw std::invalid_argument("cannot create Taylor models over an empty box");
+            }
+            long prec = 0;
+            for (const auto &x: box) {
+                prec = std::max(prec,x.get_precision());
+            }
+            const auto b = std::make_shared<const box_type>(box);
+            std::vector<taylor_model> retval;
+            for (std::size_t i = 0u; i < box.size(); ++i) {
+                taylor_model x(b,order,prec);
+                monomial m(box.size(),0u);
+                arb c{zero(prec)};
+                ::arb_get_mid_arb(c.get_arb_t(),box[i].get_arb_t());
+                x.add_term(m,c);
+                if (order > 0u) {
+                    ::arb_get_rad_arb(c.get_arb_t(),box[i].get_arb_t());
+                    m[i] = 1u;
+                    x.add_term(m,c);
+                } else {
+                    ::arb_get_rad_arb(c.get_arb_t(),box[i].get_arb_t());
+                    ::arb_add_error(x.m_rem.get_arb_t(),c.get_arb_t());
+                }
+                retval.push_back(std::move(x));
+            }
+            return retval;
+        }
+        /// Order getter.
+        /**
+         * @return the order of \p this.
+         */
+        unsigned get_order() const
+        {
+            return m_order;
+        }
+        /// Number of variables.
+        /**
+         * @return the dimension of the box of \p this.
+         */
+        std::size_t get_n_variables() const
+        {
+            return m_box->size();
+        }
+        /// Box getter.
+        /**
+         * @return a const reference to the box of \p this.
+         */
+        const box_type &get_box() const
+        {
+            return *m_box;
+        }
+        /// Precision getter.
+        /**
+         * @return the precision of \p this.
+         */
+        long get_precision() const
+        {
+            return m_prec;
+        }
+        /// Remainder getter.
+        /**
+         * @return a const reference to the remainder of \p this.
+         */
+        const arb &get_remainder() const
+        {
+            return m_rem;
+        }
+        /// Number of terms.
+        /**
+         * @return the number of monomials stored in the polynomial part of \p this.
+         */
+        std::size_t get_n_terms() const
+        {
+            return m_poly.size();
+        }
+        /// Coefficient getter.
+        /**
+         * @param[in] exponents the exponents of the monomial in the normalised variables.
+         *
+         * @return the coefficient of the monomial (zero if not present).
+         *
+         * @throws std::invalid_argument if the size of \p exponents is not the number of variables.
+         */
+        arb get_coefficient(const std::vector<unsigned> &exponents) const
+        {
+            if (exponents.size() != get_n_variables()) {
+                throw std::invalid_argument("wrong number of exponents");
+            }
+            const auto it = m_poly.find(exponents);
+            return it == m_poly.end() ? zero(m_prec) : it->second;
+        }
+        /// Range bound.
+        /**
+         * @return an enclosure of the range of \p this over its box.
+         */
+        arb bound() const
+        {
+            arb retval = poly_bound();
+            ::arb_add(retval.get_arb_t(),retval.get_arb_t(),m_rem.get_arb_t(),m_prec);
+            return retval;
+        }
+        /// Evaluation.
+        /**
+         * @param[in] x a point or a sub-box of the box of \p this (one ball for each variable).
+         *
+         * @return an enclosure of the values of \p this over \p x.
+         *
+         * @throws std::invalid_argument if the size of \p x is not the number of variables, or if \p x is not
+         * contained in the box of \p this.
+         * @throws unspecified any exception thrown by memory allocation errors.
+         */
+        arb evaluate(const box_type &x) const
+        {
+            const auto n = get_n_variables();
+            if (x.size() != n) {
+                throw std::invalid_argument("wrong number of values: expected " + std::to_string(n) +
+                    ", found " + std::to_string(x.size()));
+            }
+            // NOTE: the remainder is valid only over the box, i.e., for normalised coordinates in [-1,1].
+            for (std::size_t i = 0u; i < n; ++i) {
+                if (!::arb_contains((*m_box)[i].get_arb_t(),x[i].get_arb_t())) {
+                    throw std::invalid_argument("the value of the variable " + std::to_string(i) +
+                        " is not contained in the box of the Taylor model");
+                }
+            }
+            // Normalised coordinates.
+            std::vector<arb> u(n,zero(m_prec));
+            arb c{zero(m_prec)};
+            for (std::size_t i = 0u; i < n; ++i) {
+                const ::arb_struct *b = (*m_box)[i].get_arb_t();
+                if (::mag_is_zero(arb_radref(b))) {
+                    continue;
+                }
+                ::arb_get_mid_arb(c.get_arb_t(),b);
+                ::arb_sub(u[i].get_arb_t(),x[i].get_arb_t(),c.get_arb_t(),m_prec);
+                ::arb_get_rad_arb(c.get_arb_t(),b);
+                ::arb_div(u[i].get_arb_t(),u[i].get_arb_t(),c.get_arb_t(),m_prec);
+            }
+            arb retval{m_rem}, t{zero(m_prec)}, p{zero(m_prec)};
+            for (const auto &term: m_poly) {
+                ::arb_set(t.get_arb_t(),term.second.get_arb_t());
+                for (std::size_t i = 0u; i < n; ++i) {
+                    if (term.first[i]) {
+                        ::arb_pow_ui(p.get_arb_t(),u[i].get_arb_t(),term.first[i],m_prec);
+                        ::arb_mul(t.get_arb_t(),t.get_arb_t(),p.get_arb_t(),m_prec);
+                    }
+                }
+                ::arb_add(retval.get_arb_t(),retval.get_arb_t(),t.get_arb_t(),m_prec);
+            }
+            return retval;
+        }
+        /// Identity operator.
+        /**
+         * @return a copy of \p this.
+         */
+        taylor_model operator+() const
+        {
+            return *this;
+        }
+        /// Negated copy.
+        /**
+         * @return a negated copy of \p this.
+         */
+        taylor_model operator-() const
+        {
+            taylor_model retval{*this};
+            for (auto &t: retval.m_poly) {
+                ::arb_neg(t.second.get_arb_t(),t.second.get_arb_t());
+            }
+            ::arb_neg(retval.m_rem.get_arb_t(),retval.m_rem.get_arb_t());
+            return retval;
+        }
+        /// Addition.
+        /**
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         *
+         * @return <tt>a + b</tt>.
+         *
+         * @throws std::invalid_argument if \p a and \p b have different boxes or orders.
+         */
+        friend taylor_model operator+(const taylor_model &a, const taylor_model &b)
+        {
+            return binary_add(a,b,false);
+        }
+        /// Subtraction.
+        /**
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         *
+         * @return <tt>a - b</tt>.
+         *
+         * @throws std::invalid_argument if \p a and \p b have different boxes or orders.
+         */
+        friend taylor_model operator-(const taylor_model &a, const taylor_model &b)
+        {
+            return binary_add(a,b,true);
+        }
+        /// Multiplication.
+        /**
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         *
+         * @return <tt>a * b</tt>.
+         *
+         * @throws std::invalid_argument if \p a and \p b have different boxes or orders.
+         */
+        friend taylor_model operator*(const taylor_model &a, const taylor_model &b)
+        {
+            return binary_mul(a,b);
+        }
+        /// Division.
+        /**
+         * The division is computed as the product of \p a by the Taylor expansion of the reciprocal of \p b.
+         *
+         * @param[in] a first operand.
+         * @param[in] b second operand.
+         *
+         * @return <tt>a / b</tt>.
+         *
+         * @throws std::invalid_argument if \p a and \p b have different boxes or orders.
+         */
+        friend taylor_model operator/(const taylor_model &a, const taylor_model &b)
+        {
+            return a * b.reciprocal();
+        }
+        /// Cosine.
+        /**
+         * @param[in] x argument.
+         *
+         * @return the cosine of \p x.
+         */
+        friend taylor_model cos(const taylor_model &x)
+        {
+            // The derivatives of cos cycle through cos, -sin, -cos, sin.
+            const long prec = x.m_prec;
+            const arb c = x.center();
+            arb s{zero(prec)}, co{zero(prec)};
+            ::arb_sin_cos(s.get_arb_t(),co.get_arb_t(),c.get_arb_t(),prec);
+            auto derivative = [](unsigned k, const arb &sv, const arb &cv) -> arb {
+                switch (k % 4u) {
+                    case 0u:
+                        return cv;
+                    case 1u:
+                        return -sv;
+                    case 2u:
+                        return -cv;
+                    default:
+                        return sv;
+                }
+            };
+            std::vector<arb> coeffs;
+            arb inv_fact{1,prec};
+            for (unsigned k = 0u; k <= x.m_order; ++k) {
+                if (k > 0u) {
+                    ::arb_div_ui(inv_fact.get_arb_t(),inv_fact.get_arb_t(),k,prec);
+                }
+                coeffs.push_back(derivative(k,s,co));
+                ::arb_mul(coeffs.back().get_arb_t(),coeffs.back().get_arb_t(),inv_fact.get_arb_t(),prec);
+            }
+            // Remainder: the derivative of order + 1 over the range of x.
+            const arb r = x.bound();
+            ::arb_sin_cos(s.get_arb_t(),co.get_arb_t(),r.get_arb_t(),prec);
+            arb rem = derivative(x.m_order + 1u,s,co);
+            ::arb_div_ui(inv_fact.get_arb_t(),inv_fact.get_arb_t(),x.m_order + 1u,prec);
+            ::arb_mul(rem.get_arb_t(),rem.get_arb_t(),inv_fact.get_arb_t(),prec);
+            return x.compose(c,coeffs,rem);
+        }
+        /// Square root.
+        /**
+         * @param[in] x argument.
+         *
+         * @return the square root of \p x.
+         */
+        friend taylor_model sqrt(const taylor_model &x)
+        {
+            // phi^(k)(c) / k! = binomial(1/2,k) * c**(1/2 - k).
+            const long prec = x.m_prec;
+            const arb c = x.center();
+            arb inv{zero(prec)}, binom{1,prec};
+            ::arb_inv(inv.get_arb_t(),c.get_arb_t(),prec);
+            std::vector<arb> coeffs(1u,zero(prec));
+            ::arb_sqrt(coeffs[0].get_arb_t(),c.get_arb_t(),prec);
+            // binomial(1/2,k + 1) = binomial(1/2,k) * (1 - 2k) / (2k + 2).
+            auto next_binom = [prec](arb &b, unsigned k) {
+                ::arb_mul_si(b.get_arb_t(),b.get_arb_t(),1 - 2 * static_cast<long>(k),prec);
+                ::arb_div_ui(b.get_arb_t(),b.get_arb_t(),2u * k + 2u,prec);
+            };
+            arb p{coeffs[0]};
+            for (unsigned k = 1u; k <= x.m_order; ++k) {
+                next_binom(binom,k - 1u);
+                ::arb_mul(p.get_arb_t(),p.get_arb_t(),inv.get_arb_t(),prec);
+                coeffs.push_back(p);
+                ::arb_mul(coeffs.back().get_arb_t(),coeffs.back().get_arb_t(),binom.get_arb_t(),prec);
+            }
+            next_binom(binom,x.m_order);
+            // Remainder: binomial(1/2,order + 1) * xi**(1/2 - order - 1) over the range of x.
+            const arb r = x.bound();
+            arb rem{zero(prec)};
+            ::arb_sqrt(rem.get_arb_t(),r.get_arb_t(),prec);
+            ::arb_inv(inv.get_arb_t(),r.get_arb_t(),prec);
+            ::arb_pow_ui(inv.get_arb_t(),inv.get_arb_t(),static_cast<unsigned long>(x.m_order) + 1u,prec);
+            ::arb_mul(rem.get_arb_t(),rem.get_arb_t(),inv.get_arb_t(),prec);
+            ::arb_mul(rem.get_arb_t(),rem.get_arb_t(),binom.get_arb_t(),prec);
+            return x.compose(c,coeffs,rem);
+        }
+        /// Stream operator.
+        /**
+         * Prints the nonzero terms of the polynomial part (with the normalised variables named <tt>u0</tt>,
+         * <tt>u1</tt>, etc.), followed by the remainder.
+         *
+         * @param[in,out] os target stream.
+         * @param[in] x arbpp::taylor_model to be streamed.
+         *
+         * @return reference to \p os.
+         */
+        friend std::ostream &operator<<(std::ostream &os, const taylor_model &x)
+        {
+            for (const auto &t: x.m_poly) {
+                os << t.second;
+                for (std::size_t i = 0u; i < t.first.size(); ++i) {
+                    if (t.first[i]) {
+                        os << "*u" << i;
+                        if (t.first[i] > 1u) {
+                            os << '^' << t.first[i];
+                        }
+                    }
+                }
+                os << " + ";
+            }
+            os << '[' << x.m_rem << ']';
+            return os;
+        }
+    private:
+        std::shared_ptr<const box_type>     m_box;
+        unsigned                            m_order;
+        long                                m_prec;
+        poly_type                           m_poly;
+        arb                                 m_rem;
+};
+
+}
+
+#endif
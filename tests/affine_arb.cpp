@@ -0,0 +1,149 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#include "../src/affine_arb.hpp"
+
+#define BOOST_TEST_MODULE affine_arb_test
+#include <boost/test/unit_test.hpp>
+
+#include <arb.h>
+#include <flint/flint.h>
+
+#include "../src/arbpp.hpp"
+#include "helpers.hpp"
+
+using namespace arbpp;
+using namespace arbpp_test;
+
+static arb to_arb(const affine_arb &x)
+{
+    return static_cast<arb>(x);
+}
+
+BOOST_AUTO_TEST_CASE(affine_arb_constructors_test)
+{
+    affine_arb z;
+    BOOST_CHECK_EQUAL(z.get_precision(),arb::get_default_precision());
+    BOOST_CHECK_EQUAL(z.get_n_symbols(),0u);
+    BOOST_CHECK(::arb_is_zero(to_arb(z).get_arb_t()));
+    affine_arb a{arb{3}}, b{3}, c{1.5,100};
+    BOOST_CHECK_EQUAL(a.get_n_symbols(),0u);
+    BOOST_CHECK((to_arb(a) == arb{3}).is_true());
+    BOOST_CHECK((to_arb(b) == arb{3}).is_true());
+    BOOST_CHECK_EQUAL(c.get_precision(),100);
+    BOOST_CHECK((to_arb(c) == arb{1.5}).is_true());
+    // The radius goes into a fresh noise symbol.
+    const arb x0 = interval(0.5,1.5);
+    affine_arb x{x0};
+    BOOST_CHECK_EQUAL(x.get_n_symbols(),1u);
+    BOOST_CHECK((x.get_center() == arb{1}).is_true());
+    BOOST_CHECK(contains(to_arb(x),x0));
+    BOOST_CHECK(contains(x0,to_arb(x)));
+    // Two affine balls built from the same ball are independent.
+    affine_arb y{x0};
+    BOOST_CHECK(::arb_is_zero(to_arb(x - x).get_arb_t()));
+    BOOST_CHECK(!::arb_is_zero(to_arb(x - y).get_arb_t()));
+    BOOST_CHECK(contains(to_arb(x - y),interval(-1.,1.)));
+}
+
+BOOST_AUTO_TEST_CASE(affine_arb_correlation_test)
+{
+    const arb x0 = interval(0.9,1.1), y0 = interval(1.5,2.5);
+    const affine_arb x{x0}, y{y0};
+    // Linear cancellations are exact.
+    BOOST_CHECK(::arb_is_zero(to_arb((x + y) - x - y).get_arb_t()));
+    BOOST_CHECK(::arb_is_zero(to_arb(3 * x - x - 2 * x).get_arb_t()));
+    BOOST_CHECK(width(to_arb((x + y) - x)) < width(y0) * (1. + 1e-10));
+    const auto p = x * y;
+    BOOST_CHECK(::arb_is_zero(to_arb(p - p).get_arb_t()));
+    // A recursive filter converging to x / 2: the radius of the plain ball grows at each step, the affine one stays
+    // close to the range of x / 2.
+    affine_arb s{x};
+    arb s0{x0};
+    for (int i = 0; i < 100; ++i) {
+        s = 0.75 * s + 0.5 * x - 0.25 * (s + x);
+        s0 = 0.75 * s0 + 0.5 * x0 - 0.25 * (s0 + x0);
+    }
+    BOOST_CHECK(contains(to_arb(s),arb{0.5}));
+    BOOST_CHECK(width(to_arb(s)) < 0.51 * width(x0));
+    BOOST_CHECK(width(s0) > 10. * width(x0));
+    // Comparisons see the correlations.
+    BOOST_CHECK((x == x).is_true());
+    BOOST_CHECK((x < x + 1).is_true());
+    BOOST_CHECK((x >= x).is_true());
+    BOOST_CHECK((x != x).is_false());
+    BOOST_CHECK((x > y).is_false());
+    BOOST_CHECK((x <= y).is_true());
+    BOOST_CHECK((affine_arb{x0} == x).is_indeterminate());
+}
+
+BOOST_AUTO_TEST_CASE(affine_arb_functions_test)
+{
+    const arb x0 = interval(0.9,1.1);
+    const affine_arb x{x0};
+    const affine_arb q = x / x, r = 1 / x, s = sqrt(x), c = cos(x), p = x * x;
+    BOOST_CHECK(contains(to_arb(q),arb{1}));
+    BOOST_CHECK(width(to_arb(q)) < width(x0 / x0));
+    BOOST_CHECK(contains(to_arb(s * s - x),arb{0}));
+    BOOST_CHECK(contains(to_arb(c * c + sqrt(1 - c * c) * sqrt(1 - c * c)),arb{1}));
+    // The results enclose the values at the points of the range.
+    for (double v: {0.91,0.95,1.,1.03,1.09}) {
+        const arb pt{v};
+        BOOST_CHECK(contains(to_arb(r),1 / pt));
+        BOOST_CHECK(contains(to_arb(s),sqrt(pt)));
+        BOOST_CHECK(contains(to_arb(c),cos(pt)));
+        BOOST_CHECK(contains(to_arb(p),pt * pt));
+        BOOST_CHECK(contains(to_arb(abs(x - 1)),abs(pt - 1)));
+        BOOST_CHECK(contains(to_arb(abs(-x)),pt));
+    }
+    // No wider than the plain balls for a single operation.
+    BOOST_CHECK(width(to_arb(r)) < 1.01 * width(1 / x0));
+    BOOST_CHECK(width(to_arb(s)) < 1.01 * width(sqrt(x0)));
+    // Outside of the domain.
+    BOOST_CHECK(!::arb_is_finite(to_arb(1 / (x - 1)).get_arb_t()));
+    BOOST_CHECK(!::arb_is_finite(to_arb(sqrt(x - 1)).get_arb_t()));
+}
+
+BOOST_AUTO_TEST_CASE(affine_arb_mixed_test)
+{
+    const affine_arb x{interval(0.9,1.1)};
+    affine_arb y{x};
+    y += 1;
+    y *= arb{2};
+    y -= x;
+    y /= 2.;
+    y = 1 - y;
+    // 1 - (2 * (x + 1) - x) / 2 = -x / 2.
+    BOOST_CHECK(::arb_is_zero(to_arb(y + x / 2).get_arb_t()));
+    affine_arb z{x};
+    z += x;
+    z -= 2 * x;
+    BOOST_CHECK(::arb_is_zero(to_arb(z).get_arb_t()));
+    BOOST_CHECK(::arb_is_zero(to_arb(+x - -(-x)).get_arb_t()));
+    const affine_arb w{arb{1,200}};
+    BOOST_CHECK_EQUAL((x + w).get_precision(),200);
+    BOOST_CHECK_EQUAL((x * arb{1,300}).get_precision(),300);
+}
+
+BOOST_AUTO_TEST_CASE(affine_arb_cleanup)
+{
+    ::flint_cleanup();
+}
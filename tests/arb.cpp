@@ -23,10 +23,14 @@
 #define BOOST_TEST_MODULE arb_test
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
 #include <arb.h>
 #include <arf.h>
 #include <cmath>
 #include <flint/flint.h>
+#include <flint/fmpq.h>
+#include <flint/fmpz.h>
+#include <gmp.h>
 #include <limits>
 #include <mag.h>
 #include <mpfr.h>
@@ -34,20 +38,23 @@
 #include <stdexcept>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 using namespace arbpp;
 
 BOOST_AUTO_TEST_CASE(arb_ctor_assignment_test)
 {
     // Some type-traits checks.
-    BOOST_CHECK((!std::is_constructible<arb,long double>::value));
-    BOOST_CHECK((!std::is_constructible<arb,long long>::value));
+    BOOST_CHECK((std::is_constructible<arb,long double>::value));
+    BOOST_CHECK((std::is_constructible<arb,long long>::value));
+    BOOST_CHECK((!std::is_constructible<arb,int *>::value));
     BOOST_CHECK((std::is_constructible<arb,long>::value));
     BOOST_CHECK((std::is_constructible<arb,char>::value));
     BOOST_CHECK((std::is_constructible<arb,unsigned char>::value));
     BOOST_CHECK((std::is_assignable<arb &,unsigned char>::value));
     BOOST_CHECK((std::is_assignable<arb &,double>::value));
-    BOOST_CHECK((!std::is_assignable<arb &,long double>::value));
+    BOOST_CHECK((std::is_assignable<arb &,long double>::value));
+    BOOST_CHECK((!std::is_assignable<arb &,int *>::value));
     // Default ctor.
     arb a0;
     BOOST_CHECK(::arf_is_zero(arb_midref(a0.get_arb_t())));
@@ -634,6 +641,464 @@ BOOST_AUTO_TEST_CASE(arb_arithmetic_test)
     BOOST_CHECK_EQUAL((128. / a2).get_precision(),arb::get_default_precision() + 20);
 }
 
+BOOST_AUTO_TEST_CASE(arb_wide_interop_test)
+{
+    // long long and unsigned long long.
+    BOOST_CHECK_EQUAL(arb{42ll}.get_midpoint(),42.);
+    BOOST_CHECK_EQUAL(arb{-42ll}.get_midpoint(),-42.);
+    BOOST_CHECK_EQUAL(arb{42ull}.get_radius(),0.);
+    BOOST_CHECK_EQUAL((arb{std::numeric_limits<long long>::min(),100}.get_radius()),0.);
+    BOOST_CHECK_EQUAL((arb{std::numeric_limits<long long>::min(),100}.get_midpoint()),
+        static_cast<double>(std::numeric_limits<long long>::min()));
+    BOOST_CHECK_EQUAL((arb{std::numeric_limits<unsigned long long>::max(),100}.get_radius()),0.);
+    // 2**60 + 1 does not fit in the default precision.
+    BOOST_CHECK(arb{(1ll << 60) + 1}.get_radius() != 0.);
+    BOOST_CHECK_EQUAL(arb((1ll << 60) + 1,70).get_radius(),0.);
+    arb a0{1};
+    a0 += 2ll;
+    BOOST_CHECK_EQUAL(a0.get_midpoint(),3.);
+    a0 *= 2ull;
+    BOOST_CHECK_EQUAL(a0.get_midpoint(),6.);
+    a0 -= 1ll;
+    BOOST_CHECK_EQUAL(a0.get_midpoint(),5.);
+    a0 /= 5ll;
+    BOOST_CHECK_EQUAL(a0.get_midpoint(),1.);
+    BOOST_CHECK((std::is_same<arb,decltype(a0 + 1ll)>::value));
+    BOOST_CHECK((std::is_same<arb,decltype(1ull - a0)>::value));
+    BOOST_CHECK_EQUAL((a0 + 1ll).get_midpoint(),2.);
+    BOOST_CHECK_EQUAL((3ll - a0).get_midpoint(),2.);
+    BOOST_CHECK_EQUAL((4ull * a0).get_midpoint(),4.);
+    BOOST_CHECK_EQUAL((4ll / a0).get_midpoint(),4.);
+    BOOST_CHECK_EQUAL((a0 / 4ll).get_midpoint(),.25);
+#if defined(ARBPP_HAVE_INT128)
+    __extension__ typedef __int128 int128;
+    __extension__ typedef unsigned __int128 uint128;
+    const int128 big = (int128(1) << 100) + 1;
+    BOOST_CHECK(arb{big}.get_radius() != 0.);
+    BOOST_CHECK_EQUAL(arb(big,110).get_radius(),0.);
+    BOOST_CHECK_EQUAL(arb(-big,110).get_radius(),0.);
+    BOOST_CHECK_EQUAL(arb(-big,110).get_midpoint(),-std::ldexp(1.,100));
+    BOOST_CHECK_EQUAL(arb(uint128(big),110).get_midpoint(),std::ldexp(1.,100));
+    BOOST_CHECK_EQUAL((arb(1,110) + big).get_midpoint(),std::ldexp(1.,100));
+    BOOST_CHECK_EQUAL((int128(-3) * arb{2}).get_midpoint(),-6.);
+#endif
+    // long double.
+    BOOST_CHECK_EQUAL(arb{1.5l}.get_midpoint(),1.5);
+    BOOST_CHECK_EQUAL(arb{1.5l}.get_radius(),0.);
+    if (std::numeric_limits<long double>::digits > std::numeric_limits<double>::digits) {
+        // 1 + epsilon is exact in long double, but not at the default precision.
+        const long double x = 1.l + std::numeric_limits<long double>::epsilon();
+        BOOST_CHECK(arb{x}.get_radius() != 0.);
+        BOOST_CHECK_EQUAL(arb(x,std::numeric_limits<long double>::digits).get_radius(),0.);
+    }
+    BOOST_CHECK_EQUAL((arb{1} + .5l).get_midpoint(),1.5);
+    BOOST_CHECK_EQUAL((.5l - arb{1}).get_midpoint(),-.5);
+    BOOST_CHECK_EQUAL((arb{3} * .5l).get_midpoint(),1.5);
+    BOOST_CHECK_EQUAL((arb{3} / .5l).get_midpoint(),6.);
+    // mpz_t and fmpz_t.
+    ::mpz_t z;
+    ::mpz_init_set_si(z,-12);
+    BOOST_CHECK_EQUAL(arb{z}.get_midpoint(),-12.);
+    BOOST_CHECK_EQUAL((arb{1} + z).get_midpoint(),-11.);
+    BOOST_CHECK_EQUAL((z / arb{4}).get_midpoint(),-3.);
+    ::mpz_mul_2exp(z,z,200);
+    BOOST_CHECK_EQUAL(arb(z,10).get_radius(),0.);
+    BOOST_CHECK_EQUAL(arb(z,10).get_midpoint(),-12. * std::ldexp(1.,200));
+    ::mpz_clear(z);
+    ::fmpz_t f;
+    ::fmpz_init(f);
+    ::fmpz_set_si(f,7);
+    BOOST_CHECK_EQUAL(arb{f}.get_midpoint(),7.);
+    a0 = f;
+    BOOST_CHECK_EQUAL(a0.get_midpoint(),7.);
+    a0 -= f;
+    BOOST_CHECK_EQUAL(a0.get_midpoint(),0.);
+    BOOST_CHECK_EQUAL((f * arb{2}).get_midpoint(),14.);
+    ::fmpz_clear(f);
+    // fmpq_t.
+    ::fmpq_t q;
+    ::fmpq_init(q);
+    ::fmpq_set_si(q,1,4);
+    BOOST_CHECK_EQUAL(arb{q}.get_midpoint(),.25);
+    BOOST_CHECK_EQUAL(arb{q}.get_radius(),0.);
+    ::fmpq_set_si(q,1,3);
+    BOOST_CHECK(arb{q}.get_radius() != 0.);
+    BOOST_CHECK_EQUAL(arb(q,100).get_precision(),100);
+    BOOST_CHECK_EQUAL((arb{3} * q).get_midpoint(),1.);
+    BOOST_CHECK_EQUAL((arb{3} * q).get_radius(),0.);
+    ::fmpq_set_si(q,1,2);
+    BOOST_CHECK_EQUAL((arb{3} + q).get_midpoint(),3.5);
+    BOOST_CHECK_EQUAL((q - arb{3}).get_midpoint(),-2.5);
+    BOOST_CHECK_EQUAL((arb{3} / q).get_midpoint(),6.);
+    BOOST_CHECK_EQUAL((q / arb{2}).get_midpoint(),.25);
+    a0 = arb{1};
+    a0 *= q;
+    BOOST_CHECK_EQUAL(a0.get_midpoint(),.5);
+    ::fmpq_clear(q);
+}
+
+BOOST_AUTO_TEST_CASE(arb_rational_test)
+{
+    BOOST_CHECK((std::is_constructible<arb,rational>::value));
+    BOOST_CHECK((std::is_same<arb,decltype(arb{} + rational{})>::value));
+    BOOST_CHECK((std::is_same<arb &,decltype(arb{} *= rational{})>::value));
+    const rational half{1,2}, third{1,3}, two{2};
+    BOOST_CHECK_EQUAL(arb{half}.get_midpoint(),.5);
+    BOOST_CHECK_EQUAL(arb{half}.get_radius(),0.);
+    BOOST_CHECK(arb{third}.get_radius() != 0.);
+    // Exact results must come out exact, as only one rounding takes place.
+    BOOST_CHECK_EQUAL((arb{3} * third).get_midpoint(),1.);
+    BOOST_CHECK_EQUAL((arb{3} * third).get_radius(),0.);
+    BOOST_CHECK_EQUAL((third * arb{3}).get_radius(),0.);
+    BOOST_CHECK_EQUAL((arb{1} / third).get_midpoint(),3.);
+    BOOST_CHECK_EQUAL((arb{1} / third).get_radius(),0.);
+    BOOST_CHECK_EQUAL((third / arb{1,100}).get_precision(),100);
+    BOOST_CHECK(::arb_contains_fmpq((third / arb{3,100}).get_arb_t(),rational{1,9}.get_fmpq_t()));
+    BOOST_CHECK((third / arb{3,100}).get_radius() < 1E-28);
+    BOOST_CHECK_EQUAL((half / arb{4}).get_midpoint(),.125);
+    BOOST_CHECK_EQUAL((half / arb{4}).get_radius(),0.);
+    BOOST_CHECK_EQUAL((arb{1} + half).get_midpoint(),1.5);
+    BOOST_CHECK_EQUAL((arb{1} - half).get_midpoint(),.5);
+    BOOST_CHECK_EQUAL((half - arb{1}).get_midpoint(),-.5);
+    BOOST_CHECK_EQUAL((arb{1} + two).get_midpoint(),3.);
+    BOOST_CHECK_EQUAL((arb{1} - two).get_midpoint(),-1.);
+    BOOST_CHECK_EQUAL((arb{1} * two).get_midpoint(),2.);
+    BOOST_CHECK_EQUAL((arb{1} / two).get_midpoint(),.5);
+    BOOST_CHECK_EQUAL((two / arb{4}).get_midpoint(),.5);
+    // In-place.
+    arb a0{2,100};
+    a0 += third;
+    a0 -= third;
+    BOOST_CHECK_EQUAL(a0.get_midpoint(),2.);
+    a0 *= third;
+    a0 /= third;
+    BOOST_CHECK_EQUAL(a0.get_midpoint(),2.);
+    BOOST_CHECK_EQUAL(a0.get_precision(),100);
+    // Fused operations.
+    arb a1{1};
+    a1.addmul(arb{3},third);
+    BOOST_CHECK_EQUAL(a1.get_midpoint(),2.);
+    BOOST_CHECK_EQUAL(a1.get_radius(),0.);
+    a1.addmul(arb{3},two);
+    BOOST_CHECK_EQUAL(a1.get_midpoint(),8.);
+    BOOST_CHECK((std::is_same<arb &,decltype(a1.addmul(arb{},two))>::value));
+    // 3 * x**2 + 1/2 * x + 1/3 in x = 1/2 via Horner.
+    const rational c[] = {third,half,rational{3}};
+    const arb x{.5,200};
+    arb acc{c[2],200};
+    acc.mul_add(x,c[1]);
+    acc.mul_add(x,c[0]);
+    BOOST_CHECK_EQUAL(acc.get_precision(),200);
+    BOOST_CHECK((acc - rational{4,3}).get_radius() < 1E-50);
+    ::fmpq_t f;
+    ::fmpq_init(f);
+    ::fmpq_set_si(f,1,4);
+    a1 = 2;
+    a1.mul_add(arb{3},f);
+    BOOST_CHECK_EQUAL(a1.get_midpoint(),6.25);
+    BOOST_CHECK_EQUAL(a1.get_radius(),0.);
+    ::fmpq_clear(f);
+    // Operands with distant exponents: the intermediate steps must not be exact.
+    arb huge{1,100}, tiny{1,100};
+    ::arb_mul_2exp_si(huge.get_arb_t(),huge.get_arb_t(),1l << 40);
+    ::arb_mul_2exp_si(tiny.get_arb_t(),tiny.get_arb_t(),-(1l << 40));
+    for (const auto &y: {huge,tiny}) {
+        const arb r[] = {y + third,y - third,third - y,y * third,y / third,third / y};
+        for (const auto &z: r) {
+            BOOST_CHECK(::arb_is_finite(z.get_arb_t()));
+            BOOST_CHECK(::arb_rel_accuracy_bits(z.get_arb_t()) >= 90);
+        }
+        arb a2{y};
+        a2.addmul(tiny,third);
+        BOOST_CHECK(::arb_rel_accuracy_bits(a2.get_arb_t()) >= 90);
+        a2 = y;
+        a2.mul_add(arb{3,100},third);
+        BOOST_CHECK(::arb_rel_accuracy_bits(a2.get_arb_t()) >= 90);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(arb_bulk_conversion_test)
+{
+    std::vector<arb> v;
+    for (int i = 0; i < 1000; ++i) {
+        v.emplace_back(i);
+        v.back().add_error(.5);
+    }
+    for (unsigned n_threads = 1u; n_threads <= 4u; ++n_threads) {
+        std::vector<double> mid(v.size()), rad(v.size()), lb(v.size()), ub(v.size());
+        get_midpoints(v.begin(),v.end(),mid.data(),n_threads);
+        get_radii(v.begin(),v.end(),rad.data(),n_threads);
+        get_lower_bounds(v.begin(),v.end(),lb.data(),n_threads);
+        get_upper_bounds(v.begin(),v.end(),ub.data(),n_threads);
+        for (std::size_t i = 0u; i < v.size(); ++i) {
+            BOOST_CHECK_EQUAL(mid[i],v[i].get_midpoint());
+            BOOST_CHECK_EQUAL(rad[i],v[i].get_radius());
+            BOOST_CHECK(rad[i] >= .5);
+            BOOST_CHECK(lb[i] <= static_cast<double>(i) - .5);
+            BOOST_CHECK(ub[i] >= static_cast<double>(i) + .5);
+            BOOST_CHECK(ub[i] - lb[i] < 1.1);
+        }
+    }
+    BOOST_CHECK_THROW(get_midpoints(v.begin(),v.end(),static_cast<double *>(nullptr),0u),std::invalid_argument);
+    // Empty range.
+    get_radii(v.begin(),v.begin(),static_cast<double *>(nullptr),4u);
+    // Import from double.
+    std::vector<double> d(v.size());
+    for (std::size_t i = 0u; i < d.size(); ++i) {
+        d[i] = static_cast<double>(i) + .25;
+    }
+    set_values(v.begin(),v.end(),d.data(),100,3u);
+    for (std::size_t i = 0u; i < v.size(); ++i) {
+        BOOST_CHECK_EQUAL(v[i].get_midpoint(),d[i]);
+        BOOST_CHECK_EQUAL(v[i].get_radius(),0.);
+        BOOST_CHECK_EQUAL(v[i].get_precision(),100);
+    }
+    // Low precision introduces a radius.
+    set_values(v.begin(),v.end(),d.data(),2);
+    BOOST_CHECK(v[999].get_radius() != 0.);
+    BOOST_CHECK_THROW(set_values(v.begin(),v.end(),d.data(),0),std::invalid_argument);
+    // Import from mpfr_t.
+    ::mpfr_t m[3];
+    for (auto &x: m) {
+        ::mpfr_init2(x,200);
+    }
+    ::mpfr_set_d(m[0],1.5,MPFR_RNDN);
+    ::mpfr_set_d(m[1],-3,MPFR_RNDN);
+    ::mpfr_set_d(m[2],1,MPFR_RNDN);
+    ::mpfr_nextabove(m[2]);
+    set_values(v.begin(),v.begin() + 3,m);
+    BOOST_CHECK_EQUAL(v[0].get_midpoint(),1.5);
+    BOOST_CHECK_EQUAL(v[1].get_midpoint(),-3.);
+    BOOST_CHECK_EQUAL(v[1].get_radius(),0.);
+    BOOST_CHECK_EQUAL(v[1].get_precision(),arb::get_default_precision());
+    // 1 + 2**-199 is not representable at the default precision.
+    BOOST_CHECK(v[2].get_radius() != 0.);
+    set_values(v.begin(),v.begin() + 3,m,200,2u);
+    BOOST_CHECK_EQUAL(v[2].get_radius(),0.);
+    for (auto &x: m) {
+        ::mpfr_clear(x);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(arb_to_double_test)
+{
+    // Exact values.
+    arb a0{1.5};
+    BOOST_CHECK_EQUAL(a0.to_double(),1.5);
+    BOOST_CHECK_EQUAL(a0.to_double(rounding_mode::downward),1.5);
+    BOOST_CHECK_EQUAL(a0.to_double(rounding_mode::upward),1.5);
+    BOOST_CHECK(a0.to_double_interval() == std::make_pair(1.5,1.5));
+    // Exact value not representable in double.
+    arb a1{"1",200};
+    a1 += arb{"1E-30",200};
+    BOOST_CHECK_EQUAL(a1.to_double(),1.);
+    BOOST_CHECK_EQUAL(a1.to_double(rounding_mode::downward),1.);
+    BOOST_CHECK_EQUAL(a1.to_double(rounding_mode::upward),std::nextafter(1.,2.));
+    // Balls.
+    arb a2{1};
+    a2.add_error(.5);
+    const auto p2 = a2.to_double_interval();
+    BOOST_CHECK(p2.first <= .5);
+    BOOST_CHECK(p2.second >= 1.5);
+    BOOST_CHECK_EQUAL(p2.first,a2.to_double(rounding_mode::downward));
+    BOOST_CHECK_EQUAL(p2.second,a2.to_double(rounding_mode::upward));
+    BOOST_CHECK_EQUAL(a2.to_double(),1.);
+    // 1/3 is enclosed in an interval of width of a few ulps.
+    const auto p3 = (arb{1,200} / 3).to_double_interval();
+    BOOST_CHECK(p3.first <= 1. / 3 && p3.second >= 1. / 3);
+    BOOST_CHECK(std::nextafter(std::nextafter(p3.first,1.),1.) >= p3.second);
+    BOOST_CHECK((arb{1} / 3).to_double(rounding_mode::downward) < (arb{1} / 3).to_double(rounding_mode::upward));
+    // Out-of-range values.
+    if (std::numeric_limits<double>::has_infinity) {
+        arb big{"1E400",60};
+        BOOST_CHECK_EQUAL(big.to_double(rounding_mode::downward),std::numeric_limits<double>::max());
+        BOOST_CHECK_EQUAL(big.to_double(rounding_mode::upward),std::numeric_limits<double>::infinity());
+        arb a3{0};
+        a3.add_error(std::numeric_limits<double>::infinity());
+        BOOST_CHECK_EQUAL(a3.to_double(rounding_mode::downward),-std::numeric_limits<double>::infinity());
+        BOOST_CHECK_EQUAL(a3.to_double(rounding_mode::upward),std::numeric_limits<double>::infinity());
+    }
+    // Vectorized versions.
+    std::vector<arb> v;
+    for (int i = 0; i < 100; ++i) {
+        v.push_back(arb{i} / 7);
+    }
+    std::vector<double> d(v.size()), lo(v.size()), hi(v.size());
+    to_double(v.begin(),v.end(),d.data());
+    to_double_interval(v.begin(),v.end(),lo.data(),hi.data(),3u);
+    for (std::size_t i = 0u; i < v.size(); ++i) {
+        BOOST_CHECK_EQUAL(d[i],v[i].to_double());
+        BOOST_CHECK(lo[i] <= d[i] && d[i] <= hi[i]);
+        BOOST_CHECK_EQUAL(lo[i],v[i].to_double(rounding_mode::downward));
+        BOOST_CHECK_EQUAL(hi[i],v[i].to_double(rounding_mode::upward));
+    }
+    to_double(v.begin(),v.end(),d.data(),rounding_mode::upward,2u);
+    BOOST_CHECK(d == hi);
+}
+
+BOOST_AUTO_TEST_CASE(arb_comparison_test)
+{
+    // tribool.
+    BOOST_CHECK(tribool{true}.is_true());
+    BOOST_CHECK(tribool{}.is_false());
+    BOOST_CHECK(is_indeterminate(tribool::indeterminate()));
+    BOOST_CHECK((!tribool{true}).is_false());
+    BOOST_CHECK((!tribool{false}).is_true());
+    BOOST_CHECK(is_indeterminate(!tribool::indeterminate()));
+    BOOST_CHECK(static_cast<bool>(tribool{true}));
+    BOOST_CHECK(!static_cast<bool>(tribool::indeterminate()));
+    BOOST_CHECK((std::is_same<decltype(arb{} < arb{}),tribool>::value));
+    BOOST_CHECK(!(std::is_convertible<tribool,bool>::value));
+    // Exact balls.
+    const arb one{1}, two{2};
+    BOOST_CHECK((one < two).is_true());
+    BOOST_CHECK((one <= two).is_true());
+    BOOST_CHECK((one > two).is_false());
+    BOOST_CHECK((one >= two).is_false());
+    BOOST_CHECK((one == two).is_false());
+    BOOST_CHECK((one != two).is_true());
+    BOOST_CHECK((one == arb{1}).is_true());
+    BOOST_CHECK((one <= arb{1}).is_true());
+    BOOST_CHECK((one < arb{1}).is_false());
+    if (one < two) {
+        BOOST_CHECK(true);
+    } else {
+        BOOST_CHECK(false);
+    }
+    // Overlapping balls.
+    const arb third = arb{1} / 3;
+    BOOST_CHECK(is_indeterminate(third < third));
+    BOOST_CHECK(is_indeterminate(third == third));
+    BOOST_CHECK(is_indeterminate(third != third));
+    BOOST_CHECK(is_indeterminate(third >= third));
+    BOOST_CHECK((third < one).is_true());
+    BOOST_CHECK((third != one).is_true());
+    arb a{1};
+    a.add_error(.5);
+    BOOST_CHECK(is_indeterminate(a < arb{1.25}));
+    BOOST_CHECK((a < arb{2}).is_true());
+    BOOST_CHECK((a > arb{.25}).is_true());
+    // Indeterminate balls.
+    arb nan;
+    ::arb_indeterminate(nan.get_arb_t());
+    BOOST_CHECK(is_indeterminate(nan < one));
+    BOOST_CHECK(is_indeterminate(nan == one));
+    // Midpoint comparator.
+    const less_by_midpoint lbm;
+    BOOST_CHECK(lbm(one,two));
+    BOOST_CHECK(!lbm(two,one));
+    BOOST_CHECK(!lbm(third,third));
+    BOOST_CHECK(!lbm(a,arb{1}) && !lbm(arb{1},a));
+    // Exact even beyond double precision.
+    arb b{1,200}, c{1,200};
+    ::arb_mul_2exp_si(c.get_arb_t(),c.get_arb_t(),-150);
+    c += b;
+    BOOST_CHECK_EQUAL(b.get_midpoint(),c.get_midpoint());
+    BOOST_CHECK(lbm(b,c));
+    BOOST_CHECK(!lbm(c,b));
+    // NaN goes last.
+    BOOST_CHECK(lbm(one,nan));
+    BOOST_CHECK(!lbm(nan,one));
+    BOOST_CHECK(!lbm(nan,nan));
+}
+
+BOOST_AUTO_TEST_CASE(arb_sort_test)
+{
+    BOOST_CHECK_THROW(arbpp::sort(static_cast<arb *>(nullptr),static_cast<arb *>(nullptr),0u),std::invalid_argument);
+    arbpp::sort(static_cast<arb *>(nullptr),static_cast<arb *>(nullptr));
+    // Build a range with ties at double precision, exact duplicates and NaNs. The precision
+    // is used as a tag to check stability.
+    const long n = 1000;
+    std::vector<arb> orig;
+    for (long i = 0; i < n; ++i) {
+        arb tmp{(i * 7919) % 101 - 50,100 + i};
+        if (i % 3 == 0) {
+            arb tiny{1,100 + i};
+            ::arb_mul_2exp_si(tiny.get_arb_t(),tiny.get_arb_t(),-80 - (i % 5));
+            tmp += tiny;
+        }
+        if (i % 97 == 0) {
+            ::arb_indeterminate(tmp.get_arb_t());
+        }
+        orig.push_back(std::move(tmp));
+    }
+    const less_by_midpoint lbm;
+    for (unsigned nt: {1u,2u,3u,7u,16u}) {
+        std::vector<arb> v(orig);
+        arbpp::sort(v.begin(),v.end(),nt);
+        BOOST_CHECK_EQUAL(v.size(),orig.size());
+        for (std::size_t i = 1u; i < v.size(); ++i) {
+            BOOST_CHECK(!lbm(v[i],v[i - 1u]));
+            if (!lbm(v[i - 1u],v[i])) {
+                // Equivalent elements keep their original order.
+                BOOST_CHECK(v[i - 1u].get_precision() < v[i].get_precision());
+            }
+        }
+        BOOST_CHECK(std::isnan(v.back().get_midpoint()));
+        BOOST_CHECK(!std::isnan(v.front().get_midpoint()));
+        // Same result as the standard library.
+        std::vector<arb> w(orig);
+        std::stable_sort(w.begin(),w.end(),lbm);
+        for (std::size_t i = 0u; i < v.size(); ++i) {
+            BOOST_CHECK(::arb_equal(v[i].get_arb_t(),w[i].get_arb_t()));
+            BOOST_CHECK_EQUAL(v[i].get_precision(),w[i].get_precision());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(arb_sum_test)
+{
+    const summation_method methods[] = {summation_method::serial,summation_method::pairwise,
+        summation_method::blocked,summation_method::exact};
+    // Empty range.
+    std::vector<arb> v;
+    for (auto m: methods) {
+        const auto s = arbpp::sum(v.begin(),v.end(),m);
+        BOOST_CHECK_EQUAL(s.get_midpoint(),0.);
+        BOOST_CHECK_EQUAL(s.get_radius(),0.);
+        BOOST_CHECK_EQUAL(s.get_precision(),arb::get_default_precision());
+    }
+    BOOST_CHECK_THROW(arbpp::sum(v.begin(),v.end(),0l),std::invalid_argument);
+    // Exact summands.
+    for (int i = 1; i <= 100; ++i) {
+        v.emplace_back(i);
+    }
+    for (auto m: methods) {
+        const auto s = arbpp::sum(v.begin(),v.end(),m);
+        BOOST_CHECK_EQUAL(s.get_midpoint(),5050.);
+        BOOST_CHECK_EQUAL(s.get_radius(),0.);
+    }
+    // Harmonic sum: compare with a reference computed at high precision.
+    v.clear();
+    for (int i = 1; i <= 10000; ++i) {
+        v.push_back(arb{1,128} / arb{i,128});
+    }
+    arb ref{0,1000};
+    for (int i = 1; i <= 10000; ++i) {
+        ref += arb{1,1000} / arb{i,1000};
+    }
+    long acc[4];
+    for (std::size_t i = 0u; i < 4u; ++i) {
+        const auto s = arbpp::sum(v.begin(),v.end(),64l,methods[i]);
+        BOOST_CHECK_EQUAL(s.get_precision(),64);
+        BOOST_CHECK(::arb_overlaps(s.get_arb_t(),ref.get_arb_t()));
+        acc[i] = s.get_rel_accuracy_bits();
+        BOOST_CHECK(acc[i] > 40);
+    }
+    // The error-reducing methods do at least as well as the serial sum.
+    BOOST_CHECK(acc[1] >= acc[0]);
+    BOOST_CHECK(acc[2] >= acc[0]);
+    BOOST_CHECK(acc[3] >= acc[1]);
+    // Default precision is the max precision of the summands.
+    v.push_back(arb{1,300});
+    BOOST_CHECK_EQUAL(arbpp::sum(v.begin(),v.end()).get_precision(),300);
+    // Accuracy getter.
+    BOOST_CHECK(arb{1}.get_rel_accuracy_bits() > 1000);
+    BOOST_CHECK((arb{1,100}.get_rel_accuracy_bits() > 1000));
+    BOOST_CHECK((arb{1,100} / 3).get_rel_accuracy_bits() >= 98);
+    BOOST_CHECK((arb{1,100} / 3).get_rel_accuracy_bits() <= 100);
+}
+
 BOOST_AUTO_TEST_CASE(arb_negate_test)
 {
     arb a0;
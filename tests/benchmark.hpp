@@ -0,0 +1,269 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+#ifndef ARBPP_TESTS_BENCHMARK_HPP
+#define ARBPP_TESTS_BENCHMARK_HPP
+
+// Helpers shared by the performance test cases: a wall-clock timer, an optional reader of the hardware
+// performance counters and the export of the trace recorded by arbpp.
+//
+// The hardware counters are read through the Linux perf_event_open() system call, and only if the
+// ARBPP_PERF_COUNTERS environment variable is set: on other platforms, or when the system call is not
+// permitted (see /proc/sys/kernel/perf_event_paranoid), the counters are reported as unavailable and the
+// benchmarks run anyway. If the performance test cases are built with ARBPP_ENABLE_TRACING and the
+// ARBPP_TRACE_FILE environment variable is set, the recorded spans are written to the file it names
+// in Chrome trace format.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "../src/arbpp.hpp"
+
+namespace arbpp_benchmark
+{
+
+// Wall-clock timer, started on construction.
+class timer
+{
+    public:
+        timer():m_start(std::chrono::steady_clock::now()) {}
+        void restart()
+        {
+            m_start = std::chrono::steady_clock::now();
+        }
+        // Elapsed time in nanoseconds.
+        double elapsed() const
+        {
+            return std::chrono::duration<double,std::nano>(std::chrono::steady_clock::now() - m_start).count();
+        }
+    private:
+        std::chrono::steady_clock::time_point m_start;
+};
+
+// Hardware performance counters of the calling thread (user space only).
+class perf_counters
+{
+    public:
+        static const std::size_t n_counters = 4u;
+        typedef std::array<std::uint64_t,n_counters> values_type;
+        static const char *name(std::size_t i)
+        {
+            static const char *names[n_counters] = {"cycles","instructions","cache_misses","branch_misses"};
+            return names[i];
+        }
+        perf_counters()
+        {
+            m_fds.fill(-1);
+#if defined(__linux__)
+            if (!std::getenv("ARBPP_PERF_COUNTERS")) {
+                return;
+            }
+            const std::uint64_t configs[n_counters] = {PERF_COUNT_HW_CPU_CYCLES,PERF_COUNT_HW_INSTRUCTIONS,
+                PERF_COUNT_HW_CACHE_MISSES,PERF_COUNT_HW_BRANCH_MISSES};
+            for (std::size_t i = 0u; i < n_counters; ++i) {
+                ::perf_event_attr attr;
+                std::memset(&attr,0,sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = configs[i];
+                attr.disabled = 1;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                m_fds[i] = static_cast<int>(::syscall(SYS_perf_event_open,&attr,0,-1,-1,0));
+                if (m_fds[i] < 0) {
+                    close_all();
+                    return;
+                }
+            }
+#endif
+        }
+        perf_counters(const perf_counters &) = delete;
+        perf_counters &operator=(const perf_counters &) = delete;
+        ~perf_counters()
+        {
+            close_all();
+        }
+        bool available() const
+        {
+            return m_fds[0] >= 0;
+        }
+        // Reset and start the counters.
+        void start()
+        {
+#if defined(__linux__)
+            for (auto fd: m_fds) {
+                if (fd >= 0) {
+                    ::ioctl(fd,PERF_EVENT_IOC_RESET,0);
+                    ::ioctl(fd,PERF_EVENT_IOC_ENABLE,0);
+                }
+            }
+#endif
+        }
+        // Stop the counters and return their values (all zeroes if the counters are not available).
+        values_type stop()
+        {
+            values_type retval;
+            retval.fill(0u);
+#if defined(__linux__)
+            for (std::size_t i = 0u; i < n_counters; ++i) {
+                if (m_fds[i] >= 0) {
+                    ::ioctl(m_fds[i],PERF_EVENT_IOC_DISABLE,0);
+                    std::uint64_t value = 0u;
+                    if (::read(m_fds[i],&value,sizeof(value)) == static_cast<::ssize_t>(sizeof(value))) {
+                        retval[i] = value;
+                    }
+                }
+            }
+#endif
+            return retval;
+        }
+    private:
+        void close_all()
+        {
+#if defined(__linux__)
+            for (auto &fd: m_fds) {
+                if (fd >= 0) {
+                    ::close(fd);
+                }
+                fd = -1;
+            }
+#endif
+        }
+        std::array<int,n_counters> m_fds;
+};
+
+// Summary of a set of timing samples, in nanoseconds.
+struct summary
+{
+    double min;
+    double p10;
+    double median;
+    double p90;
+    double max;
+};
+
+// Percentile q (in [0,1]) of sorted samples, with linear interpolation.
+inline double percentile(const std::vector<double> &sorted, double q)
+{
+    if (sorted.empty()) {
+        return 0.;
+    }
+    const double pos = q * static_cast<double>(sorted.size() - 1u);
+    const auto i = static_cast<std::size_t>(pos);
+    if (i + 1u >= sorted.size()) {
+        return sorted.back();
+    }
+    return sorted[i] + (pos - static_cast<double>(i)) * (sorted[i + 1u] - sorted[i]);
+}
+
+inline summary summarize(std::vector<double> samples)
+{
+    std::sort(samples.begin(),samples.end());
+    return summary{percentile(samples,0.),percentile(samples,.1),percentile(samples,.5),percentile(samples,.9),
+        percentile(samples,1.)};
+}
+
+// Time f(), returning the samples of the time per call in nanoseconds. Each sample times a batch of calls
+// long enough to hide the resolution of the clock. Sampling stops after max_samples samples, or when the
+// time budget (in seconds) is exhausted and at least min_samples samples have been taken.
+template <typename F>
+inline std::vector<double> measure(const F &f, double budget, std::size_t min_samples = 3u,
+    std::size_t max_samples = 25u)
+{
+    // Warm up the caches of Arb and calibrate the batch size.
+    std::size_t batch = 1u;
+    for (;;) {
+        timer t;
+        for (std::size_t i = 0u; i < batch; ++i) {
+            f();
+        }
+        if (t.elapsed() >= 1E4 || batch >= (1u << 20)) {
+            break;
+        }
+        batch *= 2u;
+    }
+    std::vector<double> retval;
+    timer total;
+    while (retval.size() < max_samples && (retval.size() < min_samples || total.elapsed() < budget * 1E9)) {
+        timer t;
+        for (std::size_t i = 0u; i < batch; ++i) {
+            f();
+        }
+        retval.push_back(t.elapsed() / static_cast<double>(batch));
+    }
+    return retval;
+}
+
+// Value of a numeric field in a line of JSON written by the benchmarks (NaN if not found).
+inline double json_number(const std::string &line, const std::string &key)
+{
+    const auto pos = line.find("\"" + key + "\":");
+    if (pos == std::string::npos) {
+        return std::nan("");
+    }
+    return std::strtod(line.c_str() + pos + key.size() + 3u,nullptr);
+}
+
+// Value of a string field in a line of JSON written by the benchmarks (empty if not found).
+inline std::string json_string(const std::string &line, const std::string &key)
+{
+    const auto pos = line.find("\"" + key + "\":\"");
+    if (pos == std::string::npos) {
+        return std::string();
+    }
+    const auto begin = pos + key.size() + 4u, end = line.find('"',begin);
+    return end == std::string::npos ? std::string() : line.substr(begin,end - begin);
+}
+
+// Write the recorded trace to the file named by ARBPP_TRACE_FILE, if set.
+inline void write_trace()
+{
+#if defined(ARBPP_ENABLE_TRACING)
+    const char *path = std::getenv("ARBPP_TRACE_FILE");
+    if (!path) {
+        return;
+    }
+    std::ofstream ofs(path);
+    arbpp::tracing::export_chrome_trace(ofs);
+    if (arbpp::tracing::dropped_events()) {
+        std::cerr << "warning: " << arbpp::tracing::dropped_events() << " spans were dropped from the trace\n";
+    }
+#endif
+}
+
+}
+
+#endif
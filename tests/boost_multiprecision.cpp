@@ -0,0 +1,149 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#include "../src/boost_multiprecision.hpp"
+
+#define BOOST_TEST_MODULE boost_multiprecision_test
+#include <boost/test/unit_test.hpp>
+
+#include <boost/multiprecision/number.hpp>
+#include <cmath>
+#include <flint/flint.h>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "../src/arbpp.hpp"
+
+using namespace arbpp;
+
+typedef mp_arb<200> mp_type;
+
+// A generic function, as it would be written for any Boost.Multiprecision type.
+template <typename T>
+static T generic_poly(const T &x)
+{
+    return (3 * x - 2) * x * x + x / 7 + T(1) / 2;
+}
+
+BOOST_AUTO_TEST_CASE(boost_mp_ctor_test)
+{
+    BOOST_CHECK((boost::multiprecision::number_category<mp_type>::value == boost::multiprecision::number_kind_floating_point));
+    mp_type a0;
+    BOOST_CHECK(a0.is_zero());
+    BOOST_CHECK_EQUAL(a0.backend().value().get_precision(),200);
+    mp_type a1{42}, a2{-42ll}, a3{1.5}, a4{"0.1"};
+    BOOST_CHECK_EQUAL(a1.backend().value().get_midpoint(),42.);
+    BOOST_CHECK_EQUAL(a2.backend().value().get_midpoint(),-42.);
+    BOOST_CHECK_EQUAL(a3.backend().value().get_midpoint(),1.5);
+    BOOST_CHECK_EQUAL(a3.backend().value().get_precision(),200);
+    // 0.1 is not exact, but the radius is tiny.
+    BOOST_CHECK(a4.backend().value().get_radius() != 0.);
+    BOOST_CHECK(a4.backend().value().get_radius() < 1E-59);
+    BOOST_CHECK_THROW(mp_type{"foo"},std::invalid_argument);
+    // Conversions.
+    BOOST_CHECK_EQUAL(a3.convert_to<double>(),1.5);
+    BOOST_CHECK_EQUAL(a3.convert_to<long double>(),1.5l);
+    BOOST_CHECK_EQUAL(a2.convert_to<long long>(),-42ll);
+    BOOST_CHECK_EQUAL(a2.convert_to<int>(),-42);
+    BOOST_CHECK_EQUAL(mp_type{"2.9"}.convert_to<long>(),2l);
+    BOOST_CHECK_EQUAL(a1.convert_to<unsigned long long>(),42ull);
+    // Integral conversions use the full width of the type and saturate outside of it.
+    BOOST_CHECK_EQUAL(mp_type{"9223372036854775807"}.convert_to<long long>(),std::numeric_limits<long long>::max());
+    BOOST_CHECK_EQUAL(mp_type{"-9223372036854775807"}.convert_to<long long>(),
+        -std::numeric_limits<long long>::max());
+    BOOST_CHECK_EQUAL(mp_type{"-9223372036854775808"}.convert_to<long long>(),std::numeric_limits<long long>::min());
+    BOOST_CHECK_EQUAL(mp_type{"1e30"}.convert_to<long long>(),std::numeric_limits<long long>::max());
+    BOOST_CHECK_EQUAL(mp_type{"-1e30"}.convert_to<long long>(),std::numeric_limits<long long>::min());
+    BOOST_CHECK_EQUAL(mp_type{"18446744073709551615"}.convert_to<unsigned long long>(),
+        std::numeric_limits<unsigned long long>::max());
+    BOOST_CHECK_EQUAL(mp_type{"1e30"}.convert_to<unsigned long long>(),std::numeric_limits<unsigned long long>::max());
+    BOOST_CHECK_EQUAL(mp_type{"-5"}.convert_to<unsigned long long>(),0ull);
+    // String conversion goes through arb's operator<<.
+    std::ostringstream oss;
+    oss << a4.backend().value();
+    BOOST_CHECK_EQUAL(a4.str(),oss.str());
+}
+
+BOOST_AUTO_TEST_CASE(boost_mp_arithmetic_test)
+{
+    mp_type a{3}, b{4};
+    BOOST_CHECK((a + b).convert_to<double>() == 7.);
+    BOOST_CHECK((a - b).convert_to<double>() == -1.);
+    BOOST_CHECK((a * b).convert_to<double>() == 12.);
+    BOOST_CHECK((b / 4).convert_to<double>() == 1.);
+    BOOST_CHECK((a * b + a).convert_to<double>() == 15.);
+    BOOST_CHECK((-a).convert_to<double>() == -3.);
+    BOOST_CHECK(a < b);
+    BOOST_CHECK(b > 3);
+    BOOST_CHECK(a == 3);
+    a += 2;
+    a *= b;
+    a -= 1u;
+    a /= 19;
+    BOOST_CHECK_EQUAL(a.convert_to<double>(),1.);
+    // Expression templates are enabled.
+    BOOST_CHECK((!std::is_same<decltype(a + b),mp_type>::value));
+    // Generic code gets rigorous balls.
+    const mp_type x{"0.3"};
+    const mp_type r = generic_poly(x);
+    BOOST_CHECK(r.backend().value().get_radius() < 1E-55);
+    BOOST_CHECK(std::abs(r.convert_to<double>() - generic_poly(0.3)) < 1E-15);
+    BOOST_CHECK_EQUAL(r.backend().value().get_precision(),200);
+}
+
+BOOST_AUTO_TEST_CASE(boost_mp_functions_test)
+{
+    const mp_type x{2};
+    BOOST_CHECK(std::abs(sqrt(x).convert_to<double>() - std::sqrt(2.)) < 1E-15);
+    BOOST_CHECK(std::abs(cos(x).convert_to<double>() - std::cos(2.)) < 1E-15);
+    BOOST_CHECK(std::abs(sin(x).convert_to<double>() - std::sin(2.)) < 1E-15);
+    BOOST_CHECK(std::abs(exp(x).convert_to<double>() - std::exp(2.)) < 1E-14);
+    BOOST_CHECK(std::abs(log(x).convert_to<double>() - std::log(2.)) < 1E-15);
+    BOOST_CHECK_EQUAL(abs(mp_type{-2}).convert_to<double>(),2.);
+    BOOST_CHECK_EQUAL(floor(mp_type{"2.5"}).convert_to<double>(),2.);
+    BOOST_CHECK_EQUAL(ceil(mp_type{"2.5"}).convert_to<double>(),3.);
+    int e = 0;
+    const mp_type m = frexp(mp_type{12},&e);
+    BOOST_CHECK_EQUAL(e,4);
+    BOOST_CHECK_EQUAL(m.convert_to<double>(),.75);
+    BOOST_CHECK_EQUAL(ldexp(m,e).convert_to<double>(),12.);
+    // numeric_limits.
+    BOOST_CHECK(std::numeric_limits<mp_type>::is_specialized);
+    BOOST_CHECK_EQUAL(std::numeric_limits<mp_type>::digits,200);
+    // The static data members are defined out of class, and hence can be bound to references.
+    BOOST_CHECK_EQUAL(std::numeric_limits<mp_type>::is_bounded,false);
+    BOOST_CHECK_EQUAL(std::numeric_limits<mp_type>::has_infinity,true);
+    BOOST_CHECK(std::numeric_limits<mp_type>::round_style == std::round_to_nearest);
+    BOOST_CHECK(std::numeric_limits<mp_type>::epsilon() > 0);
+    BOOST_CHECK(std::numeric_limits<mp_type>::epsilon() < 1E-59);
+    BOOST_CHECK(isinf(std::numeric_limits<mp_type>::infinity()));
+    BOOST_CHECK(isnan(std::numeric_limits<mp_type>::quiet_NaN()));
+}
+
+// Keep this for last, in order to have proper
+// memory cleanup and make valgrind happy.
+BOOST_AUTO_TEST_CASE(boost_mp_cleanup)
+{
+    ::flint_cleanup();
+}
@@ -0,0 +1,130 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#include "../src/compiled_expr.hpp"
+
+#define BOOST_TEST_MODULE compiled_expr_test
+#include <boost/test/unit_test.hpp>
+
+#include <arb.h>
+#include <flint/flint.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../src/arbpp.hpp"
+#include "helpers.hpp"
+
+using namespace arbpp;
+using namespace arbpp_test;
+
+static bool equal(const arb &a, const arb &b)
+{
+    return ::arb_equal(a.get_arb_t(),b.get_arb_t()) != 0;
+}
+
+BOOST_AUTO_TEST_CASE(compiled_expr_basic_test)
+{
+    const long prec = 200;
+    const std::vector<arb> args = {arb{1,prec} / 3,arb{2,prec}.sqrt(),arb{-5,prec} / 7};
+    const auto &x = args[0], &y = args[1], &z = args[2];
+    compiled_expr e0("x + y*z - x/y",{"x","y","z"},prec);
+    BOOST_CHECK_EQUAL(e0.get_precision(),prec);
+    BOOST_CHECK_EQUAL(e0.get_n_variables(),3u);
+    BOOST_CHECK(overlaps(e0(args),x + y * z - x / y));
+    // Repeated evaluations give the same result.
+    BOOST_CHECK(equal(e0(args),e0(args)));
+    BOOST_CHECK_EQUAL(e0(args).get_precision(),prec);
+    // Functions and constants.
+    compiled_expr e1("sqrt(abs(z)) + exp(log(y)) - sin(x)^2 - cos(x)^2 + tan(atan(x)) + 2.5e-1*pi",{"x","y","z"},prec);
+    arb pi;
+    ::arb_const_pi(pi.get_arb_t(),prec);
+    BOOST_CHECK(overlaps(e1(args),z.abs().sqrt() + y - 1 + x + pi / 4));
+    // Powers.
+    compiled_expr e2("-x^2 + x^-3 + 2^3^2 + y^x",{"x","y"},prec);
+    arb yx;
+    ::arb_pow(yx.get_arb_t(),y.get_arb_t(),x.get_arb_t(),prec);
+    BOOST_CHECK(overlaps(e2({x,y}),-(x * x) + 1 / (x * x * x) + 512 + yx));
+    // Trivial expressions.
+    BOOST_CHECK(equal(compiled_expr("y",{"x","y"},prec)({x,y}),y));
+    BOOST_CHECK(equal(compiled_expr("(((1)))",{},prec)({}),arb{1}));
+    // Inputs and output aliasing.
+    arb out{x};
+    e0.evaluate(out,args.data());
+    BOOST_CHECK(overlaps(out,x + y * z - x / y));
+    // Copies are independent.
+    compiled_expr e3(e0);
+    BOOST_CHECK(equal(e3(args),e0(args)));
+    BOOST_CHECK_THROW(e0({x,y}),std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(compiled_expr_compiler_test)
+{
+    const std::vector<arb> args = {arb{3},arb{5},arb{7}};
+    // Fusion into a single multiply-accumulate.
+    compiled_expr e0("x*y + z",{"x","y","z"});
+    BOOST_CHECK_EQUAL(e0.get_n_instructions(),1u);
+    BOOST_CHECK_EQUAL(e0.get_n_registers(),1u);
+    BOOST_CHECK(e0.disassemble().find("addmul") != std::string::npos);
+    BOOST_CHECK(equal(e0(args),arb{22}));
+    compiled_expr e1("z - x*y",{"x","y","z"});
+    BOOST_CHECK(e1.disassemble().find("submul") != std::string::npos);
+    BOOST_CHECK(equal(e1(args),arb{-8}));
+    // Horner scheme: one multiply-accumulate per coefficient, two registers.
+    compiled_expr e2("x*(y*(z*(x + 1) + 2) + 3) + 4",{"x","y","z"});
+    BOOST_CHECK_EQUAL(e2.get_n_instructions(),4u);
+    BOOST_CHECK_EQUAL(e2.get_n_registers(),2u);
+    BOOST_CHECK(equal(e2(args),arb{3 * (5 * (7 * 4 + 2) + 3) + 4}));
+    // A product used twice is not fused, and it is computed once.
+    compiled_expr e3("x*y + x*y",{"x","y"});
+    BOOST_CHECK_EQUAL(e3.get_n_instructions(),2u);
+    BOOST_CHECK(e3.disassemble().find("addmul") == std::string::npos);
+    BOOST_CHECK(equal(e3({arb{3},arb{5}}),arb{30}));
+    // Constant folding.
+    compiled_expr e4("2*3*x + (1 + 1)",{"x"});
+    BOOST_CHECK_EQUAL(e4.get_n_instructions(),1u);
+    BOOST_CHECK(equal(e4({arb{3}}),arb{20}));
+    // Registers are reused as soon as values die.
+    compiled_expr e5("(x+1)*(x+2) + (x+3)*(x+4) + (x+5)*(x+6)",{"x"});
+    BOOST_CHECK(e5.get_n_registers() <= 3u);
+    BOOST_CHECK(equal(e5({arb{1}}),arb{2 * 3 + 4 * 5 + 6 * 7}));
+}
+
+BOOST_AUTO_TEST_CASE(compiled_expr_error_test)
+{
+    BOOST_CHECK_THROW(compiled_expr("x +",{"x"}),std::invalid_argument);
+    BOOST_CHECK_THROW(compiled_expr("foo(x)",{"x"}),std::invalid_argument);
+    BOOST_CHECK_THROW(compiled_expr("x*w",{"x"}),std::invalid_argument);
+    BOOST_CHECK_THROW(compiled_expr("1.2.3",{}),std::invalid_argument);
+    BOOST_CHECK_THROW(compiled_expr("(x",{"x"}),std::invalid_argument);
+    BOOST_CHECK_THROW(compiled_expr("",{}),std::invalid_argument);
+    BOOST_CHECK_THROW(compiled_expr("x",{"x"},0),std::invalid_argument);
+    try {
+        compiled_expr("x + )",{"x"});
+    } catch (const std::invalid_argument &e) {
+        BOOST_CHECK(std::string(e.what()).find("position 4") != std::string::npos);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(compiled_expr_cleanup)
+{
+    ::flint_cleanup();
+}
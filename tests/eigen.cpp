@@ -0,0 +1,143 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#include "../src/eigen.hpp"
+
+#define BOOST_TEST_MODULE eigen_test
+#include <boost/test/unit_test.hpp>
+
+#include <Eigen/Dense>
+#include <arb.h>
+#include <cmath>
+#include <flint/flint.h>
+
+#include "../src/arbpp.hpp"
+
+using namespace arbpp;
+
+typedef Eigen::Matrix<arb,Eigen::Dynamic,Eigen::Dynamic> mat_type;
+typedef Eigen::Matrix<arb,Eigen::Dynamic,1> vec_type;
+
+// Diagonally dominant test matrix, with a non-representable part in the off-diagonal elements.
+static mat_type make_matrix(int n, long prec)
+{
+    mat_type retval(n,n);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            retval(i,j) = arb{1,prec} / arb{i + j + 1,prec};
+            if (i == j) {
+                retval(i,j) += n;
+            }
+        }
+    }
+    return retval;
+}
+
+BOOST_AUTO_TEST_CASE(eigen_num_traits_test)
+{
+    typedef Eigen::NumTraits<arb> nt;
+    BOOST_CHECK(!nt::IsComplex);
+    BOOST_CHECK(!nt::IsInteger);
+    BOOST_CHECK(nt::RequireInitialization);
+    BOOST_CHECK((nt::epsilon() > arb{0}).is_true());
+    BOOST_CHECK_EQUAL(nt::epsilon().get_midpoint(),std::ldexp(1.,1 - arb::get_default_precision()));
+    BOOST_CHECK((nt::dummy_precision() > nt::epsilon()).is_true());
+    BOOST_CHECK_EQUAL(nt::digits10(),15);
+    BOOST_CHECK((nt::highest() > arb{1E300}).is_true());
+    BOOST_CHECK((nt::lowest() < arb{-1E300}).is_true());
+    // Hooks.
+    BOOST_CHECK_EQUAL(abs(arb{-2}).get_midpoint(),2.);
+    BOOST_CHECK_EQUAL(sqrt(arb{4}).get_midpoint(),2.);
+    BOOST_CHECK((arb{1} < arb{2}).is_true());
+    BOOST_CHECK((arb{2} == arb{2}).is_true());
+    // Strict equality is identity of the balls.
+    BOOST_CHECK(Eigen::numext::equal_strict(arb{1} / 3,arb{1} / 3));
+    BOOST_CHECK(Eigen::numext::not_equal_strict(arb{1} / 3,arb{0}));
+    BOOST_CHECK(!Eigen::numext::not_equal_strict(arb{0},arb{0}));
+}
+
+BOOST_AUTO_TEST_CASE(eigen_product_test)
+{
+    // Integer matrices large enough to go through the blocked kernel: the products are exact.
+    const int n = 40;
+    mat_type a(n,n), b(n,n);
+    Eigen::MatrixXd ad(n,n), bd(n,n);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            ad(i,j) = (i * 7 + j * 3) % 11 - 5;
+            bd(i,j) = (i * 5 + j) % 13 - 6;
+            a(i,j) = arb{ad(i,j)};
+            b(i,j) = arb{bd(i,j)};
+        }
+    }
+    const mat_type c = a * b;
+    const Eigen::MatrixXd cd = ad * bd;
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            BOOST_CHECK_EQUAL(c(i,j).get_midpoint(),cd(i,j));
+            BOOST_CHECK_EQUAL(c(i,j).get_radius(),0.);
+        }
+    }
+    // Matrix-vector product.
+    vec_type v(n);
+    for (int i = 0; i < n; ++i) {
+        v(i) = arb{i};
+    }
+    const vec_type w = a * v;
+    const Eigen::VectorXd wd = ad * Eigen::VectorXd::LinSpaced(n,0,n - 1);
+    for (int i = 0; i < n; ++i) {
+        BOOST_CHECK_EQUAL(w(i).get_midpoint(),wd(i));
+    }
+    // Precision is propagated through the products.
+    mat_type d = make_matrix(n,200);
+    const mat_type e = d * d;
+    BOOST_CHECK_EQUAL(e(0,0).get_precision(),200);
+    BOOST_CHECK(e(3,5).get_radius() < 1E-50);
+}
+
+BOOST_AUTO_TEST_CASE(eigen_solve_test)
+{
+    for (int n: {3,10,30}) {
+        const mat_type a = make_matrix(n,200);
+        vec_type x0(n);
+        for (int i = 0; i < n; ++i) {
+            x0(i) = arb{i + 1,200};
+        }
+        const vec_type b = a * x0;
+        const vec_type x_lu = a.partialPivLu().solve(b);
+        const vec_type x_qr = a.householderQr().solve(b);
+        for (int i = 0; i < n; ++i) {
+            BOOST_CHECK(::arb_contains_si(x_lu(i).get_arb_t(),i + 1));
+            BOOST_CHECK(x_lu(i).get_radius() < 1E-40);
+            BOOST_CHECK(::arb_contains_si(x_qr(i).get_arb_t(),i + 1));
+            BOOST_CHECK(x_qr(i).get_radius() < 1E-40);
+        }
+        // Determinant via LU.
+        BOOST_CHECK((a.partialPivLu().determinant() > arb{0}).is_true());
+    }
+}
+
+// Keep this for last, in order to have proper
+// memory cleanup and make valgrind happy.
+BOOST_AUTO_TEST_CASE(eigen_cleanup)
+{
+    ::flint_cleanup();
+}
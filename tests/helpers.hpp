@@ -0,0 +1,61 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+#ifndef ARBPP_TESTS_HELPERS_HPP
+#define ARBPP_TESTS_HELPERS_HPP
+
+// Helpers shared by the test cases which check enclosures.
+
+#include <arb.h>
+
+#include "../src/arbpp.hpp"
+
+namespace arbpp_test
+{
+
+// Whether a contains b.
+inline bool contains(const arbpp::arb &a, const arbpp::arb &b)
+{
+    return ::arb_contains(a.get_arb_t(),b.get_arb_t()) != 0;
+}
+
+// Whether a and b have points in common.
+inline bool overlaps(const arbpp::arb &a, const arbpp::arb &b)
+{
+    return ::arb_overlaps(a.get_arb_t(),b.get_arb_t()) != 0;
+}
+
+// Width of a, i.e., twice its radius.
+inline double width(const arbpp::arb &a)
+{
+    return 2. * ::mag_get_d(arb_radref(a.get_arb_t()));
+}
+
+// Ball enclosing [lo,hi].
+inline arbpp::arb interval(double lo, double hi)
+{
+    arbpp::arb retval{(lo + hi) / 2.};
+    retval.add_error((hi - lo) / 2.);
+    return retval;
+}
+
+}
+
+#endif
@@ -0,0 +1,129 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#define ARBPP_ENABLE_INSTRUMENTATION
+#include "../src/arbpp.hpp"
+
+#define BOOST_TEST_MODULE instrumentation_test
+#include <boost/test/unit_test.hpp>
+
+#include <flint/flint.h>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace arbpp;
+using namespace arbpp::instrumentation;
+
+static unsigned long long delta(const counters &after, const counters &before, operation op)
+{
+    return after.total(op) - before.total(op);
+}
+
+static unsigned long long lost_at_least(const counters &c, std::size_t bucket)
+{
+    unsigned long long retval = 0u;
+    for (std::size_t i = bucket; i < n_loss_buckets; ++i) {
+        retval += c.bits_lost[i];
+    }
+    return retval;
+}
+
+BOOST_AUTO_TEST_CASE(instrumentation_counters_test)
+{
+    BOOST_CHECK_EQUAL(std::string(operation_name(operation::binary_add)),"binary_add");
+    BOOST_CHECK_EQUAL(std::string(operation_name(operation::print_fmpr)),"print_fmpr");
+    const auto c0 = get_thread_counters();
+    arb a{1}, b{2,200};
+    const auto c1 = get_thread_counters();
+    BOOST_CHECK_EQUAL(delta(c1,c0,operation::construct),2u);
+    // Precision buckets: 53 bits is in [32,64), 200 bits in [128,256).
+    BOOST_CHECK_EQUAL(c1.calls[static_cast<std::size_t>(operation::construct)][5] -
+        c0.calls[static_cast<std::size_t>(operation::construct)][5],1u);
+    BOOST_CHECK_EQUAL(c1.calls[static_cast<std::size_t>(operation::construct)][7] -
+        c0.calls[static_cast<std::size_t>(operation::construct)][7],1u);
+    arb c{a};
+    c = b;
+    arb d{std::move(c)};
+    a += b;
+    a *= 3;
+    auto e = a + b;
+    e = e / 3;
+    e.addmul(a,b);
+    e = e.cos();
+    const auto c2 = get_thread_counters();
+    BOOST_CHECK_EQUAL(delta(c2,c1,operation::copy),2u);
+    BOOST_CHECK(delta(c2,c1,operation::move) >= 1u);
+    BOOST_CHECK_EQUAL(delta(c2,c1,operation::in_place_add),1u);
+    BOOST_CHECK_EQUAL(delta(c2,c1,operation::in_place_mul),1u);
+    BOOST_CHECK_EQUAL(delta(c2,c1,operation::binary_add),1u);
+    BOOST_CHECK_EQUAL(delta(c2,c1,operation::binary_div),1u);
+    BOOST_CHECK_EQUAL(delta(c2,c1,operation::addmul),1u);
+    BOOST_CHECK_EQUAL(delta(c2,c1,operation::cos),1u);
+    BOOST_CHECK_EQUAL(delta(c2,c1,operation::binary_sub),0u);
+    // Printing goes through two fmpr conversions (midpoint and radius).
+    std::ostringstream oss;
+    oss << e;
+    const auto c3 = get_thread_counters();
+    BOOST_CHECK_EQUAL(delta(c3,c2,operation::print_fmpr),2u);
+}
+
+BOOST_AUTO_TEST_CASE(instrumentation_accuracy_test)
+{
+    const arb third = arb{1} / 3;
+    const auto c0 = get_thread_counters();
+    // Exact operation, no loss.
+    arb x = arb{1} + arb{2};
+    const auto c1 = get_thread_counters();
+    BOOST_CHECK_EQUAL(c1.bits_lost[0] - c0.bits_lost[0],1u);
+    // Catastrophic cancellation: all the bits are lost.
+    x = third - third;
+    const auto c2 = get_thread_counters();
+    BOOST_CHECK_EQUAL(lost_at_least(c2,6) - lost_at_least(c1,6),1u);
+}
+
+BOOST_AUTO_TEST_CASE(instrumentation_threads_test)
+{
+    const auto c0 = get_counters();
+    std::thread t([]() {
+        arb a{1};
+        for (int i = 0; i < 10; ++i) {
+            a = a * 2;
+        }
+        ::flint_cleanup();
+    });
+    t.join();
+    const auto c1 = get_counters();
+    BOOST_CHECK_EQUAL(delta(c1,c0,operation::binary_mul),10u);
+    // The counters of the calling thread are not affected.
+    BOOST_CHECK(get_thread_counters().total(operation::binary_mul) <= c1.total(operation::binary_mul) - 10u);
+    std::ostringstream oss;
+    dump(oss);
+    BOOST_CHECK(oss.str().find("binary_mul") != std::string::npos);
+    BOOST_CHECK(oss.str().find("bits lost") != std::string::npos);
+}
+
+// Keep this for last, in order to have proper
+// memory cleanup and make valgrind happy.
+BOOST_AUTO_TEST_CASE(instrumentation_cleanup)
+{
+    ::flint_cleanup();
+}
@@ -0,0 +1,106 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#include "../src/arbpp.hpp"
+
+#define BOOST_TEST_MODULE memory_test
+#include <boost/test/unit_test.hpp>
+
+#include <flint/flint.h>
+#include <gmp.h>
+#include <thread>
+#include <vector>
+
+using namespace arbpp;
+
+// NOTE: the state of the tracking before the first allocation is tested in memory_enable.cpp.
+
+BOOST_AUTO_TEST_CASE(memory_allocated_bytes_test)
+{
+    // Small values are stored inline.
+    BOOST_CHECK_EQUAL(arb{}.allocated_bytes(),0u);
+    BOOST_CHECK_EQUAL(arb{1}.allocated_bytes(),0u);
+    // 1000 bits need at least 1000 / 8 bytes of limbs.
+    const arb third = arb{1,1000} / 3;
+    BOOST_CHECK(third.allocated_bytes() >= 125u);
+    BOOST_CHECK(third.allocated_bytes() < 1000u);
+}
+
+BOOST_AUTO_TEST_CASE(memory_thread_stats_test)
+{
+    memory::enable_tracking();
+    BOOST_CHECK(memory::tracking_enabled());
+    const auto s0 = memory::get_thread_stats();
+    {
+        std::vector<arb> v;
+        for (int i = 1; i <= 100; ++i) {
+            v.push_back(arb{1,10000} / i);
+        }
+        const auto s1 = memory::get_thread_stats();
+        BOOST_CHECK(s1.allocations > s0.allocations);
+        // Each inexact value needs about 10000 / 8 bytes (the powers of two are exact and
+        // need no limbs).
+        BOOST_CHECK(s1.current_bytes - s0.current_bytes >= 50ll * 1200ll);
+        BOOST_CHECK(s1.peak_bytes >= s1.current_bytes);
+        BOOST_CHECK(s1.allocated_bytes - s0.allocated_bytes >= 50ull * 1200ull);
+    }
+    const auto s2 = memory::get_thread_stats();
+    BOOST_CHECK(s2.deallocations > s0.deallocations);
+    // Everything was freed (the FLINT caches may retain some memory).
+    BOOST_CHECK(s2.current_bytes - s0.current_bytes < 50ll * 1200ll);
+    BOOST_CHECK(s2.peak_bytes - s0.current_bytes >= 50ll * 1200ll);
+    memory::reset_peak();
+    BOOST_CHECK_EQUAL(memory::get_thread_stats().peak_bytes,memory::get_thread_stats().current_bytes);
+    // GMP allocations are tracked too.
+    const auto s3 = memory::get_thread_stats();
+    ::mpz_t z;
+    ::mpz_init_set_ui(z,1u);
+    ::mpz_mul_2exp(z,z,80000u);
+    const auto s4 = memory::get_thread_stats();
+    BOOST_CHECK(s4.current_bytes - s3.current_bytes >= 10000ll);
+    ::mpz_clear(z);
+    BOOST_CHECK_EQUAL(memory::get_thread_stats().current_bytes,s3.current_bytes);
+}
+
+BOOST_AUTO_TEST_CASE(memory_global_stats_test)
+{
+    memory::enable_tracking();
+    const auto g0 = memory::get_global_stats();
+    const auto t0 = memory::get_thread_stats();
+    std::thread t([]() {
+        arb a = arb{1,100000} / 3;
+        ::flint_cleanup();
+    });
+    t.join();
+    const auto g1 = memory::get_global_stats();
+    BOOST_CHECK(g1.allocations > g0.allocations);
+    BOOST_CHECK(g1.allocated_bytes - g0.allocated_bytes >= 12500u);
+    BOOST_CHECK(g1.peak_bytes >= g0.current_bytes + 12500ll);
+    // The other thread does not show up in the stats of this thread.
+    BOOST_CHECK_EQUAL(memory::get_thread_stats().allocations,t0.allocations);
+}
+
+// Keep this for last, in order to have proper
+// memory cleanup and make valgrind happy.
+BOOST_AUTO_TEST_CASE(memory_cleanup)
+{
+    ::flint_cleanup();
+}
@@ -0,0 +1,63 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#include "../src/arbpp.hpp"
+
+#define BOOST_TEST_MODULE memory_enable_test
+#include <boost/test/unit_test.hpp>
+
+#include <flint/flint.h>
+#include <vector>
+
+using namespace arbpp;
+
+// NOTE: this is the only test case of this executable, so that nothing is tracked before it.
+BOOST_AUTO_TEST_CASE(memory_enable_test)
+{
+    BOOST_CHECK(!memory::tracking_enabled());
+    // Blocks allocated before the tracking is enabled.
+    std::vector<arb> v;
+    for (int i = 1; i <= 10; ++i) {
+        v.push_back(arb{1,10000} / (2 * i + 1));
+    }
+    memory::enable_tracking();
+    BOOST_CHECK(memory::tracking_enabled());
+    memory::enable_tracking();
+    BOOST_CHECK(memory::tracking_enabled());
+    const auto s0 = memory::get_thread_stats();
+    // They can be reallocated and freed by the wrappers, and they do not show up in the statistics.
+    for (int i = 0; i < 10; ++i) {
+        v[i] = arb{1,20000} / (2 * i + 3);
+    }
+    const auto s1 = memory::get_thread_stats();
+    BOOST_CHECK(s1.current_bytes - s0.current_bytes >= 10ll * 2400ll);
+    v.clear();
+    const auto s2 = memory::get_thread_stats();
+    BOOST_CHECK(s2.current_bytes - s0.current_bytes < 10ll * 2400ll);
+    BOOST_CHECK(s2.current_bytes >= 0ll);
+}
+
+// Keep this for last, in order to have proper
+// memory cleanup and make valgrind happy.
+BOOST_AUTO_TEST_CASE(memory_enable_cleanup)
+{
+    ::flint_cleanup();
+}
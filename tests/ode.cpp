@@ -0,0 +1,189 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#include "../src/ode.hpp"
+
+#define BOOST_TEST_MODULE ode_test
+#include <boost/test/unit_test.hpp>
+
+#include <arb.h>
+#include <flint/flint.h>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "../src/arbpp.hpp"
+#include "helpers.hpp"
+
+using namespace arbpp;
+using namespace arbpp_test;
+
+static arb exp_arb(const arb &x)
+{
+    arb retval;
+    ::arb_exp(retval.get_arb_t(),x.get_arb_t(),retval.get_precision());
+    return retval;
+}
+
+static arb sin_arb(const arb &x)
+{
+    arb retval;
+    ::arb_sin(retval.get_arb_t(),x.get_arb_t(),retval.get_precision());
+    return retval;
+}
+
+typedef std::vector<arb_series> series_vector;
+
+BOOST_AUTO_TEST_CASE(ode_series_test)
+{
+    const auto x = arb_series::variable(arb{0},6);
+    BOOST_CHECK_EQUAL(x.get_length(),6);
+    BOOST_CHECK_EQUAL(x.get_precision(),arb::get_default_precision());
+    BOOST_CHECK(contains(x.get_coefficient(1),arb{1}));
+    BOOST_CHECK(::arb_is_zero(x.get_coefficient(2).get_arb_t()));
+    // (1 + x)**2.
+    const auto s = (1 + x) * (x + 1);
+    BOOST_CHECK(contains(s.get_coefficient(0),arb{1}));
+    BOOST_CHECK(contains(s.get_coefficient(1),arb{2}));
+    BOOST_CHECK(contains(s.get_coefficient(2),arb{1}));
+    BOOST_CHECK(::arb_is_zero(s.get_coefficient(3).get_arb_t()));
+    BOOST_CHECK(contains(s.evaluate(arb{2}),arb{9}));
+    // 1 / (1 - x) = 1 + x + x**2 + ...
+    const auto g = 1 / (1 - x);
+    for (long i = 0; i < 6; ++i) {
+        BOOST_CHECK(contains(g.get_coefficient(i),arb{1}));
+    }
+    BOOST_CHECK(contains((g * (1 - x)).get_coefficient(0),arb{1}));
+    BOOST_CHECK(::arb_contains_zero((g * (1 - x)).get_coefficient(5).get_arb_t()));
+    // exp(x) = sum x**k / k!, and exp(log(1 + x)) = 1 + x.
+    const auto e = exp(x);
+    BOOST_CHECK(contains(e.get_coefficient(3),arb{1} / 6));
+    BOOST_CHECK(contains(e.get_coefficient(5),arb{1} / 120));
+    const auto l = exp(log(1 + x));
+    BOOST_CHECK(contains(l.get_coefficient(1),arb{1}));
+    BOOST_CHECK(::arb_contains_zero(l.get_coefficient(4).get_arb_t()));
+    // sin**2 + cos**2 = 1.
+    const auto y = arb_series::variable(arb{"0.3"},6);
+    const auto one = sin(y) * sin(y) + cos(y) * cos(y);
+    BOOST_CHECK(contains(one.get_coefficient(0),arb{1}));
+    for (long i = 1; i < 6; ++i) {
+        BOOST_CHECK(::arb_contains_zero(one.get_coefficient(i).get_arb_t()));
+    }
+    // sqrt(1 + x)**2 = 1 + x.
+    const auto r = sqrt(1 + x);
+    BOOST_CHECK(contains(r.get_coefficient(1),arb{.5}));
+    BOOST_CHECK(contains(r.get_coefficient(2),arb{-.125}));
+    BOOST_CHECK(::arb_contains_zero((r * r - x).get_coefficient(3).get_arb_t()));
+    // Compound operators and lengths.
+    auto z = x;
+    z += 2;
+    z *= arb{3};
+    z -= x;
+    z /= 2;
+    BOOST_CHECK(contains(z.get_coefficient(0),arb{3}));
+    BOOST_CHECK(contains(z.get_coefficient(1),arb{1}));
+    BOOST_CHECK_EQUAL((z * arb_series{arb{1},3}).get_length(),3);
+    z.set_length(2);
+    BOOST_CHECK_EQUAL(z.get_length(),2);
+    z.set_length(4);
+    BOOST_CHECK(::arb_is_zero(z.get_coefficient(3).get_arb_t()));
+    // Undefined operations.
+    BOOST_CHECK(!::arb_is_finite((x / (x * 0)).get_coefficient(0).get_arb_t()));
+    BOOST_CHECK(!::arb_is_finite(log(x * 0).get_coefficient(0).get_arb_t()));
+    BOOST_CHECK(!::arb_is_finite((1 / x).get_coefficient(1).get_arb_t()));
+    // Errors.
+    BOOST_CHECK_THROW(arb_series(arb{1},0),std::invalid_argument);
+    BOOST_CHECK_THROW(arb_series::variable(arb{1},-1),std::invalid_argument);
+    BOOST_CHECK_THROW(x.get_coefficient(6),std::invalid_argument);
+    BOOST_CHECK_THROW(x.get_coefficient(-1),std::invalid_argument);
+    BOOST_CHECK_THROW(z.set_length(0),std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(ode_solve_test)
+{
+    // y' = y.
+    auto growth = [](const arb_series &, const series_vector &y) {
+        return series_vector{y[0]};
+    };
+    auto sol = ode_solve(growth,{arb{1}},arb{0},arb{1},1e-10);
+    BOOST_CHECK(contains(sol.values.back()[0],exp_arb(arb{1})));
+    BOOST_CHECK(width(sol.values.back()[0]) < 1e-8);
+    BOOST_CHECK(::arb_equal(sol.times.front().get_arb_t(),arb{0}.get_arb_t()));
+    BOOST_CHECK(::arb_equal(sol.times.back().get_arb_t(),arb{1}.get_arb_t()));
+    BOOST_CHECK_EQUAL(sol.values.size(),sol.times.size());
+    BOOST_CHECK_EQUAL(sol.enclosures.size(),sol.times.size() - 1u);
+    for (std::size_t i = 0u; i + 1u < sol.times.size(); ++i) {
+        BOOST_CHECK(::arb_is_exact(sol.times[i + 1u].get_arb_t()));
+        BOOST_CHECK((sol.times[i] < sol.times[i + 1u]).is_true());
+        BOOST_CHECK(contains(sol.enclosures[i][0],sol.values[i][0]));
+        BOOST_CHECK(contains(sol.enclosures[i][0],sol.values[i + 1u][0]));
+    }
+    // Backward.
+    sol = ode_solve(growth,{exp_arb(arb{1})},arb{1},arb{0},1e-10);
+    BOOST_CHECK(contains(sol.values.back()[0],arb{1}));
+    BOOST_CHECK(width(sol.values.back()[0]) < 1e-8);
+    BOOST_CHECK((sol.times[1] < sol.times[0]).is_true());
+    // Harmonic oscillator.
+    auto oscillator = [](const arb_series &, const series_vector &y) {
+        return series_vector{y[1],-y[0]};
+    };
+    sol = ode_solve(oscillator,{arb{0},arb{1}},arb{0},arb{10},1e-12);
+    BOOST_CHECK(contains(sol.values.back()[0],sin_arb(arb{10})));
+    BOOST_CHECK(width(sol.values.back()[0]) < 1e-8);
+    // Non-autonomous: y' = cos(t) and y' = t * y.
+    auto forcing = [](const arb_series &t, const series_vector &y) {
+        return series_vector{cos(t),t * y[1]};
+    };
+    sol = ode_solve(forcing,{arb{0},arb{1}},arb{0},arb{2},1e-10);
+    BOOST_CHECK(contains(sol.values.back()[0],sin_arb(arb{2})));
+    BOOST_CHECK(contains(sol.values.back()[1],exp_arb(arb{2})));
+    BOOST_CHECK(width(sol.values.back()[1]) < 1e-6);
+    // Wide initial conditions and empty interval.
+    arb wide{1};
+    wide.add_error(1e-3);
+    sol = ode_solve(growth,{wide},arb{0},arb{1},1e-10);
+    BOOST_CHECK(contains(sol.values.back()[0],exp_arb(arb{1}) * arb{"1.001"}));
+    sol = ode_solve(growth,{arb{1}},arb{1},arb{1},1e-10);
+    BOOST_CHECK_EQUAL(sol.times.size(),1u);
+    BOOST_CHECK(sol.enclosures.empty());
+    // Errors.
+    BOOST_CHECK_THROW(ode_solve(growth,{},arb{0},arb{1},1e-10),std::invalid_argument);
+    BOOST_CHECK_THROW(ode_solve(growth,{arb{1}},wide,arb{1},1e-10),std::invalid_argument);
+    BOOST_CHECK_THROW(ode_solve(growth,{arb{1}},arb{0},wide,1e-10),std::invalid_argument);
+    BOOST_CHECK_THROW(ode_solve(growth,{arb{1}},arb{0},arb{1},0.),std::invalid_argument);
+    BOOST_CHECK_THROW(ode_solve(growth,{arb{1}},arb{0},arb{1},std::numeric_limits<double>::quiet_NaN()),
+        std::invalid_argument);
+    BOOST_CHECK_THROW(ode_solve(growth,{arb{1},arb{1}},arb{0},arb{1},1e-10),std::invalid_argument);
+    auto short_rhs = [](const arb_series &, const series_vector &) {
+        return series_vector{arb_series{arb{1}}};
+    };
+    BOOST_CHECK_THROW(ode_solve(short_rhs,{arb{1}},arb{0},arb{1},1e-10),std::invalid_argument);
+    // y' = y**2, y(0) = 1: the solution 1 / (1 - t) blows up at t = 1.
+    auto blow_up = [](const arb_series &, const series_vector &y) {
+        return series_vector{y[0] * y[0]};
+    };
+    BOOST_CHECK_THROW(ode_solve(blow_up,{arb{1}},arb{0},arb{2},1e-10),std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(ode_cleanup)
+{
+    ::flint_cleanup();
+}
@@ -0,0 +1,230 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+// Precision-scaling benchmark: times the arithmetic operators, cos(), string construction and
+// streaming of arbpp::arb from 53 bits up to 10**6 bits of precision.
+//
+// Options:
+// --output <file>      write the results as JSON to <file>;
+// --baseline <file>    compare the medians with the results stored in <file> (the output of a previous run):
+//                      the program fails if an operation got more than <threshold> percent slower;
+// --threshold <pct>    regression threshold, in percent (default 10);
+// --max-prec <bits>    maximum precision (default 1000000);
+// --budget <seconds>   time budget for each operation at each precision (default 0.2).
+//
+// A missing or empty baseline file is an error: to create one, copy the output of a run on the reference build.
+
+#include "../src/arbpp.hpp"
+#include "benchmark.hpp"
+
+#include <arb.h>
+#include <cstdlib>
+#include <flint/flint.h>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace arbpp;
+using namespace arbpp_benchmark;
+
+namespace
+{
+
+struct result
+{
+    std::string                 op;
+    long                        prec;
+    std::size_t                 n_samples;
+    summary                     times;
+    double                      allocations;
+    double                      allocated_bytes;
+    perf_counters::values_type  counters;
+};
+
+typedef std::vector<std::pair<std::string,std::function<void()>>> op_list;
+
+// Benchmark a single operation at a single precision.
+result run(const std::string &name, long prec, const std::function<void()> &f, double budget, perf_counters &pc)
+{
+    result retval;
+    retval.op = name;
+    retval.prec = prec;
+    const auto samples = measure(f,budget);
+    retval.n_samples = samples.size();
+    retval.times = summarize(samples);
+    // Allocations and hardware counters, averaged over about a millisecond of calls.
+    const std::size_t reps = std::max<std::size_t>(1u,static_cast<std::size_t>(1E6 / retval.times.median));
+    const auto s0 = memory::get_thread_stats();
+    pc.start();
+    for (std::size_t i = 0u; i < reps; ++i) {
+        f();
+    }
+    retval.counters = pc.stop();
+    const auto s1 = memory::get_thread_stats();
+    retval.allocations = static_cast<double>(s1.allocations - s0.allocations) / static_cast<double>(reps);
+    retval.allocated_bytes = static_cast<double>(s1.allocated_bytes - s0.allocated_bytes) / static_cast<double>(reps);
+    for (auto &c: retval.counters) {
+        c /= reps;
+    }
+    return retval;
+}
+
+void write_json(std::ostream &os, const std::vector<result> &results, double threshold, const perf_counters &pc)
+{
+    os << std::setprecision(10);
+    os << "{\"benchmark\":\"precision_scaling\",\"threshold\":" << threshold << ",\"results\":[";
+    for (std::size_t i = 0u; i < results.size(); ++i) {
+        const auto &r = results[i];
+        os << (i ? ",\n" : "\n") << "{\"operation\":\"" << r.op << "\",\"precision\":" << r.prec
+           << ",\"samples\":" << r.n_samples << ",\"min_ns\":" << r.times.min << ",\"p10_ns\":" << r.times.p10
+           << ",\"median_ns\":" << r.times.median << ",\"p90_ns\":" << r.times.p90 << ",\"max_ns\":" << r.times.max
+           << ",\"allocations\":" << r.allocations << ",\"allocated_bytes\":" << r.allocated_bytes;
+        if (pc.available()) {
+            for (std::size_t j = 0u; j < perf_counters::n_counters; ++j) {
+                os << ",\"" << perf_counters::name(j) << "\":" << r.counters[j];
+            }
+        }
+        os << '}';
+    }
+    os << "\n]}\n";
+}
+
+// Compare with the baseline, returning the number of regressions (a missing baseline counts as one).
+unsigned compare(const std::vector<result> &results, const std::string &path, double threshold)
+{
+    std::ifstream ifs(path);
+    if (!ifs) {
+        std::cout << "ERROR: no baseline found at '" << path << "'.\n";
+        return 1u;
+    }
+    std::map<std::pair<std::string,long>,double> baseline;
+    std::string line;
+    while (std::getline(ifs,line)) {
+        const auto op = json_string(line,"operation");
+        const auto median = json_number(line,"median_ns");
+        if (!op.empty() && !std::isnan(median)) {
+            baseline[std::make_pair(op,static_cast<long>(json_number(line,"precision")))] = median;
+        }
+    }
+    if (baseline.empty()) {
+        std::cout << "ERROR: the baseline at '" << path << "' contains no results.\n";
+        return 1u;
+    }
+    unsigned retval = 0u;
+    std::cout << "\nComparison with '" << path << "' (threshold " << threshold << "%):\n";
+    for (const auto &r: results) {
+        const auto it = baseline.find(std::make_pair(r.op,r.prec));
+        if (it == baseline.end() || !(it->second > 0.)) {
+            continue;
+        }
+        const double change = (r.times.median / it->second - 1.) * 100.;
+        if (change > threshold) {
+            std::cout << "REGRESSION: " << r.op << " at " << r.prec << " bits: " << std::setprecision(4)
+                      << it->second << " ns -> " << r.times.median << " ns (+" << change << "%)\n";
+            ++retval;
+        }
+    }
+    std::cout << retval << " regression(s).\n";
+    return retval;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    // NOTE: this must happen before the first allocation of FLINT.
+    memory::enable_tracking();
+    std::string output, baseline;
+    double threshold = 10., budget = .2;
+    long max_prec = 1000000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string opt(argv[i]), val(argv[i + 1]);
+        if (opt == "--output") {
+            output = val;
+        } else if (opt == "--baseline") {
+            baseline = val;
+        } else if (opt == "--threshold") {
+            threshold = std::atof(val.c_str());
+        } else if (opt == "--max-prec") {
+            max_prec = std::atol(val.c_str());
+        } else if (opt == "--budget") {
+            budget = std::atof(val.c_str());
+        } else {
+            std::cerr << "Unknown option '" << opt << "'\n";
+            return 1;
+        }
+    }
+    perf_counters pc;
+    std::cout << "Hardware counters " << (pc.available() ? "enabled" : "not available") << ".\n";
+    std::vector<result> results;
+    const long precs[] = {53,128,512,2048,8192,32768,131072,1000000};
+    arb sink;
+    for (const auto prec: precs) {
+        if (prec > max_prec) {
+            break;
+        }
+        // Operands with all the bits of the mantissa set.
+        const arb x = arb{2,prec}.sqrt(), y = arb{3,prec}.sqrt();
+        arb z{x};
+        arb mid{x};
+        ::mag_zero(arb_radref(mid.get_arb_t()));
+        std::ostringstream oss;
+        oss << mid;
+        const std::string str = oss.str();
+        const op_list ops = {
+            {"add",[&]() {sink = x + y;}},
+            {"sub",[&]() {sink = x - y;}},
+            {"mul",[&]() {sink = x * y;}},
+            {"div",[&]() {sink = x / y;}},
+            {"neg",[&]() {sink = -x;}},
+            // NOTE: the in-place operations alternate, so that the operand does not drift.
+            {"in_place_add_sub",[&]() {z += y; z -= y;}},
+            {"in_place_mul_div",[&]() {z *= y; z /= y;}},
+            {"cos",[&]() {sink = x.cos();}},
+            {"from_string",[&]() {sink = arb{str,prec};}},
+            {"to_stream",[&]() {oss.str(std::string()); oss << x;}}
+        };
+        for (const auto &op: ops) {
+            z = x;
+            results.push_back(run(op.first,prec,op.second,budget,pc));
+            const auto &r = results.back();
+            std::cout << std::left << std::setw(18) << r.op << std::right << std::setw(9) << r.prec
+                      << std::setw(14) << std::setprecision(5) << r.times.median << " ns"
+                      << "  [p10 " << r.times.p10 << ", p90 " << r.times.p90 << "]"
+                      << std::setw(10) << r.allocations << " allocs" << std::endl;
+        }
+    }
+    if (!output.empty()) {
+        std::ofstream ofs(output);
+        write_json(ofs,results,threshold,pc);
+        std::cout << "Results written to '" << output << "'.\n";
+    }
+    write_trace();
+    const unsigned n_regressions = baseline.empty() ? 0u : compare(results,baseline,threshold);
+    ::flint_cleanup();
+    return n_regressions ? 1 : 0;
+}
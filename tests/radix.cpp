@@ -0,0 +1,240 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#include "../src/arbpp.hpp"
+
+#define BOOST_TEST_MODULE radix_test
+#include <boost/test/unit_test.hpp>
+
+#include <arb.h>
+#include <cstddef>
+#include <flint/flint.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace arbpp;
+
+static arb pi(long prec)
+{
+    arb retval;
+    retval.set_precision(prec);
+    ::arb_const_pi(retval.get_arb_t(),prec);
+    return retval;
+}
+
+BOOST_AUTO_TEST_CASE(radix_stream_digits_test)
+{
+    std::ostringstream oss;
+    BOOST_CHECK_EQUAL(stream_digits(oss,pi,50u),50u);
+    BOOST_CHECK_EQUAL(oss.str(),"3.1415926535897932384626433832795028841971693993751");
+    oss.str("");
+    BOOST_CHECK_EQUAL(stream_digits(oss,pi,1u),1u);
+    BOOST_CHECK_EQUAL(oss.str(),"3");
+    // Negative values and exponents.
+    auto third = [](long prec) {
+        arb retval{-1,prec};
+        return retval / 3;
+    };
+    oss.str("");
+    BOOST_CHECK_EQUAL(stream_digits(oss,third,20u),20u);
+    BOOST_CHECK_EQUAL(oss.str(),"-3.3333333333333333333e-1");
+    oss.str("");
+    stream_digits(oss,[](long) {return arb{12345};},3u);
+    BOOST_CHECK_EQUAL(oss.str(),"1.23e4");
+    oss.str("");
+    stream_digits(oss,[](long) {return arb{0.125};},6u);
+    BOOST_CHECK_EQUAL(oss.str(),"1.25000e-1");
+    oss.str("");
+    BOOST_CHECK_EQUAL(stream_digits(oss,[](long) {return arb{};},6u),6u);
+    BOOST_CHECK_EQUAL(oss.str(),"0");
+    // Many digits, going through the divide-and-conquer conversion.
+    auto seventh = [](long prec) {
+        arb retval{1,prec};
+        return retval / 7;
+    };
+    oss.str("");
+    BOOST_CHECK_EQUAL(stream_digits(oss,seventh,5000u),5000u);
+    std::string expected = "1.";
+    for (std::size_t i = 1u; i < 5000u; ++i) {
+        expected += "428571"[(i - 1u) % 6u];
+    }
+    BOOST_CHECK_EQUAL(oss.str(),expected + "e-1");
+    BOOST_CHECK_THROW(stream_digits(oss,pi,0u),std::invalid_argument);
+    BOOST_CHECK_THROW(stream_digits(oss,pi,10u,-1),std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(radix_stream_digits_progress_test)
+{
+    // The digits are written progressively, with increasing precision.
+    std::ostringstream oss;
+    std::vector<long> precs;
+    std::vector<std::string> outputs;
+    const std::size_t n = 3000u;
+    stream_digits(oss,[&](long prec) {
+        precs.push_back(prec);
+        outputs.push_back(oss.str());
+        return pi(prec);
+    },n);
+    const std::string out = oss.str();
+    BOOST_CHECK_EQUAL(out.size(),n + 1u);
+    BOOST_CHECK(precs.size() > 2u);
+    BOOST_CHECK_EQUAL(precs[0],64);
+    for (std::size_t i = 1u; i < precs.size(); ++i) {
+        BOOST_CHECK(precs[i] > precs[i - 1u]);
+        BOOST_CHECK(outputs[i].size() >= outputs[i - 1u].size());
+        BOOST_CHECK_EQUAL(out.compare(0u,outputs[i].size(),outputs[i]),0);
+    }
+    // Digits were available before the final evaluation.
+    BOOST_CHECK(outputs.back().size() > 100u);
+    // Agreement with the string conversion of a high-precision ball.
+    std::ostringstream ref;
+    ref << pi(12000);
+    BOOST_CHECK_EQUAL(ref.str().compare(0u,1000u,out,0u,1000u),0);
+}
+
+BOOST_AUTO_TEST_CASE(radix_stream_digits_max_prec_test)
+{
+    // An inexact zero never certifies any digit.
+    std::ostringstream oss;
+    auto zero = [](long prec) {
+        return cos(pi(prec) / 2);
+    };
+    BOOST_CHECK_EQUAL(stream_digits(oss,zero,10u,1000),0u);
+    BOOST_CHECK(oss.str().empty());
+    // Partial output.
+    oss.str("");
+    const auto n = stream_digits(oss,[](long) {return arb{1,53} / 3;},40u,2000);
+    BOOST_CHECK(n > 10u && n < 40u);
+    BOOST_CHECK_EQUAL(oss.str(),std::string("3.") + std::string(n - 1u,'3') + "e-1");
+    // A finite decimal expansion whose truncated endpoints differ at the leading digit (2.99...9e-1 and
+    // 3.00...0e-1) at every precision.
+    oss.str("");
+    BOOST_CHECK_EQUAL(stream_digits(oss,[](long prec) {return arb{"0.3",prec};},20000u),0u);
+    BOOST_CHECK(oss.str().empty());
+    // Balls straddling a power of ten: the digits come once the exponents agree.
+    oss.str("");
+    auto below_one = [](long prec) {
+        arb retval{1,prec}, eps{1,prec};
+        ::arb_mul_2exp_si(eps.get_arb_t(),eps.get_arb_t(),-200);
+        return retval - eps;
+    };
+    BOOST_CHECK_EQUAL(stream_digits(oss,below_one,30u),30u);
+    BOOST_CHECK_EQUAL(oss.str(),"9." + std::string(29u,'9') + "e-1");
+    // A power of ten never returned exactly.
+    oss.str("");
+    auto one = [](long prec) {
+        arb retval{1,prec};
+        ::arb_add_error_2exp_si(retval.get_arb_t(),-prec);
+        return retval;
+    };
+    BOOST_CHECK_EQUAL(stream_digits(oss,one,10u,1000),0u);
+    BOOST_CHECK(oss.str().empty());
+}
+
+BOOST_AUTO_TEST_CASE(radix_string_constructor_test)
+{
+    const long prec = 1l << 17;
+    // Exact values.
+    const arb a{"-12345678901234567890.5",prec};
+    BOOST_CHECK(::mag_is_zero(arb_radref(a.get_arb_t())));
+    BOOST_CHECK_EQUAL(a.get_precision(),prec);
+    BOOST_CHECK(::arb_equal(a.get_arb_t(),arb{" -12345678901234567890.5",prec}.get_arb_t()));
+    BOOST_CHECK((arb{"1.25e3",prec} == arb{1250}).is_true());
+    BOOST_CHECK(::arb_is_zero(arb{"-0.000",prec}.get_arb_t()));
+    // Inexact values: same midpoint as the MPFR conversion (leading whitespace makes the
+    // constructor fall back on MPFR), and a radius enclosing the value.
+    std::string str = "1.";
+    for (int i = 0; i < 100000; ++i) {
+        str += static_cast<char>('0' + (i * 7) % 10);
+    }
+    for (const auto &s: {std::string("0.1"),std::string("-2.5e-40"),str,str + "e123",std::string("-") + str + "E-77"}) {
+        const arb x{s,prec}, y{" " + s,prec};
+        BOOST_CHECK(::arf_equal(arb_midref(x.get_arb_t()),arb_midref(y.get_arb_t())));
+        BOOST_CHECK(!::mag_is_zero(arb_radref(x.get_arb_t())));
+        BOOST_CHECK(::mag_cmp(arb_radref(x.get_arb_t()),arb_radref(y.get_arb_t())) >= 0);
+        BOOST_CHECK(x.get_rel_accuracy_bits() >= prec - 2);
+    }
+    BOOST_CHECK_THROW(arb("1.2.3",prec),std::invalid_argument);
+    BOOST_CHECK_THROW(arb("",prec),std::invalid_argument);
+    BOOST_CHECK_THROW(arb("1e",prec),std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(radix_stream_operator_test)
+{
+    const long prec = 1l << 17;
+    const arb x = arb{1,prec} / 3;
+    std::ostringstream oss;
+    oss << x;
+    const std::string out = oss.str();
+    // 1 + ceil(prec * log10(2)) digits.
+    const std::size_t nd = 39458u;
+    BOOST_CHECK_EQUAL(out.compare(0u,3u,"(3."),0);
+    BOOST_CHECK_EQUAL(out.find_first_not_of('3',3u),nd + 2u);
+    BOOST_CHECK_EQUAL(out.compare(nd + 2u,7u,"e-1 +/-"),0);
+    // Round trip of the midpoint.
+    arb mid;
+    ::arb_get_mid_arb(mid.get_arb_t(),x.get_arb_t());
+    mid.set_precision(prec);
+    oss.str("");
+    oss << mid;
+    const arb y{oss.str(),prec};
+    BOOST_CHECK(::arf_equal(arb_midref(y.get_arb_t()),arb_midref(x.get_arb_t())));
+    // Negative values and exact integers.
+    oss.str("");
+    oss << arb{-1250,prec};
+    BOOST_CHECK_EQUAL(oss.str().compare(0u,6u,"-1.250"),0);
+    BOOST_CHECK_EQUAL(oss.str().substr(oss.str().size() - 3u),"0e3");
+}
+
+BOOST_AUTO_TEST_CASE(radix_stream_exponent_test)
+{
+    // Large exponents go through MPFR instead of scaling by huge powers of ten.
+    const long prec = 1l << 17;
+    arb x = arb{1,prec} / 3;
+    ::arb_mul_2exp_si(x.get_arb_t(),x.get_arb_t(),1l << 28);
+    std::ostringstream oss;
+    oss << x;
+    // 2**(2**28) / 3 = 4.77... * 10**80807123.
+    BOOST_CHECK_EQUAL(oss.str().compare(0u,3u,"(4."),0);
+    BOOST_CHECK(oss.str().find("e80807123 +/-") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(radix_threads_test)
+{
+    const unsigned n = detail::radix_threads();
+    BOOST_CHECK(n >= 1u && n <= detail::radix_max_threads);
+    // The conversions do not spawn threads within the blocks of parallel_for().
+    std::vector<unsigned> inner(4u,0u);
+    detail::parallel_for(4u,4u,[&inner](std::size_t b, std::size_t e) {
+        for (auto i = b; i != e; ++i) {
+            inner[i] = detail::radix_threads();
+        }
+    });
+    BOOST_CHECK(inner == std::vector<unsigned>(4u,1u));
+    BOOST_CHECK_EQUAL(detail::radix_threads(),n);
+}
+
+BOOST_AUTO_TEST_CASE(radix_cleanup)
+{
+    ::flint_cleanup();
+}
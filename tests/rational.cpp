@@ -0,0 +1,86 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#include "../src/arbpp.hpp"
+
+#define BOOST_TEST_MODULE rational_test
+#include <boost/test/unit_test.hpp>
+
+#include <flint/flint.h>
+#include <flint/fmpq.h>
+#include <flint/fmpz.h>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+using namespace arbpp;
+
+BOOST_AUTO_TEST_CASE(rational_ctor_assignment_test)
+{
+    BOOST_CHECK((std::is_constructible<rational,int>::value));
+    BOOST_CHECK((std::is_constructible<rational,long long,unsigned>::value));
+    BOOST_CHECK((!std::is_constructible<rational,double>::value));
+    BOOST_CHECK((!std::is_convertible<int,rational>::value));
+    // Default ctor.
+    rational q0;
+    BOOST_CHECK(::fmpq_is_zero(q0.get_fmpq_t()));
+    // From integer.
+    rational q1{-42};
+    BOOST_CHECK_EQUAL(::fmpz_get_si(fmpq_numref(q1.get_fmpq_t())),-42);
+    BOOST_CHECK(::fmpz_is_one(fmpq_denref(q1.get_fmpq_t())));
+    rational q2{std::numeric_limits<long long>::min()};
+    BOOST_CHECK(::fmpz_sgn(fmpq_numref(q2.get_fmpq_t())) < 0);
+    // From numerator and denominator, canonical form.
+    rational q3{6,-4};
+    BOOST_CHECK_EQUAL(::fmpz_get_si(fmpq_numref(q3.get_fmpq_t())),-3);
+    BOOST_CHECK_EQUAL(::fmpz_get_si(fmpq_denref(q3.get_fmpq_t())),2);
+    BOOST_CHECK_THROW((rational{1,0}),std::invalid_argument);
+    // From fmpq_t.
+    ::fmpq_t f;
+    ::fmpq_init(f);
+    ::fmpq_set_si(f,1,3);
+    rational q4{f};
+    BOOST_CHECK_EQUAL(::fmpz_get_si(fmpq_denref(q4.get_fmpq_t())),3);
+    ::fmpq_clear(f);
+    // Copy and move.
+    rational q5{q3};
+    BOOST_CHECK_EQUAL(::fmpz_get_si(fmpq_numref(q5.get_fmpq_t())),-3);
+    rational q6{std::move(q5)};
+    BOOST_CHECK_EQUAL(::fmpz_get_si(fmpq_numref(q6.get_fmpq_t())),-3);
+    q0 = q4;
+    BOOST_CHECK_EQUAL(::fmpz_get_si(fmpq_denref(q0.get_fmpq_t())),3);
+    q0 = q0;
+    BOOST_CHECK_EQUAL(::fmpz_get_si(fmpq_denref(q0.get_fmpq_t())),3);
+    q0 = std::move(q6);
+    BOOST_CHECK_EQUAL(::fmpz_get_si(fmpq_numref(q0.get_fmpq_t())),-3);
+    // Swap.
+    swap(q0,q4);
+    BOOST_CHECK_EQUAL(::fmpz_get_si(fmpq_denref(q0.get_fmpq_t())),3);
+    BOOST_CHECK_EQUAL(::fmpz_get_si(fmpq_denref(q4.get_fmpq_t())),2);
+}
+
+// Keep this for last, in order to have proper
+// memory cleanup and make valgrind happy.
+BOOST_AUTO_TEST_CASE(rational_cleanup)
+{
+    ::flint_cleanup();
+}
@@ -0,0 +1,170 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#include "../src/real.hpp"
+
+#define BOOST_TEST_MODULE real_test
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <arb.h>
+#include <flint/flint.h>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+#include "../src/arbpp.hpp"
+#include "helpers.hpp"
+
+using namespace arbpp;
+using namespace arbpp_test;
+
+BOOST_AUTO_TEST_CASE(real_constructors_test)
+{
+    BOOST_CHECK(::arb_is_exact(real{}.evaluate(100).get_arb_t()));
+    BOOST_CHECK((real{3}.evaluate(100) == arb{3}).is_true());
+    BOOST_CHECK((real{-1.5}.evaluate(100) == arb{-1.5}).is_true());
+    BOOST_CHECK(::arb_is_exact(real{3}.evaluate(100).get_arb_t()));
+    BOOST_CHECK(real{std::string("0.1")}.evaluate(200).get_rel_accuracy_bits() >= 200);
+    BOOST_CHECK(overlaps(real{std::string("0.1")}.evaluate(200),arb{"0.1",300}));
+    BOOST_CHECK_THROW(real{std::string("foo")},std::invalid_argument);
+    BOOST_CHECK_THROW(real{std::function<arb(long)>{}},std::invalid_argument);
+    BOOST_CHECK_THROW(real{1}.evaluate(0),std::invalid_argument);
+    BOOST_CHECK_THROW(real{1}.evaluate(10,-1),std::invalid_argument);
+    // A fixed ball cannot be refined.
+    const arb a{"0.1",53};
+    const auto r = real{a}.evaluate(1000);
+    BOOST_CHECK(::arb_equal(r.get_arb_t(),a.get_arb_t()));
+}
+
+BOOST_AUTO_TEST_CASE(real_evaluate_test)
+{
+    const real x{std::string("0.1")};
+    const real y = (x * x + 1) / 3 - x;
+    for (long acc: {10l,53l,100l,1000l,10000l}) {
+        const auto r = y.evaluate(acc);
+        BOOST_CHECK(r.get_rel_accuracy_bits() >= acc);
+        // (0.01 + 1) / 3 - 0.1 = 0.2366...
+        BOOST_CHECK(overlaps(r,(arb{"0.01",acc + 64} + 1) / 3 - arb{"0.1",acc + 64}));
+    }
+    const real p = real::pi();
+    const auto c = cos(p / 3).evaluate(500);
+    BOOST_CHECK(c.get_rel_accuracy_bits() >= 500);
+    BOOST_CHECK(contains(c,arb{1} / 2));
+    const auto s = sqrt(abs(-real{2})).evaluate(300);
+    BOOST_CHECK(s.get_rel_accuracy_bits() >= 300);
+    BOOST_CHECK(contains(s * s,arb{2}));
+    // Catastrophic cancellation: the working precision must grow beyond the target accuracy.
+    const real big = real{1} + real{std::string("1e-100")};
+    const auto d = (big - 1).evaluate(100);
+    BOOST_CHECK(d.get_rel_accuracy_bits() >= 100);
+    BOOST_CHECK(overlaps(d,arb{"1e-100",500}));
+    // In-place operators.
+    real z{1};
+    z += 2;
+    z *= 3;
+    z -= 1;
+    z /= 4;
+    BOOST_CHECK((z.evaluate(100) == arb{2}).is_true());
+}
+
+BOOST_AUTO_TEST_CASE(real_refinement_test)
+{
+    unsigned n_a = 0, n_b = 0;
+    const real a{std::function<arb(long)>([&n_a](long prec) {
+        ++n_a;
+        return arb{"0.1",prec};
+    })};
+    const real b{std::function<arb(long)>([&n_b](long prec) {
+        ++n_b;
+        return arb{"0.3",prec};
+    })};
+    const real x = a * a + a;
+    const real y = x + b;
+    // The shared subexpression is evaluated once.
+    BOOST_CHECK(y.evaluate(100).get_rel_accuracy_bits() >= 100);
+    BOOST_CHECK_EQUAL(n_a,1u);
+    BOOST_CHECK_EQUAL(n_b,1u);
+    // Lower accuracies come from the caches.
+    y.evaluate(50);
+    x.evaluate(80);
+    BOOST_CHECK_EQUAL(n_a,1u);
+    BOOST_CHECK_EQUAL(n_b,1u);
+    // Refining b only does not touch a.
+    const real w = b * 2;
+    BOOST_CHECK(w.evaluate(1000).get_rel_accuracy_bits() >= 1000);
+    BOOST_CHECK_EQUAL(n_a,1u);
+    BOOST_CHECK_EQUAL(n_b,2u);
+    // Now y needs to re-evaluate a, but b is already accurate enough.
+    BOOST_CHECK(y.evaluate(500).get_rel_accuracy_bits() >= 500);
+    BOOST_CHECK_EQUAL(n_a,2u);
+    BOOST_CHECK_EQUAL(n_b,2u);
+}
+
+BOOST_AUTO_TEST_CASE(real_operand_accuracy_test)
+{
+    // The target accuracy of the operands does not grow by the working precision guard at each level.
+    long max_prec = 0;
+    real x{std::function<arb(long)>([&max_prec](long prec) {
+        max_prec = std::max(max_prec,prec);
+        return arb{"0.1",prec};
+    })};
+    for (int i = 0; i < 20; ++i) {
+        x = x * 3;
+    }
+    BOOST_CHECK(x.evaluate(100).get_rel_accuracy_bits() >= 100);
+    BOOST_CHECK(max_prec < 250);
+}
+
+BOOST_AUTO_TEST_CASE(real_max_prec_test)
+{
+    // An inexact zero never reaches a positive relative accuracy.
+    const real z = cos(real::pi() / 2);
+    const auto r = z.evaluate(100,2000);
+    BOOST_CHECK(r.get_rel_accuracy_bits() < 100);
+    BOOST_CHECK(contains(r,arb{0}));
+    BOOST_CHECK(r.get_precision() <= 2000);
+}
+
+BOOST_AUTO_TEST_CASE(real_long_chain_test)
+{
+    // Neither the evaluation nor the destruction of a long chain of operations recurse once per node.
+    {
+        real s;
+        const real tenth{"0.1"};
+        for (int i = 0; i < 1000000; ++i) {
+            s += tenth;
+        }
+        BOOST_CHECK(contains(s.evaluate(40),arb{100000}));
+    }
+    real t;
+    for (int i = 0; i < 1000000; ++i) {
+        t += 1;
+    }
+    const real u = t * 2;
+    t = real{};
+    BOOST_CHECK(contains(u.evaluate(40),arb{2000000}));
+}
+
+BOOST_AUTO_TEST_CASE(real_cleanup)
+{
+    ::flint_cleanup();
+}
@@ -0,0 +1,242 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#include "../tools/arbpp_server.hpp"
+
+#define BOOST_TEST_MODULE server_test
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <flint/flint.h>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "../src/arbpp.hpp"
+#include "../tools/arbpp_client.hpp"
+
+using namespace arbpp;
+using namespace arbpp::remote;
+
+static std::string to_string(const arb &a)
+{
+    std::ostringstream oss;
+    oss << a;
+    return oss.str();
+}
+
+static std::string socket_path()
+{
+    return "/tmp/arbpp_server_test_" + std::to_string(::getpid()) + ".sock";
+}
+
+BOOST_AUTO_TEST_CASE(server_protocol_test)
+{
+    const request req{"x*y",{"x","y"},{{"1","2"},{"3.5","-4"}},128};
+    std::uint32_t id;
+    const auto dec = remote::detail::decode_request(remote::detail::encode_request(42u,req),id);
+    BOOST_CHECK_EQUAL(id,42u);
+    BOOST_CHECK_EQUAL(dec.formula,req.formula);
+    BOOST_CHECK(dec.vars == req.vars);
+    BOOST_CHECK(dec.rows == req.rows);
+    BOOST_CHECK_EQUAL(dec.prec,128);
+    const std::vector<result> res = {{true,"1.5"},{false,"error"}};
+    const auto dec_res = remote::detail::decode_response(remote::detail::encode_response(7u,res),id);
+    BOOST_CHECK_EQUAL(id,7u);
+    BOOST_CHECK_EQUAL(dec_res.size(),2u);
+    BOOST_CHECK(dec_res[0u].ok && dec_res[0u].value == "1.5");
+    BOOST_CHECK(!dec_res[1u].ok && dec_res[1u].value == "error");
+    // Truncated and inconsistent messages.
+    const auto enc = remote::detail::encode_request(1u,req);
+    BOOST_CHECK_THROW(remote::detail::decode_request(enc.substr(0u,enc.size() - 1u),id),std::runtime_error);
+    BOOST_CHECK_THROW(remote::detail::encode_request(1u,request{"x",{"x"},{{"1","2"}},53}),std::invalid_argument);
+    // Invalid precisions.
+    BOOST_CHECK_THROW(remote::detail::encode_request(1u,request{"x",{"x"},{{"1"}},0}),std::invalid_argument);
+    BOOST_CHECK_THROW(remote::detail::encode_request(1u,request{"x",{"x"},{{"1"}},-1}),std::invalid_argument);
+    BOOST_CHECK_THROW(remote::detail::encode_request(1u,request{"x",{"x"},{{"1"}},remote::detail::max_precision + 1}),
+        std::invalid_argument);
+    // Too many rows.
+    BOOST_CHECK_THROW(remote::detail::encode_request(1u,request{"x",{"x"},
+        std::vector<std::vector<std::string>>(remote::detail::max_request_rows + 1u,{"1"}),53}),std::invalid_argument);
+    BOOST_CHECK_THROW(remote::detail::encode_request(1u,request{"1",{},{{},{}},53}),std::invalid_argument);
+    // Messages claiming more rows than they can hold.
+    auto empty = remote::detail::encode_request(1u,request{"1",{},{{}},53});
+    const std::uint32_t many_rows = 1u << 26;
+    std::memcpy(&empty[empty.size() - sizeof(many_rows)],&many_rows,sizeof(many_rows));
+    BOOST_CHECK_THROW(remote::detail::decode_request(empty,id),std::runtime_error);
+    const request big{"x",{"x"},std::vector<std::vector<std::string>>(remote::detail::max_request_rows,{""}),53};
+    auto enc_big = remote::detail::encode_request(1u,big);
+    BOOST_CHECK_NO_THROW(remote::detail::decode_request(enc_big,id));
+    enc_big.append(sizeof(std::uint32_t),'\0');
+    const std::uint32_t too_many = remote::detail::max_request_rows + 1u;
+    // NOTE: the number of rows follows the id, the precision, the formula and the variables.
+    std::memcpy(&enc_big[5u * sizeof(std::uint32_t) + 2u],&too_many,sizeof(too_many));
+    BOOST_CHECK_THROW(remote::detail::decode_request(enc_big,id),std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(server_evaluation_test)
+{
+    const auto path = socket_path();
+    server s(path,2u);
+    std::thread t([&s]() {s.run();});
+    {
+        client c(path);
+        BOOST_CHECK_EQUAL(c.evaluate("1/3",100),to_string(arb{1,100} / 3));
+        const auto res = c.evaluate(request{"x*y + 1",{"x","y"},{{"1.5","2"},{"0.1","3"},{"abc","1"}},53});
+        BOOST_CHECK_EQUAL(res.size(),3u);
+        BOOST_CHECK(res[0u].ok && res[0u].value == to_string(arb{4}));
+        BOOST_CHECK(res[1u].ok && res[1u].value == to_string(arb{"0.1",53} * arb{3} + 1));
+        BOOST_CHECK(!res[2u].ok);
+        // Compilation errors are reported for each row.
+        const auto err = c.evaluate(request{"x +",{"x"},{{"1"},{"2"}},53});
+        BOOST_CHECK(!err[0u].ok && !err[1u].ok);
+        BOOST_CHECK_THROW(c.evaluate("foo"),std::invalid_argument);
+        // The connection is still usable.
+        BOOST_CHECK_EQUAL(c.evaluate("2"),to_string(arb{2}));
+    }
+    {
+        // The server rejects invalid precisions sent by clients which do not validate them.
+        const request req{"x",{"x"},{{"1"}},53};
+        auto payload = remote::detail::encode_request(5u,req);
+        const std::uint32_t bad_prec = 0xffffffffu;
+        std::memcpy(&payload[sizeof(std::uint32_t)],&bad_prec,sizeof(bad_prec));
+        const auto addr = remote::detail::make_address(path);
+        const int fd = ::socket(AF_UNIX,SOCK_STREAM,0);
+        BOOST_REQUIRE(fd >= 0);
+        BOOST_REQUIRE(::connect(fd,reinterpret_cast<const ::sockaddr *>(&addr),sizeof(addr)) == 0);
+        remote::detail::write_frame(fd,payload);
+        std::string resp;
+        BOOST_REQUIRE(remote::detail::read_frame(fd,resp));
+        ::close(fd);
+        std::uint32_t id;
+        const auto res = remote::detail::decode_response(resp,id);
+        BOOST_CHECK_EQUAL(id,5u);
+        BOOST_REQUIRE_EQUAL(res.size(),1u);
+        BOOST_CHECK(!res[0u].ok);
+    }
+    // Concurrent clients.
+    std::atomic<unsigned> n_wrong(0u);
+    std::vector<std::thread> clients;
+    for (int i = 0; i < 8; ++i) {
+        clients.emplace_back([i,&path,&n_wrong]() {
+            client c(path);
+            for (int k = 0; k < 50; ++k) {
+                const int n = i * 100 + k;
+                const auto res = c.evaluate(request{"x^2",{"x"},{{std::to_string(n)}},53});
+                if (!res[0u].ok || res[0u].value != to_string(arb{n * n})) {
+                    ++n_wrong;
+                }
+            }
+            ::flint_cleanup();
+        });
+    }
+    for (auto &c: clients) {
+        c.join();
+    }
+    BOOST_CHECK_EQUAL(n_wrong.load(),0u);
+    s.stop();
+    t.join();
+}
+
+BOOST_AUTO_TEST_CASE(server_queue_test)
+{
+    // A small queue: the readers wait for the workers, and larger requests still go through.
+    const auto path = socket_path();
+    server s(path,1u,1u,2u);
+    std::thread t([&s]() {s.run();});
+    std::atomic<unsigned> n_wrong(0u);
+    std::vector<std::thread> clients;
+    for (int i = 0; i < 4; ++i) {
+        clients.emplace_back([i,&path,&n_wrong]() {
+            client c(path);
+            for (int k = 0; k < 20; ++k) {
+                const auto res = c.evaluate(request{"x+1",{"x"},{{std::to_string(i)},{std::to_string(k)},{"0"}},53});
+                if (res.size() != 3u || res[0u].value != to_string(arb{i + 1}) || res[1u].value != to_string(arb{k + 1})
+                    || res[2u].value != to_string(arb{1}))
+                {
+                    ++n_wrong;
+                }
+            }
+            ::flint_cleanup();
+        });
+    }
+    for (auto &c: clients) {
+        c.join();
+    }
+    BOOST_CHECK_EQUAL(n_wrong.load(),0u);
+    s.stop();
+    t.join();
+}
+
+BOOST_AUTO_TEST_CASE(server_socket_path_test)
+{
+    const auto path = socket_path();
+    // A file which is not a socket is never removed.
+    std::ofstream(path) << "data";
+    BOOST_CHECK_THROW(server(path,1u),std::system_error);
+    BOOST_CHECK(std::ifstream(path).good());
+    ::unlink(path.c_str());
+    // The socket of a live server is not taken over.
+    {
+        server s(path,1u);
+        BOOST_CHECK_THROW(server(path,1u),std::system_error);
+        std::thread t([&s]() {s.run();});
+        {
+            client c(path);
+            BOOST_CHECK_EQUAL(c.evaluate("2"),to_string(arb{2}));
+        }
+        s.stop();
+        t.join();
+    }
+    // A stale socket is replaced.
+    const auto addr = remote::detail::make_address(path);
+    const int fd = ::socket(AF_UNIX,SOCK_STREAM,0);
+    BOOST_REQUIRE(fd >= 0);
+    BOOST_REQUIRE(::bind(fd,reinterpret_cast<const ::sockaddr *>(&addr),sizeof(addr)) == 0);
+    ::close(fd);
+    server s(path,1u);
+    std::thread t([&s]() {s.run();});
+    {
+        client c(path);
+        BOOST_CHECK_EQUAL(c.evaluate("3"),to_string(arb{3}));
+    }
+    s.stop();
+    t.join();
+}
+
+BOOST_AUTO_TEST_CASE(server_errors_test)
+{
+    BOOST_CHECK_THROW(server(socket_path(),0u),std::invalid_argument);
+    BOOST_CHECK_THROW(client("/nonexistent/arbpp.sock"),std::system_error);
+    BOOST_CHECK_THROW(client(std::string(200u,'x')),std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(server_cleanup)
+{
+    ::flint_cleanup();
+}
@@ -0,0 +1,246 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#include "../src/subdivision.hpp"
+
+#define BOOST_TEST_MODULE subdivision_test
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <arb.h>
+#include <arf.h>
+#include <flint/flint.h>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "../src/arbpp.hpp"
+#include "helpers.hpp"
+#include "../src/taylor_model.hpp"
+
+using namespace arbpp;
+using namespace arbpp_test;
+
+// Six-hump camel function: the global minimum -1.0316284534898... is attained at (0.0898420131...,-0.7126564030...)
+// and at the opposite point.
+template <typename T>
+static T camel(const std::vector<T> &b)
+{
+    const T &x = b[0], &y = b[1];
+    const T x2 = x * x, y2 = y * y;
+    return 4 * x2 - arb{"2.1"} * x2 * x2 + x2 * x2 * x2 / 3 + x * y - 4 * y2 + 4 * y2 * y2;
+}
+
+static bool covered(const std::vector<std::vector<arb>> &boxes, const std::vector<arb> &pt)
+{
+    for (const auto &b: boxes) {
+        if (contains(b[0],pt[0]) && contains(b[1],pt[1])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+BOOST_AUTO_TEST_CASE(global_minimize_test)
+{
+    const arb min_value{"-1.03162845348987744408920985", 100};
+    const std::vector<arb> m0{arb{"0.0898420131003"},arb{"-0.7126564030207"}}, m1{-m0[0],-m0[1]};
+    for (unsigned n_threads: {1u,2u,4u}) {
+        const auto res = global_minimize(camel<arb>,{interval(-3.,3.),interval(-2.,2.)},1e-2,n_threads);
+        BOOST_CHECK(overlaps(res.minimum,min_value));
+        BOOST_CHECK(width(res.minimum) < 1.01e-2);
+        BOOST_CHECK(res.n_boxes > 0u);
+        BOOST_CHECK(!res.minimizers.empty());
+        BOOST_CHECK(covered(res.minimizers,m0));
+        BOOST_CHECK(covered(res.minimizers,m1));
+        for (const auto &b: res.minimizers) {
+            BOOST_CHECK(!(camel(b) > res.minimum).is_true());
+        }
+    }
+    // Tighter enclosures via Taylor models.
+    auto camel_tm = [](const std::vector<arb> &b) {
+        return camel(taylor_model::variables(b,4u)).bound();
+    };
+    const auto res = global_minimize(camel_tm,{interval(-3.,3.),interval(-2.,2.)},1e-4,2u);
+    BOOST_CHECK(overlaps(res.minimum,min_value));
+    BOOST_CHECK(width(res.minimum) < 1.01e-4);
+    BOOST_CHECK(covered(res.minimizers,m0));
+    BOOST_CHECK(covered(res.minimizers,m1));
+    // Errors.
+    BOOST_CHECK_THROW(global_minimize(camel<arb>,{},1.),std::invalid_argument);
+    BOOST_CHECK_THROW(global_minimize(camel<arb>,{interval(0.,1.),interval(0.,1.)},0.),std::invalid_argument);
+    BOOST_CHECK_THROW(global_minimize(camel<arb>,{interval(0.,1.),interval(0.,1.)},-1.),std::invalid_argument);
+    BOOST_CHECK_THROW(global_minimize(camel<arb>,{interval(0.,1.),interval(0.,1.)},std::numeric_limits<double>::quiet_NaN()),
+        std::invalid_argument);
+    BOOST_CHECK_THROW(global_minimize(camel<arb>,{interval(0.,1.),interval(0.,1.)},1.,0u),std::invalid_argument);
+    // Exceptions thrown by the function, in the calling thread or in the worker threads.
+    auto thrower = [](const std::vector<arb> &b) -> arb {
+        if (::arb_contains_zero(b[0].get_arb_t()) || contains(interval(1.,1.01),b[0])) {
+            throw std::runtime_error("");
+        }
+        return b[0];
+    };
+    BOOST_CHECK_THROW(global_minimize(thrower,{interval(-2.,1.)},1e-3,3u),std::runtime_error);
+    BOOST_CHECK_THROW(global_minimize(thrower,{interval(1.,2.)},1e-3,3u),std::runtime_error);
+    BOOST_CHECK_NO_THROW(global_minimize(thrower,{interval(1.,2.)},1e-1,3u));
+}
+
+BOOST_AUTO_TEST_CASE(global_minimize_gradient_test)
+{
+    // cos(3x) + x**2 / 4 over [-4,4]: the minimum -0.7403... is attained near x = +-1.0.
+    auto f = [](const std::vector<arb> &b) {
+        return cos(3 * b[0]) + b[0] * b[0] / 4;
+    };
+    auto grad = [](const std::vector<arb> &b) {
+        arb s{3 * b[0]};
+        ::arb_sin(s.get_arb_t(),s.get_arb_t(),s.get_precision());
+        return std::vector<arb>{b[0] / 2 - 3 * s};
+    };
+    const auto r0 = global_minimize(f,{interval(-4.,4.)},1e-4,2u), r1 = global_minimize(f,grad,{interval(-4.,4.)},1e-4,2u);
+    BOOST_CHECK(overlaps(r0.minimum,r1.minimum));
+    BOOST_CHECK(width(r1.minimum) < 1.01e-4);
+    BOOST_CHECK(r1.n_boxes < r0.n_boxes);
+    BOOST_CHECK(r1.minimizers.size() < r0.minimizers.size());
+    for (const auto &b: r1.minimizers) {
+        BOOST_CHECK(overlaps(grad(b)[0],arb{0}));
+    }
+    // Minimum on the boundary: x + y**2 over [1,2] x [-1,1], attained at (1,0).
+    auto g = [](const std::vector<arb> &b) {
+        return b[0] + b[1] * b[1];
+    };
+    auto g_grad = [](const std::vector<arb> &b) {
+        return std::vector<arb>{arb{1},2 * b[1]};
+    };
+    const auto r2 = global_minimize(g,g_grad,{interval(1.,2.),interval(-1.,1.)},1e-8);
+    BOOST_CHECK(contains(r2.minimum,arb{1}));
+    BOOST_CHECK(width(r2.minimum) < 1.01e-8);
+    BOOST_REQUIRE(!r2.minimizers.empty());
+    for (const auto &b: r2.minimizers) {
+        BOOST_CHECK((b[0] == arb{1}).is_true());
+        BOOST_CHECK(contains(b[1],arb{0}));
+    }
+    BOOST_CHECK(r2.n_boxes < global_minimize(g,{interval(1.,2.),interval(-1.,1.)},1e-8).n_boxes);
+    // Minimum on the boundary of a box with non-dyadic endpoints, with a derivative whose sign is fixed only
+    // over the sub-boxes: -(x - 3/10)**2 over [1/10,7/10], attained at the upper end. The bisections round
+    // outwards, so the boxes touching the face may extend slightly beyond it.
+    auto h = [](const std::vector<arb> &b) {
+        const arb d = b[0] - arb{"0.3"};
+        return -(d * d);
+    };
+    auto h_grad = [](const std::vector<arb> &b) {
+        return std::vector<arb>{-2 * (b[0] - arb{"0.3"})};
+    };
+    const arb x1 = interval(.1,.7);
+    arb e0;
+    ::arb_get_ubound_arf(arb_midref(e0.get_arb_t()),x1.get_arb_t(),x1.get_precision());
+    const auto r3 = global_minimize(h,h_grad,{x1},1e-8,2u);
+    BOOST_CHECK(overlaps(r3.minimum,h({e0})));
+    BOOST_CHECK(overlaps(r3.minimum,global_minimize(h,{x1},1e-6).minimum));
+    BOOST_REQUIRE(!r3.minimizers.empty());
+    for (const auto &b: r3.minimizers) {
+        BOOST_CHECK(contains(x1,b[0]) || ::arb_equal(b[0].get_arb_t(),e0.get_arb_t()));
+        BOOST_CHECK(overlaps(b[0],e0));
+    }
+    // Wrong size of the gradient.
+    BOOST_CHECK_THROW(global_minimize(g,grad,{interval(1.,2.),interval(-1.,1.)},1e-8),std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(bound_range_test)
+{
+    // x * (1 - x) over [0,1] ranges over [0,1/4].
+    auto f = [](const arb &x) {
+        return x * (1 - x);
+    };
+    const arb x0 = interval(0.,1.);
+    BOOST_CHECK(width(f(x0)) > 1.);
+    for (unsigned n_threads: {1u,2u,3u,8u}) {
+        const arb r = bound_range(f,x0,1e-3,n_threads);
+        BOOST_CHECK_EQUAL(r.get_precision(),x0.get_precision());
+        BOOST_CHECK(contains(r,interval(0.,.25)));
+        BOOST_CHECK(width(r) <= .25 + 1e-3);
+    }
+    // The result tightens with the target width, and it encloses the values at the points of the interval.
+    auto g = [](const arb &x) {
+        return cos(5 * x) + x;
+    };
+    const arb x1 = interval(0.,3.);
+    double lo = 1e300, hi = -1e300;
+    std::vector<arb> samples;
+    for (int i = 0; i <= 3000; ++i) {
+        samples.push_back(g(arb{i / 1000.}));
+        lo = std::min(lo,::arf_get_d(arb_midref(samples.back().get_arb_t()),ARF_RND_NEAR));
+        hi = std::max(hi,::arf_get_d(arb_midref(samples.back().get_arb_t()),ARF_RND_NEAR));
+    }
+    double prev = 1e300;
+    for (double target: {1e-1,1e-3,1e-6}) {
+        const arb r = bound_range(g,x1,target,4u);
+        for (const auto &v: samples) {
+            BOOST_CHECK(contains(r,v));
+        }
+        BOOST_CHECK(width(r) <= hi - lo + target + 1e-5);
+        BOOST_CHECK(width(r) < prev);
+        prev = width(r);
+    }
+    // Exact input.
+    BOOST_CHECK(contains(bound_range(g,arb{1},1e-3),g(arb{1})));
+    BOOST_CHECK(width(bound_range(g,arb{1},1e-3)) < 1e-10);
+    // Not defined at some points of the interval.
+    auto h = [](const arb &x) {
+        return sqrt(x);
+    };
+    BOOST_CHECK(!::arb_is_finite(bound_range(h,interval(-1.,1.),1e-3,2u).get_arb_t()));
+    BOOST_CHECK(contains(bound_range(h,interval(0.,1.),1e-3,2u),interval(0.,1.)));
+    // Poles and removable singularities: the enclosures are not finite around 0, although the values at the
+    // midpoints are.
+    auto pole = [](const arb &x) {
+        return 1 / x;
+    };
+    BOOST_CHECK(!::arb_is_finite(bound_range(pole,interval(0.,1.),1e-3,2u).get_arb_t()));
+    auto sinc = [](const arb &x) {
+        arb s;
+        ::arb_sin(s.get_arb_t(),x.get_arb_t(),s.get_precision());
+        return s / x;
+    };
+    BOOST_CHECK(!::arb_is_finite(bound_range(sinc,interval(0.,1.),1e-3).get_arb_t()));
+    auto pole_box = [](const std::vector<arb> &b) {
+        return 1 / b[0];
+    };
+    const auto r = global_minimize(pole_box,{interval(0.,1.)},1e-3,2u);
+    BOOST_CHECK(!::arb_is_finite(r.minimum.get_arb_t()) || overlaps(r.minimum,arb{1}));
+    BOOST_CHECK(!r.minimizers.empty());
+    // Errors.
+    BOOST_CHECK_THROW(bound_range(f,x0,0.),std::invalid_argument);
+    BOOST_CHECK_THROW(bound_range(f,x0,-1.),std::invalid_argument);
+    BOOST_CHECK_THROW(bound_range(f,x0,std::numeric_limits<double>::quiet_NaN()),std::invalid_argument);
+    BOOST_CHECK_THROW(bound_range(f,x0,1e-3,0u),std::invalid_argument);
+    auto thrower = [](const arb &x) -> arb {
+        if (contains(interval(.5,.51),x)) {
+            throw std::runtime_error("");
+        }
+        return x * (1 - x);
+    };
+    BOOST_CHECK_THROW(bound_range(thrower,x0,1e-6,4u),std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(subdivision_cleanup)
+{
+    ::flint_cleanup();
+}
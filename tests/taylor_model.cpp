@@ -0,0 +1,139 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#include "../src/taylor_model.hpp"
+
+#define BOOST_TEST_MODULE taylor_model_test
+#include <boost/test/unit_test.hpp>
+
+#include <arb.h>
+#include <flint/flint.h>
+#include <stdexcept>
+#include <vector>
+
+#include "../src/arbpp.hpp"
+#include "helpers.hpp"
+
+using namespace arbpp;
+using namespace arbpp_test;
+
+BOOST_AUTO_TEST_CASE(taylor_model_variables_test)
+{
+    BOOST_CHECK_THROW(taylor_model::variables({},3u),std::invalid_argument);
+    const std::vector<arb> box{interval(0.,1.),interval(-2.,2.),arb{3}};
+    const auto v = taylor_model::variables(box,3u);
+    BOOST_CHECK_EQUAL(v.size(),3u);
+    BOOST_CHECK_EQUAL(v[0].get_order(),3u);
+    BOOST_CHECK_EQUAL(v[0].get_n_variables(),3u);
+    BOOST_CHECK_EQUAL(v[0].get_precision(),arb::get_default_precision());
+    BOOST_CHECK_EQUAL(v[0].get_n_terms(),2u);
+    BOOST_CHECK((v[0].get_coefficient({0u,0u,0u}) == arb{0.5}).is_true());
+    BOOST_CHECK((v[0].get_coefficient({1u,0u,0u}) == arb{0.5}).is_true());
+    BOOST_CHECK((v[1].get_coefficient({0u,1u,0u}) == arb{2}).is_true());
+    BOOST_CHECK(::arb_is_zero(v[0].get_coefficient({0u,1u,0u}).get_arb_t()));
+    BOOST_CHECK_THROW(v[0].get_coefficient({0u,1u}),std::invalid_argument);
+    BOOST_CHECK(::arb_is_zero(v[0].get_remainder().get_arb_t()));
+    for (std::size_t i = 0u; i < 3u; ++i) {
+        BOOST_CHECK(::arb_equal(v[i].bound().get_arb_t(),box[i].get_arb_t()));
+    }
+    // Order zero: everything goes into the remainder.
+    const auto w = taylor_model::variables(box,0u);
+    BOOST_CHECK_EQUAL(w[1].get_n_terms(),1u);
+    BOOST_CHECK(contains(w[1].bound(),box[1]));
+    // Incompatible models.
+    BOOST_CHECK_THROW(v[0] + w[0],std::invalid_argument);
+    BOOST_CHECK_THROW(v[0] * taylor_model::variables({interval(0.,2.),interval(-2.,2.),arb{3}},3u)[0],
+        std::invalid_argument);
+    // Boxes with the same values are compatible.
+    BOOST_CHECK_NO_THROW(v[0] + taylor_model::variables(box,3u)[1]);
+}
+
+BOOST_AUTO_TEST_CASE(taylor_model_dependency_test)
+{
+    const arb x0 = interval(0.,1.);
+    const auto x = taylor_model::variables({x0},4u)[0];
+    // Cancellations happen on the polynomial.
+    BOOST_CHECK(::arb_is_zero((x - x).bound().get_arb_t()));
+    BOOST_CHECK(::arb_is_zero((x * x - x * x).bound().get_arb_t()));
+    // x * (1 - x) ranges over [0,1/4], while plain balls give [-1/4,3/4] or worse.
+    const auto f = x * (1 - x);
+    BOOST_CHECK(contains(f.bound(),interval(0.,.25)));
+    BOOST_CHECK(width(f.bound()) < .26);
+    BOOST_CHECK(width(x0 * (1 - x0)) > .9);
+    // Higher orders give tighter enclosures.
+    double prev = 1e300;
+    for (unsigned order: {1u,3u,6u,10u}) {
+        const auto y = taylor_model::variables({x0},order)[0];
+        const auto g = cos(y) * cos(y) + (1 - cos(y) * cos(y));
+        BOOST_CHECK(contains(g.bound(),arb{1}));
+        BOOST_CHECK(width(g.bound()) < prev);
+        prev = width(g.bound());
+    }
+    BOOST_CHECK(prev < 1e-3);
+    BOOST_CHECK(width(cos(x0) * cos(x0) + (1 - cos(x0) * cos(x0))) > .5);
+}
+
+BOOST_AUTO_TEST_CASE(taylor_model_arithmetic_test)
+{
+    const std::vector<arb> box{interval(0.,1.),interval(.75,1.25)};
+    const auto v = taylor_model::variables(box,10u);
+    const auto &x = v[0], &y = v[1];
+    // Polynomials are exact.
+    const auto p = x * x * x - 2 * x * y + 0.5;
+    BOOST_CHECK(::arb_is_zero(p.get_remainder().get_arb_t()));
+    const std::vector<arb> pt{arb{0.25},arb{1}};
+    BOOST_CHECK(contains(p.evaluate(pt),arb{0.25 * 0.25 * 0.25 - 0.5 + 0.5}));
+    BOOST_CHECK_THROW(p.evaluate({arb{0.25}}),std::invalid_argument);
+    // Points outside the box, including the coordinates of zero radius.
+    BOOST_CHECK_THROW(p.evaluate({arb{1.5},arb{1}}),std::invalid_argument);
+    BOOST_CHECK_THROW(p.evaluate({arb{0.25},interval(1.,1.5)}),std::invalid_argument);
+    const auto w = taylor_model::variables({interval(0.,1.),arb{2}},3u);
+    const auto pw = w[0] * w[1];
+    BOOST_CHECK(contains(pw.evaluate({arb{.5},arb{2}}),arb{1}));
+    BOOST_CHECK_THROW(pw.evaluate({arb{.5},arb{3}}),std::invalid_argument);
+    // Mixed operations.
+    auto q = x + arb{1};
+    q -= 2;
+    q *= 3.;
+    q /= arb{3};
+    q += y;
+    q = 2 - q;
+    BOOST_CHECK(contains(q.evaluate(pt),arb{2 - (0.25 + 1 - 2) - 1}));
+    // Elementary functions enclose the values at the points of the box.
+    const auto r = cos(x + y) / (2 + x) + sqrt(y) - 1 / y;
+    for (double a: {0.,.1,.5,.9,1.}) {
+        for (double b: {.75,.9,1.,1.25}) {
+            const arb xa{a}, yb{b};
+            const arb expected = cos(xa + yb) / (2 + xa) + sqrt(yb) - 1 / yb;
+            BOOST_CHECK(overlaps(r.evaluate({xa,yb}),expected));
+            BOOST_CHECK(width(r.evaluate({xa,yb})) < 1e-3);
+        }
+    }
+    BOOST_CHECK(overlaps(r.bound(),r.evaluate(box)));
+    // Division by a model whose range contains zero.
+    BOOST_CHECK(!::arb_is_finite((1 / (x - 0.5)).bound().get_arb_t()));
+    BOOST_CHECK(!::arb_is_finite(sqrt(x - 0.5).bound().get_arb_t()));
+}
+
+BOOST_AUTO_TEST_CASE(taylor_model_cleanup)
+{
+    ::flint_cleanup();
+}
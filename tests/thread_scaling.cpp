@@ -0,0 +1,340 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+// Multithreaded scaling benchmark: runs independent arbpp::arb kernels on 1 to N threads (each thread
+// owns its data and performs the same amount of work) and reports the throughput and the parallel
+// efficiency, i.e., the throughput divided by the number of threads times the single-thread throughput.
+//
+// The kernels come in pairs which differ only in the use of the allocator, so that contention in the
+// GMP/FLINT allocator shows up as a difference in efficiency within a pair:
+// - horner / horner_tmp: polynomial evaluation with in-place operations / with temporaries;
+// - dot / dot_tmp: dot product with addmul() / with temporaries;
+// - cos: cos() over an array, which goes through the per-thread caches of constants of Arb. The cost of
+//   the first call on each thread (which fills the caches) is reported separately;
+// - parse: construction from decimal strings.
+// arbpp itself has no global mutable state in the arithmetic paths, unless the tests are built with
+// ARBPP_ENABLE_INSTRUMENTATION or ARBPP_ENABLE_TRACING (and memory tracking updates global atomic
+// counters, which is why it is opt-in here).
+//
+// Options:
+// --max-threads <n>    maximum number of threads (default: hardware concurrency);
+// --prec <bits>        working precision (default 256);
+// --budget <seconds>   approximate duration of each single-thread run (default 0.2);
+// --track-memory       count the allocations per kernel call;
+// --output <file>      write the results as JSON to <file>.
+
+#include "../src/arbpp.hpp"
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <flint/flint.h>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace arbpp;
+using namespace arbpp_benchmark;
+
+namespace
+{
+
+const std::size_t kernel_size = 64u;
+
+// A kernel factory builds the data of a thread and returns the function performing one call of the kernel.
+struct kernel
+{
+    const char                                          *name;
+    std::function<std::function<void()>(unsigned,long)> make;
+};
+
+// Deterministic pseudo-random operand in (0,1) with all the bits of the mantissa set.
+arb operand(unsigned seed, std::size_t i, long prec)
+{
+    return arb{static_cast<long>(seed * kernel_size + i + 2u),prec}.sqrt() / static_cast<long>(kernel_size * 1000u);
+}
+
+std::vector<arb> operands(unsigned seed, long prec)
+{
+    std::vector<arb> retval;
+    for (std::size_t i = 0u; i < kernel_size; ++i) {
+        retval.push_back(operand(seed,i,prec));
+    }
+    return retval;
+}
+
+const std::vector<kernel> &kernels()
+{
+    static const std::vector<kernel> retval = {
+        {"horner",[](unsigned seed, long prec) -> std::function<void()> {
+            const auto c = operands(seed,prec);
+            const auto x = operand(seed + 1u,0u,prec);
+            auto r = std::make_shared<arb>(0,prec);
+            return [c,x,r]() {
+                *r = c.back();
+                for (auto i = c.size() - 1u; i > 0u; --i) {
+                    *r *= x;
+                    *r += c[i - 1u];
+                }
+            };
+        }},
+        {"horner_tmp",[](unsigned seed, long prec) -> std::function<void()> {
+            const auto c = operands(seed,prec);
+            const auto x = operand(seed + 1u,0u,prec);
+            auto r = std::make_shared<arb>(0,prec);
+            return [c,x,r]() {
+                arb tmp = c.back();
+                for (auto i = c.size() - 1u; i > 0u; --i) {
+                    tmp = tmp * x + c[i - 1u];
+                }
+                *r = std::move(tmp);
+            };
+        }},
+        {"dot",[](unsigned seed, long prec) -> std::function<void()> {
+            const auto a = operands(seed,prec), b = operands(seed + 1u,prec);
+            auto r = std::make_shared<arb>(0,prec);
+            return [a,b,r]() {
+                ::arb_zero(r->get_arb_t());
+                for (std::size_t i = 0u; i < a.size(); ++i) {
+                    r->addmul(a[i],b[i]);
+                }
+            };
+        }},
+        {"dot_tmp",[](unsigned seed, long prec) -> std::function<void()> {
+            const auto a = operands(seed,prec), b = operands(seed + 1u,prec);
+            auto r = std::make_shared<arb>(0,prec);
+            return [a,b,r]() {
+                arb tmp{0,a[0].get_precision()};
+                for (std::size_t i = 0u; i < a.size(); ++i) {
+                    tmp = tmp + a[i] * b[i];
+                }
+                *r = std::move(tmp);
+            };
+        }},
+        {"cos",[](unsigned seed, long prec) -> std::function<void()> {
+            const auto a = operands(seed,prec);
+            auto r = std::make_shared<arb>(0,prec);
+            return [a,r]() {
+                for (const auto &x: a) {
+                    *r = x.cos();
+                }
+            };
+        }},
+        {"parse",[](unsigned seed, long prec) -> std::function<void()> {
+            std::vector<std::string> strs;
+            for (const auto &x: operands(seed,prec)) {
+                arb mid{x};
+                ::mag_zero(arb_radref(mid.get_arb_t()));
+                std::ostringstream oss;
+                oss << mid;
+                strs.push_back(oss.str());
+            }
+            auto r = std::make_shared<arb>(0,prec);
+            return [strs,r,prec]() {
+                for (const auto &s: strs) {
+                    *r = arb{s,prec};
+                }
+            };
+        }}
+    };
+    return retval;
+}
+
+struct result
+{
+    std::string name;
+    unsigned    n_threads;
+    double      wall_ns;
+    double      throughput;
+    double      efficiency;
+    // Slowest and fastest thread, relative to the wall time.
+    double      max_thread;
+    double      min_thread;
+    // Average cost of the first call on each thread, in nanoseconds.
+    double      first_call_ns;
+    // Average allocations per call (if memory tracking is enabled).
+    double      allocations;
+};
+
+// Run n_iter calls of the kernel on each of n_threads threads.
+result run(const kernel &k, unsigned n_threads, std::size_t n_iter, long prec)
+{
+    std::vector<double> thread_ns(n_threads), first_ns(n_threads), allocs(n_threads);
+    std::atomic<unsigned> ready(0u);
+    std::atomic<bool> go(false);
+    std::vector<std::thread> threads;
+    for (unsigned i = 0u; i < n_threads; ++i) {
+        threads.emplace_back([&,i]() {
+            {
+                const auto f = k.make(i,prec);
+                timer t;
+                f();
+                first_ns[i] = t.elapsed();
+                ready.fetch_add(1u);
+                while (!go.load()) {}
+                const auto s0 = memory::get_thread_stats();
+                t.restart();
+                for (std::size_t j = 0u; j < n_iter; ++j) {
+                    f();
+                }
+                thread_ns[i] = t.elapsed();
+                allocs[i] = static_cast<double>(memory::get_thread_stats().allocations - s0.allocations) /
+                    static_cast<double>(n_iter);
+            }
+            ::flint_cleanup();
+        });
+    }
+    while (ready.load() != n_threads) {}
+    timer wall;
+    go.store(true);
+    for (auto &t: threads) {
+        t.join();
+    }
+    result retval;
+    retval.name = k.name;
+    retval.n_threads = n_threads;
+    retval.wall_ns = wall.elapsed();
+    retval.throughput = static_cast<double>(n_iter * n_threads) / retval.wall_ns * 1E9;
+    retval.efficiency = 1.;
+    retval.max_thread = *std::max_element(thread_ns.begin(),thread_ns.end()) / retval.wall_ns;
+    retval.min_thread = *std::min_element(thread_ns.begin(),thread_ns.end()) / retval.wall_ns;
+    retval.first_call_ns = 0.;
+    retval.allocations = 0.;
+    for (unsigned i = 0u; i < n_threads; ++i) {
+        retval.first_call_ns += first_ns[i] / n_threads;
+        retval.allocations += allocs[i] / n_threads;
+    }
+    return retval;
+}
+
+void write_json(std::ostream &os, const std::vector<result> &results, long prec, bool track_memory)
+{
+    os << std::setprecision(10);
+    os << "{\"benchmark\":\"thread_scaling\",\"precision\":" << prec << ",\"results\":[";
+    for (std::size_t i = 0u; i < results.size(); ++i) {
+        const auto &r = results[i];
+        os << (i ? ",\n" : "\n") << "{\"kernel\":\"" << r.name << "\",\"threads\":" << r.n_threads
+           << ",\"wall_ns\":" << r.wall_ns << ",\"throughput\":" << r.throughput << ",\"efficiency\":" << r.efficiency
+           << ",\"max_thread\":" << r.max_thread << ",\"min_thread\":" << r.min_thread
+           << ",\"first_call_ns\":" << r.first_call_ns;
+        if (track_memory) {
+            os << ",\"allocations\":" << r.allocations;
+        }
+        os << '}';
+    }
+    os << "\n]}\n";
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    unsigned max_threads = std::max(1u,std::thread::hardware_concurrency());
+    long prec = 256;
+    double budget = .2;
+    bool track_memory = false;
+    std::string output;
+    for (int i = 1; i < argc; ++i) {
+        const std::string opt(argv[i]);
+        if (opt == "--track-memory") {
+            track_memory = true;
+            continue;
+        }
+        if (i + 1 == argc) {
+            std::cerr << "Missing value for option '" << opt << "'\n";
+            return 1;
+        }
+        const std::string val(argv[++i]);
+        if (opt == "--max-threads") {
+            max_threads = static_cast<unsigned>(std::max(1l,std::atol(val.c_str())));
+        } else if (opt == "--prec") {
+            prec = std::atol(val.c_str());
+        } else if (opt == "--budget") {
+            budget = std::atof(val.c_str());
+        } else if (opt == "--output") {
+            output = val;
+        } else {
+            std::cerr << "Unknown option '" << opt << "'\n";
+            return 1;
+        }
+    }
+    if (track_memory) {
+        // NOTE: this must happen before the first allocation of FLINT.
+        memory::enable_tracking();
+    }
+    std::vector<unsigned> thread_counts;
+    for (unsigned n = 1u; n < max_threads; n *= 2u) {
+        thread_counts.push_back(n);
+    }
+    thread_counts.push_back(max_threads);
+    std::vector<result> results;
+    std::cout << "Precision: " << prec << " bits, up to " << max_threads << " threads.\n\n"
+              << std::left << std::setw(12) << "kernel" << std::right << std::setw(8) << "threads"
+              << std::setw(16) << "calls/s" << std::setw(12) << "efficiency" << std::setw(18) << "thread time"
+              << std::setw(16) << "first call ns";
+    if (track_memory) {
+        std::cout << std::setw(14) << "allocs/call";
+    }
+    std::cout << '\n';
+    for (const auto &k: kernels()) {
+        // Calibrate the number of calls on a single thread.
+        std::size_t n_iter = 1u;
+        {
+            const auto f = k.make(0u,prec);
+            f();
+            timer t;
+            f();
+            n_iter = std::max<std::size_t>(1u,static_cast<std::size_t>(budget * 1E9 / std::max(1.,t.elapsed())));
+        }
+        double base_throughput = 0.;
+        for (const auto n: thread_counts) {
+            auto r = run(k,n,n_iter,prec);
+            if (n == 1u) {
+                base_throughput = r.throughput;
+            }
+            r.efficiency = r.throughput / (n * base_throughput);
+            std::cout << std::left << std::setw(12) << r.name << std::right << std::setw(8) << r.n_threads
+                      << std::setw(16) << std::setprecision(6) << r.throughput << std::setw(12)
+                      << std::setprecision(3) << r.efficiency << std::setw(9) << r.min_thread << '-'
+                      << std::setw(8) << std::left << r.max_thread << std::right << std::setw(16)
+                      << std::setprecision(6) << r.first_call_ns;
+            if (track_memory) {
+                std::cout << std::setw(14) << r.allocations;
+            }
+            std::cout << std::endl;
+            results.push_back(r);
+        }
+    }
+    if (!output.empty()) {
+        std::ofstream ofs(output);
+        write_json(ofs,results,prec,track_memory);
+        std::cout << "\nResults written to '" << output << "'.\n";
+    }
+    write_trace();
+    ::flint_cleanup();
+}
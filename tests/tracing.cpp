@@ -0,0 +1,140 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#define ARBPP_ENABLE_TRACING
+#include "../src/arbpp.hpp"
+
+#define BOOST_TEST_MODULE tracing_test
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <flint/flint.h>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace arbpp;
+
+static std::size_t count_events(const std::vector<tracing::event> &events, const char *name)
+{
+    return static_cast<std::size_t>(std::count_if(events.begin(),events.end(),[name](const tracing::event &e) {
+        return std::strcmp(e.name,name) == 0;
+    }));
+}
+
+BOOST_AUTO_TEST_CASE(tracing_span_test)
+{
+    tracing::clear();
+    BOOST_CHECK(tracing::get_events().empty());
+    {
+        tracing::span s0{"outer"};
+        tracing::span s1{"inner"};
+        tracing::span s2{nullptr};
+    }
+    const auto events = tracing::get_events();
+    BOOST_CHECK_EQUAL(events.size(),2u);
+    BOOST_CHECK_EQUAL(count_events(events,"outer"),1u);
+    BOOST_CHECK_EQUAL(count_events(events,"inner"),1u);
+    for (const auto &e: events) {
+        BOOST_CHECK(e.begin <= e.end);
+        BOOST_CHECK_EQUAL(e.tid,events[0].tid);
+    }
+    // The inner span is nested in the outer one.
+    const auto &outer = std::strcmp(events[0].name,"outer") == 0 ? events[0] : events[1];
+    const auto &inner = std::strcmp(events[0].name,"outer") == 0 ? events[1] : events[0];
+    BOOST_CHECK(outer.begin <= inner.begin && inner.end <= outer.end);
+    tracing::clear();
+    BOOST_CHECK(tracing::get_events().empty());
+}
+
+BOOST_AUTO_TEST_CASE(tracing_parallel_test)
+{
+    tracing::clear();
+    std::vector<arb> v;
+    for (int i = 0; i < 1000; ++i) {
+        v.emplace_back((i * 7919) % 1000);
+    }
+    arbpp::sort(v.begin(),v.end(),4u);
+    arbpp::sum(v.begin(),v.end());
+    // The worker threads have exited, their spans have been retained.
+    const auto events = tracing::get_events();
+    BOOST_CHECK_EQUAL(count_events(events,"arbpp::sort"),1u);
+    BOOST_CHECK_EQUAL(count_events(events,"arbpp::sum"),1u);
+    BOOST_CHECK(count_events(events,"arbpp::parallel_for block") >= 4u);
+    std::set<unsigned> tids;
+    for (const auto &e: events) {
+        tids.insert(e.tid);
+    }
+    BOOST_CHECK(tids.size() >= 4u);
+    // Long evaluations.
+    tracing::clear();
+    arb{2,53}.cos();
+    BOOST_CHECK_EQUAL(count_events(tracing::get_events(),"arbpp::arb::cos"),0u);
+    arb{2,tracing::long_evaluation_prec}.cos();
+    arb{2,tracing::long_evaluation_prec}.sqrt();
+    BOOST_CHECK_EQUAL(count_events(tracing::get_events(),"arbpp::arb::cos"),1u);
+    BOOST_CHECK_EQUAL(count_events(tracing::get_events(),"arbpp::arb::sqrt"),1u);
+}
+
+BOOST_AUTO_TEST_CASE(tracing_overflow_test)
+{
+    tracing::clear();
+    const auto n = tracing::buffer_capacity + 10u;
+    for (std::size_t i = 0u; i < n; ++i) {
+        tracing::span s{"overflow"};
+    }
+    BOOST_CHECK_EQUAL(tracing::get_events().size(),tracing::buffer_capacity);
+    BOOST_CHECK_EQUAL(tracing::dropped_events(),10u);
+    // Spans of exiting threads.
+    tracing::clear();
+    std::thread t([]() noexcept {
+        tracing::span s{"thread"};
+    });
+    t.join();
+    BOOST_CHECK_EQUAL(count_events(tracing::get_events(),"thread"),1u);
+    BOOST_CHECK_EQUAL(tracing::dropped_events(),0u);
+}
+
+BOOST_AUTO_TEST_CASE(tracing_export_test)
+{
+    tracing::clear();
+    std::ostringstream oss;
+    tracing::export_chrome_trace(oss);
+    BOOST_CHECK_EQUAL(oss.str(),"{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n]}\n");
+    {
+        tracing::span s{"quo\"te"};
+    }
+    oss.str("");
+    tracing::export_chrome_trace(oss);
+    const auto str = oss.str();
+    BOOST_CHECK(str.find("\"name\":\"quo\\\"te\"") != std::string::npos);
+    BOOST_CHECK(str.find("\"ph\":\"X\"") != std::string::npos);
+    BOOST_CHECK(str.find("\"ts\":0.000") != std::string::npos);
+    BOOST_CHECK(str.find("\"dur\":") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(tracing_cleanup)
+{
+    ::flint_cleanup();
+}
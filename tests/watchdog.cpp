@@ -0,0 +1,154 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#include "../src/arbpp.hpp"
+
+#define BOOST_TEST_MODULE watchdog_test
+#include <boost/test/unit_test.hpp>
+
+#include <arb.h>
+#include <flint/flint.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace arbpp;
+
+// (1 + 2**-80) - 1, which collapses below 80 bits of precision.
+static arb cancellation(long prec)
+{
+    arb tiny{1,prec};
+    ::arb_mul_2exp_si(tiny.get_arb_t(),tiny.get_arb_t(),-80);
+    return (arb{1,prec} + tiny) - arb{1,prec};
+}
+
+BOOST_AUTO_TEST_CASE(watchdog_throw_test)
+{
+    const arb third = arb{1} / 3;
+    // No watchdog active.
+    BOOST_CHECK_NO_THROW(third - third);
+    {
+        precision_watchdog w{20};
+        BOOST_CHECK_EQUAL(w.get_floor(),20);
+        BOOST_CHECK(!w.triggered());
+        BOOST_CHECK_THROW(w.get_event(),std::logic_error);
+        // Operations which keep the accuracy are fine.
+        BOOST_CHECK_NO_THROW(third * third + third);
+        BOOST_CHECK_NO_THROW(third.cos());
+        BOOST_CHECK(!w.triggered());
+        try {
+            const arb tmp = third - third;
+            BOOST_CHECK(false);
+        } catch (const precision_loss_error &e) {
+            BOOST_CHECK(e.get_event().op == operation::binary_sub);
+            BOOST_CHECK_EQUAL(e.get_event().precision,53);
+            BOOST_CHECK(e.get_event().accuracy < 20);
+            BOOST_CHECK(std::string(e.what()).find("binary_sub") != std::string::npos);
+        }
+        BOOST_CHECK(w.triggered());
+        BOOST_CHECK(w.get_event().op == operation::binary_sub);
+        // In-place operations: the operand is left unchanged when throwing.
+        arb x{third};
+        BOOST_CHECK_THROW(x -= third,precision_loss_error);
+        BOOST_CHECK(::arb_equal(x.get_arb_t(),third.get_arb_t()));
+        BOOST_CHECK_EQUAL(x.get_precision(),third.get_precision());
+        BOOST_CHECK_THROW(x -= x,precision_loss_error);
+        BOOST_CHECK(::arb_equal(x.get_arb_t(),third.get_arb_t()));
+        // The first event is retained.
+        BOOST_CHECK(w.get_event().op == operation::binary_sub);
+        arb y{third};
+        BOOST_CHECK_THROW(y.addmul(third,arb{-1}),precision_loss_error);
+        BOOST_CHECK(::arb_equal(y.get_arb_t(),third.get_arb_t()));
+        BOOST_CHECK_THROW(y.addmul(third,rational{-1}),precision_loss_error);
+        BOOST_CHECK(::arb_equal(y.get_arb_t(),third.get_arb_t()));
+        BOOST_CHECK_EQUAL(y.get_precision(),third.get_precision());
+    }
+    // The watchdog is gone.
+    BOOST_CHECK_NO_THROW(third - third);
+}
+
+BOOST_AUTO_TEST_CASE(watchdog_callback_test)
+{
+    const arb third = arb{1} / 3;
+    int n_calls = 0;
+    operation last_op = operation::construct;
+    precision_watchdog w{20,[&n_calls,&last_op](const precision_event &e) {
+        ++n_calls;
+        last_op = e.op;
+    }};
+    arb x = third - third;
+    BOOST_CHECK_EQUAL(n_calls,1);
+    BOOST_CHECK(last_op == operation::binary_sub);
+    // The callback fires only once, the computation goes on.
+    x *= 2;
+    x = x.sqrt();
+    BOOST_CHECK_EQUAL(n_calls,1);
+    BOOST_CHECK(w.triggered());
+    BOOST_CHECK(w.get_event().op == operation::binary_sub);
+}
+
+BOOST_AUTO_TEST_CASE(watchdog_nesting_test)
+{
+    const arb third = arb{1} / 3;
+    int n_calls = 0;
+    precision_watchdog outer{20,[&n_calls](const precision_event &) {++n_calls;}};
+    {
+        precision_watchdog inner{20};
+        BOOST_CHECK_THROW(third - third,precision_loss_error);
+        BOOST_CHECK_EQUAL(n_calls,0);
+    }
+    arb x = third - third;
+    BOOST_CHECK_EQUAL(n_calls,1);
+    BOOST_CHECK(outer.get_event().accuracy < 20);
+    // Watchdogs are per thread.
+    std::thread t([&third]() {
+        arb y = third - third;
+        ::flint_cleanup();
+    });
+    t.join();
+    BOOST_CHECK_EQUAL(n_calls,1);
+}
+
+BOOST_AUTO_TEST_CASE(watchdog_restart_test)
+{
+    long prec = 64;
+    arb result;
+    while (true) {
+        try {
+            precision_watchdog w{20};
+            result = cancellation(prec);
+            break;
+        } catch (const precision_loss_error &e) {
+            BOOST_CHECK_EQUAL(e.get_event().precision,prec);
+            prec *= 2;
+        }
+    }
+    BOOST_CHECK_EQUAL(prec,128);
+    BOOST_CHECK_EQUAL(result.get_radius(),0.);
+    BOOST_CHECK(result.get_midpoint() > 0.);
+}
+
+// Keep this for last, in order to have proper
+// memory cleanup and make valgrind happy.
+BOOST_AUTO_TEST_CASE(watchdog_cleanup)
+{
+    ::flint_cleanup();
+}
@@ -0,0 +1,404 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#ifndef ARBPP_TOOLS_ARBPP_CLIENT_HPP
+#define ARBPP_TOOLS_ARBPP_CLIENT_HPP
+
+// Client of the arbpp evaluation server (see arbpp_server.hpp), and the wire format shared with the server.
+// This header does not depend on Arb.
+//
+// The server listens on a Unix domain socket. Each message is a frame made of a 32-bit length (the number
+// of bytes which follow) and a payload. Integers are unsigned 32-bit values in host byte order (client and
+// server run on the same host), strings are a 32-bit length followed by the bytes.
+//
+// Request payload:  id, precision, formula, number of variables, variable names, number of rows, and for
+//                   each row as many strings as variables (the values, in the syntax of the string
+//                   constructor of arbpp::arb). An expression without variables is a request with one
+//                   empty row. A request has at most max_request_rows rows.
+// Response payload: id, number of results, and for each result a status byte (1 for success) followed by
+//                   a string (the value formatted by the stream operator of arbpp::arb, or an error message).
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <system_error>
+#include <unistd.h>
+#include <vector>
+
+namespace arbpp
+{
+
+/// Remote evaluation.
+namespace remote
+{
+
+/// Evaluation request.
+struct request
+{
+    /// Formula (see arbpp::compiled_expr).
+    std::string                             formula;
+    /// Names of the variables.
+    std::vector<std::string>                vars;
+    /// Rows of values of the variables.
+    std::vector<std::vector<std::string>>   rows;
+    /// Working precision.
+    long                                    prec;
+};
+
+/// Result of the evaluation of a row.
+struct result
+{
+    /// \p true if the evaluation succeeded.
+    bool        ok;
+    /// Formatted value, or error message.
+    std::string value;
+};
+
+namespace detail
+{
+
+// Largest accepted frame.
+const std::uint32_t max_frame_size = 1u << 26;
+
+// Largest number of rows in a request.
+const std::uint32_t max_request_rows = 1u << 16;
+
+// Largest accepted working precision, in bits.
+const long max_precision = 1l << 20;
+
+inline void check_precision(long prec)
+{
+    if (prec < 1 || prec > max_precision) {
+        throw std::invalid_argument("invalid precision " + std::to_string(prec) + ": it must be between 1 and " +
+            std::to_string(max_precision));
+    }
+}
+
+inline void put_u32(std::string &buf, std::uint32_t n)
+{
+    buf.append(reinterpret_cast<const char *>(&n),sizeof(n));
+}
+
+inline void put_str(std::string &buf, const std::string &s)
+{
+    put_u32(buf,static_cast<std::uint32_t>(s.size()));
+    buf.append(s);
+}
+
+// Sequential reader of a payload.
+class reader
+{
+    public:
+        explicit reader(const std::string &buf):m_ptr(buf.data()),m_end(buf.data() + buf.size()) {}
+        std::uint32_t u32()
+        {
+            check(sizeof(std::uint32_t));
+            std::uint32_t retval;
+            std::memcpy(&retval,m_ptr,sizeof(retval));
+            m_ptr += sizeof(retval);
+            return retval;
+        }
+        unsigned char byte()
+        {
+            check(1u);
+            return static_cast<unsigned char>(*m_ptr++);
+        }
+        std::string str()
+        {
+            const std::uint32_t n = u32();
+            check(n);
+            std::string retval(m_ptr,n);
+            m_ptr += n;
+            return retval;
+        }
+        // Number of items of a sequence whose items take at least min_size bytes each.
+        std::uint32_t count(std::size_t min_size)
+        {
+            const std::uint32_t n = u32();
+            if (n > max_frame_size) {
+                throw std::runtime_error("malformed message");
+            }
+            check(n * min_size);
+            return n;
+        }
+    private:
+        void check(std::size_t n) const
+        {
+            if (static_cast<std::size_t>(m_end - m_ptr) < n) {
+                throw std::runtime_error("malformed message");
+            }
+        }
+        const char  *m_ptr;
+        const char  *m_end;
+};
+
+inline void write_all(int fd, const char *data, std::size_t n)
+{
+    while (n) {
+        const auto w = ::send(fd,data,n,MSG_NOSIGNAL);
+        if (w < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno,std::system_category(),"send() failed");
+        }
+        data += w;
+        n -= static_cast<std::size_t>(w);
+    }
+}
+
+// Returns false on end of stream before any byte is read.
+inline bool read_all(int fd, char *data, std::size_t n)
+{
+    bool first = true;
+    while (n) {
+        const auto r = ::recv(fd,data,n,0);
+        if (r < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno,std::system_category(),"recv() failed");
+        }
+        if (r == 0) {
+            if (first) {
+                return false;
+            }
+            throw std::runtime_error("connection closed in the middle of a message");
+        }
+        first = false;
+        data += r;
+        n -= static_cast<std::size_t>(r);
+    }
+    return true;
+}
+
+// Frame I/O. read_frame() returns false on end of stream.
+inline void write_frame(int fd, const std::string &payload)
+{
+    std::string buf;
+    buf.reserve(payload.size() + sizeof(std::uint32_t));
+    put_u32(buf,static_cast<std::uint32_t>(payload.size()));
+    buf.append(payload);
+    write_all(fd,buf.data(),buf.size());
+}
+
+inline bool read_frame(int fd, std::string &payload)
+{
+    std::uint32_t n;
+    if (!read_all(fd,reinterpret_cast<char *>(&n),sizeof(n))) {
+        return false;
+    }
+    if (n > max_frame_size) {
+        throw std::runtime_error("message too large");
+    }
+    payload.resize(n);
+    if (n && !read_all(fd,&payload[0],n)) {
+        throw std::runtime_error("connection closed in the middle of a message");
+    }
+    return true;
+}
+
+inline std::string encode_request(std::uint32_t id, const request &req)
+{
+    check_precision(req.prec);
+    if (req.rows.size() > max_request_rows || (req.vars.empty() && req.rows.size() > 1u)) {
+        throw std::invalid_argument("too many rows in a request: " + std::to_string(req.rows.size()));
+    }
+    std::string retval;
+    put_u32(retval,id);
+    put_u32(retval,static_cast<std::uint32_t>(req.prec));
+    put_str(retval,req.formula);
+    put_u32(retval,static_cast<std::uint32_t>(req.vars.size()));
+    for (const auto &v: req.vars) {
+        put_str(retval,v);
+    }
+    put_u32(retval,static_cast<std::uint32_t>(req.rows.size()));
+    for (const auto &row: req.rows) {
+        if (row.size() != req.vars.size()) {
+            throw std::invalid_argument("the number of values in a row differs from the number of variables");
+        }
+        for (const auto &s: row) {
+            put_str(retval,s);
+        }
+    }
+    return retval;
+}
+
+inline request decode_request(const std::string &payload, std::uint32_t &id)
+{
+    reader r(payload);
+    request retval;
+    id = r.u32();
+    retval.prec = static_cast<long>(r.u32());
+    retval.formula = r.str();
+    const auto n_vars = r.count(sizeof(std::uint32_t));
+    for (std::uint32_t i = 0u; i < n_vars; ++i) {
+        retval.vars.push_back(r.str());
+    }
+    // NOTE: the rows take at least one byte each, except for the single empty row of a request without
+    // variables: the size of the payload thus bounds the memory allocated for the rows.
+    const auto n_rows = n_vars ? r.count(n_vars * sizeof(std::uint32_t)) : r.u32();
+    if (n_rows > max_request_rows || (n_vars == 0u && n_rows > 1u)) {
+        throw std::runtime_error("malformed message");
+    }
+    retval.rows.resize(n_rows);
+    for (auto &row: retval.rows) {
+        for (std::uint32_t i = 0u; i < n_vars; ++i) {
+            row.push_back(r.str());
+        }
+    }
+    return retval;
+}
+
+inline std::string encode_response(std::uint32_t id, const std::vector<result> &results)
+{
+    std::string retval;
+    put_u32(retval,id);
+    put_u32(retval,static_cast<std::uint32_t>(results.size()));
+    for (const auto &res: results) {
+        retval.push_back(res.ok ? '\1' : '\0');
+        put_str(retval,res.value);
+    }
+    return retval;
+}
+
+inline std::vector<result> decode_response(const std::string &payload, std::uint32_t &id)
+{
+    reader r(payload);
+    id = r.u32();
+    std::vector<result> retval(r.count(1u + sizeof(std::uint32_t)));
+    for (auto &res: retval) {
+        res.ok = r.byte() != 0u;
+        res.value = r.str();
+    }
+    return retval;
+}
+
+inline ::sockaddr_un make_address(const std::string &path)
+{
+    ::sockaddr_un retval;
+    std::memset(&retval,0,sizeof(retval));
+    retval.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(retval.sun_path)) {
+        throw std::invalid_argument("socket path too long: '" + path + "'");
+    }
+    std::memcpy(retval.sun_path,path.c_str(),path.size() + 1u);
+    return retval;
+}
+
+}
+
+/// Client of the evaluation server.
+/**
+ * Each object holds a connection to the server, and sends one request at a time. Objects must not be used
+ * concurrently from multiple threads: concurrent clients should use separate objects (the server batches
+ * the requests coming from different connections).
+ */
+class client
+{
+    public:
+        /// Constructor.
+        /**
+         * @param[in] path path of the socket of the server.
+         *
+         * @throws std::system_error if the connection fails.
+         * @throws std::invalid_argument if \p path is too long.
+         */
+        explicit client(const std::string &path):m_fd(-1),m_next_id(0u)
+        {
+            const auto addr = detail::make_address(path);
+            m_fd = ::socket(AF_UNIX,SOCK_STREAM,0);
+            if (m_fd < 0) {
+                throw std::system_error(errno,std::system_category(),"socket() failed");
+            }
+            if (::connect(m_fd,reinterpret_cast<const ::sockaddr *>(&addr),sizeof(addr)) != 0) {
+                const int err = errno;
+                ::close(m_fd);
+                throw std::system_error(err,std::system_category(),"cannot connect to '" + path + "'");
+            }
+        }
+        client(const client &) = delete;
+        client &operator=(const client &) = delete;
+        /// Destructor.
+        ~client()
+        {
+            ::close(m_fd);
+        }
+        /// Evaluate a request.
+        /**
+         * @param[in] req request.
+         *
+         * @return the results of the evaluation of the rows of \p req, in the same order.
+         *
+         * @throws std::invalid_argument if a row of \p req does not have as many values as variables, if \p req
+         * has more rows than an implementation-defined maximum (or more than one row without variables), or if the
+         * precision of \p req is not between 1 and an implementation-defined maximum.
+         * @throws std::system_error in case of communication errors.
+         * @throws std::runtime_error if the response is malformed or the server closed the connection.
+         */
+        std::vector<result> evaluate(const request &req)
+        {
+            const std::uint32_t id = m_next_id++;
+            detail::write_frame(m_fd,detail::encode_request(id,req));
+            std::string payload;
+            if (!detail::read_frame(m_fd,payload)) {
+                throw std::runtime_error("the server closed the connection");
+            }
+            std::uint32_t resp_id;
+            auto retval = detail::decode_response(payload,resp_id);
+            if (resp_id != id || retval.size() != req.rows.size()) {
+                throw std::runtime_error("mismatched response");
+            }
+            return retval;
+        }
+        /// Evaluate an expression.
+        /**
+         * @param[in] expr expression without variables.
+         * @param[in] prec working precision.
+         *
+         * @return the value of \p expr, formatted by the stream operator of arbpp::arb.
+         *
+         * @throws std::invalid_argument if the evaluation fails on the server.
+         * @throws unspecified any exception thrown by evaluate(const request &).
+         */
+        std::string evaluate(const std::string &expr, long prec = 53)
+        {
+            const auto res = evaluate(request{expr,{},{{}},prec});
+            if (!res[0u].ok) {
+                throw std::invalid_argument(res[0u].value);
+            }
+            return res[0u].value;
+        }
+    private:
+        int             m_fd;
+        std::uint32_t   m_next_id;
+};
+
+}
+
+}
+
+#endif
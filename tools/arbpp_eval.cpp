@@ -0,0 +1,419 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+// arbpp-eval: batch evaluation of expressions or of a formula over rows of parameters.
+//
+// The input (stdin, or a file mapped into memory) is split into batches of lines, which are evaluated in
+// parallel by a pool of worker threads. The results are written to stdout in input order, one line per input
+// line, through a bounded reorder buffer: the reader stops when too many batches are in flight, so the memory
+// usage does not depend on the size of the input. A line which cannot be evaluated produces a line starting
+// with "error:", and the exit status is then 1.
+
+#include "../src/arbpp.hpp"
+#include "../src/compiled_expr.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <flint/flint.h>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ARBPP_EVAL_MMAP
+#else
+#include <fstream>
+#endif
+
+using namespace arbpp;
+
+namespace
+{
+
+const char *usage_text =
+"Usage: arbpp-eval [options]\n"
+"\n"
+"Without --expr, each input line is an expression to be evaluated. With --expr, each input line is a row\n"
+"of values (separated by spaces or commas) for the variables given with --vars, and the formula is\n"
+"evaluated on each row. Numbers are parsed as by the string constructor of arbpp::arb, the results are\n"
+"printed as by its stream operator.\n"
+"\n"
+"Options:\n"
+"  --expr <formula>      formula to be evaluated on each row (see arbpp::compiled_expr for the syntax)\n"
+"  --vars <x,y,...>      names of the variables of the formula, in the order of the columns\n"
+"  --prec <bits>         working precision (default 53)\n"
+"  --accuracy <bits>     target relative accuracy: the precision is doubled until it is reached\n"
+"  --max-prec <bits>     maximum precision when a target accuracy is given (default 65536)\n"
+"  --input <file>        read from <file> instead of stdin\n"
+"  --threads <n>         number of worker threads (default: hardware concurrency)\n"
+"  --batch <n>           number of lines per batch (default 256)\n"
+"  --help                print this message\n";
+
+struct options
+{
+    std::string                 expr;
+    std::vector<std::string>    vars;
+    long                        prec = 53;
+    long                        accuracy = 0;
+    long                        max_prec = 65536;
+    std::string                 input;
+    unsigned                    n_threads = std::max(1u,std::thread::hardware_concurrency());
+    std::size_t                 batch_size = 256u;
+};
+
+std::vector<std::string> split(const std::string &s, const std::string &seps)
+{
+    std::vector<std::string> retval;
+    std::size_t pos = 0u;
+    while (true) {
+        const auto begin = s.find_first_not_of(seps,pos);
+        if (begin == std::string::npos) {
+            return retval;
+        }
+        pos = s.find_first_of(seps,begin);
+        retval.push_back(s.substr(begin,pos == std::string::npos ? std::string::npos : pos - begin));
+    }
+}
+
+// Evaluator of a single worker. In row mode, the formula is compiled once for each precision used.
+class evaluator
+{
+    public:
+        explicit evaluator(const options &opts):m_opts(opts) {}
+        std::string operator()(const std::string &line)
+        {
+            if (line.find_first_not_of(" \t\r") == std::string::npos) {
+                return std::string();
+            }
+            arb result;
+            for (long prec = m_opts.prec;; prec *= 2) {
+                prec = std::min(prec,std::max(m_opts.max_prec,m_opts.prec));
+                result = evaluate(line,prec);
+                if (m_opts.accuracy <= 0 || result.get_rel_accuracy_bits() >= m_opts.accuracy ||
+                    prec >= m_opts.max_prec)
+                {
+                    break;
+                }
+            }
+            std::ostringstream oss;
+            oss << result;
+            return oss.str();
+        }
+    private:
+        arb evaluate(const std::string &line, long prec)
+        {
+            if (m_opts.expr.empty()) {
+                return compiled_expr(line,{},prec)({});
+            }
+            const auto fields = split(line," \t\r,");
+            if (fields.size() != m_opts.vars.size()) {
+                throw std::invalid_argument("wrong number of values: expected " + std::to_string(m_opts.vars.size()) +
+                    ", found " + std::to_string(fields.size()));
+            }
+            m_args.clear();
+            for (const auto &f: fields) {
+                m_args.emplace_back(f,prec);
+            }
+            auto it = m_compiled.find(prec);
+            if (it == m_compiled.end()) {
+                it = m_compiled.emplace(prec,compiled_expr(m_opts.expr,m_opts.vars,prec)).first;
+            }
+            arb retval;
+            it->second.evaluate(retval,m_args.data());
+            return retval;
+        }
+        const options                   &m_opts;
+        std::map<long,compiled_expr>    m_compiled;
+        std::vector<arb>                m_args;
+};
+
+// Source of input lines: stdin or a file mapped into memory.
+class line_source
+{
+    public:
+        explicit line_source(const std::string &path):m_data(nullptr),m_size(0u),m_pos(0u)
+        {
+            if (path.empty()) {
+                return;
+            }
+#if defined(ARBPP_EVAL_MMAP)
+            const int fd = ::open(path.c_str(),O_RDONLY);
+            struct ::stat st;
+            if (fd < 0 || ::fstat(fd,&st) != 0) {
+                if (fd >= 0) {
+                    ::close(fd);
+                }
+                throw std::runtime_error("cannot open the input file '" + path + "'");
+            }
+            m_size = static_cast<std::size_t>(st.st_size);
+            if (m_size) {
+                void *ptr = ::mmap(nullptr,m_size,PROT_READ,MAP_PRIVATE,fd,0);
+                if (ptr == MAP_FAILED) {
+                    ::close(fd);
+                    throw std::runtime_error("cannot map the input file '" + path + "'");
+                }
+                ::madvise(ptr,m_size,MADV_SEQUENTIAL);
+                m_data = static_cast<const char *>(ptr);
+            }
+            ::close(fd);
+            m_mapped = true;
+#else
+            m_file.reset(new std::ifstream(path));
+            if (!*m_file) {
+                throw std::runtime_error("cannot open the input file '" + path + "'");
+            }
+#endif
+        }
+        line_source(const line_source &) = delete;
+        line_source &operator=(const line_source &) = delete;
+        ~line_source()
+        {
+#if defined(ARBPP_EVAL_MMAP)
+            if (m_data) {
+                ::munmap(const_cast<char *>(m_data),m_size);
+            }
+#endif
+        }
+        bool next(std::string &line)
+        {
+            if (m_mapped) {
+                if (m_pos == m_size) {
+                    return false;
+                }
+                const char *begin = m_data + m_pos, *end = std::find(begin,m_data + m_size,'\n');
+                line.assign(begin,end);
+                m_pos = static_cast<std::size_t>(end - m_data) + (end == m_data + m_size ? 0u : 1u);
+                return true;
+            }
+            return static_cast<bool>(std::getline(m_file ? *m_file : std::cin,line));
+        }
+    private:
+        const char                      *m_data;
+        std::size_t                     m_size;
+        std::size_t                     m_pos;
+        bool                            m_mapped = false;
+        std::unique_ptr<std::istream>   m_file;
+};
+
+struct batch
+{
+    std::size_t                 seq;
+    std::vector<std::string>    lines;
+    unsigned                    n_errors;
+};
+
+// Reader -> workers -> writer pipeline, with at most max_in_flight batches between the reader and the writer.
+class pipeline
+{
+    public:
+        pipeline(const options &opts, line_source &src):m_opts(opts),m_src(src),
+            m_max_in_flight(4u * opts.n_threads),m_in_flight(0u),m_n_batches(0u),m_eof(false),m_n_errors(0u) {}
+        unsigned run(std::ostream &os)
+        {
+            std::vector<std::thread> threads;
+            threads.emplace_back([this]() {read();});
+            for (unsigned i = 0u; i < m_opts.n_threads; ++i) {
+                threads.emplace_back([this]() {
+                    work();
+                    ::flint_cleanup();
+                });
+            }
+            write(os);
+            for (auto &t: threads) {
+                t.join();
+            }
+            return m_n_errors;
+        }
+    private:
+        void read()
+        {
+            std::size_t seq = 0u;
+            bool more = true;
+            while (more) {
+                std::shared_ptr<batch> b(new batch{seq,{},0u});
+                std::string line;
+                while (b->lines.size() < m_opts.batch_size && (more = m_src.next(line))) {
+                    b->lines.push_back(std::move(line));
+                }
+                if (b->lines.empty()) {
+                    break;
+                }
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_space.wait(lock,[this]() {return m_in_flight < m_max_in_flight;});
+                m_queue.push_back(std::move(b));
+                ++m_in_flight;
+                ++seq;
+                m_work.notify_one();
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_n_batches = seq;
+            m_eof = true;
+            m_work.notify_all();
+            m_done.notify_all();
+        }
+        void work()
+        {
+            evaluator eval(m_opts);
+            while (true) {
+                std::shared_ptr<batch> b;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_work.wait(lock,[this]() {return !m_queue.empty() || m_eof;});
+                    if (m_queue.empty()) {
+                        return;
+                    }
+                    b = std::move(m_queue.front());
+                    m_queue.pop_front();
+                }
+                for (auto &line: b->lines) {
+                    try {
+                        line = eval(line);
+                    } catch (const std::exception &e) {
+                        line = std::string("error: ") + e.what();
+                        ++b->n_errors;
+                    }
+                }
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_completed.emplace(b->seq,std::move(b));
+                m_done.notify_all();
+            }
+        }
+        void write(std::ostream &os)
+        {
+            for (std::size_t next = 0u;; ++next) {
+                std::shared_ptr<batch> b;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_done.wait(lock,[this,next]() {return m_completed.count(next) || (m_eof && next == m_n_batches);});
+                    const auto it = m_completed.find(next);
+                    if (it == m_completed.end()) {
+                        return;
+                    }
+                    b = std::move(it->second);
+                    m_completed.erase(it);
+                    --m_in_flight;
+                    m_n_errors += b->n_errors;
+                    m_space.notify_one();
+                }
+                for (const auto &line: b->lines) {
+                    os << line << '\n';
+                }
+                os.flush();
+            }
+        }
+        const options                                   &m_opts;
+        line_source                                     &m_src;
+        const std::size_t                               m_max_in_flight;
+        std::mutex                                      m_mutex;
+        std::condition_variable                         m_work;
+        std::condition_variable                         m_done;
+        std::condition_variable                         m_space;
+        std::deque<std::shared_ptr<batch>>              m_queue;
+        std::map<std::size_t,std::shared_ptr<batch>>    m_completed;
+        std::size_t                                     m_in_flight;
+        std::size_t                                     m_n_batches;
+        bool                                            m_eof;
+        unsigned                                        m_n_errors;
+};
+
+long parse_long(const std::string &opt, const std::string &val, long min)
+{
+    char *end;
+    const long retval = std::strtol(val.c_str(),&end,10);
+    if (val.empty() || *end != '\0' || retval < min) {
+        throw std::invalid_argument("invalid value '" + val + "' for option '" + opt + "'");
+    }
+    return retval;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    std::ios_base::sync_with_stdio(false);
+    options opts;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string opt(argv[i]);
+            if (opt == "--help") {
+                std::cout << usage_text;
+                return 0;
+            }
+            if (i + 1 == argc) {
+                throw std::invalid_argument("missing value for option '" + opt + "'");
+            }
+            const std::string val(argv[++i]);
+            if (opt == "--expr") {
+                opts.expr = val;
+            } else if (opt == "--vars") {
+                opts.vars = split(val,", ");
+            } else if (opt == "--prec") {
+                opts.prec = parse_long(opt,val,1);
+            } else if (opt == "--accuracy") {
+                opts.accuracy = parse_long(opt,val,1);
+            } else if (opt == "--max-prec") {
+                opts.max_prec = parse_long(opt,val,1);
+            } else if (opt == "--input") {
+                opts.input = val;
+            } else if (opt == "--threads") {
+                opts.n_threads = static_cast<unsigned>(parse_long(opt,val,1));
+            } else if (opt == "--batch") {
+                opts.batch_size = static_cast<std::size_t>(parse_long(opt,val,1));
+            } else {
+                throw std::invalid_argument("unknown option '" + opt + "'");
+            }
+        }
+        if (!opts.vars.empty() && opts.expr.empty()) {
+            throw std::invalid_argument("--vars requires --expr");
+        }
+        if (!opts.expr.empty()) {
+            // Check the formula once, before starting the workers.
+            compiled_expr(opts.expr,opts.vars,opts.prec);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "arbpp-eval: " << e.what() << "\n\n" << usage_text;
+        return 2;
+    }
+    try {
+        line_source src(opts.input);
+        pipeline p(opts,src);
+        const unsigned n_errors = p.run(std::cout);
+        ::flint_cleanup();
+        return n_errors ? 1 : 0;
+    } catch (const std::exception &e) {
+        std::cerr << "arbpp-eval: " << e.what() << '\n';
+        return 2;
+    }
+}
@@ -0,0 +1,102 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+// arbpp-server: evaluation daemon listening on a Unix domain socket (see arbpp_server.hpp).
+
+#include "arbpp_server.hpp"
+
+#include <algorithm>
+#include <csignal>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace
+{
+
+const char *usage_text =
+"Usage: arbpp-server [options]\n"
+"\n"
+"Options:\n"
+"  --socket <path>       path of the socket (default /tmp/arbpp.sock)\n"
+"  --threads <n>         number of worker threads (default: hardware concurrency)\n"
+"  --max-batch <n>       maximum number of rows evaluated in one batch (default 4096)\n"
+"  --max-queued <n>      maximum number of rows waiting to be evaluated (default 1048576)\n"
+"  --help                print this message\n";
+
+arbpp::remote::server *the_server = nullptr;
+
+extern "C" void handle_signal(int)
+{
+    if (the_server) {
+        the_server->stop();
+    }
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    std::string path = "/tmp/arbpp.sock";
+    unsigned n_threads = std::max(1u,std::thread::hardware_concurrency());
+    std::size_t max_batch = 4096u, max_queued = 1u << 20;
+    for (int i = 1; i < argc; ++i) {
+        const std::string opt(argv[i]);
+        if (opt == "--help") {
+            std::cout << usage_text;
+            return 0;
+        }
+        if (i + 1 == argc) {
+            std::cerr << "arbpp-server: missing value for option '" << opt << "'\n\n" << usage_text;
+            return 2;
+        }
+        const std::string val(argv[++i]);
+        if (opt == "--socket") {
+            path = val;
+        } else if (opt == "--threads" && std::atol(val.c_str()) > 0) {
+            n_threads = static_cast<unsigned>(std::atol(val.c_str()));
+        } else if (opt == "--max-batch" && std::atol(val.c_str()) > 0) {
+            max_batch = static_cast<std::size_t>(std::atol(val.c_str()));
+        } else if (opt == "--max-queued" && std::atol(val.c_str()) > 0) {
+            max_queued = static_cast<std::size_t>(std::atol(val.c_str()));
+        } else {
+            std::cerr << "arbpp-server: invalid option '" << opt << "'\n\n" << usage_text;
+            return 2;
+        }
+    }
+    try {
+        arbpp::remote::server s(path,n_threads,max_batch,max_queued);
+        the_server = &s;
+        std::signal(SIGINT,handle_signal);
+        std::signal(SIGTERM,handle_signal);
+        std::cerr << "arbpp-server: listening on '" << path << "' with " << n_threads << " worker thread(s)\n";
+        s.run();
+        std::signal(SIGINT,SIG_DFL);
+        std::signal(SIGTERM,SIG_DFL);
+        the_server = nullptr;
+    } catch (const std::exception &e) {
+        std::cerr << "arbpp-server: " << e.what() << '\n';
+        return 1;
+    }
+}
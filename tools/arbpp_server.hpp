@@ -0,0 +1,406 @@
+/***************************************************************************
+ *   Copyright (C) 2014 by Francesco Biscani                               *
+ *   bluescarni@gmail.com                                                  *
+ *                                                                         *
+ *   This file is part of Arbpp.                                           *
+ *                                                                         *
+ *   Arbpp is free software: you can redistribute it and/or modify         *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Arbpp is distributed in the hope that it will be useful,              *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Arbpp.  If not, see <http://www.gnu.org/licenses/>.        *
+ ***************************************************************************/
+
+
+#ifndef ARBPP_TOOLS_ARBPP_SERVER_HPP
+#define ARBPP_TOOLS_ARBPP_SERVER_HPP
+
+// Evaluation server: keeps a pool of worker threads (and thus the caches of constants of Arb and the
+// compiled formulas) warm across requests, and serves requests coming over a Unix domain socket in the
+// format described in arbpp_client.hpp.
+//
+// Each connection has a thread which decodes the requests and queues them. A worker takes the oldest
+// request and, together with it, all the queued requests for the same formula at the same precision (up to
+// a maximum number of rows), and evaluates all their rows through a single compiled formula. Under load,
+// the requests of concurrent clients are thus batched into one kernel call, while a lone request is served
+// immediately. The total number of queued rows is bounded: when the limit is reached, the reader threads stop
+// reading from their connections until the workers catch up, and the clients block.
+
+#include "../src/arbpp.hpp"
+#include "../src/compiled_expr.hpp"
+#include "arbpp_client.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <flint/flint.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <poll.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace arbpp
+{
+
+namespace remote
+{
+
+/// Evaluation server.
+class server
+{
+        struct connection
+        {
+            explicit connection(int fd):m_fd(fd) {}
+            ~connection()
+            {
+                ::close(m_fd);
+            }
+            void send(const std::string &payload)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                try {
+                    detail::write_frame(m_fd,payload);
+                } catch (const std::exception &) {
+                    // NOTE: the client went away, the reader thread will notice.
+                }
+            }
+            const int   m_fd;
+            std::mutex  m_mutex;
+        };
+        struct job
+        {
+            std::shared_ptr<connection> conn;
+            std::uint32_t               id;
+            request                     req;
+        };
+        // Number of running reader threads.
+        struct reader_count
+        {
+            std::mutex              mutex;
+            std::condition_variable cond;
+            std::size_t             n = 0u;
+        };
+        // Number of rows accounted for a job in the queue.
+        static std::size_t n_queued_rows(const job &j)
+        {
+            return std::max<std::size_t>(j.req.rows.size(),1u);
+        }
+        typedef std::tuple<std::string,std::vector<std::string>,long> formula_key;
+        static formula_key key(const request &req)
+        {
+            return formula_key(req.formula,req.vars,req.prec);
+        }
+        // Remove the socket file left at path by a server which is no longer running. Anything else (a file which
+        // is not a socket, or the socket of a live server) is left alone.
+        static void remove_stale_socket(const std::string &path, const ::sockaddr_un &addr)
+        {
+            struct ::stat st;
+            if (::lstat(path.c_str(),&st) != 0) {
+                if (errno == ENOENT) {
+                    return;
+                }
+                throw std::system_error(errno,std::system_category(),"cannot stat '" + path + "'");
+            }
+            if (!S_ISSOCK(st.st_mode)) {
+                throw std::system_error(EEXIST,std::system_category(),"'" + path + "' exists and is not a socket");
+            }
+            // Probe the socket: only a refused connection means that nobody is listening.
+            const int fd = ::socket(AF_UNIX,SOCK_STREAM,0);
+            if (fd < 0) {
+                throw std::system_error(errno,std::system_category(),"socket() failed");
+            }
+            const int err = ::connect(fd,reinterpret_cast<const ::sockaddr *>(&addr),sizeof(addr)) == 0 ? 0 : errno;
+            ::close(fd);
+            if (err != ECONNREFUSED && err != ENOENT) {
+                throw std::system_error(EADDRINUSE,std::system_category(),"a server is already listening on '" +
+                    path + "'");
+            }
+            if (::unlink(path.c_str()) != 0 && errno != ENOENT) {
+                throw std::system_error(errno,std::system_category(),"cannot remove '" + path + "'");
+            }
+        }
+    public:
+        /// Constructor.
+        /**
+         * Binds the socket and starts the workers. Connections are accepted only from within run(). A socket
+         * file at \p path is removed only if no server is listening on it.
+         *
+         * @param[in] path path of the socket.
+         * @param[in] n_threads number of worker threads.
+         * @param[in] max_batch_rows maximum number of rows evaluated by a worker in one batch.
+         * @param[in] max_queued_rows maximum number of rows waiting in the queue (a larger request is queued only
+         * when the queue is empty).
+         *
+         * @throws std::invalid_argument if \p n_threads is zero or \p path is too long.
+         * @throws std::system_error if the socket cannot be created, if \p path exists and is not a socket, or
+         * if another server is listening on \p path.
+         */
+        explicit server(const std::string &path, unsigned n_threads = 1u, std::size_t max_batch_rows = 4096u,
+            std::size_t max_queued_rows = 1u << 20):
+            m_path(path),m_max_batch_rows(max_batch_rows),m_max_queued_rows(max_queued_rows),m_stopping(false),
+            m_n_queued_rows(0u),m_readers(std::make_shared<reader_count>())
+        {
+            if (n_threads == 0u) {
+                throw std::invalid_argument("the number of threads must be positive");
+            }
+            const auto addr = detail::make_address(path);
+            remove_stale_socket(path,addr);
+            if (::pipe(m_wakeup) != 0) {
+                throw std::system_error(errno,std::system_category(),"pipe() failed");
+            }
+            m_fd = ::socket(AF_UNIX,SOCK_STREAM,0);
+            if (m_fd < 0) {
+                const int err = errno;
+                close_pipe();
+                throw std::system_error(err,std::system_category(),"socket() failed");
+            }
+            if (::bind(m_fd,reinterpret_cast<const ::sockaddr *>(&addr),sizeof(addr)) != 0 ||
+                ::listen(m_fd,SOMAXCONN) != 0)
+            {
+                const int err = errno;
+                ::close(m_fd);
+                close_pipe();
+                throw std::system_error(err,std::system_category(),"cannot listen on '" + path + "'");
+            }
+            for (unsigned i = 0u; i < n_threads; ++i) {
+                m_workers.emplace_back([this]() {
+                    work();
+                    ::flint_cleanup();
+                });
+            }
+        }
+        server(const server &) = delete;
+        server &operator=(const server &) = delete;
+        /// Destructor.
+        /**
+         * Stops the workers, closes the connections and removes the socket file.
+         */
+        ~server()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stopping = true;
+                for (const auto &c: m_connections) {
+                    ::shutdown(c->m_fd,SHUT_RDWR);
+                }
+            }
+            m_cond.notify_all();
+            m_space_cond.notify_all();
+            {
+                std::unique_lock<std::mutex> lock(m_readers->mutex);
+                m_readers->cond.wait(lock,[this]() {return m_readers->n == 0u;});
+            }
+            for (auto &t: m_workers) {
+                t.join();
+            }
+            ::close(m_fd);
+            ::unlink(m_path.c_str());
+            close_pipe();
+        }
+        /// Accept connections.
+        /**
+         * Blocks until stop() is called.
+         *
+         * @throws std::system_error if waiting on the socket fails.
+         */
+        void run()
+        {
+            ::pollfd fds[2] = {{m_fd,POLLIN,0},{m_wakeup[0],POLLIN,0}};
+            while (true) {
+                if (::poll(fds,2,-1) < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    throw std::system_error(errno,std::system_category(),"poll() failed");
+                }
+                if (fds[1].revents) {
+                    char c;
+                    while (::read(m_wakeup[0],&c,1) < 0 && errno == EINTR) {}
+                    return;
+                }
+                if (fds[0].revents & POLLIN) {
+                    const int fd = ::accept(m_fd,nullptr,nullptr);
+                    if (fd < 0) {
+                        continue;
+                    }
+                    auto conn = std::make_shared<connection>(fd);
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (m_stopping) {
+                        return;
+                    }
+                    m_connections.push_back(conn);
+                    // NOTE: the reader threads are detached, so that the threads of the clients which went away
+                    // do not accumulate. The destructor waits for them through the counter, which the threads
+                    // co-own as it is used after the last access to the server.
+                    auto readers = m_readers;
+                    std::lock_guard<std::mutex> readers_lock(readers->mutex);
+                    std::thread([this,conn,readers]() {
+                        read(conn);
+                        std::lock_guard<std::mutex> lock(readers->mutex);
+                        --readers->n;
+                        readers->cond.notify_all();
+                    }).detach();
+                    ++readers->n;
+                }
+            }
+        }
+        /// Stop accepting connections.
+        /**
+         * Makes run() return. This function is async-signal-safe.
+         */
+        void stop() noexcept
+        {
+            const char c = 0;
+            while (::write(m_wakeup[1],&c,1) < 0 && errno == EINTR) {}
+        }
+    private:
+        void close_pipe()
+        {
+            ::close(m_wakeup[0]);
+            ::close(m_wakeup[1]);
+        }
+        // Decode the requests of a connection and queue them.
+        void read(std::shared_ptr<connection> conn)
+        {
+            std::string payload;
+            try {
+                while (detail::read_frame(conn->m_fd,payload)) {
+                    job j{conn,0u,request{}};
+                    j.req = detail::decode_request(payload,j.id);
+                    const auto n = n_queued_rows(j);
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    // Back-pressure: wait for room in the queue.
+                    m_space_cond.wait(lock,[this,n]() {
+                        return m_stopping || m_n_queued_rows == 0u || m_n_queued_rows + n <= m_max_queued_rows;
+                    });
+                    if (m_stopping) {
+                        break;
+                    }
+                    m_n_queued_rows += n;
+                    m_queue.push_back(std::move(j));
+                    m_cond.notify_one();
+                }
+            } catch (const std::exception &) {
+                // NOTE: malformed input or I/O error: drop the connection.
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_connections.erase(std::remove(m_connections.begin(),m_connections.end(),conn),m_connections.end());
+        }
+        void work()
+        {
+            // Formulas compiled by this worker.
+            std::map<formula_key,compiled_expr> cache;
+            std::vector<arb> args;
+            arb out;
+            while (true) {
+                std::vector<job> batch;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_cond.wait(lock,[this]() {return m_stopping || !m_queue.empty();});
+                    if (m_stopping) {
+                        return;
+                    }
+                    batch.push_back(std::move(m_queue.front()));
+                    m_queue.pop_front();
+                    m_n_queued_rows -= n_queued_rows(batch[0u]);
+                    // Gather the queued requests for the same formula.
+                    const auto k = key(batch[0u].req);
+                    std::size_t n_rows = batch[0u].req.rows.size();
+                    for (auto it = m_queue.begin(); it != m_queue.end() && n_rows < m_max_batch_rows;) {
+                        if (key(it->req) == k) {
+                            n_rows += it->req.rows.size();
+                            m_n_queued_rows -= n_queued_rows(*it);
+                            batch.push_back(std::move(*it));
+                            it = m_queue.erase(it);
+                        } else {
+                            ++it;
+                        }
+                    }
+                }
+                m_space_cond.notify_all();
+                const auto &req0 = batch[0u].req;
+                compiled_expr *expr = nullptr;
+                std::string error;
+                try {
+                    // NOTE: the clients validate the precision as well, but the server cannot trust them.
+                    detail::check_precision(req0.prec);
+                    auto it = cache.find(key(req0));
+                    if (it == cache.end()) {
+                        if (cache.size() >= 256u) {
+                            cache.clear();
+                        }
+                        it = cache.emplace(key(req0),compiled_expr(req0.formula,req0.vars,req0.prec)).first;
+                    }
+                    expr = &it->second;
+                } catch (const std::exception &e) {
+                    error = e.what();
+                }
+                for (const auto &j: batch) {
+                    std::vector<result> results;
+                    results.reserve(j.req.rows.size());
+                    for (const auto &row: j.req.rows) {
+                        if (!expr) {
+                            results.push_back(result{false,error});
+                            continue;
+                        }
+                        try {
+                            args.clear();
+                            for (const auto &s: row) {
+                                args.emplace_back(s,j.req.prec);
+                            }
+                            expr->evaluate(out,args.data());
+                            std::ostringstream oss;
+                            oss << out;
+                            results.push_back(result{true,oss.str()});
+                        } catch (const std::exception &e) {
+                            results.push_back(result{false,e.what()});
+                        }
+                    }
+                    j.conn->send(detail::encode_response(j.id,results));
+                }
+            }
+        }
+        const std::string                           m_path;
+        const std::size_t                           m_max_batch_rows;
+        const std::size_t                           m_max_queued_rows;
+        int                                         m_fd;
+        int                                         m_wakeup[2];
+        std::mutex                                  m_mutex;
+        std::condition_variable                     m_cond;
+        std::condition_variable                     m_space_cond;
+        bool                                        m_stopping;
+        std::deque<job>                             m_queue;
+        std::size_t                                 m_n_queued_rows;
+        std::vector<std::shared_ptr<connection>>    m_connections;
+        std::vector<std::thread>                    m_workers;
+        std::shared_ptr<reader_count>               m_readers;
+};
+
+}
+
+}
+
+#endif